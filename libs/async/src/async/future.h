@@ -3,6 +3,8 @@
 
 #include <memory>
 #include <functional>
+#include <mutex>
+#include <optional>
 
 namespace eco {
 namespace async {
@@ -26,7 +28,97 @@ namespace async {
             d_promise->setResultCallback(callback);
         }
     };
+
+    /**
+     * @brief Promise whose result is set by the producer.
+     *
+     * The result callback of the future is called exactly once: by
+     * `setResult` when the callback is already set, or by
+     * `setResultCallback` when the result is already available. The callback
+     * is called on the thread that completes the pair, without holding a
+     * lock. Only the first result is delivered.
+     */
+    template <typename T>
+    class ResultPromise {
+        struct State {
+            std::mutex d_mutex;
+            std::optional<T> d_result;
+            typename Future<T>::ResultCallback d_callback;
+            bool d_isDelivered = false;
+        };
+
+        class SharedPromise : public Future<T>::Promise {
+            std::shared_ptr<State> d_state;
+
+        public:
+            SharedPromise(std::shared_ptr<State> state) : d_state(std::move(state)) {}
+
+            void setResultCallback(typename Future<T>::ResultCallback callback) noexcept override {
+                std::unique_lock<std::mutex> lock(d_state->d_mutex);
+
+                if (!d_state->d_result || d_state->d_isDelivered) {
+                    d_state->d_callback = std::move(callback);
+                    return;
+                }
+
+                d_state->d_isDelivered = true;
+                auto result = std::move(*d_state->d_result);
+                lock.unlock();
+                callback(std::move(result));
+            }
+        };
+
+        // PRIVATE DATA
+        std::shared_ptr<State> d_state;
+
+    public:
+        // CREATORS
+        ResultPromise() : d_state(std::make_shared<State>()) {}
+
+        // MANIPULATORS
+
+        /**
+         * @brief Return a future that receives the result of this promise.
+         */
+        Future<T> future() const {
+            return Future<T>(std::make_unique<SharedPromise>(d_state));
+        }
+
+        /**
+         * @brief Set the specified `result` and deliver it to the callback of
+         * the future when one is set. Ignored after the first result.
+         */
+        void setResult(T result) noexcept {
+            std::unique_lock<std::mutex> lock(d_state->d_mutex);
+
+            if (d_state->d_result) {
+                return;
+            }
+
+            d_state->d_result = std::move(result);
+
+            if (!d_state->d_callback) {
+                return;
+            }
+
+            d_state->d_isDelivered = true;
+            auto callback = std::move(d_state->d_callback);
+            auto value = std::move(*d_state->d_result);
+            lock.unlock();
+            callback(std::move(value));
+        }
+
+        // ACCESSORS
+
+        /**
+         * @brief Return `true` when the result was set.
+         */
+        bool hasResult() const noexcept {
+            std::lock_guard<std::mutex> lock(d_state->d_mutex);
+            return d_state->d_result.has_value();
+        }
+    };
 }
 }
 
-#endif //  ECO_ASYNC_FUTURE
\ No newline at end of file
+#endif //  ECO_ASYNC_FUTURE
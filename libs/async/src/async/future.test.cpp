@@ -28,3 +28,40 @@ TEST(Future, SetResultCallback) {
     // THEN
     EXPECT_EQ(VALUE, resultValue);
 }
+
+TEST(ResultPromise, ResultBeforeCallback) {
+    // GIVEN
+    ResultPromise<int> sut;
+    auto future = sut.future();
+
+    // WHEN
+    sut.setResult(VALUE);
+    sut.setResult(VALUE + 1);
+
+    // THEN
+    int resultValue = -1;
+    future.setResultCallback([&resultValue](int value) {
+        resultValue = value;
+    });
+    EXPECT_TRUE(sut.hasResult());
+    EXPECT_EQ(VALUE, resultValue);
+}
+
+TEST(ResultPromise, CallbackBeforeResult) {
+    // GIVEN
+    ResultPromise<int> sut;
+    auto future = sut.future();
+    int callCount = 0;
+    future.setResultCallback([&callCount](int value) {
+        EXPECT_EQ(VALUE, value);
+        ++callCount;
+    });
+
+    // WHEN
+    EXPECT_FALSE(sut.hasResult());
+    sut.setResult(VALUE);
+    sut.setResult(VALUE);
+
+    // THEN
+    EXPECT_EQ(1, callCount);
+}
@@ -0,0 +1,168 @@
+#include <io/asyncfileio.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <new>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if __linux__
+#include <sys/eventfd.h>
+#endif
+
+namespace eco {
+namespace io {
+
+// STATIC CREATORS
+
+std::unique_ptr<AsyncFileIo> AsyncFileIo::createSystemDefault(
+    std::shared_ptr<FileDescriptorEventRegistry> registry) noexcept {
+  auto fileIo = createIoUring(registry);
+
+  if (fileIo == nullptr) {
+    fileIo = createThreadPool(registry);
+  }
+
+  return fileIo;
+}
+
+// PROTECTED CREATORS
+
+AsyncFileIo::AsyncFileIo(
+    std::shared_ptr<FileDescriptorEventRegistry> registry) noexcept
+    : d_registry(std::move(registry)) {}
+
+// CREATORS
+
+AsyncFileIo::~AsyncFileIo() {
+  if (d_eventFileDescriptor == -1) {
+    return;
+  }
+
+  d_registry->remove(d_eventFileDescriptor);
+  close(d_eventFileDescriptor);
+
+  if (d_signalFileDescriptor != d_eventFileDescriptor) {
+    close(d_signalFileDescriptor);
+  }
+}
+
+// MANIPULATORS
+
+async::Future<std::size_t> AsyncFileIo::read(FileDescriptor fileDescriptor,
+                                             char *data,
+                                             std::size_t sizeInBytes,
+                                             off_t offset) noexcept {
+  return start(OperationType::Read, fileDescriptor, data, sizeInBytes, offset);
+}
+
+async::Future<std::size_t> AsyncFileIo::write(FileDescriptor fileDescriptor,
+                                              char const *data,
+                                              std::size_t sizeInBytes,
+                                              off_t offset) noexcept {
+  // The data is only read by the operation.
+  return start(OperationType::Write, fileDescriptor, const_cast<char *>(data),
+               sizeInBytes, offset);
+}
+
+async::Future<std::size_t>
+AsyncFileIo::sync(FileDescriptor fileDescriptor) noexcept {
+  return start(OperationType::Sync, fileDescriptor, nullptr, 0, 0);
+}
+
+void AsyncFileIo::onEvent(FileDescriptorEventType) noexcept {
+  processCompletions();
+}
+
+// PROTECTED MANIPULATORS
+
+bool AsyncFileIo::registerEventFileDescriptor() noexcept {
+#if __linux__
+  d_eventFileDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  d_signalFileDescriptor = d_eventFileDescriptor;
+#else
+  int pipeFileDescriptors[2];
+  if (pipe(pipeFileDescriptors) == 0) {
+    for (auto fileDescriptor : pipeFileDescriptors) {
+      fcntl(fileDescriptor, F_SETFL, O_NONBLOCK);
+      fcntl(fileDescriptor, F_SETFD, FD_CLOEXEC);
+    }
+
+    d_eventFileDescriptor = pipeFileDescriptors[0];
+    d_signalFileDescriptor = pipeFileDescriptors[1];
+  }
+#endif
+
+  if (d_eventFileDescriptor == -1) {
+    return false;
+  }
+
+  FileDescriptorEventOptions options;
+  options.interest = FileDescriptorInterest::Read;
+  return d_registry->addOrReplace(d_eventFileDescriptor, this, options);
+}
+
+void AsyncFileIo::signal() noexcept {
+#if __linux__
+  uint64_t value = 1;
+#else
+  char value = 0;
+#endif
+
+  // A full pipe is already readable, so failures can be ignored.
+  while (::write(d_signalFileDescriptor, &value, sizeof(value)) == -1 &&
+         errno == EINTR)
+    ;
+}
+
+void AsyncFileIo::clearEventFileDescriptor() noexcept {
+  char buffer[64];
+
+  while (true) {
+    auto count = ::read(d_eventFileDescriptor, buffer, sizeof(buffer));
+
+    if (count <= 0 && (count == 0 || errno != EINTR)) {
+      break;
+    }
+  }
+}
+
+void AsyncFileIo::complete(Operation *operation) noexcept {
+  auto result = operation->d_result;
+  auto promise = std::move(operation->d_promise);
+  delete operation;
+  promise.setResult(result);
+}
+
+// PRIVATE MANIPULATORS
+
+async::Future<std::size_t> AsyncFileIo::start(OperationType type,
+                                              FileDescriptor fileDescriptor,
+                                              char *data,
+                                              std::size_t sizeInBytes,
+                                              off_t offset) noexcept {
+  auto operation = new (std::nothrow) Operation();
+
+  if (operation == nullptr) {
+    async::ResultPromise<std::size_t> promise;
+    promise.setResult(c_failed);
+    return promise.future();
+  }
+
+  operation->d_type = type;
+  operation->d_fileDescriptor = fileDescriptor;
+  operation->d_data = data;
+  operation->d_sizeInBytes = sizeInBytes;
+  operation->d_offset = offset;
+  auto future = operation->d_promise.future();
+
+  if (!submit(operation)) {
+    complete(operation);
+  }
+
+  return future;
+}
+
+} // namespace io
+} // namespace eco
@@ -0,0 +1,178 @@
+#ifndef ECO_IO_ASYNCFILEIO
+#define ECO_IO_ASYNCFILEIO
+
+#include <io/filedescriptor.h>
+#include <io/filedescriptoreventpoller.h>
+
+#include <async/future.h>
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+
+#include <sys/types.h>
+
+namespace eco {
+namespace io {
+
+/**
+ * @brief Asynchronous IO on regular files, which epoll can not poll.
+ *
+ * Operations are executed outside of the calling thread, with io_uring or a
+ * dedicated thread pool. Completions are signalled through an event file
+ * descriptor that is registered in the registry the instance was created
+ * with, with the instance as user data. Call `processCompletions`, or
+ * `onEvent`, for each event of it; the futures of the completed operations
+ * resolve on that thread. This way disk access never blocks the event loop.
+ *
+ * Read and write futures resolve with the number of transferred bytes. Like
+ * with `pread` and `pwrite`, this can be less than requested: one operation
+ * transfers at most `0x7ffff000` bytes, and a read stops at the end of the
+ * file. Start another operation for the rest; a read of `0` bytes means the
+ * end of the file was reached. Sync futures resolve with `0`. All futures
+ * resolve with `c_failed` when the operation failed.
+ *
+ * The buffers of pending operations must stay valid until they completed.
+ * Futures of operations that are pending when the instance is destroyed
+ * never resolve.
+ *
+ * This class is not thread-safe: start operations and process completions on
+ * the thread of one event loop.
+ */
+class AsyncFileIo : public FileDescriptorEventUserData {
+public:
+  // PUBLIC CONSTANTS
+  static constexpr std::size_t c_failed =
+      std::numeric_limits<std::size_t>::max();
+
+protected:
+  // PROTECTED TYPES
+  enum class OperationType { Read, Write, Sync };
+
+  struct Operation {
+    OperationType d_type = OperationType::Read;
+    FileDescriptor d_fileDescriptor = -1;
+    char *d_data = nullptr;
+    std::size_t d_sizeInBytes = 0;
+    off_t d_offset = 0;
+    std::size_t d_result = c_failed;
+    async::ResultPromise<std::size_t> d_promise;
+  };
+
+  // PROTECTED DATA
+  std::shared_ptr<FileDescriptorEventRegistry> d_registry;
+  FileDescriptor d_eventFileDescriptor = -1;
+  FileDescriptor d_signalFileDescriptor = -1;
+
+  // PROTECTED CREATORS
+  AsyncFileIo(std::shared_ptr<FileDescriptorEventRegistry> registry) noexcept;
+
+public:
+  // STATIC CREATORS
+  /**
+   * @brief Create an instance that signals completions through the specified
+   * `registry`, using io_uring when available and a thread pool otherwise.
+   * Return `nullptr` on failure.
+   */
+  static std::unique_ptr<AsyncFileIo> createSystemDefault(
+      std::shared_ptr<FileDescriptorEventRegistry> registry) noexcept;
+
+  /**
+   * @brief Create an instance that executes operations on the specified
+   * `threadCount` threads and signals completions through the specified
+   * `registry`. Return `nullptr` on failure.
+   */
+  static std::unique_ptr<AsyncFileIo>
+  createThreadPool(std::shared_ptr<FileDescriptorEventRegistry> registry,
+                   std::size_t threadCount = 2) noexcept;
+
+  /**
+   * @brief Create an instance that executes operations with io_uring and
+   * signals completions through the specified `registry`. Return `nullptr`
+   * when io_uring is not available.
+   */
+  static std::unique_ptr<AsyncFileIo>
+  createIoUring(std::shared_ptr<FileDescriptorEventRegistry> registry) noexcept;
+
+  // CREATORS
+  AsyncFileIo(AsyncFileIo const &) = delete;
+  AsyncFileIo &operator=(AsyncFileIo const &) = delete;
+
+  virtual ~AsyncFileIo();
+
+  // MANIPULATORS
+  /**
+   * @brief Read up to the specified `sizeInBytes` bytes at the specified
+   * `offset` of the specified `fileDescriptor` into the specified `data`.
+   */
+  async::Future<std::size_t> read(FileDescriptor fileDescriptor, char *data,
+                                  std::size_t sizeInBytes,
+                                  off_t offset) noexcept;
+
+  /**
+   * @brief Write the specified `sizeInBytes` bytes of the specified `data` at
+   * the specified `offset` of the specified `fileDescriptor`.
+   */
+  async::Future<std::size_t> write(FileDescriptor fileDescriptor,
+                                   char const *data, std::size_t sizeInBytes,
+                                   off_t offset) noexcept;
+
+  /**
+   * @brief Flush the data and metadata of the specified `fileDescriptor` to
+   * the storage device.
+   */
+  async::Future<std::size_t> sync(FileDescriptor fileDescriptor) noexcept;
+
+  /**
+   * @brief Resolve the futures of all completed operations.
+   */
+  virtual void processCompletions() noexcept = 0;
+
+  /**
+   * @brief Process the completions signalled by the specified `eventType`.
+   */
+  void onEvent(FileDescriptorEventType eventType) noexcept override;
+
+protected:
+  // PROTECTED MANIPULATORS
+  /**
+   * @brief Create the event file descriptor and register it in the registry.
+   * Return `true` on success.
+   */
+  bool registerEventFileDescriptor() noexcept;
+
+  /**
+   * @brief Make the event file descriptor readable. Can be called from any
+   * thread.
+   */
+  void signal() noexcept;
+
+  /**
+   * @brief Start the specified `operation`, whose future resolves through
+   * `processCompletions`. Return `false` when it could not be started.
+   */
+  virtual bool submit(Operation *operation) noexcept = 0;
+
+  /**
+   * @brief Consume the pending signals of the event file descriptor.
+   */
+  void clearEventFileDescriptor() noexcept;
+
+  /**
+   * @brief Resolve the future of the specified `operation` with its result
+   * and destroy it.
+   */
+  static void complete(Operation *operation) noexcept;
+
+private:
+  // PRIVATE MANIPULATORS
+  async::Future<std::size_t> start(OperationType type,
+                                   FileDescriptor fileDescriptor, char *data,
+                                   std::size_t sizeInBytes,
+                                   off_t offset) noexcept;
+};
+
+} // namespace io
+} // namespace eco
+
+#endif // ECO_IO_ASYNCFILEIO
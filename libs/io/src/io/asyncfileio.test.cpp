@@ -0,0 +1,110 @@
+#include <io/asyncfileio.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace eco::io;
+
+namespace {
+
+/**
+ * Process completions of the specified `fileIo` until the specified `future`
+ * resolved or one second passed, and return its result.
+ */
+std::optional<std::size_t> waitForResult(
+    FileDescriptorEventPoller &poller, AsyncFileIo &fileIo,
+    eco::async::Future<std::size_t> future) {
+  std::optional<std::size_t> result;
+  future.setResultCallback([&](std::size_t value) { result = value; });
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+
+  while (!result && std::chrono::steady_clock::now() < deadline) {
+    auto event = poller.waitForNextEvent(deadline);
+    if (event.userData == &fileIo) {
+      fileIo.processCompletions();
+    }
+  }
+
+  return result;
+}
+
+void testReadWriteSync(
+    std::shared_ptr<FileDescriptorEventRegistry> const &registry,
+    AsyncFileIo &sut) {
+  // GIVEN
+  FileDescriptorEventPoller poller(registry);
+  char path[] = "/tmp/asyncfileio.test.XXXXXX";
+  int file = mkstemp(path);
+  ASSERT_NE(-1, file);
+
+  // WHEN-THEN writing.
+  auto written = waitForResult(poller, sut, sut.write(file, "hello", 6, 100));
+  EXPECT_EQ(6, written);
+
+  // WHEN-THEN syncing, which resolves with zero.
+  EXPECT_EQ(0, waitForResult(poller, sut, sut.sync(file)));
+
+  // WHEN-THEN reading, including past the end of the file.
+  char buffer[32] = {0};
+  auto read =
+      waitForResult(poller, sut, sut.read(file, buffer, sizeof(buffer), 100));
+  EXPECT_EQ(6, read);
+  EXPECT_STREQ("hello", buffer);
+
+  // WHEN-THEN reading into a buffer of more than 4 GiB, whose size does not
+  // fit into 32 bits.
+  std::size_t largeSize = (std::size_t(1) << 32) + 10;
+  void *large = mmap(nullptr, largeSize, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  ASSERT_NE(MAP_FAILED, large);
+  read = waitForResult(
+      poller, sut, sut.read(file, static_cast<char *>(large), largeSize, 0));
+  EXPECT_EQ(106, read);
+  munmap(large, largeSize);
+
+  // WHEN-THEN failing.
+  EXPECT_EQ(AsyncFileIo::c_failed,
+            waitForResult(poller, sut, sut.read(-1, buffer, 1, 0)));
+
+  close(file);
+  unlink(path);
+}
+
+} // namespace
+
+TEST(AsyncFileIo, ThreadPool) {
+  auto registry = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  auto sut = AsyncFileIo::createThreadPool(registry);
+  ASSERT_NE(nullptr, sut);
+  testReadWriteSync(registry, *sut);
+}
+
+TEST(AsyncFileIo, IoUring) {
+  auto registry = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  auto sut = AsyncFileIo::createIoUring(registry);
+  if (sut == nullptr) {
+    GTEST_SKIP() << "io_uring is not available";
+  }
+
+  testReadWriteSync(registry, *sut);
+}
+
+TEST(AsyncFileIo, SystemDefault) {
+  auto registry = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createIoUring());
+  if (registry == nullptr) {
+    registry = FileDescriptorEventRegistry::createSystemDefault();
+  }
+
+  auto sut = AsyncFileIo::createSystemDefault(registry);
+  ASSERT_NE(nullptr, sut);
+  testReadWriteSync(registry, *sut);
+}
@@ -0,0 +1,162 @@
+#include <io/asyncfileio.h>
+
+#if __linux__ && __has_include(<linux/io_uring.h>)
+
+#include <io/iouring.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+
+namespace eco {
+namespace io {
+
+namespace {
+
+const unsigned c_ringEntries = 256;
+const unsigned c_completionBufferSize = 64;
+
+// The most bytes the kernel transfers with one read or write, like
+// MAX_RW_COUNT. Larger lengths would not fit into a submission anyway.
+const std::size_t c_maxTransferSizeInBytes = 0x7ffff000;
+
+class IoUringAsyncFileIo : public AsyncFileIo {
+  // PRIVATE DATA
+  std::unique_ptr<IoUring> d_ring;
+  std::size_t d_pendingCount = 0;
+
+public:
+  IoUringAsyncFileIo(std::shared_ptr<FileDescriptorEventRegistry> registry,
+                     std::unique_ptr<IoUring> ring)
+      : AsyncFileIo(std::move(registry)), d_ring(std::move(ring)) {}
+
+  ~IoUringAsyncFileIo() {
+    // The buffers of pending operations are owned by the caller, so the
+    // operations are waited for instead of cancelled.
+    std::array<struct io_uring_cqe, c_completionBufferSize> completions;
+
+    while (d_pendingCount > 0) {
+      int result = d_ring->waitForCompletion(std::chrono::nanoseconds(-1));
+      if (result < 0 && result != -EINTR) {
+        break;
+      }
+
+      auto count = d_ring->reapCompletions(completions.data(),
+                                           c_completionBufferSize);
+      for (unsigned i = 0; i < count; ++i) {
+        delete reinterpret_cast<Operation *>(completions[i].user_data);
+      }
+
+      d_pendingCount -= count;
+    }
+  }
+
+  bool start() noexcept {
+    return registerEventFileDescriptor() &&
+           d_ring->registerEventFileDescriptor(d_eventFileDescriptor);
+  }
+
+  void processCompletions() noexcept override {
+    clearEventFileDescriptor();
+
+    std::array<struct io_uring_cqe, c_completionBufferSize> completions;
+    unsigned count = 0;
+
+    do {
+      count =
+          d_ring->reapCompletions(completions.data(), c_completionBufferSize);
+      d_pendingCount -= count;
+
+      for (unsigned i = 0; i < count; ++i) {
+        auto operation =
+            reinterpret_cast<Operation *>(completions[i].user_data);
+        auto result = completions[i].res;
+        operation->d_result =
+            result < 0 ? c_failed : static_cast<std::size_t>(result);
+        complete(operation);
+      }
+    } while (count == c_completionBufferSize);
+  }
+
+protected:
+  bool submit(Operation *operation) noexcept override {
+    auto sqe = d_ring->nextSubmission();
+
+    if (sqe == nullptr) {
+      // Submitting empties the queue, because it is not polled by the kernel.
+      d_ring->submit();
+      sqe = d_ring->nextSubmission();
+    }
+
+    if (sqe == nullptr) {
+      return false;
+    }
+
+    sqe->fd = operation->d_fileDescriptor;
+    sqe->user_data = reinterpret_cast<uint64_t>(operation);
+
+    switch (operation->d_type) {
+    case OperationType::Read:
+      sqe->opcode = IORING_OP_READ;
+      break;
+    case OperationType::Write:
+      sqe->opcode = IORING_OP_WRITE;
+      break;
+    case OperationType::Sync:
+      sqe->opcode = IORING_OP_FSYNC;
+      break;
+    }
+
+    if (operation->d_type != OperationType::Sync) {
+      sqe->addr = reinterpret_cast<uint64_t>(operation->d_data);
+      sqe->len = static_cast<uint32_t>(
+          std::min(operation->d_sizeInBytes, c_maxTransferSizeInBytes));
+      sqe->off = static_cast<uint64_t>(operation->d_offset);
+    }
+
+    // The submission can not be withdrawn once it is queued, so it counts as
+    // pending even if submitting fails; it is submitted with the next one.
+    ++d_pendingCount;
+    d_ring->submit();
+    return true;
+  }
+};
+
+} // namespace
+
+std::unique_ptr<AsyncFileIo> AsyncFileIo::createIoUring(
+    std::shared_ptr<FileDescriptorEventRegistry> registry) noexcept {
+  auto ring = IoUring::create(c_ringEntries);
+
+  if (ring == nullptr || !ring->isOpcodeSupported(IORING_OP_READ) ||
+      !ring->isOpcodeSupported(IORING_OP_WRITE)) {
+    return nullptr;
+  }
+
+  auto fileIo = std::make_unique<IoUringAsyncFileIo>(std::move(registry),
+                                                     std::move(ring));
+
+  if (!fileIo->start()) {
+    return nullptr;
+  }
+
+  return fileIo;
+}
+
+} // namespace io
+} // namespace eco
+
+#else
+
+namespace eco {
+namespace io {
+
+std::unique_ptr<AsyncFileIo> AsyncFileIo::createIoUring(
+    std::shared_ptr<FileDescriptorEventRegistry>) noexcept {
+  return nullptr;
+}
+
+} // namespace io
+} // namespace eco
+
+#endif
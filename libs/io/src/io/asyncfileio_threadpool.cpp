@@ -0,0 +1,137 @@
+#include <io/asyncfileio.h>
+
+#include <containers/asyncqueue.h>
+
+#include <cerrno>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+namespace eco {
+namespace io {
+
+namespace {
+
+class ThreadPoolAsyncFileIo : public AsyncFileIo {
+  // PRIVATE DATA
+  containers::AsyncQueue<Operation *> d_queue;
+  std::vector<std::thread> d_threads;
+  std::mutex d_completedMutex;
+  std::vector<Operation *> d_completed;
+
+public:
+  ThreadPoolAsyncFileIo(std::shared_ptr<FileDescriptorEventRegistry> registry)
+      : AsyncFileIo(std::move(registry)) {}
+
+  ~ThreadPoolAsyncFileIo() {
+    // A null operation stops one thread.
+    for (std::size_t i = 0; i < d_threads.size(); ++i) {
+      d_queue.push(nullptr);
+    }
+
+    for (auto &thread : d_threads) {
+      thread.join();
+    }
+
+    for (auto operation : d_completed) {
+      delete operation;
+    }
+
+    while (auto operation = d_queue.tryPop()) {
+      delete *operation;
+    }
+  }
+
+  bool start(std::size_t threadCount) noexcept {
+    if (!registerEventFileDescriptor()) {
+      return false;
+    }
+
+    for (std::size_t i = 0; i < threadCount; ++i) {
+      d_threads.emplace_back([this] { run(); });
+    }
+
+    return true;
+  }
+
+  void processCompletions() noexcept override {
+    clearEventFileDescriptor();
+
+    std::vector<Operation *> completed;
+    {
+      auto lock = std::lock_guard(d_completedMutex);
+      completed.swap(d_completed);
+    }
+
+    for (auto operation : completed) {
+      complete(operation);
+    }
+  }
+
+protected:
+  bool submit(Operation *operation) noexcept override {
+    d_queue.push(operation);
+    return true;
+  }
+
+private:
+  void run() noexcept {
+    while (auto operation = d_queue.pop()) {
+      execute(*operation);
+
+      bool wasEmpty = false;
+      {
+        auto lock = std::lock_guard(d_completedMutex);
+        wasEmpty = d_completed.empty();
+        d_completed.push_back(operation);
+      }
+
+      // The loop is only woken up for the first of a batch of completions.
+      if (wasEmpty) {
+        signal();
+      }
+    }
+  }
+
+  static void execute(Operation &operation) noexcept {
+    ssize_t result = -1;
+
+    do {
+      switch (operation.d_type) {
+      case OperationType::Read:
+        result = pread(operation.d_fileDescriptor, operation.d_data,
+                       operation.d_sizeInBytes, operation.d_offset);
+        break;
+      case OperationType::Write:
+        result = pwrite(operation.d_fileDescriptor, operation.d_data,
+                        operation.d_sizeInBytes, operation.d_offset);
+        break;
+      case OperationType::Sync:
+        result = fsync(operation.d_fileDescriptor);
+        break;
+      }
+    } while (result == -1 && errno == EINTR);
+
+    operation.d_result =
+        result < 0 ? c_failed : static_cast<std::size_t>(result);
+  }
+};
+
+} // namespace
+
+std::unique_ptr<AsyncFileIo> AsyncFileIo::createThreadPool(
+    std::shared_ptr<FileDescriptorEventRegistry> registry,
+    std::size_t threadCount) noexcept {
+  auto fileIo = std::make_unique<ThreadPoolAsyncFileIo>(std::move(registry));
+
+  if (!fileIo->start(threadCount == 0 ? 1 : threadCount)) {
+    return nullptr;
+  }
+
+  return fileIo;
+}
+
+} // namespace io
+} // namespace eco
@@ -0,0 +1,19 @@
+#include <io/buffer.h>
+
+#include <io/bufferpool.h>
+
+namespace eco {
+namespace io {
+
+// PRIVATE MANIPULATORS
+
+void Buffer::release(BufferHeader *header) noexcept {
+  if (header->d_release != nullptr) {
+    header->d_release(header);
+  } else {
+    header->d_pool->release(header);
+  }
+}
+
+} // namespace io
+} // namespace eco
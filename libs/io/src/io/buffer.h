@@ -1,45 +1,124 @@
 #ifndef ECO_IO_BUFFER
 #define ECO_IO_BUFFER
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <utility>
 
 namespace eco {
 namespace io {
-struct Buffer {
+
+class BufferPool;
+
+/**
+ * @brief Bookkeeping of a buffer.
+ *
+ * For pooled buffers it precedes the data in its slab. The header is a cache
+ * line, so that data is cache line aligned. Buffers that are not pooled, like
+ * views of mapped files, set `d_release` to free themselves.
+ */
+struct alignas(64) BufferHeader {
+  std::atomic<uint32_t> d_referenceCount{0};
+  uint32_t d_sizeClass = 0;
+  std::size_t d_sizeInBytes = 0;
+  char *d_data = nullptr;
+  BufferPool *d_pool = nullptr;
+  BufferHeader *d_next = nullptr;
+  void (*d_release)(BufferHeader *header) noexcept = nullptr;
+};
+
+/**
+ * @brief Intrusively reference counted handle to a buffer allocated by a
+ * `BufferPool` or mapped by a `MappedFile`.
+ *
+ * Copies share the same data, and the buffer is returned to its pool when the
+ * last handle is destroyed. A single handle is not thread-safe, but different
+ * handles to the same buffer can be used and destroyed on different threads.
+ * A pool must outlive all of its buffers.
+ */
+class Buffer {
+  // PRIVATE DATA
+  BufferHeader *d_header = nullptr;
+
+  friend class BufferPool;
+  friend class MappedFile;
+
+  // PRIVATE CREATORS
+  explicit Buffer(BufferHeader *header) noexcept : d_header(header) {}
+
+public:
+  // CREATORS
+  Buffer() noexcept = default;
+
+  Buffer(Buffer const &other) noexcept : d_header(other.d_header) {
+    if (d_header != nullptr) {
+      d_header->d_referenceCount.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  Buffer(Buffer &&other) noexcept
+      : d_header(std::exchange(other.d_header, nullptr)) {}
+
+  ~Buffer() { reset(); }
+
   // MANIPULATORS
+  Buffer &operator=(Buffer other) noexcept {
+    std::swap(d_header, other.d_header);
+    return *this;
+  }
+
+  /**
+   * @brief Release the buffer held by this handle, leaving it empty.
+   */
+  void reset() noexcept {
+    if (d_header != nullptr &&
+        d_header->d_referenceCount.fetch_sub(1, std::memory_order_acq_rel) ==
+            1) {
+      release(d_header);
+    }
+
+    d_header = nullptr;
+  }
 
   /**
-   * Return a pointer to the data array. The size of the array is at least as
-   * specified by `sizeInBytes()`.
+   * @brief Return a pointer to the data array, which has `sizeInBytes()`
+   * bytes, or `nullptr` for an empty handle.
    */
-  virtual char *data() noexcept = 0;
+  char *data() noexcept {
+    return d_header == nullptr ? nullptr : d_header->d_data;
+  }
 
   // ACCESSORS
+  char const *data() const noexcept {
+    return d_header == nullptr ? nullptr : d_header->d_data;
+  }
 
   /**
-   * Return a const pointer to the data array. The size of the array is at least
-   * as specified by `sizeInBytes()`.
+   * @brief Return the size of the data array, which is at least the size
+   * that was requested from the pool, or `0` for an empty handle.
    */
-  virtual char const *data() const noexcept = 0;
+  std::size_t sizeInBytes() const noexcept {
+    return d_header == nullptr ? 0 : d_header->d_sizeInBytes;
+  }
 
   /**
-   * Return the size of the data array inside this buffer.
+   * @brief Return the number of handles that share this buffer.
    */
-  virtual std::size_t sizeInBytes() const noexcept = 0;
-};
+  uint32_t useCount() const noexcept {
+    return d_header == nullptr
+               ? 0
+               : d_header->d_referenceCount.load(std::memory_order_relaxed);
+  }
 
-/**
- * Buffer that contains an array of a static size.
- */
-template <std::size_t N> class ArrayBuffer : public Buffer {
-  std::array<char, N> d_data;
+  explicit operator bool() const noexcept { return d_header != nullptr; }
 
-public:
-  char *data() noexcept override { return d_data.data(); }
-  char const *data() noexcept const override { return d_data.data(); }
-  std::size_t sizeInBytes() const noexcept override { return N; }
+private:
+  // PRIVATE MANIPULATORS
+  static void release(BufferHeader *header) noexcept;
 };
+
 } // namespace io
 } // namespace eco
 
-#endif // ECO_IO_BUFFER
\ No newline at end of file
+#endif // ECO_IO_BUFFER
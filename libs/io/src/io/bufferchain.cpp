@@ -0,0 +1,202 @@
+#include <io/bufferchain.h>
+
+#include <io/bufferpool.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace eco {
+namespace io {
+
+// CREATORS
+
+BufferChain::BufferChain(Buffer buffer) noexcept { append(std::move(buffer)); }
+
+BufferChain::BufferChain(BufferChain &&other) noexcept
+    : d_slices(std::move(other.d_slices)),
+      d_sizeInBytes(std::exchange(other.d_sizeInBytes, 0)) {
+  other.d_slices.clear();
+}
+
+BufferChain &BufferChain::operator=(BufferChain &&other) noexcept {
+  d_slices = std::move(other.d_slices);
+  d_sizeInBytes = std::exchange(other.d_sizeInBytes, 0);
+  other.d_slices.clear();
+  return *this;
+}
+
+// MANIPULATORS
+
+bool BufferChain::append(Buffer buffer, std::size_t offset,
+                         std::size_t length) noexcept {
+  if (offset > buffer.sizeInBytes() ||
+      length > buffer.sizeInBytes() - offset) {
+    return false;
+  }
+
+  if (length == 0) {
+    return true;
+  }
+
+  d_slices.push_back(BufferSlice{std::move(buffer), offset, length});
+  d_sizeInBytes += length;
+  return true;
+}
+
+bool BufferChain::append(Buffer buffer) noexcept {
+  auto length = buffer.sizeInBytes();
+  return append(std::move(buffer), 0, length);
+}
+
+void BufferChain::append(BufferChain &&other) noexcept {
+  if (d_slices.empty()) {
+    *this = std::move(other);
+    return;
+  }
+
+  for (auto &slice : other.d_slices) {
+    d_slices.push_back(std::move(slice));
+  }
+
+  d_sizeInBytes += other.d_sizeInBytes;
+  other.clear();
+}
+
+bool BufferChain::prepend(Buffer buffer, std::size_t offset,
+                          std::size_t length) noexcept {
+  if (offset > buffer.sizeInBytes() ||
+      length > buffer.sizeInBytes() - offset) {
+    return false;
+  }
+
+  if (length == 0) {
+    return true;
+  }
+
+  d_slices.push_front(BufferSlice{std::move(buffer), offset, length});
+  d_sizeInBytes += length;
+  return true;
+}
+
+BufferChain BufferChain::splitFront(std::size_t sizeInBytes) noexcept {
+  BufferChain front;
+
+  while (sizeInBytes > 0 && !d_slices.empty()) {
+    auto &slice = d_slices.front();
+
+    if (slice.length <= sizeInBytes) {
+      sizeInBytes -= slice.length;
+      d_sizeInBytes -= slice.length;
+      front.d_sizeInBytes += slice.length;
+      front.d_slices.push_back(std::move(slice));
+      d_slices.pop_front();
+      continue;
+    }
+
+    // The slice is shared by both chains.
+    front.d_slices.push_back(
+        BufferSlice{slice.buffer, slice.offset, sizeInBytes});
+    front.d_sizeInBytes += sizeInBytes;
+    slice.offset += sizeInBytes;
+    slice.length -= sizeInBytes;
+    d_sizeInBytes -= sizeInBytes;
+    break;
+  }
+
+  return front;
+}
+
+void BufferChain::trimFront(std::size_t sizeInBytes) noexcept {
+  while (sizeInBytes > 0 && !d_slices.empty()) {
+    auto &slice = d_slices.front();
+
+    if (slice.length <= sizeInBytes) {
+      sizeInBytes -= slice.length;
+      d_sizeInBytes -= slice.length;
+      d_slices.pop_front();
+      continue;
+    }
+
+    slice.offset += sizeInBytes;
+    slice.length -= sizeInBytes;
+    d_sizeInBytes -= sizeInBytes;
+    break;
+  }
+}
+
+void BufferChain::trimBack(std::size_t sizeInBytes) noexcept {
+  while (sizeInBytes > 0 && !d_slices.empty()) {
+    auto &slice = d_slices.back();
+
+    if (slice.length <= sizeInBytes) {
+      sizeInBytes -= slice.length;
+      d_sizeInBytes -= slice.length;
+      d_slices.pop_back();
+      continue;
+    }
+
+    slice.length -= sizeInBytes;
+    d_sizeInBytes -= sizeInBytes;
+    break;
+  }
+}
+
+bool BufferChain::coalesce(BufferPool &pool) noexcept {
+  if (d_slices.size() <= 1) {
+    return true;
+  }
+
+  auto buffer = pool.allocate(d_sizeInBytes);
+
+  if (!buffer) {
+    return false;
+  }
+
+  copyTo(buffer.data(), d_sizeInBytes);
+
+  auto sizeInBytes = d_sizeInBytes;
+  clear();
+  append(std::move(buffer), 0, sizeInBytes);
+  return true;
+}
+
+void BufferChain::clear() noexcept {
+  d_slices.clear();
+  d_sizeInBytes = 0;
+}
+
+// ACCESSORS
+
+std::size_t BufferChain::exportIoVecs(struct iovec *iovecs,
+                                      std::size_t maxCount) const noexcept {
+  auto count = std::min(maxCount, d_slices.size());
+
+  for (std::size_t i = 0; i < count; ++i) {
+    auto &slice = d_slices[i];
+    iovecs[i].iov_base = const_cast<char *>(slice.data());
+    iovecs[i].iov_len = slice.length;
+  }
+
+  return count;
+}
+
+std::size_t BufferChain::copyTo(char *destination,
+                                std::size_t sizeInBytes) const noexcept {
+  std::size_t copied = 0;
+
+  for (auto const &slice : d_slices) {
+    if (copied == sizeInBytes) {
+      break;
+    }
+
+    auto length = std::min(slice.length, sizeInBytes - copied);
+    std::memcpy(destination + copied, slice.data(), length);
+    copied += length;
+  }
+
+  return copied;
+}
+
+} // namespace io
+} // namespace eco
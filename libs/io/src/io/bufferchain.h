@@ -0,0 +1,152 @@
+#ifndef ECO_IO_BUFFERCHAIN
+#define ECO_IO_BUFFERCHAIN
+
+#include <io/buffer.h>
+
+#include <cstddef>
+#include <deque>
+
+#include <sys/uio.h>
+
+namespace eco {
+namespace io {
+
+class BufferPool;
+
+/**
+ * @brief A range of bytes inside of a pooled buffer.
+ */
+struct BufferSlice {
+  /**
+   * @brief The buffer that holds the bytes.
+   */
+  Buffer buffer;
+
+  /**
+   * @brief The position of the first byte inside of `buffer`.
+   */
+  std::size_t offset = 0;
+
+  /**
+   * @brief The number of bytes.
+   */
+  std::size_t length = 0;
+
+  char *data() noexcept { return buffer.data() + offset; }
+  char const *data() const noexcept { return buffer.data() + offset; }
+};
+
+/**
+ * @brief A sequence of bytes stored in slices of pooled buffers.
+ *
+ * Appending, prepending, splitting and trimming move or adjust slices but
+ * never copy bytes; slices of the same buffer can be shared between chains.
+ * Only `coalesce` copies. The slices can be exported as `struct iovec` arrays
+ * for vectored IO.
+ *
+ * To read into a chain, append buffers with the capacity to fill, read into
+ * the exported `iovec` array and trim the unused bytes from the back.
+ *
+ * This class is not thread-safe.
+ */
+class BufferChain {
+  // PRIVATE DATA
+  std::deque<BufferSlice> d_slices;
+  std::size_t d_sizeInBytes = 0;
+
+public:
+  using const_iterator = std::deque<BufferSlice>::const_iterator;
+
+  // CREATORS
+  BufferChain() noexcept = default;
+
+  /**
+   * @brief Create a chain that holds all bytes of the specified `buffer`.
+   */
+  explicit BufferChain(Buffer buffer) noexcept;
+
+  BufferChain(BufferChain const &) = default;
+  BufferChain(BufferChain &&other) noexcept;
+
+  BufferChain &operator=(BufferChain const &) = default;
+  BufferChain &operator=(BufferChain &&other) noexcept;
+
+  // MANIPULATORS
+  /**
+   * @brief Append the specified `length` bytes at the specified `offset` of
+   * the specified `buffer`. Return `false` when the range exceeds `buffer`.
+   */
+  bool append(Buffer buffer, std::size_t offset, std::size_t length) noexcept;
+
+  /**
+   * @brief Append all bytes of the specified `buffer`.
+   */
+  bool append(Buffer buffer) noexcept;
+
+  /**
+   * @brief Move all slices of the specified `other` chain to the end of this
+   * chain, leaving `other` empty.
+   */
+  void append(BufferChain &&other) noexcept;
+
+  /**
+   * @brief Prepend the specified `length` bytes at the specified `offset` of
+   * the specified `buffer`. Return `false` when the range exceeds `buffer`.
+   */
+  bool prepend(Buffer buffer, std::size_t offset, std::size_t length) noexcept;
+
+  /**
+   * @brief Remove the first specified `sizeInBytes` bytes, or all bytes when
+   * the chain is shorter, and return them as a new chain.
+   */
+  BufferChain splitFront(std::size_t sizeInBytes) noexcept;
+
+  /**
+   * @brief Remove the first specified `sizeInBytes` bytes, or all bytes when
+   * the chain is shorter.
+   */
+  void trimFront(std::size_t sizeInBytes) noexcept;
+
+  /**
+   * @brief Remove the last specified `sizeInBytes` bytes, or all bytes when
+   * the chain is shorter.
+   */
+  void trimBack(std::size_t sizeInBytes) noexcept;
+
+  /**
+   * @brief Copy all bytes into a single buffer allocated from the specified
+   * `pool`, unless they already are in a single slice. Return `false` when
+   * the bytes do not fit into a pooled buffer, leaving the chain unchanged.
+   */
+  bool coalesce(BufferPool &pool) noexcept;
+
+  void clear() noexcept;
+
+  // ACCESSORS
+  /**
+   * @brief Store up to the specified `maxCount` slices, starting at the first
+   * one, in the specified `iovecs` array. Return the number of stored
+   * entries.
+   */
+  std::size_t exportIoVecs(struct iovec *iovecs,
+                           std::size_t maxCount) const noexcept;
+
+  /**
+   * @brief Copy up to the specified `sizeInBytes` bytes from the front of the
+   * chain to the specified `destination`, e.g. to parse a header that spans
+   * slices. Return the number of copied bytes.
+   */
+  std::size_t copyTo(char *destination, std::size_t sizeInBytes) const noexcept;
+
+  std::size_t sizeInBytes() const noexcept { return d_sizeInBytes; }
+  std::size_t sliceCount() const noexcept { return d_slices.size(); }
+  bool empty() const noexcept { return d_sizeInBytes == 0; }
+
+  const_iterator begin() const noexcept { return d_slices.begin(); }
+  const_iterator end() const noexcept { return d_slices.end(); }
+};
+
+} // namespace io
+} // namespace eco
+
+#endif // ECO_IO_BUFFERCHAIN
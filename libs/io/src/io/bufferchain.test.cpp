@@ -0,0 +1,115 @@
+#include <io/bufferchain.h>
+#include <io/bufferpool.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace eco::io;
+
+namespace {
+
+Buffer createBuffer(BufferPool &pool, char const *text) {
+  auto buffer = pool.allocate(std::strlen(text));
+  std::memcpy(buffer.data(), text, std::strlen(text));
+  return buffer;
+}
+
+std::string toString(BufferChain const &chain) {
+  std::string text(chain.sizeInBytes(), '\0');
+  chain.copyTo(text.data(), text.size());
+  return text;
+}
+
+} // namespace
+
+TEST(BufferChain, AppendAndPrepend) {
+  // GIVEN
+  BufferPool pool;
+  BufferChain sut;
+
+  // WHEN
+  EXPECT_TRUE(sut.append(createBuffer(pool, "world"), 0, 5));
+  EXPECT_TRUE(sut.prepend(createBuffer(pool, "hello "), 0, 6));
+  BufferChain other(createBuffer(pool, "!"));
+  other.trimBack(other.sizeInBytes() - 1);
+  sut.append(std::move(other));
+
+  // THEN
+  EXPECT_EQ(3, sut.sliceCount());
+  EXPECT_EQ("hello world!", toString(sut));
+  EXPECT_TRUE(other.empty());
+  EXPECT_FALSE(sut.append(pool.allocate(256), 200, 57));
+}
+
+TEST(BufferChain, SplitAndTrim) {
+  // GIVEN
+  BufferPool pool;
+  auto buffer = createBuffer(pool, "abcdefghij");
+  BufferChain sut;
+  sut.append(buffer, 0, 5);
+  sut.append(buffer, 5, 5);
+
+  // WHEN-THEN splitting inside a slice shares the buffer.
+  auto front = sut.splitFront(7);
+  EXPECT_EQ("abcdefg", toString(front));
+  EXPECT_EQ("hij", toString(sut));
+  EXPECT_EQ(4, buffer.useCount());
+  EXPECT_EQ(buffer.data(), front.begin()->data());
+
+  // WHEN-THEN trimming.
+  front.trimFront(2);
+  front.trimBack(1);
+  EXPECT_EQ("cdef", toString(front));
+  front.trimFront(100);
+  EXPECT_TRUE(front.empty());
+  EXPECT_EQ(0, front.sliceCount());
+}
+
+TEST(BufferChain, Coalesce) {
+  // GIVEN
+  BufferPool pool;
+  BufferChain sut;
+  sut.append(createBuffer(pool, "abc"), 0, 3);
+  sut.append(createBuffer(pool, "def"), 0, 3);
+
+  // WHEN
+  EXPECT_TRUE(sut.coalesce(pool));
+
+  // THEN
+  EXPECT_EQ(1, sut.sliceCount());
+  EXPECT_EQ("abcdef", toString(sut));
+}
+
+TEST(BufferChain, VectoredIo) {
+  // GIVEN
+  BufferPool pool;
+  int sockets[2];
+  ASSERT_EQ(0, socketpair(PF_LOCAL, SOCK_STREAM, 0, sockets));
+  BufferChain message;
+  message.append(createBuffer(pool, "hello "), 0, 6);
+  message.append(createBuffer(pool, "world"), 0, 5);
+
+  // WHEN
+  struct iovec iovecs[4];
+  auto count = message.exportIoVecs(iovecs, 4);
+  EXPECT_EQ(11, writev(sockets[0], iovecs, count));
+
+  BufferChain received;
+  received.append(pool.allocate(4));
+  received.append(pool.allocate(256));
+  count = received.exportIoVecs(iovecs, 4);
+  auto length = readv(sockets[1], iovecs, count);
+  received.trimBack(received.sizeInBytes() - length);
+
+  // THEN
+  EXPECT_EQ(11, length);
+  EXPECT_EQ("hello world", toString(received));
+
+  close(sockets[0]);
+  close(sockets[1]);
+}
@@ -0,0 +1,387 @@
+#include <io/bufferpool.h>
+
+#include <algorithm>
+#include <new>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace eco {
+namespace io {
+
+namespace {
+
+const std::size_t c_hugePageSize = 2 * 1024 * 1024;
+
+/**
+ * @brief The thread index of the current thread. It is trivially
+ * destructible, so it stays accessible while other thread local objects are
+ * destroyed when the thread exits.
+ */
+struct ThreadIndexState {
+  std::size_t d_index = 0;
+  bool d_isAssigned = false;
+  bool d_isReleased = false;
+};
+
+thread_local ThreadIndexState t_threadIndexState;
+
+std::size_t sizeClassOf(std::size_t sizeInBytes) noexcept {
+  std::size_t sizeClass = 0;
+
+  while ((BufferPool::c_minBufferSize << sizeClass) < sizeInBytes) {
+    ++sizeClass;
+  }
+
+  return sizeClass;
+}
+
+std::size_t roundUp(std::size_t value, std::size_t multiple) noexcept {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+} // namespace
+
+/**
+ * @brief Hands out small thread indices that are reused after a thread exits,
+ * so they can index fixed size per-thread arrays.
+ *
+ * An instance is a thread local object of each thread that got an index. Its
+ * destructor returns the buffers in the caches of the thread to the shared
+ * free lists of all pools before the index is reused, and from then on the
+ * thread has no index, so buffers it releases later go to the shared free
+ * lists directly.
+ */
+class BufferPoolThreadIndex {
+  // PRIVATE TYPES
+  struct Registry {
+    std::mutex d_mutex;
+    std::vector<std::size_t> d_freeIndices;
+    std::size_t d_nextIndex = 0;
+    std::vector<BufferPool *> d_pools;
+  };
+
+public:
+  // PUBLIC CONSTANTS
+  static constexpr std::size_t c_noIndex = static_cast<std::size_t>(-1);
+
+  // CREATORS
+  ~BufferPoolThreadIndex();
+
+  // CLASS METHODS
+  /**
+   * @brief Return the index of the current thread, or `c_noIndex` once it
+   * was released because the thread exits.
+   */
+  static std::size_t current() noexcept;
+
+  static void addPool(BufferPool *pool) noexcept;
+
+  static void removePool(BufferPool *pool) noexcept;
+
+  // ACCESSORS
+  void touch() const noexcept {}
+
+private:
+  /**
+   * @brief Return the registry, which is never destroyed, so that pools with
+   * static storage duration can be destroyed in any order.
+   */
+  static Registry &registry() noexcept {
+    static auto registry = new Registry();
+    return *registry;
+  }
+};
+
+namespace {
+
+thread_local BufferPoolThreadIndex t_threadIndex;
+
+} // namespace
+
+BufferPoolThreadIndex::~BufferPoolThreadIndex() {
+  auto &state = t_threadIndexState;
+  state.d_isReleased = true;
+
+  auto &shared = registry();
+  auto lock = std::lock_guard(shared.d_mutex);
+
+  for (auto pool : shared.d_pools) {
+    pool->flushThreadCache(state.d_index);
+  }
+
+  shared.d_freeIndices.push_back(state.d_index);
+}
+
+std::size_t BufferPoolThreadIndex::current() noexcept {
+  auto &state = t_threadIndexState;
+
+  if (state.d_isReleased) {
+    return c_noIndex;
+  }
+
+  if (!state.d_isAssigned) {
+    auto &shared = registry();
+    auto lock = std::lock_guard(shared.d_mutex);
+
+    if (shared.d_freeIndices.empty()) {
+      state.d_index = shared.d_nextIndex++;
+    } else {
+      state.d_index = shared.d_freeIndices.back();
+      shared.d_freeIndices.pop_back();
+    }
+
+    state.d_isAssigned = true;
+
+    // Using the thread local object constructs it, which makes the thread
+    // release the index when it exits.
+    t_threadIndex.touch();
+  }
+
+  return state.d_index;
+}
+
+void BufferPoolThreadIndex::addPool(BufferPool *pool) noexcept {
+  auto &shared = registry();
+  auto lock = std::lock_guard(shared.d_mutex);
+  shared.d_pools.push_back(pool);
+}
+
+void BufferPoolThreadIndex::removePool(BufferPool *pool) noexcept {
+  auto &shared = registry();
+  auto lock = std::lock_guard(shared.d_mutex);
+  shared.d_pools.erase(
+      std::remove(shared.d_pools.begin(), shared.d_pools.end(), pool),
+      shared.d_pools.end());
+}
+
+// CREATORS
+
+BufferPool::BufferPool(BufferPoolOptions const &options) noexcept
+    : d_options(options),
+      d_threadCaches(new (std::nothrow) ThreadCache[c_maxThreadCount]) {
+  auto pageSize = options.hugePages
+                      ? c_hugePageSize
+                      : static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  d_slabSizeInBytes =
+      roundUp(std::max(options.slabSizeInBytes,
+                       sizeof(BufferHeader) + c_maxBufferSize),
+              pageSize);
+
+  if (d_threadCaches != nullptr) {
+    BufferPoolThreadIndex::addPool(this);
+  }
+}
+
+BufferPool::~BufferPool() {
+  if (d_threadCaches != nullptr) {
+    BufferPoolThreadIndex::removePool(this);
+  }
+
+  for (auto const &slab : d_slabs) {
+    munmap(slab.d_memory, slab.d_sizeInBytes);
+  }
+}
+
+// MANIPULATORS
+
+Buffer BufferPool::allocate(std::size_t sizeInBytes) noexcept {
+  if (sizeInBytes > c_maxBufferSize) {
+    return Buffer();
+  }
+
+  auto sizeClass = sizeClassOf(sizeInBytes);
+  auto cache = threadCache();
+  BufferHeader *header = nullptr;
+
+  if (cache != nullptr && cache->d_freeLists[sizeClass].d_head != nullptr) {
+    auto &freeList = cache->d_freeLists[sizeClass];
+    header = freeList.d_head;
+    freeList.d_head = header->d_next;
+    --freeList.d_count;
+  } else {
+    header = refill(sizeClass, cache == nullptr
+                                   ? nullptr
+                                   : &cache->d_freeLists[sizeClass]);
+  }
+
+  if (header == nullptr) {
+    return Buffer();
+  }
+
+  header->d_next = nullptr;
+  header->d_referenceCount.store(1, std::memory_order_relaxed);
+  return Buffer(header);
+}
+
+// ACCESSORS
+
+std::size_t BufferPool::slabCount() const noexcept {
+  auto lock = std::lock_guard(d_mutex);
+  return d_slabs.size();
+}
+
+std::size_t BufferPool::sizeClassSize(std::size_t sizeInBytes) noexcept {
+  return sizeInBytes > c_maxBufferSize
+             ? 0
+             : c_minBufferSize << sizeClassOf(sizeInBytes);
+}
+
+// PRIVATE MANIPULATORS
+
+void BufferPool::release(BufferHeader *header) noexcept {
+  auto cache = threadCache();
+
+  if (cache == nullptr) {
+    auto lock = std::lock_guard(d_mutex);
+    auto &freeList = d_freeLists[header->d_sizeClass];
+    header->d_next = freeList.d_head;
+    freeList.d_head = header;
+    ++freeList.d_count;
+    return;
+  }
+
+  auto &cacheList = cache->d_freeLists[header->d_sizeClass];
+  header->d_next = cacheList.d_head;
+  cacheList.d_head = header;
+  ++cacheList.d_count;
+
+  if (cacheList.d_count <= d_options.threadCacheSize) {
+    return;
+  }
+
+  // Return half of the cache, so buffers released by one thread become
+  // available to the threads that allocate them.
+  auto count = cacheList.d_count / 2;
+  auto first = cacheList.d_head;
+  auto last = first;
+  for (std::size_t i = 1; i < count; ++i) {
+    last = last->d_next;
+  }
+
+  cacheList.d_head = last->d_next;
+  cacheList.d_count -= count;
+
+  auto lock = std::lock_guard(d_mutex);
+  auto &freeList = d_freeLists[header->d_sizeClass];
+  last->d_next = freeList.d_head;
+  freeList.d_head = first;
+  freeList.d_count += count;
+}
+
+BufferHeader *BufferPool::refill(std::size_t sizeClass,
+                                 FreeList *cache) noexcept {
+  auto lock = std::lock_guard(d_mutex);
+  auto &freeList = d_freeLists[sizeClass];
+
+  if (freeList.d_head == nullptr && !allocateSlab(sizeClass)) {
+    return nullptr;
+  }
+
+  auto header = freeList.d_head;
+  freeList.d_head = header->d_next;
+  --freeList.d_count;
+
+  if (cache == nullptr) {
+    return header;
+  }
+
+  // Take up to half a cache worth of buffers, so the next allocations of this
+  // thread do not take the lock.
+  auto count = std::min(freeList.d_count, d_options.threadCacheSize / 2);
+  for (std::size_t i = 0; i < count; ++i) {
+    auto next = freeList.d_head;
+    freeList.d_head = next->d_next;
+    next->d_next = cache->d_head;
+    cache->d_head = next;
+  }
+
+  freeList.d_count -= count;
+  cache->d_count += count;
+  return header;
+}
+
+bool BufferPool::allocateSlab(std::size_t sizeClass) noexcept {
+  void *memory = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+  if (d_options.hugePages) {
+    memory = mmap(nullptr, d_slabSizeInBytes, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  }
+#endif
+
+  if (memory == MAP_FAILED) {
+    memory = mmap(nullptr, d_slabSizeInBytes, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (memory == MAP_FAILED) {
+      return false;
+    }
+
+#ifdef MADV_HUGEPAGE
+    if (d_options.hugePages) {
+      madvise(memory, d_slabSizeInBytes, MADV_HUGEPAGE);
+    }
+#endif
+  }
+
+  d_slabs.push_back(Slab{memory, d_slabSizeInBytes});
+
+  auto bufferSize = c_minBufferSize << sizeClass;
+  auto stride = sizeof(BufferHeader) + bufferSize;
+  auto count = d_slabSizeInBytes / stride;
+  auto &freeList = d_freeLists[sizeClass];
+
+  // Buffers are linked in reverse, so they are handed out in address order.
+  for (std::size_t i = count; i > 0; --i) {
+    auto header = new (static_cast<char *>(memory) + (i - 1) * stride)
+        BufferHeader();
+    header->d_sizeClass = static_cast<uint32_t>(sizeClass);
+    header->d_sizeInBytes = bufferSize;
+    header->d_data = reinterpret_cast<char *>(header + 1);
+    header->d_pool = this;
+    header->d_next = freeList.d_head;
+    freeList.d_head = header;
+  }
+
+  freeList.d_count += count;
+  return true;
+}
+
+void BufferPool::flushThreadCache(std::size_t threadIndex) noexcept {
+  if (threadIndex >= c_maxThreadCount) {
+    return;
+  }
+
+  auto &cache = d_threadCaches[threadIndex];
+  auto lock = std::lock_guard(d_mutex);
+
+  for (std::size_t sizeClass = 0; sizeClass < c_sizeClassCount; ++sizeClass) {
+    auto &cacheList = cache.d_freeLists[sizeClass];
+    auto &freeList = d_freeLists[sizeClass];
+
+    while (cacheList.d_head != nullptr) {
+      auto header = cacheList.d_head;
+      cacheList.d_head = header->d_next;
+      header->d_next = freeList.d_head;
+      freeList.d_head = header;
+    }
+
+    freeList.d_count += cacheList.d_count;
+    cacheList.d_count = 0;
+  }
+}
+
+BufferPool::ThreadCache *BufferPool::threadCache() noexcept {
+  auto index = BufferPoolThreadIndex::current();
+
+  if (d_threadCaches == nullptr || index >= c_maxThreadCount) {
+    return nullptr;
+  }
+
+  return &d_threadCaches[index];
+}
+
+} // namespace io
+} // namespace eco
@@ -0,0 +1,145 @@
+#ifndef ECO_IO_BUFFERPOOL
+#define ECO_IO_BUFFERPOOL
+
+#include <io/buffer.h>
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace eco {
+namespace io {
+
+/**
+ * @brief Configures a `BufferPool`.
+ */
+struct BufferPoolOptions {
+  /**
+   * @brief The size of the memory regions that buffers are carved from. It is
+   * raised to fit at least one buffer of the largest size class.
+   */
+  std::size_t slabSizeInBytes = 2 * 1024 * 1024;
+
+  /**
+   * @brief Back slabs with huge pages. When none are reserved, transparent
+   * huge pages are requested instead.
+   */
+  bool hugePages = false;
+
+  /**
+   * @brief The number of free buffers per size class each thread keeps
+   * before it returns some of them to the shared free list.
+   */
+  std::size_t threadCacheSize = 64;
+};
+
+/**
+ * @brief Thread-safe pool of reference counted buffers with power of two size
+ * classes from `c_minBufferSize` to `c_maxBufferSize` bytes.
+ *
+ * Buffers are carved from slabs that are allocated on demand and only
+ * released when the pool is destroyed. Released buffers are kept in a cache of
+ * the releasing thread, so a thread that allocates and releases buffers in a
+ * steady state neither allocates memory nor takes a lock.
+ */
+class BufferPool {
+public:
+  // PUBLIC CONSTANTS
+  static constexpr std::size_t c_minBufferSize = 256;
+  static constexpr std::size_t c_maxBufferSize = 64 * 1024;
+  static constexpr std::size_t c_sizeClassCount = 9;
+
+  /**
+   * @brief The number of threads that can have a cache at the same time.
+   * Additional threads use the shared free lists.
+   */
+  static constexpr std::size_t c_maxThreadCount = 256;
+
+private:
+  struct FreeList {
+    BufferHeader *d_head = nullptr;
+    std::size_t d_count = 0;
+  };
+
+  struct alignas(64) ThreadCache {
+    std::array<FreeList, c_sizeClassCount> d_freeLists;
+  };
+
+  struct Slab {
+    void *d_memory = nullptr;
+    std::size_t d_sizeInBytes = 0;
+  };
+
+  // PRIVATE DATA
+  BufferPoolOptions d_options;
+  std::size_t d_slabSizeInBytes = 0;
+  mutable std::mutex d_mutex;
+  std::array<FreeList, c_sizeClassCount> d_freeLists;
+  std::vector<Slab> d_slabs;
+  std::unique_ptr<ThreadCache[]> d_threadCaches;
+
+  friend class Buffer;
+  friend class BufferPoolThreadIndex;
+
+public:
+  // CREATORS
+  explicit BufferPool(
+      BufferPoolOptions const &options = BufferPoolOptions()) noexcept;
+
+  BufferPool(BufferPool const &) = delete;
+  BufferPool &operator=(BufferPool const &) = delete;
+
+  ~BufferPool();
+
+  // MANIPULATORS
+  /**
+   * @brief Return a buffer of at least the specified `sizeInBytes`, or an
+   * empty buffer when `sizeInBytes` exceeds `c_maxBufferSize` or no memory is
+   * available.
+   */
+  Buffer allocate(std::size_t sizeInBytes) noexcept;
+
+  // ACCESSORS
+  /**
+   * @brief Return the number of slabs allocated so far.
+   */
+  std::size_t slabCount() const noexcept;
+
+  /**
+   * @brief Return the size of the buffers of the size class that fits the
+   * specified `sizeInBytes`, or `0` when it exceeds `c_maxBufferSize`.
+   */
+  static std::size_t sizeClassSize(std::size_t sizeInBytes) noexcept;
+
+private:
+  // PRIVATE MANIPULATORS
+  void release(BufferHeader *header) noexcept;
+
+  /**
+   * @brief Move free buffers of the specified `sizeClass` from the shared
+   * free list to the specified `cache`, allocating a slab when there are none.
+   * Return one of them, or `nullptr` when no memory is available.
+   */
+  BufferHeader *refill(std::size_t sizeClass, FreeList *cache) noexcept;
+
+  bool allocateSlab(std::size_t sizeClass) noexcept;
+
+  /**
+   * @brief Move the buffers in the cache of the thread with the specified
+   * `threadIndex`, which exits, to the shared free lists.
+   */
+  void flushThreadCache(std::size_t threadIndex) noexcept;
+
+  /**
+   * @brief Return the cache of the current thread, or `nullptr` when it has
+   * none, e.g. because it exits.
+   */
+  ThreadCache *threadCache() noexcept;
+};
+
+} // namespace io
+} // namespace eco
+
+#endif // ECO_IO_BUFFERPOOL
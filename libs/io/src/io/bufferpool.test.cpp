@@ -0,0 +1,177 @@
+#include <io/bufferpool.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace eco::io;
+
+TEST(BufferPool, Allocate) {
+  // GIVEN
+  BufferPool sut;
+
+  // WHEN-THEN sizes are rounded up to their size class.
+  auto buffer = sut.allocate(100);
+  ASSERT_TRUE(buffer);
+  EXPECT_EQ(256, buffer.sizeInBytes());
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(buffer.data()) % 64);
+  EXPECT_EQ(1024, sut.allocate(1000).sizeInBytes());
+  EXPECT_EQ(BufferPool::c_maxBufferSize,
+            sut.allocate(BufferPool::c_maxBufferSize).sizeInBytes());
+  EXPECT_EQ(256, sut.allocate(0).sizeInBytes());
+
+  // WHEN-THEN too large sizes are rejected.
+  auto tooLarge = sut.allocate(BufferPool::c_maxBufferSize + 1);
+  EXPECT_FALSE(tooLarge);
+  EXPECT_EQ(nullptr, tooLarge.data());
+  EXPECT_EQ(0, tooLarge.sizeInBytes());
+}
+
+TEST(BufferPool, ReferenceCounting) {
+  // GIVEN
+  BufferPool sut;
+  auto buffer = sut.allocate(256);
+  std::memcpy(buffer.data(), "abcdefg", 8);
+
+  // WHEN-THEN copies share the data.
+  auto copy = buffer;
+  EXPECT_EQ(2, buffer.useCount());
+  EXPECT_EQ(buffer.data(), copy.data());
+  EXPECT_STREQ("abcdefg", copy.data());
+
+  // WHEN-THEN moving transfers the reference.
+  auto moved = std::move(copy);
+  EXPECT_FALSE(copy);
+  EXPECT_EQ(2, moved.useCount());
+
+  // WHEN-THEN resetting releases the reference.
+  moved.reset();
+  EXPECT_EQ(1, buffer.useCount());
+}
+
+TEST(BufferPool, Reuse) {
+  // GIVEN
+  BufferPool sut;
+  auto data = sut.allocate(4096).data();
+  auto slabCount = sut.slabCount();
+
+  // WHEN-THEN a released buffer is handed out again without new slabs.
+  for (int i = 0; i < 1000; ++i) {
+    auto buffer = sut.allocate(4096);
+    EXPECT_EQ(data, buffer.data());
+  }
+
+  EXPECT_EQ(1, slabCount);
+  EXPECT_EQ(slabCount, sut.slabCount());
+}
+
+TEST(BufferPool, ManyBuffers) {
+  // GIVEN
+  BufferPoolOptions options;
+  options.slabSizeInBytes = 64 * 1024;
+  options.hugePages = true;
+  BufferPool sut(options);
+  std::vector<Buffer> buffers;
+  std::set<char *> data;
+
+  // WHEN
+  for (int i = 0; i < 3000; ++i) {
+    buffers.push_back(sut.allocate(1024));
+    ASSERT_TRUE(buffers.back());
+    data.insert(buffers.back().data());
+  }
+
+  // THEN all buffers are distinct and slabs, rounded up to a huge page, were
+  // added on demand.
+  EXPECT_EQ(3000, data.size());
+  EXPECT_LT(1, sut.slabCount());
+}
+
+TEST(BufferPool, MultipleThreads) {
+  // GIVEN
+  BufferPoolOptions options;
+  options.threadCacheSize = 8;
+  BufferPool sut(options);
+  std::vector<Buffer> buffers(4000);
+  std::vector<std::thread> threads;
+
+  // WHEN buffers are allocated on some threads and released on others.
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = t * 1000; i < (t + 1) * 1000; ++i) {
+        buffers[i] = sut.allocate(512);
+        buffers[i].data()[0] = static_cast<char>(i);
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = t; i < 4000; i += 4) {
+        EXPECT_EQ(static_cast<char>(i), buffers[i].data()[0]);
+        buffers[i].reset();
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // THEN all buffers are available again.
+  auto slabCount = sut.slabCount();
+  for (int i = 0; i < 4000; ++i) {
+    buffers[i] = sut.allocate(512);
+    ASSERT_TRUE(buffers[i]);
+  }
+
+  EXPECT_EQ(slabCount, sut.slabCount());
+}
+
+namespace {
+
+/**
+ * Holds a buffer until the thread exits.
+ */
+struct ThreadExitHolder {
+  Buffer d_buffer;
+};
+
+} // namespace
+
+TEST(BufferPool, ThreadExitReturnsCachedBuffers) {
+  // GIVEN a pool with one slab and caches that can hold all of its buffers
+  BufferPoolOptions options;
+  options.slabSizeInBytes = 1;
+  options.threadCacheSize = 100000;
+  BufferPool sut(options);
+
+  // WHEN a thread caches the buffers of the slab and exits, releasing its last
+  // buffer after its caches were flushed
+  std::thread([&] {
+    thread_local ThreadExitHolder holder;
+    std::vector<Buffer> buffers;
+    for (int i = 0; i < 10; ++i) {
+      buffers.push_back(sut.allocate(256));
+    }
+    holder.d_buffer = sut.allocate(256);
+  }).join();
+  ASSERT_EQ(1, sut.slabCount());
+
+  // THEN all buffers of the slab are available to other threads.
+  std::vector<Buffer> buffers;
+  for (int i = 0; i < 100; ++i) {
+    buffers.push_back(sut.allocate(256));
+    ASSERT_TRUE(buffers.back());
+  }
+
+  EXPECT_EQ(1, sut.slabCount());
+}
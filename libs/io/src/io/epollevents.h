@@ -0,0 +1,112 @@
+#ifndef ECO_IO_EPOLLEVENTS
+#define ECO_IO_EPOLLEVENTS
+
+#include <io/filedescriptoreventpoller.h>
+
+#include <cstdint>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+namespace eco {
+namespace io {
+
+/**
+ * @brief Translate the specified `options` to `EPOLL*` flags and store them in
+ * the specified `events`. Return `false` when `options` are incompatible.
+ *
+ * Only available on Linux, where both the epoll and the io_uring backend use
+ * these flags.
+ */
+inline bool optionsToEPollEvents(FileDescriptorEventOptions const &options,
+                                 uint32_t &events) noexcept {
+  if (options.exclusive && options.oneShot) {
+    return false;
+  }
+
+  events = 0;
+
+  if ((options.interest & FileDescriptorInterest::Read) !=
+      FileDescriptorInterest::None) {
+    events |= EPOLLIN;
+  }
+
+  if ((options.interest & FileDescriptorInterest::Write) !=
+      FileDescriptorInterest::None) {
+    events |= EPOLLOUT;
+  }
+
+  if ((options.interest & FileDescriptorInterest::PeerClosed) !=
+      FileDescriptorInterest::None) {
+    events |= EPOLLRDHUP;
+  }
+
+  if (options.triggerMode == FileDescriptorTriggerMode::Edge) {
+    events |= EPOLLET;
+  }
+
+  if (options.oneShot) {
+    events |= EPOLLONESHOT;
+  }
+
+  if (options.exclusive) {
+    events |= EPOLLEXCLUSIVE;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Enable busy polling on the specified `fileDescriptor` as requested by
+ * the specified `options`. Failures are ignored, because busy polling is only
+ * a hint: the file descriptor might not be a socket, or raising the busy poll
+ * time might require `CAP_NET_ADMIN`.
+ */
+inline void applyBusyPoll(FileDescriptor fileDescriptor,
+                          FileDescriptorEventOptions const &options) noexcept {
+  int busyPoll = static_cast<int>(options.busyPoll.count());
+  setsockopt(fileDescriptor, SOL_SOCKET, SO_BUSY_POLL, &busyPoll,
+             sizeof(busyPoll));
+
+#ifdef SO_PREFER_BUSY_POLL
+  int preferBusyPoll = busyPoll > 0 ? 1 : 0;
+  setsockopt(fileDescriptor, SOL_SOCKET, SO_PREFER_BUSY_POLL, &preferBusyPoll,
+             sizeof(preferBusyPoll));
+#endif
+}
+
+/**
+ * @brief Return the event type that corresponds to the specified `EPOLL*`
+ * `events`, or `FileDescriptorEventType::Timeout` when none of them apply.
+ */
+inline FileDescriptorEventType
+ePollEventsToEventType(uint32_t events) noexcept {
+  auto eventType = FileDescriptorEventType::Timeout;
+
+  if ((events & EPOLLIN) != 0) {
+    eventType = eventType | FileDescriptorEventType::Readable;
+  }
+
+  if ((events & EPOLLOUT) != 0) {
+    eventType = eventType | FileDescriptorEventType::Writable;
+  }
+
+  if ((events & EPOLLERR) != 0) {
+    eventType = eventType | FileDescriptorEventType::ErrorCondition;
+  }
+
+  if ((events & EPOLLHUP) != 0) {
+    eventType = eventType | FileDescriptorEventType::HangUp;
+  }
+
+  if ((events & EPOLLRDHUP) != 0) {
+    eventType = eventType | FileDescriptorEventType::PeerClosed;
+  }
+
+  return eventType;
+}
+
+} // namespace io
+} // namespace eco
+
+#endif // ECO_IO_EPOLLEVENTS
@@ -0,0 +1,200 @@
+#include <io/filedescriptoreventpoller.h>
+
+#include <algorithm>
+
+namespace eco {
+namespace io {
+
+namespace {
+
+/**
+ * @brief The events that `FileDescriptorEventPoller::dispatch` has yet to
+ * hand out, with those of the dispatch it is nested in, if any.
+ */
+struct DispatchedEvents {
+  FileDescriptorEvent *d_events;
+  std::size_t d_nextIndex;
+  std::size_t d_count;
+  DispatchedEvents *d_outer;
+};
+
+thread_local DispatchedEvents *t_dispatchedEvents = nullptr;
+
+} // namespace
+
+// CREATORS
+
+FileDescriptorEventUserData::~FileDescriptorEventUserData() {
+  for (auto dispatched = t_dispatchedEvents; dispatched != nullptr;
+       dispatched = dispatched->d_outer) {
+    for (auto i = dispatched->d_nextIndex; i < dispatched->d_count; ++i) {
+      if (dispatched->d_events[i].userData == this) {
+        dispatched->d_events[i].userData = nullptr;
+      }
+    }
+  }
+}
+
+// MANIPULATORS
+
+int FileDescriptorEventPollerBuffer::waitForEvents(
+    FileDescriptorEvent *events, std::size_t maxEventCount,
+    std::chrono::nanoseconds const &timeout) noexcept {
+  std::size_t count = 0;
+  auto nextTimeout = timeout;
+
+  while (count < maxEventCount) {
+    auto event = waitForNextEvent(nextTimeout);
+
+    if (event.eventType == FileDescriptorEventType::Error) {
+      return count == 0 ? -1 : static_cast<int>(count);
+    }
+
+    if (event.eventType == FileDescriptorEventType::Timeout) {
+      break;
+    }
+
+    events[count++] = std::move(event);
+
+    // Only the first event is waited for, the remaining events are collected
+    // as long as they are immediately available.
+    nextTimeout = std::chrono::nanoseconds(0);
+  }
+
+  return static_cast<int>(count);
+}
+
+void FileDescriptorEventPoller::setSpinOptions(
+    FileDescriptorEventSpinOptions const &options) noexcept {
+  d_spinOptions = options;
+  d_spinOptions.minSpinTime =
+      std::min(std::max(options.minSpinTime, std::chrono::nanoseconds(1)),
+               options.maxSpinTime);
+  setSpinTime(options.maxSpinTime);
+}
+
+// STATIC MANIPULATORS
+
+void FileDescriptorEventPoller::dispatch(FileDescriptorEvent *events,
+                                         std::size_t count) noexcept {
+  DispatchedEvents dispatched{events, 0, count, t_dispatchedEvents};
+  t_dispatchedEvents = &dispatched;
+
+  while (dispatched.d_nextIndex < count) {
+    auto &event = events[dispatched.d_nextIndex++];
+
+    if (event.userData != nullptr) {
+      event.userData->onEvent(event.eventType);
+    }
+  }
+
+  t_dispatchedEvents = dispatched.d_outer;
+}
+
+// ACCESSORS
+
+FileDescriptorEventPollerStatistics
+FileDescriptorEventPoller::statistics() const noexcept {
+  FileDescriptorEventPollerStatistics statistics;
+  statistics.spinHits = d_spinHits.load(std::memory_order_relaxed);
+  statistics.blockingWaits = d_blockingWaits.load(std::memory_order_relaxed);
+  statistics.spinTime = std::chrono::nanoseconds(
+      d_spinTimeCount.load(std::memory_order_relaxed));
+  return statistics;
+}
+
+// PRIVATE MANIPULATORS
+
+FileDescriptorEvent FileDescriptorEventPoller::spinForNextEvent(
+    std::chrono::nanoseconds const &timeout) noexcept {
+  FileDescriptorEvent event;
+
+  spinThenWait(timeout, [&](std::chrono::nanoseconds const &pollTimeout) {
+    event = d_buffer->waitForNextEvent(pollTimeout);
+
+    switch (event.eventType) {
+    case FileDescriptorEventType::Timeout:
+      return PollResult::Timeout;
+    case FileDescriptorEventType::Error:
+      return PollResult::Error;
+    default:
+      return PollResult::Events;
+    }
+  });
+
+  return event;
+}
+
+int FileDescriptorEventPoller::spinForEvents(
+    FileDescriptorEvent *events, std::size_t maxEventCount,
+    std::chrono::nanoseconds const &timeout) noexcept {
+  int count = 0;
+
+  spinThenWait(timeout, [&](std::chrono::nanoseconds const &pollTimeout) {
+    count = d_buffer->waitForEvents(events, maxEventCount, pollTimeout);
+    return count > 0    ? PollResult::Events
+           : count == 0 ? PollResult::Timeout
+                        : PollResult::Error;
+  });
+
+  return count;
+}
+
+template <typename Poll>
+void FileDescriptorEventPoller::spinThenWait(
+    std::chrono::nanoseconds const &timeout, Poll const &poll) noexcept {
+  auto start = std::chrono::steady_clock::now();
+  auto spinTime =
+      timeout.count() < 0 ? d_spinTime : std::min(d_spinTime, timeout);
+  auto now = start;
+
+  do {
+    auto result = poll(std::chrono::nanoseconds(0));
+
+    // Errors are passed straight through, they are no reason to wait.
+    if (result == PollResult::Error) {
+      return;
+    }
+
+    if (result == PollResult::Events) {
+      d_spinHits.fetch_add(1, std::memory_order_relaxed);
+
+      // Spinning pays off, so the window slowly grows back to its maximum.
+      setSpinTime(std::min(d_spinTime + d_spinTime / 8 +
+                               std::chrono::nanoseconds(1),
+                           d_spinOptions.maxSpinTime));
+      return;
+    }
+
+    now = std::chrono::steady_clock::now();
+  } while (now - start < spinTime);
+
+  d_blockingWaits.fetch_add(1, std::memory_order_relaxed);
+
+  auto remaining = timeout;
+  if (timeout.count() >= 0) {
+    remaining = std::max(timeout - (now - start), std::chrono::nanoseconds(0));
+  }
+
+  auto result = poll(remaining);
+  auto blocked = std::chrono::steady_clock::now() - now;
+
+  // An event that arrived shortly after the window elapsed would have been
+  // caught by spinning a little longer. Otherwise the events are too rare for
+  // spinning to pay off.
+  if (result == PollResult::Events &&
+      d_spinTime + blocked <= d_spinOptions.maxSpinTime) {
+    setSpinTime(d_spinTime + blocked);
+  } else {
+    setSpinTime(std::max(d_spinTime / 2, d_spinOptions.minSpinTime));
+  }
+}
+
+void FileDescriptorEventPoller::setSpinTime(
+    std::chrono::nanoseconds spinTime) noexcept {
+  d_spinTime = spinTime;
+  d_spinTimeCount.store(spinTime.count(), std::memory_order_relaxed);
+}
+
+} // namespace io
+} // namespace eco
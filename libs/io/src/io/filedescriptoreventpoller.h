@@ -3,7 +3,11 @@
 
 #include <io/filedescriptor.h>
 
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 
 namespace eco {
@@ -11,8 +15,12 @@ namespace io {
 
 /**
  * @brief The types of file descriptor events.
+ *
+ * Apart from `Error` and `Timeout`, the values are bits that are combined
+ * into a single event per file descriptor. Use `hasEventType` to test for
+ * them.
  */
-enum class FileDescriptorEventType {
+enum class FileDescriptorEventType : int {
   /**
    * @brief An error ocurred while retrieving events.
    */
@@ -26,16 +34,210 @@ enum class FileDescriptorEventType {
   /**
    * @brief The file descriptor became readable.
    */
-  Readable = 1,
+  Readable = 1 << 0,
 
   /**
    * @brief The file descriptor became writable.
    */
-  Writable = 2
+  Writable = 1 << 1,
+
+  /**
+   * @brief An error condition ocurred on the file descriptor.
+   */
+  ErrorCondition = 1 << 2,
+
+  /**
+   * @brief The file descriptor was hung up, e.g. both sides of the connection
+   * are closed.
+   */
+  HangUp = 1 << 3,
+
+  /**
+   * @brief The peer closed its side of the connection. Only reported when
+   * interested in `FileDescriptorInterest::PeerClosed`.
+   */
+  PeerClosed = 1 << 4
+};
+
+constexpr FileDescriptorEventType operator|(FileDescriptorEventType lhs,
+                                            FileDescriptorEventType rhs) {
+  return static_cast<FileDescriptorEventType>(static_cast<int>(lhs) |
+                                              static_cast<int>(rhs));
+}
+
+constexpr FileDescriptorEventType operator&(FileDescriptorEventType lhs,
+                                            FileDescriptorEventType rhs) {
+  return static_cast<FileDescriptorEventType>(static_cast<int>(lhs) &
+                                              static_cast<int>(rhs));
+}
+
+/**
+ * @brief Return `true` when the specified `eventType` is a file descriptor
+ * event that contains any of the specified `types` and `false` otherwise.
+ */
+constexpr bool hasEventType(FileDescriptorEventType eventType,
+                            FileDescriptorEventType types) {
+  return static_cast<int>(eventType) > 0 &&
+         (eventType & types) != FileDescriptorEventType::Timeout;
+}
+
+/**
+ * @brief The events a registered file descriptor is interested in.
+ *
+ * Values can be combined using the bitwise operators.
+ */
+enum class FileDescriptorInterest : unsigned {
+  /**
+   * @brief Not interested in any events.
+   */
+  None = 0,
+
+  /**
+   * @brief Interested in the file descriptor becoming readable.
+   */
+  Read = 1 << 0,
+
+  /**
+   * @brief Interested in the file descriptor becoming writable.
+   */
+  Write = 1 << 1,
+
+  /**
+   * @brief Interested in the peer closing its side of the connection.
+   */
+  PeerClosed = 1 << 2
+};
+
+constexpr FileDescriptorInterest operator|(FileDescriptorInterest lhs,
+                                           FileDescriptorInterest rhs) {
+  return static_cast<FileDescriptorInterest>(static_cast<unsigned>(lhs) |
+                                             static_cast<unsigned>(rhs));
+}
+
+constexpr FileDescriptorInterest operator&(FileDescriptorInterest lhs,
+                                           FileDescriptorInterest rhs) {
+  return static_cast<FileDescriptorInterest>(static_cast<unsigned>(lhs) &
+                                             static_cast<unsigned>(rhs));
+}
+
+/**
+ * @brief How readiness of a registered file descriptor is reported.
+ */
+enum class FileDescriptorTriggerMode {
+  /**
+   * @brief Report an event only when the file descriptor becomes ready.
+   */
+  Edge,
+
+  /**
+   * @brief Report an event every time events are retrieved for as long as the
+   * file descriptor is ready.
+   */
+  Level
+};
+
+/**
+ * @brief Options for registering a file descriptor.
+ */
+struct FileDescriptorEventOptions {
+  /**
+   * @brief The events the file descriptor is interested in.
+   */
+  FileDescriptorInterest interest =
+      FileDescriptorInterest::Read | FileDescriptorInterest::Write;
+
+  /**
+   * @brief How readiness of the file descriptor is reported.
+   */
+  FileDescriptorTriggerMode triggerMode = FileDescriptorTriggerMode::Edge;
+
+  /**
+   * @brief Disable the registration after one event was retrieved until it is
+   * re-armed, so exactly one poller handles the file descriptor at a time.
+   */
+  bool oneShot = false;
+
+  /**
+   * @brief Wake up only one of the pollers that wait for events on the file
+   * descriptor, even when it is registered in multiple registries. Intended
+   * for listening sockets shared between registries. Can not be combined
+   * with `oneShot`.
+   */
+  bool exclusive = false;
+
+  /**
+   * @brief Ask the kernel to busy poll the device queue of the socket for up
+   * to this time when it is read and no data is available. This is best
+   * effort: it is ignored for file descriptors that are not sockets and on
+   * systems that do not support or permit it. Zero leaves the socket
+   * unchanged.
+   */
+  std::chrono::microseconds busyPoll{0};
+};
+
+/**
+ * @brief Configures how long a `FileDescriptorEventPoller` spins on zero
+ * timeout polls before it blocks.
+ *
+ * The spin window adapts to the observed event rate between `minSpinTime` and
+ * `maxSpinTime`: it grows when events arrive shortly after the poller started
+ * blocking and shrinks when spinning does not pay off.
+ */
+struct FileDescriptorEventSpinOptions {
+  /**
+   * @brief The longest time to spin before blocking. Zero disables spinning.
+   */
+  std::chrono::nanoseconds maxSpinTime{0};
+
+  /**
+   * @brief The shortest time to spin before blocking while spinning is
+   * enabled.
+   */
+  std::chrono::nanoseconds minSpinTime{std::chrono::microseconds(1)};
+};
+
+/**
+ * @brief Counters of a `FileDescriptorEventPoller`, to tune its
+ * `FileDescriptorEventSpinOptions`.
+ */
+struct FileDescriptorEventPollerStatistics {
+  /**
+   * @brief The number of waits that were satisfied while spinning.
+   */
+  uint64_t spinHits = 0;
+
+  /**
+   * @brief The number of waits that blocked after the spin window elapsed.
+   */
+  uint64_t blockingWaits = 0;
+
+  /**
+   * @brief The current adaptive spin window.
+   */
+  std::chrono::nanoseconds spinTime{0};
 };
 
+/**
+ * @brief Base class for data that is associated with a registered file
+ * descriptor and handed back with each of its events.
+ *
+ * Event loops that do not know the concrete types of their user data hand
+ * each event to `onEvent`, so sockets, rings and file IO can share a loop.
+ * User data that is destroyed while `FileDescriptorEventPoller::dispatch`
+ * hands a batch of events to their user data on the same thread does not
+ * receive its remaining events of that batch.
+ */
 struct FileDescriptorEventUserData {
-  virtual ~FileDescriptorEventUserData() {}
+  virtual ~FileDescriptorEventUserData();
+
+  /**
+   * @brief Handle the specified `eventType` that was retrieved for the file
+   * descriptor this is registered with. The default implementation ignores
+   * it.
+   */
+  virtual void onEvent(FileDescriptorEventType eventType) noexcept {
+    static_cast<void>(eventType);
+  }
 };
 
 /**
@@ -43,9 +245,10 @@ struct FileDescriptorEventUserData {
  */
 struct FileDescriptorEvent {
   /**
-   * @brief Opaque userdata pointer.
+   * @brief Non-owning pointer to the user data the file descriptor was
+   * registered with, or `nullptr`.
    */
-  std::weak_ptr<FileDescriptorEventUserData> userData;
+  FileDescriptorEventUserData *userData;
 
   /**
    * @brief The file descriptor the event ocurred on.
@@ -53,7 +256,7 @@ struct FileDescriptorEvent {
   FileDescriptor fileDescriptor;
 
   /**
-   * @brief The type of event that ocurred.
+   * @brief The types of the event that ocurred, combined into a single value.
    */
   FileDescriptorEventType eventType;
 };
@@ -69,10 +272,28 @@ public:
   // MANIPULATORS
   /**
    * @brief Wait for the specified `timeout` for the next event to ocur on a
-   * registered file descriptor and return that event.
+   * registered file descriptor and return that event. A negative `timeout`
+   * waits indefinitely.
+   *
+   * Implementations should honor the full resolution of `timeout` where the
+   * platform allows it.
    */
   virtual FileDescriptorEvent
-  waitForNextEvent(std::chrono::milliseconds const &timeout) noexcept = 0;
+  waitForNextEvent(std::chrono::nanoseconds const &timeout) noexcept = 0;
+
+  /**
+   * @brief Wait for the specified `timeout` for events to ocur on registered
+   * file descriptors and store up to the specified `maxEventCount` of them in
+   * the specified `events` array. Return the number of events stored, `0` when
+   * retrieving events timed out or `-1` on error.
+   *
+   * The default implementation calls `waitForNextEvent` until no more events
+   * are immediately available. Implementations should override this to
+   * retrieve all ready events with a single system call.
+   */
+  virtual int waitForEvents(FileDescriptorEvent *events,
+                            std::size_t maxEventCount,
+                            std::chrono::nanoseconds const &timeout) noexcept;
 };
 
 /**
@@ -80,6 +301,12 @@ public:
  *
  * This registry is thread-safe and can be used from multiple threads
  * concurrently.
+ *
+ * The registry does not own the user data of a file descriptor. Events that
+ * were retrieved before a file descriptor was removed or replaced are not
+ * reported, but the user data must stay alive until no poller is handling an
+ * event for it anymore. Typically this means removing the file descriptor and
+ * destroying the user data from the thread that polls for its events.
  */
 class FileDescriptorEventRegistry {
   friend class FileDescriptorEventPoller;
@@ -93,18 +320,54 @@ public:
   static std::unique_ptr<FileDescriptorEventRegistry>
   createSystemDefault() noexcept;
 
+  /**
+   * @brief Create a registry that uses io_uring multishot poll requests and
+   * return it. Return `nullptr` when the running kernel does not support them.
+   */
+  static std::unique_ptr<FileDescriptorEventRegistry> createIoUring() noexcept;
+
+  /**
+   * @brief Create a registry for polling from multiple threads and return it.
+   *
+   * The registered file descriptors are distributed over the specified
+   * `shardCount` shards, and each poller that is created for the registry
+   * polls the next shard in round-robin order. When exactly `shardCount`
+   * pollers are created, each used by a single thread, all events of a file
+   * descriptor are handled by the same thread and never concurrently.
+   */
+  static std::unique_ptr<FileDescriptorEventRegistry>
+  createSharded(std::size_t shardCount) noexcept;
+
   virtual ~FileDescriptorEventRegistry() {}
 
   // MANIPULATORS
   /**
    * @brief Add or replace the specified `fileDescriptor` to the registry with
-   * the specified `userData`. Return `true` on success and `false` when
-   * `fileDescriptor` is incompatible.
+   * the specified non-owning `userData` and the specified `options`. Return
+   * `true` on success and `false` when `fileDescriptor` or `options` are
+   * incompatible.
+   */
+  virtual bool addOrReplace(FileDescriptor fileDescriptor,
+                            FileDescriptorEventUserData *userData = nullptr,
+                            FileDescriptorEventOptions const &options =
+                                FileDescriptorEventOptions()) noexcept = 0;
+
+  /**
+   * @brief Change the options of the registered `fileDescriptor` to the
+   * specified `options` while keeping its user data. Unlike `addOrReplace`
+   * this does not make already retrieved events stale. Return `true` on
+   * success or `false` when `fileDescriptor` was not registered or `options`
+   * are incompatible.
+   */
+  virtual bool modify(FileDescriptor fileDescriptor,
+                      FileDescriptorEventOptions const &options) noexcept = 0;
+
+  /**
+   * @brief Re-enable the one-shot registration of the specified
+   * `fileDescriptor` after an event for it was retrieved. Return `true` on
+   * success or `false` when `fileDescriptor` was not registered.
    */
-  virtual bool
-  addOrReplace(FileDescriptor fileDescriptor,
-               std::weak_ptr<FileDescriptorEventUserData> userData =
-                   std::weak_ptr<FileDescriptorEventUserData>()) noexcept = 0;
+  virtual bool rearm(FileDescriptor fileDescriptor) noexcept = 0;
 
   /**
    * @brief Remove the specified `fileDescriptor` from the registry. Return
@@ -119,8 +382,16 @@ protected:
 };
 
 class FileDescriptorEventPoller {
+  // PRIVATE TYPES
+  enum class PollResult { Timeout, Events, Error };
+
   std::shared_ptr<FileDescriptorEventRegistry> d_registry;
   std::unique_ptr<FileDescriptorEventPollerBuffer> d_buffer;
+  FileDescriptorEventSpinOptions d_spinOptions;
+  std::chrono::nanoseconds d_spinTime{0};
+  std::atomic<uint64_t> d_spinHits{0};
+  std::atomic<uint64_t> d_blockingWaits{0};
+  std::atomic<std::chrono::nanoseconds::rep> d_spinTimeCount{0};
 
 public:
   // CREATORS
@@ -129,9 +400,104 @@ public:
       : d_registry(registry), d_buffer(registry->createPollerBuffer()) {}
 
   // MANIPULATORS
+  /**
+   * @brief Spin with zero timeout polls according to the specified `options`
+   * before blocking in subsequent waits. Must be called from the thread that
+   * waits for events.
+   */
+  void setSpinOptions(FileDescriptorEventSpinOptions const &options) noexcept;
+
   FileDescriptorEvent
-  waitForNextEvent(std::chrono::milliseconds const &timeout) noexcept {
-    return d_buffer->waitForNextEvent(timeout);
+  waitForNextEvent(std::chrono::nanoseconds const &timeout) noexcept {
+    if (d_spinTime.count() == 0 || timeout.count() == 0) {
+      return d_buffer->waitForNextEvent(timeout);
+    }
+
+    return spinForNextEvent(timeout);
+  }
+
+  int waitForEvents(FileDescriptorEvent *events, std::size_t maxEventCount,
+                    std::chrono::nanoseconds const &timeout) noexcept {
+    if (d_spinTime.count() == 0 || timeout.count() == 0) {
+      return d_buffer->waitForEvents(events, maxEventCount, timeout);
+    }
+
+    return spinForEvents(events, maxEventCount, timeout);
+  }
+
+  template <std::size_t N>
+  int waitForEvents(std::array<FileDescriptorEvent, N> &events,
+                    std::chrono::nanoseconds const &timeout) noexcept {
+    return waitForEvents(events.data(), N, timeout);
+  }
+
+  /**
+   * @brief Wait until the specified `deadline` for the next event and return
+   * it. A `deadline` in the past does not wait.
+   */
+  FileDescriptorEvent waitForNextEvent(
+      std::chrono::steady_clock::time_point const &deadline) noexcept {
+    return waitForNextEvent(timeoutUntil(deadline));
+  }
+
+  /**
+   * @brief Wait until the specified `deadline` for events and store up to the
+   * specified `maxEventCount` of them in the specified `events` array. Return
+   * the number of events stored, `0` on timeout or `-1` on error.
+   */
+  int waitForEvents(
+      FileDescriptorEvent *events, std::size_t maxEventCount,
+      std::chrono::steady_clock::time_point const &deadline) noexcept {
+    return waitForEvents(events, maxEventCount, timeoutUntil(deadline));
+  }
+
+  template <std::size_t N>
+  int waitForEvents(
+      std::array<FileDescriptorEvent, N> &events,
+      std::chrono::steady_clock::time_point const &deadline) noexcept {
+    return waitForEvents(events.data(), N, timeoutUntil(deadline));
+  }
+
+  // STATIC MANIPULATORS
+  /**
+   * @brief Hand each of the specified `count` `events` to `onEvent` of its
+   * user data. Events of user data that is destroyed by a handler are
+   * skipped, so a handler can destroy the user data of other file
+   * descriptors in the batch.
+   */
+  static void dispatch(FileDescriptorEvent *events, std::size_t count) noexcept;
+
+  // ACCESSORS
+  /**
+   * @brief Return the spin counters of this poller. Can be called from any
+   * thread.
+   */
+  FileDescriptorEventPollerStatistics statistics() const noexcept;
+
+private:
+  // PRIVATE MANIPULATORS
+  FileDescriptorEvent
+  spinForNextEvent(std::chrono::nanoseconds const &timeout) noexcept;
+
+  int spinForEvents(FileDescriptorEvent *events, std::size_t maxEventCount,
+                    std::chrono::nanoseconds const &timeout) noexcept;
+
+  /**
+   * @brief Call the specified `poll` with a zero timeout until it returns
+   * events or the spin window elapsed, then call it once with the rest of the
+   * specified `timeout`. Stop right away when it returns an error.
+   */
+  template <typename Poll>
+  void spinThenWait(std::chrono::nanoseconds const &timeout,
+                    Poll const &poll) noexcept;
+
+  void setSpinTime(std::chrono::nanoseconds spinTime) noexcept;
+
+  static std::chrono::nanoseconds
+  timeoutUntil(std::chrono::steady_clock::time_point const &deadline) noexcept {
+    auto timeout = deadline - std::chrono::steady_clock::now();
+    return timeout.count() < 0 ? std::chrono::nanoseconds(0)
+                               : std::chrono::nanoseconds(timeout);
   }
 };
 
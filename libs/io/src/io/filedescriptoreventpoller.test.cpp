@@ -1,12 +1,23 @@
 #include <io/filedescriptoreventpoller.h>
+#include <io/filedescriptoreventpoller.test.h>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include <fcntl.h>
 #include <sys/socket.h>
 
+#if __linux__
+#include <sys/epoll.h>
+#endif
+
 using namespace eco::io;
+using namespace eco::io::test;
 using namespace testing;
 
 namespace {
@@ -15,14 +26,21 @@ class MockFileDescriptorEventPollerBuffer
     : public FileDescriptorEventPollerBuffer {
 public:
   MOCK_METHOD(FileDescriptorEvent, waitForNextEvent,
-              (std::chrono::milliseconds const &timeout), (noexcept, override));
+              (std::chrono::nanoseconds const &timeout), (noexcept, override));
 };
 
 class MockFileDescriptorEventRegistry : public FileDescriptorEventRegistry {
 public:
   MOCK_METHOD(bool, addOrReplace,
               (FileDescriptor fileDescriptor,
-               std::weak_ptr<FileDescriptorEventUserData> userData),
+               FileDescriptorEventUserData *userData,
+               FileDescriptorEventOptions const &options),
+              (noexcept, override));
+  MOCK_METHOD(bool, modify,
+              (FileDescriptor fileDescriptor,
+               FileDescriptorEventOptions const &options),
+              (noexcept, override));
+  MOCK_METHOD(bool, rearm, (FileDescriptor fileDescriptor),
               (noexcept, override));
   MOCK_METHOD(bool, remove, (FileDescriptor fileDescriptor),
               (noexcept, override));
@@ -30,40 +48,6 @@ public:
               createPollerBuffer, (), (noexcept, override));
 };
 
-std::pair<int, int> createNonBlockingSocketPair() {
-  int sockets[2] = {-1};
-  int result = socketpair(PF_LOCAL, SOCK_STREAM, 0, sockets);
-  EXPECT_NE(-1, result) << strerror(errno);
-  fcntl(sockets[0], F_SETFL, fcntl(sockets[0], F_GETFL) | O_NONBLOCK);
-  fcntl(sockets[1], F_SETFL, fcntl(sockets[1], F_GETFL) | O_NONBLOCK);
-  return std::make_pair(sockets[0], sockets[1]);
-}
-
-std::set<FileDescriptorEventType>
-pollEventTypes(FileDescriptorEventPoller &poller) {
-  std::set<FileDescriptorEventType> eventTypes;
-
-  while (true) {
-    auto event = poller.waitForNextEvent(std::chrono::milliseconds(10));
-
-    if (event.eventType == FileDescriptorEventType::Timeout) {
-      break;
-    }
-
-    eventTypes.insert(event.eventType);
-  }
-
-  return eventTypes;
-}
-
-bool isWritable(std::set<FileDescriptorEventType> const &eventTypes) {
-  return eventTypes.find(FileDescriptorEventType::Writable) != eventTypes.end();
-}
-
-bool isReadable(std::set<FileDescriptorEventType> const &eventTypes) {
-  return eventTypes.find(FileDescriptorEventType::Readable) != eventTypes.end();
-}
-
 char buffer[1024];
 auto userData = std::make_shared<FileDescriptorEventUserData>();
 } // namespace
@@ -78,30 +62,22 @@ TEST(FileDescriptorEventRegistry, AddAndRemove) {
   EXPECT_FALSE(sut->remove(sockets.first));
 
   // WHEN-THEN add socket.
-  EXPECT_TRUE(sut->addOrReplace(sockets.first,
-                                std::weak_ptr<FileDescriptorEventUserData>()));
+  EXPECT_TRUE(sut->addOrReplace(sockets.first, nullptr));
 
   // WHEN-THEN add socket again.
-  EXPECT_TRUE(sut->addOrReplace(sockets.first,
-                                std::weak_ptr<FileDescriptorEventUserData>()));
-
-  // WHEN add socket again.
-  EXPECT_TRUE(sut->addOrReplace(sockets.first, userData));
+  EXPECT_TRUE(sut->addOrReplace(sockets.first, nullptr));
 
-  // THEN
-  EXPECT_EQ(userData.use_count(), 1);
+  // WHEN-THEN add socket again.
+  EXPECT_TRUE(sut->addOrReplace(sockets.first, userData.get()));
 
-  // WHEN remove socket.
+  // WHEN-THEN remove socket.
   EXPECT_TRUE(sut->remove(sockets.first));
 
-  // THEN
-  EXPECT_EQ(1, userData.use_count());
-
   // WHEN-THEN remove again.
   EXPECT_FALSE(sut->remove(sockets.first));
 
   // WHEN-THEN
-  EXPECT_FALSE(sut->addOrReplace(-1, userData));
+  EXPECT_FALSE(sut->addOrReplace(-1, userData.get()));
 }
 
 TEST(FileDescriptorEventPoller, Creation) {
@@ -120,7 +96,8 @@ TEST(FileDescriptorEventPoller, Creation) {
   FileDescriptorEventPoller sut(registry);
 
   // EXPECT
-  EXPECT_CALL(*bufferPtr, waitForNextEvent(std::chrono::milliseconds(10)));
+  EXPECT_CALL(*bufferPtr, waitForNextEvent(std::chrono::nanoseconds(
+                              std::chrono::milliseconds(10))));
 
   // WHEN
   sut.waitForNextEvent(std::chrono::milliseconds(10));
@@ -133,7 +110,7 @@ TEST(FileDescriptorEventRegistry, EventSemantics) {
   auto sockets = createNonBlockingSocketPair();
 
   FileDescriptorEventPoller poller(sut);
-  sut->addOrReplace(sockets.first, userData);
+  sut->addOrReplace(sockets.first, userData.get());
 
   // WHEN polled for the first time.
   auto eventTypes = pollEventTypes(poller);
@@ -223,35 +200,592 @@ TEST(FileDescriptorEventRegistry, UserData) {
   FileDescriptorEventPoller poller(sut);
 
   // WHEN
-  sut->addOrReplace(sockets.first, userData);
+  sut->addOrReplace(sockets.first, userData.get());
   auto event = poller.waitForNextEvent(std::chrono::milliseconds(10));
 
   // THEN
   EXPECT_EQ(FileDescriptorEventType::Writable, event.eventType);
-  EXPECT_EQ(userData.get(), event.userData.lock().get());
+  EXPECT_EQ(sockets.first, event.fileDescriptor);
+  EXPECT_EQ(userData.get(), event.userData);
 
   // WHEN
   event = poller.waitForNextEvent(std::chrono::milliseconds(10));
 
   // THEN
   EXPECT_EQ(FileDescriptorEventType::Timeout, event.eventType);
-  EXPECT_EQ(nullptr, event.userData.lock());
+  EXPECT_EQ(nullptr, event.userData);
 }
 
-TEST(FileDescriptorEventRegistry, UserDataExpired) {
+TEST(FileDescriptorEventRegistry, StaleEventAfterRemove) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  auto sockets1 = createNonBlockingSocketPair();
+  auto sockets2 = createNonBlockingSocketPair();
+  FileDescriptorEventPoller poller(sut);
+  sut->addOrReplace(sockets1.first, userData.get());
+  sut->addOrReplace(sockets2.first, userData.get());
+
+  // WHEN both events are retrieved, but only the first one is handled.
+  auto event = poller.waitForNextEvent(std::chrono::milliseconds(10));
+  ASSERT_EQ(FileDescriptorEventType::Writable, event.eventType);
+  auto other = event.fileDescriptor == sockets1.first ? sockets2.first
+                                                      : sockets1.first;
+  EXPECT_TRUE(sut->remove(other));
+  event = poller.waitForNextEvent(std::chrono::milliseconds(10));
+
+  // THEN the event of the removed file descriptor is not reported.
+  EXPECT_EQ(FileDescriptorEventType::Timeout, event.eventType);
+}
+
+TEST(FileDescriptorEventRegistry, StaleEventAfterReplace) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  auto sockets1 = createNonBlockingSocketPair();
+  auto sockets2 = createNonBlockingSocketPair();
+  auto otherUserData = std::make_shared<FileDescriptorEventUserData>();
+  FileDescriptorEventPoller poller(sut);
+  sut->addOrReplace(sockets1.first, userData.get());
+  sut->addOrReplace(sockets2.first, userData.get());
+
+  // WHEN the other file descriptor is replaced after its event was retrieved.
+  auto event = poller.waitForNextEvent(std::chrono::milliseconds(10));
+  ASSERT_EQ(FileDescriptorEventType::Writable, event.eventType);
+  auto other = event.fileDescriptor == sockets1.first ? sockets2.first
+                                                      : sockets1.first;
+  EXPECT_TRUE(sut->addOrReplace(other, otherUserData.get()));
+  event = poller.waitForNextEvent(std::chrono::milliseconds(10));
+
+  // THEN the event is reported with the new user data only.
+  EXPECT_EQ(FileDescriptorEventType::Writable, event.eventType);
+  EXPECT_EQ(other, event.fileDescriptor);
+  EXPECT_EQ(otherUserData.get(), event.userData);
+  event = poller.waitForNextEvent(std::chrono::milliseconds(10));
+  EXPECT_EQ(FileDescriptorEventType::Timeout, event.eventType);
+}
+
+TEST(FileDescriptorEventRegistry, ReusedFileDescriptor) {
   // GIVEN
   auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
       FileDescriptorEventRegistry::createSystemDefault());
   auto sockets = createNonBlockingSocketPair();
   FileDescriptorEventPoller poller(sut);
-  auto userData = std::make_shared<FileDescriptorEventUserData>();
+  sut->addOrReplace(sockets.first, userData.get());
+  pollEventTypes(poller);
+
+  // WHEN the file descriptor is closed without removing it and reused.
+  close(sockets.first);
+  close(sockets.second);
+  auto reused = createNonBlockingSocketPair();
+  ASSERT_EQ(sockets.first, reused.first);
+
+  // THEN it can be registered again.
+  EXPECT_TRUE(sut->addOrReplace(reused.first, userData.get()));
+  EXPECT_TRUE(isWritable(pollEventTypes(poller)));
+}
+
+TEST(FileDescriptorEventRegistry, WaitForEvents) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  auto sockets1 = createNonBlockingSocketPair();
+  auto sockets2 = createNonBlockingSocketPair();
+  FileDescriptorEventUserData userData1;
+  FileDescriptorEventUserData userData2;
+  FileDescriptorEventPoller poller(sut);
+  std::array<FileDescriptorEvent, 16> events;
+
+  // WHEN
+  sut->addOrReplace(sockets1.first, &userData1);
+  sut->addOrReplace(sockets2.first, &userData2);
+  auto count = poller.waitForEvents(events, std::chrono::milliseconds(10));
+
+  // THEN both sockets are reported as writable in a single call.
+  ASSERT_EQ(2, count);
+  std::set<FileDescriptor> fileDescriptors;
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(FileDescriptorEventType::Writable, events[i].eventType);
+    fileDescriptors.insert(events[i].fileDescriptor);
+    EXPECT_EQ(events[i].fileDescriptor == sockets1.first ? &userData1
+                                                         : &userData2,
+              events[i].userData);
+  }
+  EXPECT_EQ(1, fileDescriptors.count(sockets1.first));
+  EXPECT_EQ(1, fileDescriptors.count(sockets2.first));
+
+  // WHEN
+  count = poller.waitForEvents(events, std::chrono::milliseconds(10));
+
+  // THEN
+  EXPECT_EQ(0, count);
+
+  // WHEN only a single event is requested.
+  write(sockets1.second, "abcdefg", 8);
+  write(sockets2.second, "abcdefg", 8);
+  count = poller.waitForEvents(events.data(), 1, std::chrono::milliseconds(10));
+
+  // THEN the remaining event is returned by the next call.
+  ASSERT_EQ(1, count);
+  EXPECT_TRUE(
+      hasEventType(events[0].eventType, FileDescriptorEventType::Readable));
+  count = poller.waitForEvents(events, std::chrono::milliseconds(10));
+  ASSERT_EQ(1, count);
+  EXPECT_TRUE(
+      hasEventType(events[0].eventType, FileDescriptorEventType::Readable));
+}
+
+TEST(FileDescriptorEventRegistry, InterestMask) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  auto sockets = createNonBlockingSocketPair();
+  FileDescriptorEventPoller poller(sut);
+  FileDescriptorEventOptions options;
+  options.interest = FileDescriptorInterest::Read;
+
+  // WHEN only interested in reading.
+  EXPECT_TRUE(sut->addOrReplace(sockets.first, userData.get(), options));
+  auto eventTypes = pollEventTypes(poller);
+
+  // THEN the writable socket is not reported.
+  EXPECT_FALSE(isWritable(eventTypes));
+  EXPECT_FALSE(isReadable(eventTypes));
+
+  // WHEN writing to the other side.
+  write(sockets.second, "abcdefg", 8);
+  eventTypes = pollEventTypes(poller);
+
+  // THEN the socket becomes readable.
+  EXPECT_TRUE(isReadable(eventTypes));
+  EXPECT_FALSE(isWritable(eventTypes));
+
+  // WHEN becoming interested in writing as well.
+  options.interest =
+      FileDescriptorInterest::Read | FileDescriptorInterest::Write;
+  EXPECT_TRUE(sut->modify(sockets.first, options));
+  std::array<FileDescriptorEvent, 16> events;
+  auto count = poller.waitForEvents(events, std::chrono::milliseconds(10));
+
+  // THEN the socket is reported as writable with the same user data.
+  ASSERT_GT(count, 0);
+  eventTypes.clear();
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(userData.get(), events[i].userData);
+    insertEventTypes(eventTypes, events[i].eventType);
+  }
+  EXPECT_TRUE(isWritable(eventTypes));
+
+  // WHEN-THEN modifying a file descriptor that is not registered.
+  EXPECT_FALSE(sut->modify(sockets.second, options));
+}
+
+TEST(FileDescriptorEventRegistry, LevelTriggered) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  auto sockets = createNonBlockingSocketPair();
+  FileDescriptorEventPoller poller(sut);
+  FileDescriptorEventOptions options;
+  options.interest = FileDescriptorInterest::Read;
+  options.triggerMode = FileDescriptorTriggerMode::Level;
+  EXPECT_TRUE(sut->addOrReplace(sockets.first, userData.get(), options));
+
+  // WHEN
+  write(sockets.second, "abcdefg", 8);
+
+  // THEN the socket is reported as long as it is readable.
+  for (int i = 0; i < 3; ++i) {
+    auto event = poller.waitForNextEvent(std::chrono::milliseconds(10));
+    EXPECT_EQ(FileDescriptorEventType::Readable, event.eventType);
+  }
+
+  // WHEN
+  while (read(sockets.first, buffer, 1024) != -1)
+    ;
+
+  // THEN
+  auto event = poller.waitForNextEvent(std::chrono::milliseconds(10));
+  EXPECT_EQ(FileDescriptorEventType::Timeout, event.eventType);
+}
+
+TEST(FileDescriptorEventRegistry, OneShot) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  auto sockets = createNonBlockingSocketPair();
+  FileDescriptorEventPoller poller(sut);
+  FileDescriptorEventOptions options;
+  options.interest = FileDescriptorInterest::Read;
+  options.oneShot = true;
+  EXPECT_TRUE(sut->addOrReplace(sockets.first, userData.get(), options));
+
+  // WHEN
+  write(sockets.second, "abcdefg", 8);
+
+  // THEN the socket is reported once.
+  EXPECT_TRUE(isReadable(pollEventTypes(poller)));
+
+  // WHEN more data arrives before re-arming.
+  write(sockets.second, "abcdefg", 8);
+
+  // THEN it is not reported.
+  EXPECT_FALSE(isReadable(pollEventTypes(poller)));
+
+  // WHEN re-armed.
+  EXPECT_TRUE(sut->rearm(sockets.first));
+
+  // THEN it is reported again.
+  EXPECT_TRUE(isReadable(pollEventTypes(poller)));
+
+  // WHEN-THEN re-arming a file descriptor that is not registered.
+  EXPECT_FALSE(sut->rearm(sockets.second));
+}
+
+TEST(FileDescriptorEventRegistry, Exclusive) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  auto sockets = createNonBlockingSocketPair();
+  FileDescriptorEventPoller poller(sut);
+  FileDescriptorEventOptions options;
+  options.exclusive = true;
+  options.oneShot = true;
+
+  // WHEN-THEN exclusive can not be combined with one-shot.
+  EXPECT_FALSE(sut->addOrReplace(sockets.first, userData.get(), options));
+
+  // WHEN
+  options.oneShot = false;
+  EXPECT_TRUE(sut->addOrReplace(sockets.first, userData.get(), options));
+
+  // THEN
+  EXPECT_TRUE(isWritable(pollEventTypes(poller)));
+
+  // WHEN-THEN an exclusive registration can be modified and replaced.
+  options.interest = FileDescriptorInterest::Read;
+  EXPECT_TRUE(sut->modify(sockets.first, options));
+  EXPECT_TRUE(sut->addOrReplace(sockets.first, userData.get()));
+  EXPECT_TRUE(sut->remove(sockets.first));
+}
+
+#if __linux__
+TEST(FileDescriptorEventRegistry, FailedReplaceKeepsRegistration) {
+  // GIVEN an epoll set, which can not be registered exclusively.
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  auto sockets = createNonBlockingSocketPair();
+  auto otherUserData = std::make_shared<FileDescriptorEventUserData>();
+  FileDescriptorEventPoller poller(sut);
+  int epoll = epoll_create1(EPOLL_CLOEXEC);
+  struct epoll_event socketEvent {
+    EPOLLIN, { .fd = sockets.first }
+  };
+  ASSERT_EQ(0, epoll_ctl(epoll, EPOLL_CTL_ADD, sockets.first, &socketEvent));
+  FileDescriptorEventOptions options;
+  options.interest = FileDescriptorInterest::Read;
+  ASSERT_TRUE(sut->addOrReplace(epoll, userData.get(), options));
 
   // WHEN
-  sut->addOrReplace(sockets.first, userData);
+  options.exclusive = true;
+  EXPECT_FALSE(sut->addOrReplace(epoll, otherUserData.get(), options));
+  write(sockets.second, "abc", 3);
   auto event = poller.waitForNextEvent(std::chrono::milliseconds(10));
-  userData.reset();
+
+  // THEN the old registration is kept.
+  EXPECT_EQ(FileDescriptorEventType::Readable, event.eventType);
+  EXPECT_EQ(epoll, event.fileDescriptor);
+  EXPECT_EQ(userData.get(), event.userData);
+
+  // WHEN-THEN it can still be replaced and removed.
+  EXPECT_TRUE(sut->addOrReplace(epoll, otherUserData.get()));
+  EXPECT_TRUE(sut->remove(epoll));
+  close(epoll);
+}
+#endif
+
+TEST(FileDescriptorEventRegistry, CombinedEventTypes) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  auto sockets = createNonBlockingSocketPair();
+  FileDescriptorEventPoller poller(sut);
+
+  // WHEN the socket is both readable and writable.
+  write(sockets.second, "abcdefg", 8);
+  sut->addOrReplace(sockets.first, userData.get());
+  auto event = poller.waitForNextEvent(std::chrono::milliseconds(10));
+
+  // THEN both are reported in a single event.
+  EXPECT_EQ(FileDescriptorEventType::Readable |
+                FileDescriptorEventType::Writable,
+            event.eventType);
+  event = poller.waitForNextEvent(std::chrono::milliseconds(10));
+  EXPECT_EQ(FileDescriptorEventType::Timeout, event.eventType);
+}
+
+TEST(FileDescriptorEventRegistry, PeerClosed) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  auto sockets = createNonBlockingSocketPair();
+  FileDescriptorEventPoller poller(sut);
+  FileDescriptorEventOptions options;
+  options.interest =
+      FileDescriptorInterest::Read | FileDescriptorInterest::PeerClosed;
+  sut->addOrReplace(sockets.first, userData.get(), options);
+
+  // WHEN the other side shuts down writing.
+  shutdown(sockets.second, SHUT_WR);
+  auto eventTypes = pollEventTypes(poller);
 
   // THEN
-  EXPECT_EQ(FileDescriptorEventType::Writable, event.eventType);
-  EXPECT_EQ(nullptr, event.userData.lock());
+  EXPECT_TRUE(isReadable(eventTypes));
+  EXPECT_EQ(1, eventTypes.count(FileDescriptorEventType::PeerClosed));
+}
+
+TEST(FileDescriptorEventRegistry, HangUpWithoutInterest) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  auto sockets = createNonBlockingSocketPair();
+  FileDescriptorEventPoller poller(sut);
+  FileDescriptorEventOptions options;
+  options.interest = FileDescriptorInterest::None;
+  sut->addOrReplace(sockets.first, userData.get(), options);
+
+  // WHEN the other side is closed.
+  close(sockets.second);
+  auto event = poller.waitForNextEvent(std::chrono::milliseconds(10));
+
+  // THEN the hang up is reported once and consumed.
+  EXPECT_TRUE(hasEventType(event.eventType, FileDescriptorEventType::HangUp));
+  EXPECT_FALSE(
+      hasEventType(event.eventType, FileDescriptorEventType::Readable));
+  event = poller.waitForNextEvent(std::chrono::milliseconds(10));
+  EXPECT_EQ(FileDescriptorEventType::Timeout, event.eventType);
+}
+
+namespace {
+struct StressConnection : FileDescriptorEventUserData {
+  std::pair<int, int> sockets;
+  std::atomic<int> owner{-1};
+  std::atomic<int> activeHandlers{0};
+  std::atomic<size_t> bytesRead{0};
+};
+} // namespace
+
+TEST(FileDescriptorEventRegistry, ShardedStress) {
+  // GIVEN
+  const size_t threadCount = 4;
+  const size_t connectionCount = 64;
+  const size_t messageCount = 200;
+  const size_t messageSize = 16;
+
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSharded(threadCount));
+  std::vector<std::unique_ptr<StressConnection>> connections;
+  for (size_t i = 0; i < connectionCount; ++i) {
+    connections.push_back(std::make_unique<StressConnection>());
+    connections.back()->sockets = createNonBlockingSocketPair();
+    FileDescriptorEventOptions options;
+    options.interest = FileDescriptorInterest::Read;
+    ASSERT_TRUE(sut->addOrReplace(connections.back()->sockets.first,
+                                  connections.back().get(), options));
+  }
+
+  std::atomic<bool> stop{false};
+  std::atomic<size_t> ownershipViolations{0};
+  std::atomic<size_t> concurrencyViolations{0};
+  std::vector<std::thread> pollers;
+
+  // WHEN each thread polls with its own poller.
+  for (size_t threadIndex = 0; threadIndex < threadCount; ++threadIndex) {
+    pollers.emplace_back([&, threadIndex,
+                          poller = std::make_shared<FileDescriptorEventPoller>(
+                              sut)]() {
+      std::array<FileDescriptorEvent, 32> events;
+      char readBuffer[256];
+
+      while (!stop) {
+        int count = poller->waitForEvents(events, std::chrono::milliseconds(5));
+
+        for (int i = 0; i < count; ++i) {
+          auto connection = static_cast<StressConnection *>(events[i].userData);
+          int expected = -1;
+          if (!connection->owner.compare_exchange_strong(
+                  expected, static_cast<int>(threadIndex)) &&
+              expected != static_cast<int>(threadIndex)) {
+            ++ownershipViolations;
+          }
+
+          if (connection->activeHandlers.fetch_add(1) != 0) {
+            ++concurrencyViolations;
+          }
+
+          // Edge triggered, so drain the socket completely.
+          ssize_t result;
+          while ((result = read(connection->sockets.first, readBuffer,
+                                sizeof(readBuffer))) > 0) {
+            connection->bytesRead += result;
+          }
+
+          connection->activeHandlers.fetch_sub(1);
+        }
+      }
+    });
+  }
+
+  char message[messageSize] = {};
+  for (size_t i = 0; i < messageCount; ++i) {
+    for (auto &connection : connections) {
+      ASSERT_EQ(messageSize,
+                write(connection->sockets.second, message, messageSize));
+    }
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  auto allRead = [&]() {
+    for (auto &connection : connections) {
+      if (connection->bytesRead != messageCount * messageSize) {
+        return false;
+      }
+    }
+    return true;
+  };
+  while (!allRead() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  stop = true;
+  for (auto &poller : pollers) {
+    poller.join();
+  }
+
+  // THEN no events were lost and every connection was handled by a single
+  // thread, never concurrently.
+  for (auto &connection : connections) {
+    EXPECT_EQ(messageCount * messageSize, connection->bytesRead);
+    EXPECT_TRUE(sut->remove(connection->sockets.first));
+    close(connection->sockets.first);
+    close(connection->sockets.second);
+  }
+  EXPECT_EQ(0, ownershipViolations);
+  EXPECT_EQ(0, concurrencyViolations);
+}
+
+TEST(FileDescriptorEventRegistry, Timeouts) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  FileDescriptorEventPoller poller(sut);
+
+  for (auto timeout :
+       {std::chrono::nanoseconds(std::chrono::microseconds(500)),
+        std::chrono::nanoseconds(std::chrono::milliseconds(1020)),
+        std::chrono::nanoseconds(std::chrono::microseconds(1500))}) {
+    // WHEN
+    auto start = std::chrono::steady_clock::now();
+    auto event = poller.waitForNextEvent(timeout);
+
+    // THEN the full timeout is waited for, including sub-millisecond parts.
+    EXPECT_EQ(FileDescriptorEventType::Timeout, event.eventType);
+    EXPECT_LE(timeout, std::chrono::steady_clock::now() - start);
+  }
+
+  // WHEN-THEN waiting until a deadline.
+  auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(2);
+  auto event = poller.waitForNextEvent(deadline);
+  EXPECT_EQ(FileDescriptorEventType::Timeout, event.eventType);
+  EXPECT_LE(deadline, std::chrono::steady_clock::now());
+
+  // WHEN-THEN a deadline in the past does not wait.
+  std::array<FileDescriptorEvent, 4> events;
+  EXPECT_EQ(0, poller.waitForEvents(
+                   events, std::chrono::steady_clock::now() -
+                               std::chrono::milliseconds(1)));
+}
+
+TEST(FileDescriptorEventPoller, Spin) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  auto sockets = createNonBlockingSocketPair();
+  FileDescriptorEventPoller poller(sut);
+  FileDescriptorEventSpinOptions spinOptions;
+  spinOptions.maxSpinTime = std::chrono::milliseconds(1);
+  poller.setSpinOptions(spinOptions);
+  FileDescriptorEventOptions options;
+  options.interest = FileDescriptorInterest::Read;
+  options.busyPoll = std::chrono::microseconds(50);
+  EXPECT_TRUE(sut->addOrReplace(sockets.first, nullptr, options));
+
+  // WHEN-THEN nothing arrives, so the poller blocks after spinning and the
+  // spin window shrinks.
+  auto event = poller.waitForNextEvent(std::chrono::milliseconds(5));
+  EXPECT_EQ(FileDescriptorEventType::Timeout, event.eventType);
+  auto statistics = poller.statistics();
+  EXPECT_EQ(0, statistics.spinHits);
+  EXPECT_EQ(1, statistics.blockingWaits);
+  EXPECT_EQ(std::chrono::microseconds(500), statistics.spinTime);
+
+  // WHEN-THEN an available event is retrieved while spinning.
+  write(sockets.second, "abcdefg", 8);
+  event = poller.waitForNextEvent(std::chrono::milliseconds(5));
+  EXPECT_EQ(FileDescriptorEventType::Readable, event.eventType);
+  statistics = poller.statistics();
+  EXPECT_EQ(1, statistics.spinHits);
+  EXPECT_EQ(1, statistics.blockingWaits);
+  EXPECT_LT(std::chrono::microseconds(500), statistics.spinTime);
+
+  // WHEN-THEN the window never shrinks below the minimum.
+  for (int i = 0; i < 16; ++i) {
+    poller.waitForNextEvent(std::chrono::microseconds(100));
+  }
+  EXPECT_EQ(spinOptions.minSpinTime, poller.statistics().spinTime);
+
+  close(sockets.first);
+  close(sockets.second);
+}
+
+TEST(FileDescriptorEventPoller, DispatchSkipsDestroyedUserData) {
+  // GIVEN user data whose handler destroys the user data of later events.
+  struct UserData : FileDescriptorEventUserData {
+    std::vector<int> *d_handled = nullptr;
+    int d_id = 0;
+    std::unique_ptr<UserData> *d_victim = nullptr;
+
+    void onEvent(FileDescriptorEventType) noexcept override {
+      d_handled->push_back(d_id);
+
+      if (d_victim != nullptr) {
+        d_victim->reset();
+      }
+    }
+  };
+
+  std::vector<int> handled;
+  auto first = std::make_unique<UserData>();
+  auto second = std::make_unique<UserData>();
+  auto third = std::make_unique<UserData>();
+  first->d_handled = second->d_handled = third->d_handled = &handled;
+  first->d_id = 1;
+  second->d_id = 2;
+  third->d_id = 3;
+  first->d_victim = &second;
+
+  FileDescriptorEvent events[] = {
+      {first.get(), 1, FileDescriptorEventType::Readable},
+      {second.get(), 2, FileDescriptorEventType::Readable},
+      {third.get(), 3, FileDescriptorEventType::Readable},
+      {second.get(), 2, FileDescriptorEventType::Writable}};
+
+  // WHEN
+  FileDescriptorEventPoller::dispatch(events, 4);
+
+  // THEN
+  EXPECT_THAT(handled, ElementsAre(1, 3));
+  EXPECT_EQ(nullptr, events[1].userData);
+  EXPECT_EQ(nullptr, events[3].userData);
 }
@@ -0,0 +1,82 @@
+#ifndef ECO_IO_FILEDESCRIPTOREVENTPOLLER_TEST
+#define ECO_IO_FILEDESCRIPTOREVENTPOLLER_TEST
+
+#include <io/filedescriptoreventpoller.h>
+
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <set>
+#include <utility>
+
+#include <sys/socket.h>
+
+namespace eco {
+namespace io {
+namespace test {
+
+/**
+ * @brief Create a connected pair of non-blocking local stream sockets and
+ * return it.
+ */
+inline std::pair<int, int> createNonBlockingSocketPair() {
+  int sockets[2] = {-1};
+  int result = socketpair(PF_LOCAL, SOCK_STREAM | SOCK_NONBLOCK, 0, sockets);
+  EXPECT_NE(-1, result) << strerror(errno);
+  return std::make_pair(sockets[0], sockets[1]);
+}
+
+/**
+ * @brief Insert each event type that is set in the specified `eventType` into
+ * the specified `eventTypes`.
+ */
+inline void insertEventTypes(std::set<FileDescriptorEventType> &eventTypes,
+                             FileDescriptorEventType eventType) {
+  for (auto type :
+       {FileDescriptorEventType::Readable, FileDescriptorEventType::Writable,
+        FileDescriptorEventType::ErrorCondition,
+        FileDescriptorEventType::HangUp,
+        FileDescriptorEventType::PeerClosed}) {
+    if (hasEventType(eventType, type)) {
+      eventTypes.insert(type);
+    }
+  }
+}
+
+/**
+ * @brief Retrieve the events of the specified `poller` until it times out
+ * and return the event types that were reported.
+ */
+inline std::set<FileDescriptorEventType>
+pollEventTypes(FileDescriptorEventPoller &poller) {
+  std::set<FileDescriptorEventType> eventTypes;
+
+  while (true) {
+    auto event = poller.waitForNextEvent(std::chrono::milliseconds(10));
+
+    if (event.eventType == FileDescriptorEventType::Timeout ||
+        event.eventType == FileDescriptorEventType::Error) {
+      break;
+    }
+
+    insertEventTypes(eventTypes, event.eventType);
+  }
+
+  return eventTypes;
+}
+
+inline bool isWritable(std::set<FileDescriptorEventType> const &eventTypes) {
+  return eventTypes.find(FileDescriptorEventType::Writable) != eventTypes.end();
+}
+
+inline bool isReadable(std::set<FileDescriptorEventType> const &eventTypes) {
+  return eventTypes.find(FileDescriptorEventType::Readable) != eventTypes.end();
+}
+
+} // namespace test
+} // namespace io
+} // namespace eco
+
+#endif // ECO_IO_FILEDESCRIPTOREVENTPOLLER_TEST
@@ -0,0 +1,483 @@
+#include <io/filedescriptoreventpoller.h>
+
+#if __linux__ && __has_include(<linux/io_uring.h>)
+
+#include <io/epollevents.h>
+#include <io/filedescriptorslottable.h>
+#include <io/iouring.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <mutex>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace eco {
+namespace io {
+
+namespace {
+
+const unsigned c_ringEntries = 1024;
+const unsigned c_eventBufferSize = 256;
+
+/**
+ * User data of submissions whose completions are not reported. File
+ * descriptors are never this large, so it never equals a slot key.
+ */
+const uint64_t c_ignoredUserData = ~uint64_t(0);
+
+/**
+ * Poll requests are tagged with the sequence number of their submission in
+ * the bits of the slot key above the file descriptor, so that the final
+ * completion of a request that was replaced does not resubmit it.
+ */
+const unsigned c_sequenceShift =
+    FileDescriptorSlotTable::c_fileDescriptorBitCount;
+const uint64_t c_sequenceMask = ((uint64_t(1) << (31 - c_sequenceShift)) - 1)
+                                << c_sequenceShift;
+
+uint64_t tag(FileDescriptorSlotTable::Key key, uint32_t sequence) noexcept {
+  return key | ((uint64_t(sequence) << c_sequenceShift) & c_sequenceMask);
+}
+
+FileDescriptorSlotTable::Key untag(uint64_t userData) noexcept {
+  return userData & ~c_sequenceMask;
+}
+
+class IoUringFileDescriptorEventRegistry;
+
+class IoUringFileDescriptorEventPollerBuffer
+    : public FileDescriptorEventPollerBuffer {
+  IoUringFileDescriptorEventRegistry &d_registry;
+  std::array<struct io_uring_cqe, c_eventBufferSize> d_events;
+  size_t d_bufferSize = 0;
+
+public:
+  IoUringFileDescriptorEventPollerBuffer(
+      IoUringFileDescriptorEventRegistry &registry)
+      : d_registry(registry) {}
+
+  virtual FileDescriptorEvent
+  waitForNextEvent(std::chrono::nanoseconds const &timeout) noexcept override;
+
+  int waitForEvents(FileDescriptorEvent *events, std::size_t maxEventCount,
+                    std::chrono::nanoseconds const &timeout) noexcept override;
+
+private:
+  bool popEvent(FileDescriptorEvent &result) noexcept;
+
+  size_t popEvents(FileDescriptorEvent *events, size_t maxEventCount) noexcept {
+    size_t count = 0;
+    while (count < maxEventCount && popEvent(events[count])) {
+      ++count;
+    }
+
+    return count;
+  }
+
+  bool pollEvents(std::chrono::nanoseconds const &timeout) noexcept;
+};
+
+/**
+ * Registry that polls file descriptors using io_uring multishot poll requests.
+ *
+ * Registrations are submitted to the ring right away. Completions of all
+ * registered file descriptors are retrieved in batches by the pollers, which
+ * share the completion queue.
+ */
+class IoUringFileDescriptorEventRegistry : public FileDescriptorEventRegistry {
+  // DATA
+  std::unique_ptr<IoUring> d_ring;
+  FileDescriptorSlotTable d_slots;
+  std::mutex d_submissionMutex;
+  std::mutex d_completionMutex;
+
+  friend class IoUringFileDescriptorEventPollerBuffer;
+
+public:
+  // STATIC CREATORS
+  /**
+   * Create a registry when the running kernel supports multishot poll
+   * requests and waiting with a timeout, or return `nullptr`.
+   */
+  static std::unique_ptr<IoUringFileDescriptorEventRegistry> create() noexcept {
+    auto ring = IoUring::create(c_ringEntries);
+
+    if (ring == nullptr || (ring->features() & IORING_FEAT_EXT_ARG) == 0 ||
+        !ring->isOpcodeSupported(IORING_OP_POLL_ADD) ||
+        !ring->isOpcodeSupported(IORING_OP_POLL_REMOVE) ||
+        !supportsMultishotPoll(*ring)) {
+      return nullptr;
+    }
+
+    auto registry = std::make_unique<IoUringFileDescriptorEventRegistry>();
+    registry->d_ring = std::move(ring);
+    return registry;
+  }
+
+  bool addOrReplace(FileDescriptor fileDescriptor,
+                    FileDescriptorEventUserData *userData = nullptr,
+                    FileDescriptorEventOptions const &options =
+                        FileDescriptorEventOptions()) noexcept override {
+    uint32_t flags = 0;
+    if (!optionsToEPollEvents(options, flags) ||
+        !isPollable(fileDescriptor)) {
+      return false;
+    }
+
+    auto lock = d_slots.lockForWriting(fileDescriptor);
+
+    FileDescriptorSlotTable::Key oldKey = 0;
+    uint32_t oldFlags = 0;
+    bool wasRegistered = d_slots.registration(fileDescriptor, oldKey, oldFlags);
+
+    FileDescriptorSlotTable::Key key = 0;
+    if (!d_slots.addOrReplace(fileDescriptor, userData, flags, key,
+                              wasRegistered)) {
+      return false;
+    }
+
+    auto submissionLock = std::lock_guard(d_submissionMutex);
+
+    if (wasRegistered && !prepareRemove(oldKey)) {
+      d_slots.remove(fileDescriptor);
+      return false;
+    }
+
+    if (!prepareAdd(fileDescriptor, flags, key) || d_ring->submit() < 0) {
+      d_slots.remove(fileDescriptor);
+      return false;
+    }
+
+    if (options.busyPoll.count() > 0) {
+      applyBusyPoll(fileDescriptor, options);
+    }
+
+    return true;
+  }
+
+  bool modify(FileDescriptor fileDescriptor,
+              FileDescriptorEventOptions const &options) noexcept override {
+    uint32_t flags = 0;
+    if (!optionsToEPollEvents(options, flags)) {
+      return false;
+    }
+
+    auto lock = d_slots.lockForWriting(fileDescriptor);
+
+    FileDescriptorSlotTable::Key key = 0;
+    uint32_t oldFlags = 0;
+    if (!d_slots.registration(fileDescriptor, key, oldFlags)) {
+      return false;
+    }
+
+    auto submissionLock = std::lock_guard(d_submissionMutex);
+
+    // The poll request is replaced with one using the same key, so events of
+    // the old request that are already retrieved are not stale. Its final
+    // completion carries an older sequence number and is not resubmitted.
+    if (!prepareRemove(key) || !prepareAdd(fileDescriptor, flags, key) ||
+        d_ring->submit() < 0) {
+      return false;
+    }
+
+    if (options.busyPoll.count() > 0) {
+      applyBusyPoll(fileDescriptor, options);
+    }
+
+    d_slots.setFlags(fileDescriptor, flags);
+    return true;
+  }
+
+  bool rearm(FileDescriptor fileDescriptor) noexcept override {
+    auto lock = d_slots.lockForWriting(fileDescriptor);
+
+    FileDescriptorSlotTable::Key key = 0;
+    uint32_t flags = 0;
+    if (!d_slots.registration(fileDescriptor, key, flags)) {
+      return false;
+    }
+
+    auto submissionLock = std::lock_guard(d_submissionMutex);
+
+    // Removing a one-shot request that already completed fails, which is
+    // harmless, while it prevents duplicate requests otherwise.
+    return prepareRemove(key) && prepareAdd(fileDescriptor, flags, key) &&
+           d_ring->submit() >= 0;
+  }
+
+  bool remove(FileDescriptor fileDescriptor) noexcept override {
+    auto lock = d_slots.lockForWriting(fileDescriptor);
+
+    FileDescriptorSlotTable::Key key = 0;
+    uint32_t flags = 0;
+    if (!d_slots.registration(fileDescriptor, key, flags)) {
+      return false;
+    }
+
+    d_slots.remove(fileDescriptor);
+
+    auto submissionLock = std::lock_guard(d_submissionMutex);
+    return prepareRemove(key) && d_ring->submit() >= 0;
+  }
+
+protected:
+  std::unique_ptr<FileDescriptorEventPollerBuffer>
+  createPollerBuffer() noexcept override {
+    return std::make_unique<IoUringFileDescriptorEventPollerBuffer>(*this);
+  }
+
+private:
+  /**
+   * Submit a new poll request for the request with the specified `userData`
+   * if it is the last request of the current registration of its file
+   * descriptor and not one-shot. This is needed after every completion of a
+   * level triggered registration and when the kernel terminates a multishot
+   * poll request, e.g. when the completion queue overflowed.
+   */
+  void resubmit(uint64_t userData) noexcept {
+    auto key = untag(userData);
+    auto fileDescriptor = FileDescriptorSlotTable::fileDescriptorOf(key);
+    auto lock = d_slots.lockForWriting(fileDescriptor);
+
+    FileDescriptorSlotTable::Key currentKey = 0;
+    uint32_t flags = 0;
+    if (!d_slots.registration(fileDescriptor, currentKey, flags) ||
+        currentKey != key || (flags & EPOLLONESHOT) != 0 ||
+        tag(key, d_slots.submission(fileDescriptor)) != userData) {
+      return;
+    }
+
+    auto submissionLock = std::lock_guard(d_submissionMutex);
+    if (prepareAdd(fileDescriptor, flags, key)) {
+      d_ring->submit();
+    }
+  }
+
+  /**
+   * Return a submission queue entry, submitting the queued entries first when
+   * the queue is full. The caller must hold the submission lock.
+   */
+  struct io_uring_sqe *nextSubmission() noexcept {
+    auto sqe = d_ring->nextSubmission();
+    if (sqe == nullptr && d_ring->submit() >= 0) {
+      sqe = d_ring->nextSubmission();
+    }
+    return sqe;
+  }
+
+  /**
+   * Prepare a poll request for the specified `fileDescriptor` as the next
+   * submission of its registration with the specified `key` and `flags`. The
+   * caller must hold the write lock of the file descriptor.
+   */
+  bool prepareAdd(FileDescriptor fileDescriptor, uint32_t flags,
+                  FileDescriptorSlotTable::Key key) noexcept {
+    auto sqe = nextSubmission();
+    if (sqe == nullptr) {
+      return false;
+    }
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fileDescriptor;
+    // Level triggered registrations use single-shot requests that are
+    // resubmitted after each completion, which reports the file descriptor
+    // again for as long as it is ready.
+    sqe->poll32_events = flags & ~(EPOLLET | EPOLLONESHOT);
+    sqe->len = (flags & (EPOLLET | EPOLLONESHOT)) == EPOLLET
+                   ? IORING_POLL_ADD_MULTI
+                   : 0;
+    sqe->user_data = tag(key, d_slots.nextSubmission(fileDescriptor));
+    return true;
+  }
+
+  /**
+   * Prepare the removal of the last poll request that was submitted for the
+   * registration with the specified `key`. The caller must hold the write
+   * lock of its file descriptor.
+   */
+  bool prepareRemove(FileDescriptorSlotTable::Key key) noexcept {
+    auto sqe = nextSubmission();
+    if (sqe == nullptr) {
+      return false;
+    }
+
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = tag(key, d_slots.submission(
+                             FileDescriptorSlotTable::fileDescriptorOf(key)));
+    sqe->user_data = c_ignoredUserData;
+    return true;
+  }
+
+  /**
+   * Return `true` when the specified `fileDescriptor` can be polled. Like
+   * epoll we reject regular files and directories, which are always ready.
+   */
+  static bool isPollable(FileDescriptor fileDescriptor) noexcept {
+    struct stat status;
+    return fileDescriptor >= 0 && fstat(fileDescriptor, &status) == 0 &&
+           !S_ISREG(status.st_mode) && !S_ISDIR(status.st_mode);
+  }
+
+  /**
+   * Return `true` when a multishot poll request on a pipe that is writable
+   * completes while staying armed.
+   */
+  static bool supportsMultishotPoll(IoUring &ring) noexcept {
+    int pipe[2];
+    if (::pipe(pipe) != 0) {
+      return false;
+    }
+
+    bool result = false;
+    auto sqe = ring.nextSubmission();
+
+    if (sqe != nullptr) {
+      sqe->opcode = IORING_OP_POLL_ADD;
+      sqe->fd = pipe[1];
+      sqe->poll32_events = EPOLLOUT;
+      sqe->len = IORING_POLL_ADD_MULTI;
+      sqe->user_data = 1;
+
+      struct io_uring_cqe cqe;
+      if (ring.submit() == 1 &&
+          ring.waitForCompletion(std::chrono::seconds(1)) == 0 &&
+          ring.reapCompletions(&cqe, 1) == 1) {
+        result = cqe.res > 0 && (cqe.flags & IORING_CQE_F_MORE) != 0;
+      }
+    }
+
+    close(pipe[0]);
+    close(pipe[1]);
+
+    // Closing the pipe terminates the request, drop its completions.
+    struct io_uring_cqe cqes[8];
+    while (ring.waitForCompletion(std::chrono::milliseconds(1)) == 0 &&
+           ring.reapCompletions(cqes, 8) != 0)
+      ;
+
+    return result;
+  }
+};
+
+// IoUringFileDescriptorEventPollerBuffer
+
+FileDescriptorEvent IoUringFileDescriptorEventPollerBuffer::waitForNextEvent(
+    std::chrono::nanoseconds const &timeout) noexcept {
+  FileDescriptorEvent result{nullptr, -1, FileDescriptorEventType::Error};
+
+  if (popEvent(result)) {
+    return result;
+  }
+
+  if (!pollEvents(timeout)) {
+    return result;
+  }
+
+  if (!popEvent(result)) {
+    result.eventType = FileDescriptorEventType::Timeout;
+  }
+
+  return result;
+}
+
+int IoUringFileDescriptorEventPollerBuffer::waitForEvents(
+    FileDescriptorEvent *events, std::size_t maxEventCount,
+    std::chrono::nanoseconds const &timeout) noexcept {
+  if (maxEventCount == 0) {
+    return 0;
+  }
+
+  size_t count = popEvents(events, maxEventCount);
+
+  if (count == 0) {
+    if (!pollEvents(timeout)) {
+      return -1;
+    }
+
+    count = popEvents(events, maxEventCount);
+  }
+
+  return static_cast<int>(count);
+}
+
+bool IoUringFileDescriptorEventPollerBuffer::popEvent(
+    FileDescriptorEvent &result) noexcept {
+  while (d_bufferSize != 0) {
+    auto &cqe = d_events[--d_bufferSize];
+    auto key = untag(cqe.user_data);
+
+    if (cqe.user_data == c_ignoredUserData ||
+        !d_registry.d_slots.get(key, result.userData)) {
+      continue;
+    }
+
+    if (cqe.res >= 0 && (cqe.flags & IORING_CQE_F_MORE) == 0) {
+      d_registry.resubmit(cqe.user_data);
+    }
+
+    if (cqe.res == -ECANCELED) {
+      continue;
+    }
+
+    result.fileDescriptor = FileDescriptorSlotTable::fileDescriptorOf(key);
+    result.eventType = cqe.res < 0
+                           ? FileDescriptorEventType::ErrorCondition
+                           : ePollEventsToEventType(
+                                 static_cast<uint32_t>(cqe.res));
+
+    if (result.eventType == FileDescriptorEventType::Timeout) {
+      continue;
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+bool IoUringFileDescriptorEventPollerBuffer::pollEvents(
+    std::chrono::nanoseconds const &timeout) noexcept {
+  int result = d_registry.d_ring->waitForCompletion(timeout);
+
+  if (result < 0 && result != -ETIME) {
+    return false;
+  }
+
+  auto lock = std::lock_guard(d_registry.d_completionMutex);
+  d_bufferSize =
+      d_registry.d_ring->reapCompletions(d_events.data(), c_eventBufferSize);
+
+  // The completions are stored in reverse order, because they are popped from
+  // the back of the buffer.
+  std::reverse(d_events.begin(), d_events.begin() + d_bufferSize);
+  return true;
+}
+
+} // namespace
+
+std::unique_ptr<FileDescriptorEventRegistry>
+FileDescriptorEventRegistry::createIoUring() noexcept {
+  return IoUringFileDescriptorEventRegistry::create();
+}
+
+} // namespace io
+} // namespace eco
+
+#else
+
+namespace eco {
+namespace io {
+
+std::unique_ptr<FileDescriptorEventRegistry>
+FileDescriptorEventRegistry::createIoUring() noexcept {
+  return nullptr;
+}
+
+} // namespace io
+} // namespace eco
+
+#endif
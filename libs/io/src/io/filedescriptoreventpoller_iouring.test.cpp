@@ -0,0 +1,219 @@
+#include <io/filedescriptoreventpoller.h>
+#include <io/filedescriptoreventpoller.test.h>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <set>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace eco::io;
+using namespace eco::io::test;
+
+namespace {
+
+char buffer[1024];
+FileDescriptorEventUserData userData;
+} // namespace
+
+TEST(IoUringFileDescriptorEventRegistry, AddAndRemove) {
+  // GIVEN
+  auto sockets = createNonBlockingSocketPair();
+  auto sut = FileDescriptorEventRegistry::createIoUring();
+  ASSERT_NE(nullptr, sut);
+  int file = open("/proc/self/exe", O_RDONLY | O_CLOEXEC);
+
+  // WHEN-THEN
+  EXPECT_FALSE(sut->remove(sockets.first));
+  EXPECT_TRUE(sut->addOrReplace(sockets.first, &userData));
+  EXPECT_TRUE(sut->addOrReplace(sockets.first, &userData));
+  EXPECT_TRUE(sut->remove(sockets.first));
+  EXPECT_FALSE(sut->remove(sockets.first));
+  EXPECT_FALSE(sut->addOrReplace(-1, &userData));
+  EXPECT_FALSE(sut->addOrReplace(file, &userData));
+
+  close(file);
+  close(sockets.first);
+  close(sockets.second);
+}
+
+TEST(IoUringFileDescriptorEventRegistry, EventSemantics) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createIoUring());
+  ASSERT_NE(nullptr, sut);
+  auto sockets = createNonBlockingSocketPair();
+  FileDescriptorEventPoller poller(sut);
+  sut->addOrReplace(sockets.first, &userData);
+
+  // WHEN-THEN the socket is initially writable, which is reported once.
+  auto event = poller.waitForNextEvent(std::chrono::milliseconds(10));
+  EXPECT_EQ(FileDescriptorEventType::Writable, event.eventType);
+  EXPECT_EQ(sockets.first, event.fileDescriptor);
+  EXPECT_EQ(&userData, event.userData);
+  EXPECT_FALSE(isWritable(pollEventTypes(poller)));
+
+  // WHEN-THEN writing to the other side makes it readable.
+  write(sockets.second, "abcdefg", 8);
+  EXPECT_TRUE(isReadable(pollEventTypes(poller)));
+
+  // WHEN-THEN writing until the buffer is full does not report anything.
+  while (write(sockets.first, buffer, 1024) != -1)
+    ;
+  auto eventTypes = pollEventTypes(poller);
+  EXPECT_FALSE(isWritable(eventTypes));
+  EXPECT_FALSE(isReadable(eventTypes));
+
+  // WHEN-THEN draining the other side makes it writable again.
+  while (read(sockets.second, buffer, 1024) != -1)
+    ;
+  EXPECT_TRUE(isWritable(pollEventTypes(poller)));
+
+  // WHEN-THEN after removing no events are reported.
+  EXPECT_TRUE(sut->remove(sockets.first));
+  write(sockets.second, "abcdefg", 8);
+  EXPECT_TRUE(pollEventTypes(poller).empty());
+
+  close(sockets.first);
+  close(sockets.second);
+}
+
+TEST(IoUringFileDescriptorEventRegistry, OneShot) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createIoUring());
+  ASSERT_NE(nullptr, sut);
+  auto sockets = createNonBlockingSocketPair();
+  FileDescriptorEventPoller poller(sut);
+  FileDescriptorEventOptions options;
+  options.interest = FileDescriptorInterest::Read;
+  options.oneShot = true;
+  EXPECT_TRUE(sut->addOrReplace(sockets.first, &userData, options));
+
+  // WHEN-THEN
+  write(sockets.second, "abcdefg", 8);
+  EXPECT_TRUE(isReadable(pollEventTypes(poller)));
+
+  // WHEN-THEN not reported again before re-arming.
+  write(sockets.second, "abcdefg", 8);
+  EXPECT_FALSE(isReadable(pollEventTypes(poller)));
+
+  // WHEN-THEN reported again after re-arming.
+  EXPECT_TRUE(sut->rearm(sockets.first));
+  EXPECT_TRUE(isReadable(pollEventTypes(poller)));
+
+  close(sockets.first);
+  close(sockets.second);
+}
+
+TEST(IoUringFileDescriptorEventRegistry, LevelTriggered) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createIoUring());
+  ASSERT_NE(nullptr, sut);
+  auto sockets = createNonBlockingSocketPair();
+  FileDescriptorEventPoller poller(sut);
+  FileDescriptorEventOptions options;
+  options.interest = FileDescriptorInterest::Read;
+  options.triggerMode = FileDescriptorTriggerMode::Level;
+  EXPECT_TRUE(sut->addOrReplace(sockets.first, &userData, options));
+
+  // WHEN
+  write(sockets.second, "abcdefg", 8);
+
+  // THEN the socket is reported as long as it is readable.
+  for (int i = 0; i < 3; ++i) {
+    auto event = poller.waitForNextEvent(std::chrono::milliseconds(10));
+    EXPECT_EQ(FileDescriptorEventType::Readable, event.eventType);
+  }
+
+  close(sockets.first);
+  close(sockets.second);
+}
+
+TEST(IoUringFileDescriptorEventRegistry, ModifyLevelTriggered) {
+  // GIVEN a readable socket whose single-shot request already completed
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createIoUring());
+  ASSERT_NE(nullptr, sut);
+  auto sockets = createNonBlockingSocketPair();
+  FileDescriptorEventPoller poller(sut);
+  FileDescriptorEventOptions options;
+  options.interest = FileDescriptorInterest::Read;
+  options.triggerMode = FileDescriptorTriggerMode::Level;
+  EXPECT_TRUE(sut->addOrReplace(sockets.first, &userData, options));
+  write(sockets.second, "abcdefg", 8);
+  usleep(5000);
+
+  // WHEN
+  EXPECT_TRUE(sut->modify(sockets.first, options));
+  std::array<FileDescriptorEvent, 16> events;
+  poller.waitForEvents(events, std::chrono::milliseconds(10));
+
+  // THEN the completion of the replaced request is not resubmitted, so the
+  // socket is reported once per round.
+  for (int i = 0; i < 3; ++i) {
+    usleep(5000);
+    EXPECT_EQ(1, poller.waitForEvents(events, std::chrono::milliseconds(10)));
+  }
+
+  close(sockets.first);
+  close(sockets.second);
+}
+
+TEST(IoUringFileDescriptorEventRegistry, ModifyAndPeerClosed) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createIoUring());
+  ASSERT_NE(nullptr, sut);
+  auto sockets = createNonBlockingSocketPair();
+  FileDescriptorEventPoller poller(sut);
+  FileDescriptorEventOptions options;
+  options.interest = FileDescriptorInterest::Read;
+  EXPECT_TRUE(sut->addOrReplace(sockets.first, &userData, options));
+  EXPECT_TRUE(pollEventTypes(poller).empty());
+
+  // WHEN
+  options.interest =
+      FileDescriptorInterest::Read | FileDescriptorInterest::PeerClosed;
+  EXPECT_TRUE(sut->modify(sockets.first, options));
+  shutdown(sockets.second, SHUT_WR);
+  auto eventTypes = pollEventTypes(poller);
+
+  // THEN
+  EXPECT_TRUE(isReadable(eventTypes));
+  EXPECT_FALSE(isWritable(eventTypes));
+  EXPECT_EQ(1, eventTypes.count(FileDescriptorEventType::PeerClosed));
+
+  close(sockets.first);
+  close(sockets.second);
+}
+
+TEST(IoUringFileDescriptorEventRegistry, WaitForEvents) {
+  // GIVEN
+  auto sut = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createIoUring());
+  ASSERT_NE(nullptr, sut);
+  FileDescriptorEventPoller poller(sut);
+  std::set<FileDescriptor> fileDescriptors;
+
+  for (int i = 0; i < 8; ++i) {
+    auto sockets = createNonBlockingSocketPair();
+    sut->addOrReplace(sockets.first, &userData);
+    fileDescriptors.insert(sockets.first);
+  }
+
+  // WHEN
+  std::array<FileDescriptorEvent, 16> events;
+  auto count = poller.waitForEvents(events, std::chrono::milliseconds(100));
+
+  // THEN all sockets are reported as writable in a single call.
+  ASSERT_EQ(8, count);
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(FileDescriptorEventType::Writable, events[i].eventType);
+    EXPECT_EQ(1, fileDescriptors.count(events[i].fileDescriptor));
+  }
+}
@@ -2,8 +2,13 @@
 
 #include <io/filedescriptoreventpoller.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include <unistd.h>
 #include <sys/event.h>
@@ -22,7 +27,7 @@ class KQueueFileDescriptorEventPollerBuffer : public FileDescriptorEventPollerBu
 public:
     KQueueFileDescriptorEventPollerBuffer(int kQueue) : d_kQueue(kQueue) {}
 
-    virtual FileDescriptorEvent waitForNextEvent(std::chrono::milliseconds const &timeout) noexcept override {
+    virtual FileDescriptorEvent waitForNextEvent(std::chrono::nanoseconds const &timeout) noexcept override {
         if (d_bufferSize == 0) {
             if (!pollEvents(timeout)) {
                 return FileDescriptorEvent{
@@ -39,12 +44,11 @@ public:
     }
 
 private:
-    bool pollEvents(std::chrono::milliseconds timeout) {
+    bool pollEvents(std::chrono::nanoseconds const &timeout) {
         auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
-        timeout -= seconds;
-        auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout);
-        auto timeoutTimeSpec = timespec{seconds.count(), nanoseconds.count()};
-        int count = kevent(d_kQueue, nullptr, 0, d_events.data(), c_eventBufferSize, &timeoutTimeSpec);
+        auto timeoutTimeSpec = timespec{seconds.count(), (timeout - seconds).count()};
+        int count = kevent(d_kQueue, nullptr, 0, d_events.data(), c_eventBufferSize,
+                           timeout.count() < 0 ? nullptr : &timeoutTimeSpec);
 
         if (count == -1) {
             return false;
@@ -57,55 +61,141 @@ private:
 
     static FileDescriptorEvent kEventToFileDescriptorEvent(struct kevent const &event) {
         return FileDescriptorEvent{
-            event.udata,
+            static_cast<FileDescriptorEventUserData *>(event.udata),
             static_cast<FileDescriptor>(event.ident),
-            filterToEventType(event.filter)
+            kEventToEventType(event)
         };
     }
 
-    static FileDescriptorEventType filterToEventType(int16_t filter) {
-        switch (filter) {
-            case EVFILT_READ: return FileDescriptorEventType::Readable;
-            case EVFILT_WRITE: return FileDescriptorEventType::Writable;
-            default: return FileDescriptorEventType::Error;
+    static FileDescriptorEventType kEventToEventType(struct kevent const &event) {
+        auto eventType = FileDescriptorEventType::ErrorCondition;
+
+        switch (event.filter) {
+            case EVFILT_READ: eventType = FileDescriptorEventType::Readable; break;
+            case EVFILT_WRITE: eventType = FileDescriptorEventType::Writable; break;
+            default: break;
+        }
+
+        if ((event.flags & EV_ERROR) != 0) {
+            eventType = eventType | FileDescriptorEventType::ErrorCondition;
         }
+
+        if ((event.flags & EV_EOF) != 0) {
+            eventType = eventType | (event.filter == EVFILT_READ ? FileDescriptorEventType::PeerClosed : FileDescriptorEventType::HangUp);
+        }
+
+        return eventType;
     }
 };
 
 class KQueueFileDescriptorEventRegistry : public FileDescriptorEventRegistry {
-    int d_kQueue = -1;
+    using Registration = std::pair<FileDescriptorEventUserData *, FileDescriptorEventOptions>;
+
+    // One kqueue per shard, each file descriptor is registered in the shard
+    // of its number.
+    std::vector<int> d_kQueues;
+    std::atomic<size_t> d_nextPollerShard{0};
+    std::mutex d_mutex;
+    std::unordered_map<FileDescriptor, Registration> d_registrations;
 public:
-    KQueueFileDescriptorEventRegistry() {
-        d_kQueue = kqueue();
+    explicit KQueueFileDescriptorEventRegistry(size_t shardCount = 1)
+    : d_kQueues(std::max<size_t>(shardCount, 1), -1)
+    {
+        for (auto &kQueue : d_kQueues) {
+            kQueue = kqueue();
+        }
     }
 
     virtual ~KQueueFileDescriptorEventRegistry() {
-        close(d_kQueue);
+        for (auto kQueue : d_kQueues) {
+            close(kQueue);
+        }
     }
 
-    bool addOrReplace(FileDescriptor fileDescriptor, void *userData = nullptr) noexcept override
+    bool addOrReplace(FileDescriptor fileDescriptor, FileDescriptorEventUserData *userData = nullptr, FileDescriptorEventOptions const &options = FileDescriptorEventOptions()) noexcept override
     {
-        struct kevent events[2];
+        auto lock = std::lock_guard(d_mutex);
 
-        EV_SET(&events[0], fileDescriptor, EVFILT_READ, EV_ADD | EV_CLEAR, 0, 0, userData);
-        EV_SET(&events[1], fileDescriptor, EVFILT_WRITE, EV_ADD | EV_CLEAR, 0, 0, userData);
+        if (!control(fileDescriptor, userData, options)) {
+            return false;
+        }
+
+        d_registrations[fileDescriptor] = Registration(userData, options);
+        return true;
+    }
 
-        return kevent(d_kQueue, events, 2, nullptr, 0, nullptr) != -1;
+    bool modify(FileDescriptor fileDescriptor, FileDescriptorEventOptions const &options) noexcept override
+    {
+        auto lock = std::lock_guard(d_mutex);
+        auto iter = d_registrations.find(fileDescriptor);
+
+        if (iter == d_registrations.end() || !control(fileDescriptor, iter->second.first, options)) {
+            return false;
+        }
+
+        iter->second.second = options;
+        return true;
+    }
+
+    bool rearm(FileDescriptor fileDescriptor) noexcept override
+    {
+        auto lock = std::lock_guard(d_mutex);
+        auto iter = d_registrations.find(fileDescriptor);
+
+        // Adding an existing filter again enables it after it was disabled by
+        // `EV_DISPATCH`.
+        return iter != d_registrations.end() && control(fileDescriptor, iter->second.first, iter->second.second);
     }
 
     bool remove(FileDescriptor fileDescriptor) noexcept override
     {
+        auto lock = std::lock_guard(d_mutex);
+        d_registrations.erase(fileDescriptor);
+
         struct kevent events[2];
 
         EV_SET(&events[0], fileDescriptor, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
         EV_SET(&events[1], fileDescriptor, EVFILT_WRITE, EV_DELETE, 0, 0, nullptr);
 
-        return kevent(d_kQueue, events, 2, nullptr, 0, nullptr) != -1;
+        return kevent(shard(fileDescriptor), events, 2, nullptr, 0, nullptr) != -1;
+    }
+
+private:
+    bool control(FileDescriptor fileDescriptor, FileDescriptorEventUserData *userData, FileDescriptorEventOptions const &options) noexcept
+    {
+        if (options.exclusive && options.oneShot) {
+            return false;
+        }
+
+        // kqueue has no exclusive wake-up mode, which only matters for file
+        // descriptors that are registered in multiple registries.
+        uint16_t flags = EV_ADD;
+        flags |= options.triggerMode == FileDescriptorTriggerMode::Edge ? EV_CLEAR : 0;
+        flags |= options.oneShot ? EV_DISPATCH : 0;
+
+        bool read = (options.interest & (FileDescriptorInterest::Read | FileDescriptorInterest::PeerClosed)) != FileDescriptorInterest::None;
+        bool write = (options.interest & FileDescriptorInterest::Write) != FileDescriptorInterest::None;
+
+        struct kevent events[2];
+
+        EV_SET(&events[0], fileDescriptor, EVFILT_READ, flags | (read ? EV_ENABLE : EV_DISABLE), 0, 0, userData);
+        EV_SET(&events[1], fileDescriptor, EVFILT_WRITE, flags | (write ? EV_ENABLE : EV_DISABLE), 0, 0, userData);
+
+        return kevent(shard(fileDescriptor), events, 2, nullptr, 0, nullptr) != -1;
+    }
+
+    /**
+     * Return the kqueue of the shard the specified `fileDescriptor` belongs
+     * to.
+     */
+    int shard(FileDescriptor fileDescriptor) const noexcept {
+        return d_kQueues[static_cast<uint32_t>(fileDescriptor) % d_kQueues.size()];
     }
 
 protected:
     std::unique_ptr<FileDescriptorEventPollerBuffer> createPollerBuffer() noexcept override {
-        return std::make_unique<KQueueFileDescriptorEventPollerBuffer>(d_kQueue);
+        auto index = d_nextPollerShard.fetch_add(1) % d_kQueues.size();
+        return std::make_unique<KQueueFileDescriptorEventPollerBuffer>(d_kQueues[index]);
     }
 };
 
@@ -115,6 +205,10 @@ std::unique_ptr<FileDescriptorEventRegistry> FileDescriptorEventRegistry::create
     return std::make_unique<KQueueFileDescriptorEventRegistry>();
 }
 
+std::unique_ptr<FileDescriptorEventRegistry> FileDescriptorEventRegistry::createSharded(std::size_t shardCount) noexcept {
+    return std::make_unique<KQueueFileDescriptorEventRegistry>(shardCount);
+}
+
 }
 }
 
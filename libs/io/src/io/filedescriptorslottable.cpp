@@ -0,0 +1,148 @@
+#include <io/filedescriptorslottable.h>
+
+#include <new>
+
+namespace eco {
+namespace io {
+
+// CREATORS
+
+FileDescriptorSlotTable::FileDescriptorSlotTable() noexcept {
+  for (auto &chunk : d_chunks) {
+    chunk.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+FileDescriptorSlotTable::~FileDescriptorSlotTable() {
+  for (auto &chunk : d_chunks) {
+    delete[] chunk.load(std::memory_order_relaxed);
+  }
+}
+
+// MANIPULATORS
+
+bool FileDescriptorSlotTable::addOrReplace(
+    FileDescriptor fileDescriptor, FileDescriptorEventUserData *userData,
+    uint32_t flags, Key &key, bool &wasRegistered) noexcept {
+  auto slotPtr = slot(fileDescriptor, true);
+
+  if (slotPtr == nullptr) {
+    return false;
+  }
+
+  auto generation = slotPtr->d_generation.load() + 1;
+  slotPtr->d_generation.store(generation);
+  slotPtr->d_userData.store(userData);
+
+  wasRegistered = slotPtr->d_registered;
+  slotPtr->d_registered = true;
+  slotPtr->d_flags = flags;
+
+  key = (static_cast<Key>(generation) << 32) |
+        static_cast<uint32_t>(fileDescriptor);
+  return true;
+}
+
+bool FileDescriptorSlotTable::restore(FileDescriptor fileDescriptor, Key key,
+                                      FileDescriptorEventUserData *userData,
+                                      uint32_t flags) noexcept {
+  auto slotPtr = slot(fileDescriptor, false);
+
+  if (slotPtr == nullptr) {
+    return false;
+  }
+
+  slotPtr->d_generation.store(static_cast<uint32_t>(key >> 32));
+  slotPtr->d_userData.store(userData);
+  slotPtr->d_registered = true;
+  slotPtr->d_flags = flags;
+  return true;
+}
+
+bool FileDescriptorSlotTable::setFlags(FileDescriptor fileDescriptor,
+                                       uint32_t flags) noexcept {
+  auto slotPtr = slot(fileDescriptor, false);
+
+  if (slotPtr == nullptr || !slotPtr->d_registered) {
+    return false;
+  }
+
+  slotPtr->d_flags = flags;
+  return true;
+}
+
+bool FileDescriptorSlotTable::registration(FileDescriptor fileDescriptor,
+                                           Key &key,
+                                           uint32_t &flags) noexcept {
+  auto slotPtr = slot(fileDescriptor, false);
+
+  if (slotPtr == nullptr || !slotPtr->d_registered) {
+    return false;
+  }
+
+  key = (static_cast<Key>(slotPtr->d_generation.load()) << 32) |
+        static_cast<uint32_t>(fileDescriptor);
+  flags = slotPtr->d_flags;
+  return true;
+}
+
+bool FileDescriptorSlotTable::remove(FileDescriptor fileDescriptor) noexcept {
+  auto slotPtr = slot(fileDescriptor, false);
+
+  if (slotPtr == nullptr || !slotPtr->d_registered) {
+    return false;
+  }
+
+  slotPtr->d_generation.store(slotPtr->d_generation.load() + 1);
+  slotPtr->d_userData.store(nullptr);
+  slotPtr->d_registered = false;
+  slotPtr->d_flags = 0;
+  return true;
+}
+
+uint32_t FileDescriptorSlotTable::nextSubmission(
+    FileDescriptor fileDescriptor) noexcept {
+  auto slotPtr = slot(fileDescriptor, false);
+  return slotPtr == nullptr ? 0 : ++slotPtr->d_submission;
+}
+
+uint32_t
+FileDescriptorSlotTable::submission(FileDescriptor fileDescriptor) noexcept {
+  auto slotPtr = slot(fileDescriptor, false);
+  return slotPtr == nullptr ? 0 : slotPtr->d_submission;
+}
+
+// PRIVATE MANIPULATORS
+
+FileDescriptorSlotTable::Slot *
+FileDescriptorSlotTable::slot(FileDescriptor fileDescriptor,
+                              bool allocate) noexcept {
+  if (fileDescriptor < 0) {
+    return nullptr;
+  }
+
+  auto index = static_cast<std::size_t>(fileDescriptor);
+  auto chunkIndex = index / c_slotsPerChunk;
+
+  if (chunkIndex >= c_maxChunkCount) {
+    return nullptr;
+  }
+
+  auto chunk = d_chunks[chunkIndex].load(std::memory_order_acquire);
+
+  if (chunk == nullptr && allocate) {
+    // Chunks are never freed before the table is destroyed, so readers can
+    // access them without taking a lock.
+    auto lock = std::lock_guard(d_chunkMutex);
+    chunk = d_chunks[chunkIndex].load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+      chunk = new (std::nothrow) Slot[c_slotsPerChunk];
+      d_chunks[chunkIndex].store(chunk, std::memory_order_release);
+    }
+  }
+
+  return chunk == nullptr ? nullptr : &chunk[index % c_slotsPerChunk];
+}
+
+} // namespace io
+} // namespace eco
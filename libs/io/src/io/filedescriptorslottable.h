@@ -0,0 +1,206 @@
+#ifndef ECO_IO_FILEDESCRIPTORSLOTTABLE
+#define ECO_IO_FILEDESCRIPTORSLOTTABLE
+
+#include <io/filedescriptor.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace eco {
+namespace io {
+
+struct FileDescriptorEventUserData;
+
+/**
+ * @brief Flat table of registration slots indexed by file descriptor.
+ *
+ * Every registration of a file descriptor gets a new generation. The file
+ * descriptor and the generation are packed into a 64 bit key that is handed to
+ * the kernel as event data, so events that were retrieved before the file
+ * descriptor was removed or replaced can be detected as stale.
+ *
+ * Looking up a key is lock-free and can be done from multiple threads
+ * concurrently. Modifying a slot requires holding the lock returned by
+ * `lockForWriting` for that file descriptor.
+ */
+class FileDescriptorSlotTable {
+public:
+  // PUBLIC TYPES
+  using Key = uint64_t;
+
+  using WriteLock = std::unique_lock<std::mutex>;
+
+private:
+  // PRIVATE TYPES
+  struct Slot {
+    std::atomic<uint32_t> d_generation{0};
+    std::atomic<FileDescriptorEventUserData *> d_userData{nullptr};
+    bool d_registered = false;
+    uint32_t d_flags = 0;
+    uint32_t d_submission = 0;
+  };
+
+  // PRIVATE CONSTANTS
+  static constexpr std::size_t c_slotsPerChunk = 1024;
+  static constexpr std::size_t c_maxChunkCount = 4096;
+  static constexpr std::size_t c_writeMutexCount = 64;
+
+  // PRIVATE DATA
+  std::array<std::atomic<Slot *>, c_maxChunkCount> d_chunks;
+  std::array<std::mutex, c_writeMutexCount> d_writeMutexes;
+  std::mutex d_chunkMutex;
+
+public:
+  // PUBLIC CONSTANTS
+  /**
+   * @brief The number of low bits of a key that hold the file descriptor. The
+   * bits above them in the lower half of a key are always zero, so backends
+   * can tag the keys they hand to the kernel with them.
+   */
+  static constexpr unsigned c_fileDescriptorBitCount = 22;
+
+  // STATIC ACCESSORS
+  /**
+   * @brief Return the file descriptor that is packed into the specified `key`.
+   */
+  static FileDescriptor fileDescriptorOf(Key key) noexcept {
+    return static_cast<FileDescriptor>(static_cast<uint32_t>(key));
+  }
+
+  // CREATORS
+  FileDescriptorSlotTable() noexcept;
+
+  FileDescriptorSlotTable(FileDescriptorSlotTable const &) = delete;
+  FileDescriptorSlotTable &operator=(FileDescriptorSlotTable const &) = delete;
+
+  ~FileDescriptorSlotTable();
+
+  // MANIPULATORS
+  /**
+   * @brief Return the lock that serializes modifications of the slot of the
+   * specified `fileDescriptor`.
+   */
+  WriteLock lockForWriting(FileDescriptor fileDescriptor) noexcept {
+    return WriteLock(
+        d_writeMutexes[static_cast<uint32_t>(fileDescriptor) %
+                       c_writeMutexCount]);
+  }
+
+  /**
+   * @brief Start a new generation for the specified `fileDescriptor` with the
+   * specified `userData` and backend specific `flags` and store its key in the
+   * specified `key`. Return `true` on success and `false` when
+   * `fileDescriptor` is out of range. Set `wasRegistered` to whether the file
+   * descriptor was already registered.
+   *
+   * The caller must hold the write lock of `fileDescriptor`.
+   */
+  bool addOrReplace(FileDescriptor fileDescriptor,
+                    FileDescriptorEventUserData *userData, uint32_t flags,
+                    Key &key, bool &wasRegistered) noexcept;
+
+  /**
+   * @brief Restore the registration of the specified `fileDescriptor` with the
+   * specified `key`, `userData` and backend specific `flags` that was replaced
+   * by `addOrReplace`, when the replacement could not be passed on to the
+   * kernel. Return `true` on success or `false` when `fileDescriptor` is out
+   * of range.
+   *
+   * The caller must hold the write lock of `fileDescriptor`.
+   */
+  bool restore(FileDescriptor fileDescriptor, Key key,
+               FileDescriptorEventUserData *userData, uint32_t flags) noexcept;
+
+  /**
+   * @brief Replace the backend specific flags of the registered
+   * `fileDescriptor` with the specified `flags` without starting a new
+   * generation. Return `true` on success or `false` when `fileDescriptor` was
+   * not registered.
+   *
+   * The caller must hold the write lock of `fileDescriptor`.
+   */
+  bool setFlags(FileDescriptor fileDescriptor, uint32_t flags) noexcept;
+
+  /**
+   * @brief Store the key and the backend specific flags of the current
+   * generation of the specified `fileDescriptor` in the specified `key` and
+   * `flags`. Return `true` on success or `false` when `fileDescriptor` is not
+   * registered.
+   *
+   * The caller must hold the write lock of `fileDescriptor`.
+   */
+  bool registration(FileDescriptor fileDescriptor, Key &key,
+                    uint32_t &flags) noexcept;
+
+  /**
+   * @brief Invalidate the current generation of the specified
+   * `fileDescriptor`. Return `true` on success or `false` when
+   * `fileDescriptor` was not registered.
+   *
+   * The caller must hold the write lock of `fileDescriptor`.
+   */
+  bool remove(FileDescriptor fileDescriptor) noexcept;
+
+  /**
+   * @brief Start the next submission of the specified `fileDescriptor` to the
+   * kernel and return its sequence number, so that events of earlier
+   * submissions can be told apart. Sequence numbers are kept across
+   * generations. Return `0` when `fileDescriptor` is out of range.
+   *
+   * The caller must hold the write lock of `fileDescriptor`.
+   */
+  uint32_t nextSubmission(FileDescriptor fileDescriptor) noexcept;
+
+  /**
+   * @brief Return the sequence number of the last submission of the specified
+   * `fileDescriptor`.
+   *
+   * The caller must hold the write lock of `fileDescriptor`.
+   */
+  uint32_t submission(FileDescriptor fileDescriptor) noexcept;
+
+  // ACCESSORS
+  /**
+   * @brief Store the user data registered for the specified `key` in the
+   * specified `userData`. Return `true` on success or `false` when `key`
+   * belongs to a generation that was removed or replaced.
+   *
+   * This never blocks.
+   */
+  bool get(Key key, FileDescriptorEventUserData *&userData) const noexcept {
+    auto fileDescriptor = static_cast<uint32_t>(key);
+    auto generation = static_cast<uint32_t>(key >> 32);
+    Slot const *chunk =
+        fileDescriptor / c_slotsPerChunk < c_maxChunkCount
+            ? d_chunks[fileDescriptor / c_slotsPerChunk].load(
+                  std::memory_order_acquire)
+            : nullptr;
+
+    if (chunk == nullptr) {
+      return false;
+    }
+
+    // The user data is loaded before the generation and a writer stores the
+    // generation before the user data, so a matching generation guarantees
+    // the user data belongs to it.
+    auto &slot = chunk[fileDescriptor % c_slotsPerChunk];
+    userData = slot.d_userData.load();
+    return slot.d_generation.load() == generation;
+  }
+
+private:
+  // PRIVATE MANIPULATORS
+  Slot *slot(FileDescriptor fileDescriptor, bool allocate) noexcept;
+
+  static_assert(c_slotsPerChunk * c_maxChunkCount <=
+                    std::size_t(1) << c_fileDescriptorBitCount,
+                "file descriptors must fit into their bits of a key");
+};
+
+} // namespace io
+} // namespace eco
+
+#endif // ECO_IO_FILEDESCRIPTORSLOTTABLE
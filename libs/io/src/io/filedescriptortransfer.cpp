@@ -0,0 +1,291 @@
+#include <io/filedescriptortransfer.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <new>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#if __linux__
+#include <sys/sendfile.h>
+#endif
+
+namespace eco {
+namespace io {
+
+namespace {
+
+/**
+ * @brief The most bytes moved into the pipe or the user space buffer at a
+ * time, which is the default pipe capacity on Linux.
+ */
+const std::size_t c_maxSpliceSize = 64 * 1024;
+
+} // namespace
+
+// STATIC CREATORS
+
+std::unique_ptr<FileDescriptorTransfer>
+FileDescriptorTransfer::sendFile(FileDescriptor source, off_t offset,
+                                 std::size_t length,
+                                 FileDescriptor destination) noexcept {
+  auto transfer = std::unique_ptr<FileDescriptorTransfer>(
+      new (std::nothrow) FileDescriptorTransfer());
+
+  if (transfer == nullptr) {
+    return nullptr;
+  }
+
+  transfer->d_source = source;
+  transfer->d_destination = destination;
+  transfer->d_offset = offset;
+  transfer->d_length = length;
+  transfer->d_isSendFile = true;
+  return transfer;
+}
+
+std::unique_ptr<FileDescriptorTransfer>
+FileDescriptorTransfer::splice(FileDescriptor source,
+                               FileDescriptor destination,
+                               std::size_t length) noexcept {
+#if __linux__
+  auto transfer = std::unique_ptr<FileDescriptorTransfer>(
+      new (std::nothrow) FileDescriptorTransfer());
+
+  if (transfer == nullptr) {
+    return nullptr;
+  }
+
+  if (pipe2(transfer->d_pipe, O_NONBLOCK | O_CLOEXEC) == 0) {
+    transfer->d_source = source;
+    transfer->d_destination = destination;
+    transfer->d_length = length;
+    return transfer;
+  }
+#endif
+
+  return copy(source, destination, length);
+}
+
+std::unique_ptr<FileDescriptorTransfer>
+FileDescriptorTransfer::copy(FileDescriptor source, FileDescriptor destination,
+                             std::size_t length) noexcept {
+  auto transfer = std::unique_ptr<FileDescriptorTransfer>(
+      new (std::nothrow) FileDescriptorTransfer());
+
+  if (transfer == nullptr || !transfer->allocateBuffer()) {
+    return nullptr;
+  }
+
+  transfer->d_source = source;
+  transfer->d_destination = destination;
+  transfer->d_length = length;
+  return transfer;
+}
+
+// CREATORS
+
+FileDescriptorTransfer::~FileDescriptorTransfer() {
+  for (auto fileDescriptor : d_pipe) {
+    if (fileDescriptor != -1) {
+      close(fileDescriptor);
+    }
+  }
+}
+
+// MANIPULATORS
+
+bool FileDescriptorTransfer::resume() noexcept {
+  if (d_isDone) {
+    return true;
+  }
+
+  if (d_isSendFile) {
+    return resumeSendFile();
+  }
+
+  return d_buffer != nullptr ? resumeCopy() : resumeSplice();
+}
+
+void FileDescriptorTransfer::onEvent(FileDescriptorEventType) noexcept {
+  resume();
+}
+
+// PRIVATE MANIPULATORS
+
+bool FileDescriptorTransfer::resumeSendFile() noexcept {
+  while (d_transferred < d_length) {
+#if __linux__
+    auto count = ::sendfile(d_destination, d_source, &d_offset,
+                            d_length - d_transferred);
+#else
+    // Without sendfile the bytes are copied, but the file offset still
+    // tracks progress, so nothing is buffered between calls.
+    char buffer[16 * 1024];
+    auto count = pread(d_source, buffer,
+                       std::min(sizeof(buffer), d_length - d_transferred),
+                       d_offset);
+    if (count > 0) {
+      count = write(d_destination, buffer, count);
+      d_offset += count > 0 ? count : 0;
+    }
+#endif
+
+    if (count > 0) {
+      d_transferred += static_cast<std::size_t>(count);
+      continue;
+    }
+
+    if (count == 0) {
+      return finish(0);
+    }
+
+    if (errno == EINTR) {
+      continue;
+    }
+
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return false;
+    }
+
+    return finish(errno);
+  }
+
+  return finish(0);
+}
+
+bool FileDescriptorTransfer::resumeSplice() noexcept {
+#if __linux__
+  while (true) {
+    ssize_t count = 0;
+
+    if (d_pipeSizeInBytes > 0) {
+      count = ::splice(d_pipe[0], nullptr, d_destination, nullptr,
+                       d_pipeSizeInBytes, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+
+      if (count > 0) {
+        d_pipeSizeInBytes -= static_cast<std::size_t>(count);
+        d_transferred += static_cast<std::size_t>(count);
+        continue;
+      }
+
+      if (count < 0 && errno == EINVAL) {
+        // The destination cannot be spliced to, so the bytes in the pipe
+        // move to the user space buffer and are written from there.
+        if (!allocateBuffer()) {
+          return finish(ENOMEM);
+        }
+
+        while (d_bufferEnd < d_pipeSizeInBytes) {
+          count = read(d_pipe[0], d_buffer.get() + d_bufferEnd,
+                       d_pipeSizeInBytes - d_bufferEnd);
+
+          if (count <= 0 && !(count < 0 && errno == EINTR)) {
+            return finish(count < 0 ? errno : EIO);
+          }
+
+          d_bufferEnd += count > 0 ? static_cast<std::size_t>(count) : 0;
+        }
+
+        d_pipeSizeInBytes = 0;
+        return resumeCopy();
+      }
+    } else {
+      if (d_transferred == d_length) {
+        return finish(0);
+      }
+
+      count = ::splice(d_source, nullptr, d_pipe[1], nullptr,
+                       std::min(d_length - d_transferred, c_maxSpliceSize),
+                       SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+
+      if (count > 0) {
+        d_pipeSizeInBytes = static_cast<std::size_t>(count);
+        continue;
+      }
+
+      if (count == 0) {
+        return finish(0);
+      }
+
+      if (count < 0 && errno == EINVAL) {
+        // The source cannot be spliced from.
+        return allocateBuffer() ? resumeCopy() : finish(ENOMEM);
+      }
+    }
+
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+
+    if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return false;
+    }
+
+    return finish(count < 0 ? errno : EIO);
+  }
+#else
+  return finish(ENOSYS);
+#endif
+}
+
+bool FileDescriptorTransfer::resumeCopy() noexcept {
+  while (true) {
+    ssize_t count = 0;
+
+    if (d_bufferBegin < d_bufferEnd) {
+      count = write(d_destination, d_buffer.get() + d_bufferBegin,
+                    d_bufferEnd - d_bufferBegin);
+
+      if (count > 0) {
+        d_bufferBegin += static_cast<std::size_t>(count);
+        d_transferred += static_cast<std::size_t>(count);
+        continue;
+      }
+    } else {
+      if (d_transferred == d_length) {
+        return finish(0);
+      }
+
+      d_bufferBegin = 0;
+      d_bufferEnd = 0;
+      count = read(d_source, d_buffer.get(),
+                   std::min(d_length - d_transferred, c_maxSpliceSize));
+
+      if (count > 0) {
+        d_bufferEnd = static_cast<std::size_t>(count);
+        continue;
+      }
+
+      if (count == 0) {
+        return finish(0);
+      }
+    }
+
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+
+    if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return false;
+    }
+
+    return finish(count < 0 ? errno : EIO);
+  }
+}
+
+bool FileDescriptorTransfer::allocateBuffer() noexcept {
+  d_buffer.reset(new (std::nothrow) char[c_maxSpliceSize]);
+  return d_buffer != nullptr;
+}
+
+bool FileDescriptorTransfer::finish(int error) noexcept {
+  d_error = error;
+  d_isDone = true;
+  d_promise.setResult(d_transferred);
+  return true;
+}
+
+} // namespace io
+} // namespace eco
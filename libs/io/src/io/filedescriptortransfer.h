@@ -0,0 +1,137 @@
+#ifndef ECO_IO_FILEDESCRIPTORTRANSFER
+#define ECO_IO_FILEDESCRIPTORTRANSFER
+
+#include <io/filedescriptor.h>
+#include <io/filedescriptoreventpoller.h>
+
+#include <async/future.h>
+
+#include <cstddef>
+#include <memory>
+
+#include <sys/types.h>
+
+namespace eco {
+namespace io {
+
+/**
+ * @brief Moves bytes between file descriptors inside of the kernel, without
+ * copying them to user space.
+ *
+ * A file is sent to a socket with `sendfile`, and a socket is proxied to
+ * another file descriptor with `splice` through a pipe. Where `splice` is not
+ * available, i.e. outside of Linux or for file descriptors the kernel cannot
+ * splice, the bytes are proxied through a user space buffer instead, which
+ * `copy` uses unconditionally. The file descriptors
+ * involved must be non-blocking. `resume` transfers as much as possible
+ * without blocking; when it returns `false` the transfer waits for the
+ * destination to become writable, or the source to become readable when
+ * proxying. With an edge-triggered registry, register the file descriptors
+ * with the transfer as user data and call `resume`, or `onEvent`, for each of
+ * their events.
+ *
+ * The future resolves with the number of transferred bytes once the transfer
+ * completed. Fewer bytes than requested mean that the source reached its end
+ * or that an error occurred, which `error` tells apart.
+ *
+ * This class is not thread-safe.
+ */
+class FileDescriptorTransfer : public FileDescriptorEventUserData {
+  // PRIVATE DATA
+  FileDescriptor d_source = -1;
+  FileDescriptor d_destination = -1;
+  off_t d_offset = 0;
+  bool d_isSendFile = false;
+  std::size_t d_length = 0;
+  std::size_t d_transferred = 0;
+  FileDescriptor d_pipe[2] = {-1, -1};
+  std::size_t d_pipeSizeInBytes = 0;
+  std::unique_ptr<char[]> d_buffer;
+  std::size_t d_bufferBegin = 0;
+  std::size_t d_bufferEnd = 0;
+  int d_error = 0;
+  bool d_isDone = false;
+  async::ResultPromise<std::size_t> d_promise;
+
+  // PRIVATE CREATORS
+  FileDescriptorTransfer() = default;
+
+public:
+  // STATIC CREATORS
+  /**
+   * @brief Create a transfer of the specified `length` bytes at the specified
+   * `offset` of the file `source` to the socket `destination`.
+   */
+  static std::unique_ptr<FileDescriptorTransfer>
+  sendFile(FileDescriptor source, off_t offset, std::size_t length,
+           FileDescriptor destination) noexcept;
+
+  /**
+   * @brief Create a transfer of up to the specified `length` bytes from the
+   * socket or pipe `source` to the specified `destination`. Return `nullptr`
+   * when neither a pipe nor a user space buffer could be created.
+   */
+  static std::unique_ptr<FileDescriptorTransfer>
+  splice(FileDescriptor source, FileDescriptor destination,
+         std::size_t length) noexcept;
+
+  /**
+   * @brief Create a transfer of up to the specified `length` bytes from the
+   * specified `source` to the specified `destination` through a user space
+   * buffer. Return `nullptr` when the buffer could not be allocated.
+   */
+  static std::unique_ptr<FileDescriptorTransfer>
+  copy(FileDescriptor source, FileDescriptor destination,
+       std::size_t length) noexcept;
+
+  // CREATORS
+  FileDescriptorTransfer(FileDescriptorTransfer const &) = delete;
+  FileDescriptorTransfer &operator=(FileDescriptorTransfer const &) = delete;
+
+  ~FileDescriptorTransfer();
+
+  // MANIPULATORS
+  /**
+   * @brief Transfer as many bytes as possible without blocking. Return `true`
+   * when the transfer is done and its future resolved.
+   */
+  bool resume() noexcept;
+
+  /**
+   * @brief Resume the transfer after the specified `eventType` was retrieved
+   * for one of its file descriptors.
+   */
+  void onEvent(FileDescriptorEventType eventType) noexcept override;
+
+  /**
+   * @brief Return a future that resolves with the number of transferred bytes
+   * when the transfer is done.
+   */
+  async::Future<std::size_t> future() noexcept { return d_promise.future(); }
+
+  // ACCESSORS
+  /**
+   * @brief Return the number of bytes transferred so far.
+   */
+  std::size_t transferred() const noexcept { return d_transferred; }
+
+  /**
+   * @brief Return the `errno` value that stopped the transfer, or `0`.
+   */
+  int error() const noexcept { return d_error; }
+
+  bool isDone() const noexcept { return d_isDone; }
+
+private:
+  // PRIVATE MANIPULATORS
+  bool resumeSendFile() noexcept;
+  bool resumeSplice() noexcept;
+  bool resumeCopy() noexcept;
+  bool allocateBuffer() noexcept;
+  bool finish(int error) noexcept;
+};
+
+} // namespace io
+} // namespace eco
+
+#endif // ECO_IO_FILEDESCRIPTORTRANSFER
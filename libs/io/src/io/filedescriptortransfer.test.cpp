@@ -0,0 +1,167 @@
+#include <io/filedescriptortransfer.h>
+#include <io/filedescriptoreventpoller.test.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <string>
+
+#include <unistd.h>
+
+using namespace eco::io;
+using namespace eco::io::test;
+
+namespace {
+
+/**
+ * Resume the specified `transfer` on each event of the specified `poller`
+ * while draining the specified `reader` into the specified `received`, until
+ * the transfer is done.
+ */
+void run(FileDescriptorEventPoller &poller, FileDescriptorTransfer &transfer,
+         int reader, std::string &received) {
+  transfer.resume();
+
+  while (true) {
+    char buffer[4096];
+    ssize_t count = 0;
+    while ((count = read(reader, buffer, sizeof(buffer))) > 0) {
+      received.append(buffer, count);
+    }
+
+    if (transfer.isDone()) {
+      break;
+    }
+
+    auto event = poller.waitForNextEvent(std::chrono::milliseconds(10));
+    if (event.userData == &transfer) {
+      transfer.resume();
+    }
+  }
+}
+
+} // namespace
+
+TEST(FileDescriptorTransfer, SendFile) {
+  // GIVEN
+  char path[] = "/tmp/filedescriptortransfer.test.XXXXXX";
+  int file = mkstemp(path);
+  std::string content;
+  for (int i = 0; i < 300000; ++i) {
+    content.push_back(static_cast<char>(i % 251));
+  }
+  ASSERT_EQ(content.size(), write(file, content.data(), content.size()));
+
+  auto registry = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  FileDescriptorEventPoller poller(registry);
+  auto sockets = createNonBlockingSocketPair();
+  auto sut =
+      FileDescriptorTransfer::sendFile(file, 1000, 200000, sockets.first);
+  ASSERT_NE(nullptr, sut);
+
+  std::size_t result = 0;
+  sut->future().setResultCallback([&](std::size_t value) { result = value; });
+
+  FileDescriptorEventOptions options;
+  options.interest = FileDescriptorInterest::Write;
+  registry->addOrReplace(sockets.first, sut.get(), options);
+
+  // WHEN
+  std::string received;
+  run(poller, *sut, sockets.second, received);
+
+  // THEN
+  EXPECT_EQ(200000, result);
+  EXPECT_EQ(0, sut->error());
+  EXPECT_TRUE(content.substr(1000, 200000) == received);
+
+  close(file);
+  unlink(path);
+  close(sockets.first);
+  close(sockets.second);
+}
+
+TEST(FileDescriptorTransfer, Splice) {
+  // GIVEN
+  auto registry = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  FileDescriptorEventPoller poller(registry);
+  auto source = createNonBlockingSocketPair();
+  auto destination = createNonBlockingSocketPair();
+  auto sut = FileDescriptorTransfer::splice(source.first, destination.first,
+                                            1000000);
+  ASSERT_NE(nullptr, sut);
+
+  std::size_t result = 0;
+  sut->future().setResultCallback([&](std::size_t value) { result = value; });
+
+  FileDescriptorEventOptions options;
+  options.interest = FileDescriptorInterest::Read;
+  registry->addOrReplace(source.first, sut.get(), options);
+  options.interest = FileDescriptorInterest::Write;
+  registry->addOrReplace(destination.first, sut.get(), options);
+
+  // WHEN the source sends less than requested and closes.
+  std::string content(50000, 'x');
+  ASSERT_EQ(content.size(),
+            write(source.second, content.data(), content.size()));
+  shutdown(source.second, SHUT_WR);
+
+  std::string received;
+  run(poller, *sut, destination.second, received);
+
+  // THEN
+  EXPECT_EQ(50000, result);
+  EXPECT_EQ(0, sut->error());
+  EXPECT_TRUE(content == received);
+
+  close(source.first);
+  close(source.second);
+  close(destination.first);
+  close(destination.second);
+}
+
+TEST(FileDescriptorTransfer, Copy) {
+  // GIVEN
+  auto registry = std::shared_ptr<FileDescriptorEventRegistry>(
+      FileDescriptorEventRegistry::createSystemDefault());
+  FileDescriptorEventPoller poller(registry);
+  auto source = createNonBlockingSocketPair();
+  auto destination = createNonBlockingSocketPair();
+  auto sut =
+      FileDescriptorTransfer::copy(source.first, destination.first, 50000);
+  ASSERT_NE(nullptr, sut);
+
+  std::size_t result = 0;
+  sut->future().setResultCallback([&](std::size_t value) { result = value; });
+
+  FileDescriptorEventOptions options;
+  options.interest = FileDescriptorInterest::Read;
+  registry->addOrReplace(source.first, sut.get(), options);
+  options.interest = FileDescriptorInterest::Write;
+  registry->addOrReplace(destination.first, sut.get(), options);
+
+  // WHEN the source sends more than requested.
+  std::string content;
+  for (int i = 0; i < 30000; ++i) {
+    content.push_back(static_cast<char>(i % 251));
+  }
+  ASSERT_EQ(content.size(),
+            write(source.second, content.data(), content.size()));
+  ASSERT_EQ(content.size(),
+            write(source.second, content.data(), content.size()));
+
+  std::string received;
+  run(poller, *sut, destination.second, received);
+
+  // THEN
+  EXPECT_EQ(50000, result);
+  EXPECT_EQ(0, sut->error());
+  EXPECT_TRUE((content + content).substr(0, 50000) == received);
+
+  close(source.first);
+  close(source.second);
+  close(destination.first);
+  close(destination.second);
+}
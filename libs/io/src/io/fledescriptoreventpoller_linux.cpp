@@ -1,12 +1,21 @@
 #if __LINUX__ || __UNIX__ || __linux__
 
+#include <io/epollevents.h>
 #include <io/filedescriptoreventpoller.h>
+#include <io/filedescriptorslottable.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <limits>
 #include <memory>
-#include <shared_mutex>
-#include <unordered_map>
+#include <vector>
 
+#include <linux/time_types.h>
 #include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
 #include <unistd.h>
 
 namespace eco {
@@ -16,175 +25,469 @@ namespace {
 
 const size_t c_eventBufferSize = 256;
 
-class EventDataManager {
-public:
-  // PUBLIC TYPES
-  using EventDataKey = uint64_t;
-  using EventData =
-      std::pair<FileDescriptor, std::weak_ptr<FileDescriptorEventUserData>>;
+/**
+ * Cleared when the running kernel turns out not to support `epoll_pwait2`.
+ */
+std::atomic<bool> s_hasEPollPWait2{true};
 
-private:
-  std::unordered_map<EventDataKey, std::unique_ptr<EventData>> d_eventData;
-  std::unordered_map<FileDescriptor, EventDataKey> d_fileDescriptorKeys;
-  EventDataKey d_eventDataKeyCounter = 0;
-  std::shared_mutex d_mutex;
+class EPollFileDescriptorEventPollerBuffer
+    : public FileDescriptorEventPollerBuffer {
+  int d_epoll = -1;
+  FileDescriptorSlotTable &d_slots;
+  std::array<struct epoll_event, c_eventBufferSize> d_events;
+  size_t d_bufferSize = 0;
+  int d_timerEpoll = -1;
+  int d_timer = -1;
 
 public:
-  std::pair<EventDataKey, bool>
-  addOrReplace(FileDescriptor fileDescriptor,
-               std::weak_ptr<FileDescriptorEventUserData> userData) {
-    std::pair<EventDataKey, bool> result(0, true);
+  EPollFileDescriptorEventPollerBuffer(int epoll,
+                                       FileDescriptorSlotTable &slots)
+      : d_epoll(epoll), d_slots(slots) {}
 
-    auto data = std::make_unique<EventData>(fileDescriptor, userData);
+  ~EPollFileDescriptorEventPollerBuffer() { closeTimer(); }
 
-    auto lock = std::unique_lock<std::shared_mutex>(d_mutex);
-    result.first = ++d_eventDataKeyCounter;
-    d_eventData[result.first] = std::move(data);
+  virtual FileDescriptorEvent
+  waitForNextEvent(std::chrono::nanoseconds const &timeout) noexcept override {
+    FileDescriptorEvent result{nullptr, -1,
+                               FileDescriptorEventType::Error};
 
-    auto iter = d_fileDescriptorKeys.find(fileDescriptor);
-    if (iter != d_fileDescriptorKeys.end()) {
-      d_eventData.erase(iter->second);
-      result.second = false;
+    // The buffer might only contain stale events, in which case we still need
+    // to wait for the next event.
+    if (popEvent(result)) {
+      return result;
+    }
+
+    if (!pollEvents(timeout)) {
+      return result;
+    }
+
+    if (!popEvent(result)) {
+      result.eventType = FileDescriptorEventType::Timeout;
     }
 
-    d_fileDescriptorKeys[fileDescriptor] = result.first;
     return result;
   }
 
-  EventData get(EventDataKey key) {
-    auto lock = std::shared_lock(d_mutex);
-    auto iter = d_eventData.find(key);
-    return iter == d_eventData.end()
-               ? EventData(-1, std::weak_ptr<FileDescriptorEventUserData>())
-               : *(iter->second);
+  int waitForEvents(FileDescriptorEvent *events, std::size_t maxEventCount,
+                    std::chrono::nanoseconds const &timeout) noexcept override {
+    if (maxEventCount == 0) {
+      return 0;
+    }
+
+    size_t count = popEvents(events, maxEventCount);
+
+    if (count == 0) {
+      if (!pollEvents(timeout)) {
+        return -1;
+      }
+
+      count = popEvents(events, maxEventCount);
+    }
+
+    return static_cast<int>(count);
+  }
+
+private:
+  /**
+   * Store the next buffered event that is not stale in the specified `result`
+   * and consume it. Return `false` when only stale events or no events are
+   * buffered.
+   */
+  bool popEvent(FileDescriptorEvent &result) noexcept {
+    while (d_bufferSize != 0) {
+      auto &event = d_events[--d_bufferSize];
+
+      if (!d_slots.get(event.data.u64, result.userData)) {
+        // The file descriptor was removed or replaced after this event was
+        // retrieved.
+        continue;
+      }
+
+      result.fileDescriptor =
+          FileDescriptorSlotTable::fileDescriptorOf(event.data.u64);
+      result.eventType = ePollEventsToEventType(event.events);
+
+      if (result.eventType == FileDescriptorEventType::Timeout) {
+        continue;
+      }
+
+      return true;
+    }
+
+    return false;
   }
 
-  bool remove(FileDescriptor FileDescriptor) {
-    auto lock = std::unique_lock<std::shared_mutex>(d_mutex);
-    auto iter = d_fileDescriptorKeys.find(FileDescriptor);
-    if (iter == d_fileDescriptorKeys.end()) {
+  size_t popEvents(FileDescriptorEvent *events, size_t maxEventCount) noexcept {
+    size_t count = 0;
+    while (count < maxEventCount && popEvent(events[count])) {
+      ++count;
+    }
+
+    return count;
+  }
+
+  bool pollEvents(std::chrono::nanoseconds const &timeout) noexcept {
+    int count = wait(timeout);
+
+    if (count < 0) {
       return false;
     }
 
-    d_eventData.erase(iter->second);
-    d_fileDescriptorKeys.erase(iter);
+    d_bufferSize = count;
 
     return true;
   }
-};
 
-class EPollFileDescriptorEventPollerBuffer
-    : public FileDescriptorEventPollerBuffer {
-  int d_epoll = -1;
-  EventDataManager &d_eventDataManager;
-  std::array<struct epoll_event, c_eventBufferSize> d_events;
-  size_t d_bufferSize = 0;
+  /**
+   * Wait for the specified `timeout` for events using the most precise
+   * mechanism that is available and return the result of `epoll_wait`.
+   */
+  int wait(std::chrono::nanoseconds const &timeout) noexcept {
+    if (timeout.count() < 0) {
+      return epoll_wait(d_epoll, d_events.data(), c_eventBufferSize, -1);
+    }
 
-public:
-  EPollFileDescriptorEventPollerBuffer(int epoll,
-                                       EventDataManager &eventDataManager)
-      : d_epoll(epoll), d_eventDataManager(eventDataManager) {}
+    auto milliseconds =
+        std::chrono::duration_cast<std::chrono::milliseconds>(timeout);
+    if (milliseconds == timeout &&
+        milliseconds.count() <= std::numeric_limits<int>::max()) {
+      return epoll_wait(d_epoll, d_events.data(), c_eventBufferSize,
+                        static_cast<int>(milliseconds.count()));
+    }
 
-  virtual FileDescriptorEvent
-  waitForNextEvent(std::chrono::milliseconds const &timeout) noexcept override {
-    FileDescriptorEvent result{std::weak_ptr<FileDescriptorEventUserData>(), -1,
-                               FileDescriptorEventType::Error};
+#ifdef __NR_epoll_pwait2
+    if (s_hasEPollPWait2.load(std::memory_order_relaxed)) {
+      auto timeoutTimeSpec = toKernelTimeSpec(timeout);
+      int count = static_cast<int>(
+          syscall(__NR_epoll_pwait2, d_epoll, d_events.data(),
+                  c_eventBufferSize, &timeoutTimeSpec, nullptr, 0));
 
-    if (d_bufferSize == 0) {
-      if (!pollEvents(timeout)) {
-        return result;
+      if (count >= 0 || errno != ENOSYS) {
+        return count;
       }
+
+      s_hasEPollPWait2.store(false, std::memory_order_relaxed);
     }
+#endif
 
-    if (d_bufferSize == 0) {
-      result.eventType = FileDescriptorEventType::Timeout;
-      return result;
+    return waitWithTimer(timeout);
+  }
+
+  /**
+   * Wait for the specified `timeout` for events on kernels without
+   * `epoll_pwait2`, by waiting on a private epoll set that contains both the
+   * shared epoll set and a timer.
+   */
+  int waitWithTimer(std::chrono::nanoseconds const &timeout) noexcept {
+    if (timeout.count() == 0) {
+      return epoll_wait(d_epoll, d_events.data(), c_eventBufferSize, 0);
     }
 
-    auto &event = d_events[d_bufferSize - 1];
+    if (d_timerEpoll == -1 && !createTimer()) {
+      // Round up, so we never wake up before the timeout.
+      auto milliseconds =
+          std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+      return epoll_wait(
+          d_epoll, d_events.data(), c_eventBufferSize,
+          static_cast<int>(std::min<std::chrono::milliseconds::rep>(
+              milliseconds, std::numeric_limits<int>::max())));
+    }
 
-    auto eventData = d_eventDataManager.get(event.data.u64);
+    struct itimerspec timerSpec {};
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    timerSpec.it_value.tv_sec = seconds.count();
+    timerSpec.it_value.tv_nsec = (timeout - seconds).count();
+    timerfd_settime(d_timer, 0, &timerSpec, nullptr);
+
+    int count = 0;
+    while (true) {
+      struct epoll_event events[2];
+      int timerCount = epoll_wait(d_timerEpoll, events, 2, -1);
+
+      if (timerCount < 0) {
+        count = -1;
+        break;
+      }
 
-    result.fileDescriptor = eventData.first;
-    result.userData = eventData.second;
+      bool expired = false;
+      for (int i = 0; i < timerCount; ++i) {
+        expired = expired || events[i].data.fd == d_timer;
+      }
 
-    if ((event.events & EPOLLIN) != 0) {
-      result.eventType = FileDescriptorEventType::Readable;
-      event.events &= ~EPOLLIN;
-    } else if ((event.events & EPOLLOUT) != 0) {
-      result.eventType = FileDescriptorEventType::Writable;
-      event.events &= ~EPOLLOUT;
+      // Another poller of the shared epoll set might have retrieved the
+      // events already, in which case we keep waiting.
+      count = epoll_wait(d_epoll, d_events.data(), c_eventBufferSize, 0);
+      if (count != 0 || expired) {
+        break;
+      }
     }
 
-    if ((event.events & (EPOLLIN | EPOLLOUT)) == 0) {
-      --d_bufferSize;
-    }
+    timerSpec = {};
+    timerfd_settime(d_timer, 0, &timerSpec, nullptr);
+    uint64_t expirations = 0;
+    while (read(d_timer, &expirations, sizeof(expirations)) > 0)
+      ;
 
-    return result;
+    return count;
   }
 
-private:
-  bool pollEvents(std::chrono::milliseconds timeout) {
-    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
-    timeout -= seconds;
-    auto nanoseconds =
-        std::chrono::duration_cast<std::chrono::nanoseconds>(timeout);
-    auto timeoutTimeSpec = timespec{seconds.count(), nanoseconds.count()};
+  bool createTimer() noexcept {
+    d_timerEpoll = epoll_create1(EPOLL_CLOEXEC);
+    d_timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
 
-    int count = epoll_wait(d_epoll, d_events.data(), c_eventBufferSize,
-                           timeout.count());
+    struct epoll_event epollEvent {
+      EPOLLIN, { .fd = d_epoll }
+    };
+    struct epoll_event timerEvent {
+      EPOLLIN, { .fd = d_timer }
+    };
 
-    if (count < 0) {
+    if (d_timerEpoll == -1 || d_timer == -1 ||
+        epoll_ctl(d_timerEpoll, EPOLL_CTL_ADD, d_epoll, &epollEvent) == -1 ||
+        epoll_ctl(d_timerEpoll, EPOLL_CTL_ADD, d_timer, &timerEvent) == -1) {
+      closeTimer();
       return false;
     }
 
-    d_bufferSize = count;
-
     return true;
   }
+
+  void closeTimer() noexcept {
+    if (d_timerEpoll != -1) {
+      close(d_timerEpoll);
+    }
+
+    if (d_timer != -1) {
+      close(d_timer);
+    }
+
+    d_timerEpoll = d_timer = -1;
+  }
+
+  static struct __kernel_timespec
+  toKernelTimeSpec(std::chrono::nanoseconds const &timeout) noexcept {
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    return {seconds.count(), (timeout - seconds).count()};
+  }
 };
 
+/**
+ * Registry that distributes file descriptors over one or more epoll sets,
+ * called shards. A file descriptor is always registered in the same shard and
+ * every poller polls a single shard.
+ */
 class EPollFileDescriptorEventRegistry : public FileDescriptorEventRegistry {
   // DATA
-  int d_epoll = -1;
-  EventDataManager d_eventDataManager;
+  std::vector<int> d_epolls;
+  std::atomic<size_t> d_nextPollerShard{0};
+  FileDescriptorSlotTable d_slots;
 
 public:
-  EPollFileDescriptorEventRegistry() { d_epoll = epoll_create1(EPOLL_CLOEXEC); }
+  EPollFileDescriptorEventRegistry(size_t shardCount = 1)
+      : d_epolls(std::max<size_t>(shardCount, 1), -1) {
+    for (auto &epoll : d_epolls) {
+      epoll = epoll_create1(EPOLL_CLOEXEC);
+    }
+  }
+
+  virtual ~EPollFileDescriptorEventRegistry() {
+    for (auto epoll : d_epolls) {
+      close(epoll);
+    }
+  }
+
+  bool addOrReplace(FileDescriptor fileDescriptor,
+                    FileDescriptorEventUserData *userData = nullptr,
+                    FileDescriptorEventOptions const &options =
+                        FileDescriptorEventOptions()) noexcept override {
+    uint32_t flags = 0;
+    if (!optionsToEPollEvents(options, flags)) {
+      return false;
+    }
+
+    auto lock = d_slots.lockForWriting(fileDescriptor);
 
-  virtual ~EPollFileDescriptorEventRegistry() { close(d_epoll); }
+    FileDescriptorSlotTable::Key oldKey = 0;
+    uint32_t oldFlags = 0;
+    FileDescriptorEventUserData *oldUserData = nullptr;
+    if (d_slots.registration(fileDescriptor, oldKey, oldFlags)) {
+      d_slots.get(oldKey, oldUserData);
+    }
+
+    FileDescriptorSlotTable::Key key = 0;
+    bool wasRegistered = false;
+    if (!d_slots.addOrReplace(fileDescriptor, userData, flags, key,
+                              wasRegistered)) {
+      return false;
+    }
+
+    bool isOldEntryKept = false;
+    if (!control(fileDescriptor, wasRegistered, oldFlags, oldKey, flags, key,
+                 isOldEntryKept)) {
+      if (isOldEntryKept) {
+        d_slots.restore(fileDescriptor, oldKey, oldUserData, oldFlags);
+      } else {
+        discard(fileDescriptor);
+      }
 
-  bool addOrReplace(
-      FileDescriptor fileDescriptor,
-      std::weak_ptr<FileDescriptorEventUserData> userData =
-          std::weak_ptr<FileDescriptorEventUserData>()) noexcept override {
-    auto eventDataResult =
-        d_eventDataManager.addOrReplace(fileDescriptor, userData);
+      return false;
+    }
+
+    if (options.busyPoll.count() > 0) {
+      applyBusyPoll(fileDescriptor, options);
+    }
+
+    return true;
+  }
+
+  bool modify(FileDescriptor fileDescriptor,
+              FileDescriptorEventOptions const &options) noexcept override {
+    uint32_t flags = 0;
+    if (!optionsToEPollEvents(options, flags)) {
+      return false;
+    }
+
+    auto lock = d_slots.lockForWriting(fileDescriptor);
+
+    FileDescriptorSlotTable::Key key = 0;
+    uint32_t oldFlags = 0;
+    if (!d_slots.registration(fileDescriptor, key, oldFlags)) {
+      return false;
+    }
+
+    bool isOldEntryKept = false;
+    if (!control(fileDescriptor, true, oldFlags, key, flags, key,
+                 isOldEntryKept)) {
+      if (!isOldEntryKept) {
+        discard(fileDescriptor);
+      }
+
+      return false;
+    }
+
+    if (options.busyPoll.count() > 0) {
+      applyBusyPoll(fileDescriptor, options);
+    }
+
+    d_slots.setFlags(fileDescriptor, flags);
+    return true;
+  }
+
+  bool rearm(FileDescriptor fileDescriptor) noexcept override {
+    auto lock = d_slots.lockForWriting(fileDescriptor);
+
+    FileDescriptorSlotTable::Key key = 0;
+    uint32_t flags = 0;
+    if (!d_slots.registration(fileDescriptor, key, flags)) {
+      return false;
+    }
 
     struct epoll_event event {
-      EPOLLIN | EPOLLOUT | EPOLLET, { .u64 = eventDataResult.first }
+      flags, { .u64 = key }
     };
 
-    if (eventDataResult.second) {
-      return epoll_ctl(d_epoll, EPOLL_CTL_ADD, fileDescriptor, &event) != -1;
-    } else {
-      return epoll_ctl(d_epoll, EPOLL_CTL_MOD, fileDescriptor, &event) != -1;
-    }
+    return epoll_ctl(shard(fileDescriptor), EPOLL_CTL_MOD, fileDescriptor,
+                     &event) != -1;
   }
 
   bool remove(FileDescriptor fileDescriptor) noexcept override {
-    d_eventDataManager.remove(fileDescriptor);
-    return epoll_ctl(d_epoll, EPOLL_CTL_DEL, fileDescriptor, nullptr) != -1;
+    auto lock = d_slots.lockForWriting(fileDescriptor);
+
+    if (!d_slots.remove(fileDescriptor)) {
+      return false;
+    }
+
+    return epoll_ctl(shard(fileDescriptor), EPOLL_CTL_DEL, fileDescriptor,
+                     nullptr) != -1;
   }
 
 protected:
   std::unique_ptr<FileDescriptorEventPollerBuffer>
   createPollerBuffer() noexcept override {
+    auto index = d_nextPollerShard.fetch_add(1) % d_epolls.size();
     return std::make_unique<EPollFileDescriptorEventPollerBuffer>(
-        d_epoll, d_eventDataManager);
+        d_epolls[index], d_slots);
   }
 
 private:
+  /**
+   * Register the specified `fileDescriptor` with the specified `flags` and
+   * `key` in the epoll set, replacing the registration with the specified
+   * `oldFlags` and `oldKey` if `wasRegistered` is `true`. Return `true` on
+   * success. On failure set the specified `isOldEntryKept` to whether the old
+   * registration is still in the epoll set.
+   */
+  bool control(FileDescriptor fileDescriptor, bool wasRegistered,
+               uint32_t oldFlags, FileDescriptorSlotTable::Key oldKey,
+               uint32_t flags, FileDescriptorSlotTable::Key key,
+               bool &isOldEntryKept) noexcept {
+    struct epoll_event event {
+      flags, { .u64 = key }
+    };
+
+    isOldEntryKept = false;
+
+    if (wasRegistered) {
+      // Exclusive registrations can not be modified, only removed and added
+      // again.
+      int operation = ((oldFlags | flags) & EPOLLEXCLUSIVE) != 0
+                          ? EPOLL_CTL_DEL
+                          : EPOLL_CTL_MOD;
+
+      if (epoll_ctl(shard(fileDescriptor), operation, fileDescriptor,
+                    &event) != -1) {
+        if (operation == EPOLL_CTL_MOD) {
+          return true;
+        }
+
+        if (epoll_ctl(shard(fileDescriptor), EPOLL_CTL_ADD, fileDescriptor,
+                      &event) != -1) {
+          return true;
+        }
+
+        // The registration was removed above, so it is added again with its
+        // own key rather than leaving a slot without an entry in the epoll
+        // set behind.
+        struct epoll_event oldEvent {
+          oldFlags, { .u64 = oldKey }
+        };
+
+        isOldEntryKept = epoll_ctl(shard(fileDescriptor), EPOLL_CTL_ADD,
+                                   fileDescriptor, &oldEvent) != -1;
+        return false;
+      }
+
+      if (errno != ENOENT) {
+        isOldEntryKept = true;
+        return false;
+      }
+
+      // The file descriptor was closed without being removed, which removes
+      // it from the epoll set, and its number got reused.
+    }
+
+    return epoll_ctl(shard(fileDescriptor), EPOLL_CTL_ADD, fileDescriptor,
+                     &event) != -1;
+  }
+
+  /**
+   * Remove the specified `fileDescriptor`, whose registration could not be
+   * kept, from both the epoll set and the slots, so that they agree again.
+   */
+  void discard(FileDescriptor fileDescriptor) noexcept {
+    int error = errno;
+    epoll_ctl(shard(fileDescriptor), EPOLL_CTL_DEL, fileDescriptor, nullptr);
+    d_slots.remove(fileDescriptor);
+    errno = error;
+  }
+
+  /**
+   * Return the epoll set of the shard the specified `fileDescriptor` belongs
+   * to.
+   */
+  int shard(FileDescriptor fileDescriptor) const noexcept {
+    return d_epolls[static_cast<uint32_t>(fileDescriptor) % d_epolls.size()];
+  }
 };
 
 } // namespace
@@ -194,6 +497,11 @@ FileDescriptorEventRegistry::createSystemDefault() noexcept {
   return std::make_unique<EPollFileDescriptorEventRegistry>();
 }
 
+std::unique_ptr<FileDescriptorEventRegistry>
+FileDescriptorEventRegistry::createSharded(std::size_t shardCount) noexcept {
+  return std::make_unique<EPollFileDescriptorEventRegistry>(shardCount);
+}
+
 } // namespace io
 } // namespace eco
 
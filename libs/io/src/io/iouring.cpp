@@ -0,0 +1,223 @@
+#if __linux__
+
+#include <io/iouring.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace eco {
+namespace io {
+
+namespace {
+
+int ioUringSetup(unsigned entries, struct io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete,
+                 unsigned flags, void *arg, std::size_t argSize) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit,
+                                  minComplete, flags, arg, argSize));
+}
+
+int ioUringRegister(int fd, unsigned opcode, void *arg, unsigned argCount) {
+  return static_cast<int>(
+      syscall(__NR_io_uring_register, fd, opcode, arg, argCount));
+}
+
+template <typename T> T *offset(void *base, std::size_t offset) {
+  return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+}
+
+} // namespace
+
+// STATIC CREATORS
+
+std::unique_ptr<IoUring> IoUring::create(unsigned entries) noexcept {
+  struct io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CLAMP;
+
+  int fd = ioUringSetup(entries, &params);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  auto ring = std::unique_ptr<IoUring>(new IoUring());
+  ring->d_fd = fd;
+  ring->d_features = params.features;
+
+  ring->d_sqRingSize =
+      params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->d_cqRingSize =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+    ring->d_sqRingSize = ring->d_cqRingSize =
+        std::max(ring->d_sqRingSize, ring->d_cqRingSize);
+  }
+
+  ring->d_sqRing =
+      mmap(nullptr, ring->d_sqRingSize, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (ring->d_sqRing == MAP_FAILED) {
+    ring->d_sqRing = nullptr;
+    return nullptr;
+  }
+
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+    ring->d_cqRing = ring->d_sqRing;
+  } else {
+    ring->d_cqRing =
+        mmap(nullptr, ring->d_cqRingSize, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (ring->d_cqRing == MAP_FAILED) {
+      ring->d_cqRing = nullptr;
+      return nullptr;
+    }
+  }
+
+  ring->d_sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+  void *sqes = mmap(nullptr, ring->d_sqesSize, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    return nullptr;
+  }
+  ring->d_sqes = static_cast<struct io_uring_sqe *>(sqes);
+
+  ring->d_sqHead = offset<unsigned>(ring->d_sqRing, params.sq_off.head);
+  ring->d_sqTail = offset<unsigned>(ring->d_sqRing, params.sq_off.tail);
+  ring->d_sqArray = offset<unsigned>(ring->d_sqRing, params.sq_off.array);
+  ring->d_sqMask = *offset<unsigned>(ring->d_sqRing, params.sq_off.ring_mask);
+  ring->d_sqEntries = params.sq_entries;
+
+  ring->d_cqHead = offset<unsigned>(ring->d_cqRing, params.cq_off.head);
+  ring->d_cqTail = offset<unsigned>(ring->d_cqRing, params.cq_off.tail);
+  ring->d_cqMask = *offset<unsigned>(ring->d_cqRing, params.cq_off.ring_mask);
+  ring->d_cqes =
+      offset<struct io_uring_cqe>(ring->d_cqRing, params.cq_off.cqes);
+
+  return ring;
+}
+
+// CREATORS
+
+IoUring::~IoUring() {
+  if (d_sqes != nullptr) {
+    munmap(d_sqes, d_sqesSize);
+  }
+
+  if (d_cqRing != nullptr && d_cqRing != d_sqRing) {
+    munmap(d_cqRing, d_cqRingSize);
+  }
+
+  if (d_sqRing != nullptr) {
+    munmap(d_sqRing, d_sqRingSize);
+  }
+
+  close(d_fd);
+}
+
+// MANIPULATORS
+
+struct io_uring_sqe *IoUring::nextSubmission() noexcept {
+  unsigned head = __atomic_load_n(d_sqHead, __ATOMIC_ACQUIRE);
+  unsigned tail = *d_sqTail + d_sqPending;
+
+  if (tail - head >= d_sqEntries) {
+    return nullptr;
+  }
+
+  unsigned index = tail & d_sqMask;
+  auto sqe = &d_sqes[index];
+  std::memset(sqe, 0, sizeof(*sqe));
+  d_sqArray[index] = index;
+  ++d_sqPending;
+  return sqe;
+}
+
+int IoUring::submit() noexcept {
+  if (d_sqPending == 0) {
+    return 0;
+  }
+
+  unsigned count = d_sqPending;
+  __atomic_store_n(d_sqTail, *d_sqTail + count, __ATOMIC_RELEASE);
+  d_sqPending = 0;
+
+  int result = ioUringEnter(d_fd, count, 0, 0, nullptr, 0);
+  return result < 0 ? -errno : result;
+}
+
+int IoUring::waitForCompletion(
+    std::chrono::nanoseconds const &timeout) noexcept {
+  if (__atomic_load_n(d_cqTail, __ATOMIC_ACQUIRE) !=
+      __atomic_load_n(d_cqHead, __ATOMIC_RELAXED)) {
+    return 0;
+  }
+
+  auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+  struct __kernel_timespec timeoutTimeSpec {
+    seconds.count(), (timeout - seconds).count()
+  };
+
+  struct io_uring_getevents_arg arg;
+  std::memset(&arg, 0, sizeof(arg));
+  arg.sigmask_sz = _NSIG / 8;
+  if (timeout.count() >= 0) {
+    arg.ts = reinterpret_cast<uint64_t>(&timeoutTimeSpec);
+  }
+
+  int result =
+      ioUringEnter(d_fd, 0, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                   &arg, sizeof(arg));
+  return result < 0 ? -errno : 0;
+}
+
+unsigned IoUring::reapCompletions(struct io_uring_cqe *cqes,
+                                  unsigned maxCount) noexcept {
+  unsigned head = *d_cqHead;
+  unsigned tail = __atomic_load_n(d_cqTail, __ATOMIC_ACQUIRE);
+  unsigned count = 0;
+
+  while (head != tail && count < maxCount) {
+    cqes[count++] = d_cqes[head & d_cqMask];
+    ++head;
+  }
+
+  __atomic_store_n(d_cqHead, head, __ATOMIC_RELEASE);
+  return count;
+}
+
+bool IoUring::registerEventFileDescriptor(int eventFileDescriptor) noexcept {
+  return ioUringRegister(d_fd, IORING_REGISTER_EVENTFD, &eventFileDescriptor,
+                         1) == 0;
+}
+
+// ACCESSORS
+
+bool IoUring::isOpcodeSupported(unsigned opcode) const noexcept {
+  std::size_t size = sizeof(struct io_uring_probe) +
+                     256 * sizeof(struct io_uring_probe_op);
+  std::vector<char> storage(size, 0);
+  auto probe = reinterpret_cast<struct io_uring_probe *>(storage.data());
+
+  if (ioUringRegister(d_fd, IORING_REGISTER_PROBE, probe, 256) < 0) {
+    return false;
+  }
+
+  return opcode <= probe->last_op &&
+         (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) != 0;
+}
+
+} // namespace io
+} // namespace eco
+
+#endif
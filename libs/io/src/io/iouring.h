@@ -0,0 +1,120 @@
+#ifndef ECO_IO_IOURING
+#define ECO_IO_IOURING
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+#include <linux/io_uring.h>
+
+namespace eco {
+namespace io {
+
+/**
+ * @brief Minimal wrapper around a Linux io_uring instance.
+ *
+ * Owns the ring file descriptor and the memory mapped submission and
+ * completion queues. Only available on Linux.
+ *
+ * This class is not thread-safe: submissions must be serialized and
+ * completions must be reaped by one thread at a time. Waiting for completions
+ * can be done concurrently with submitting.
+ */
+class IoUring {
+  // PRIVATE DATA
+  int d_fd = -1;
+  unsigned d_features = 0;
+
+  void *d_sqRing = nullptr;
+  std::size_t d_sqRingSize = 0;
+  void *d_cqRing = nullptr;
+  std::size_t d_cqRingSize = 0;
+  struct io_uring_sqe *d_sqes = nullptr;
+  std::size_t d_sqesSize = 0;
+
+  unsigned *d_sqHead = nullptr;
+  unsigned *d_sqTail = nullptr;
+  unsigned *d_sqArray = nullptr;
+  unsigned d_sqMask = 0;
+  unsigned d_sqEntries = 0;
+  unsigned d_sqPending = 0;
+
+  unsigned *d_cqHead = nullptr;
+  unsigned *d_cqTail = nullptr;
+  unsigned d_cqMask = 0;
+  struct io_uring_cqe *d_cqes = nullptr;
+
+  // PRIVATE CREATORS
+  IoUring() = default;
+
+public:
+  // STATIC CREATORS
+  /**
+   * @brief Create a ring with at least the specified `entries` submission
+   * queue entries. Return `nullptr` when io_uring is not supported or the
+   * ring could not be created.
+   */
+  static std::unique_ptr<IoUring> create(unsigned entries) noexcept;
+
+  // CREATORS
+  IoUring(IoUring const &) = delete;
+  IoUring &operator=(IoUring const &) = delete;
+
+  ~IoUring();
+
+  // MANIPULATORS
+  /**
+   * @brief Return a zeroed submission queue entry that is submitted by the
+   * next call to `submit`, or `nullptr` when the submission queue is full.
+   */
+  struct io_uring_sqe *nextSubmission() noexcept;
+
+  /**
+   * @brief Submit all queued submission queue entries. Return the number of
+   * submitted entries or `-errno` on failure.
+   */
+  int submit() noexcept;
+
+  /**
+   * @brief Wait for at most the specified `timeout` for at least one
+   * completion to become available, or indefinitely when `timeout` is
+   * negative. Return `0` on success, `-ETIME` when the wait timed out or
+   * `-errno` on failure.
+   */
+  int waitForCompletion(std::chrono::nanoseconds const &timeout) noexcept;
+
+  /**
+   * @brief Copy up to the specified `maxCount` available completions into the
+   * specified `cqes` array and consume them. Return the number of copied
+   * completions.
+   */
+  unsigned reapCompletions(struct io_uring_cqe *cqes,
+                           unsigned maxCount) noexcept;
+
+  /**
+   * @brief Signal the specified `eventFileDescriptor` whenever a completion is
+   * posted. Return `true` on success.
+   */
+  bool registerEventFileDescriptor(int eventFileDescriptor) noexcept;
+
+  // ACCESSORS
+  /**
+   * @brief Return the file descriptor of the ring.
+   */
+  int fileDescriptor() const noexcept { return d_fd; }
+
+  /**
+   * @brief Return the `IORING_FEAT_*` flags reported by the kernel.
+   */
+  unsigned features() const noexcept { return d_features; }
+
+  /**
+   * @brief Return `true` when the kernel supports the specified `opcode`.
+   */
+  bool isOpcodeSupported(unsigned opcode) const noexcept;
+};
+
+} // namespace io
+} // namespace eco
+
+#endif // ECO_IO_IOURING
@@ -0,0 +1,219 @@
+#include <io/mappedfile.h>
+
+#include <algorithm>
+#include <new>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace eco {
+namespace io {
+
+namespace {
+
+/**
+ * @brief The header of a mapped window, which counts itself as mapped until
+ * its last reference is released.
+ */
+struct WindowHeader : BufferHeader {
+  std::shared_ptr<std::atomic<std::size_t>> d_mappedWindowCount;
+};
+
+void releaseMapping(BufferHeader *header) noexcept {
+  auto window = static_cast<WindowHeader *>(header);
+  munmap(window->d_data, window->d_sizeInBytes);
+  window->d_mappedWindowCount->fetch_sub(1, std::memory_order_release);
+  delete window;
+}
+
+bool adviceToMAdvise(MappedFileAdvice advice, int &mAdvise) noexcept {
+  switch (advice) {
+  case MappedFileAdvice::Normal:
+    mAdvise = MADV_NORMAL;
+    return true;
+  case MappedFileAdvice::Sequential:
+    mAdvise = MADV_SEQUENTIAL;
+    return true;
+  case MappedFileAdvice::Random:
+    mAdvise = MADV_RANDOM;
+    return true;
+  case MappedFileAdvice::WillNeed:
+    mAdvise = MADV_WILLNEED;
+    return true;
+  case MappedFileAdvice::HugePage:
+#ifdef MADV_HUGEPAGE
+    mAdvise = MADV_HUGEPAGE;
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  return false;
+}
+
+} // namespace
+
+// STATIC CREATORS
+
+std::unique_ptr<MappedFile>
+MappedFile::open(char const *path, MappedFileOptions const &options) noexcept {
+  int flags = options.mode == MappedFileMode::ReadOnly
+                  ? O_RDONLY | O_CLOEXEC
+                  : O_RDWR | O_CREAT | O_CLOEXEC;
+  int fileDescriptor = ::open(path, flags, 0644);
+
+  if (fileDescriptor == -1) {
+    return nullptr;
+  }
+
+  struct stat status;
+  if (fstat(fileDescriptor, &status) == -1 || !S_ISREG(status.st_mode)) {
+    close(fileDescriptor);
+    return nullptr;
+  }
+
+  auto file = std::unique_ptr<MappedFile>(new (std::nothrow) MappedFile());
+  auto mappedWindowCount = std::shared_ptr<std::atomic<std::size_t>>(
+      new (std::nothrow) std::atomic<std::size_t>(0));
+  if (file == nullptr || mappedWindowCount == nullptr) {
+    close(fileDescriptor);
+    return nullptr;
+  }
+
+  file->d_fileDescriptor = fileDescriptor;
+  file->d_options = options;
+  file->d_sizeInBytes = static_cast<std::size_t>(status.st_size);
+  file->d_pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  file->d_mappedWindowCount = std::move(mappedWindowCount);
+  return file;
+}
+
+// CREATORS
+
+MappedFile::~MappedFile() {
+  if (d_fileDescriptor != -1) {
+    close(d_fileDescriptor);
+  }
+}
+
+// MANIPULATORS
+
+BufferSlice MappedFile::view(std::size_t offset, std::size_t length) noexcept {
+  if (length == 0 || offset > d_sizeInBytes ||
+      length > d_sizeInBytes - offset) {
+    return BufferSlice();
+  }
+
+  bool isMapped = d_window && offset >= d_windowOffset &&
+                  offset + length <= d_windowOffset + d_window.sizeInBytes();
+
+  if (!isMapped && !mapWindow(offset, length)) {
+    return BufferSlice();
+  }
+
+  return BufferSlice{d_window, offset - d_windowOffset, length};
+}
+
+bool MappedFile::resize(std::size_t sizeInBytes) noexcept {
+  if (d_options.mode != MappedFileMode::ReadWrite) {
+    return false;
+  }
+
+  // The window might extend past the new end of the file, where accesses
+  // fault, so it is mapped again on the next view.
+  d_window.reset();
+  d_windowOffset = 0;
+
+  if (sizeInBytes < d_sizeInBytes &&
+      d_mappedWindowCount->load(std::memory_order_acquire) != 0) {
+    return false;
+  }
+
+  if (ftruncate(d_fileDescriptor, static_cast<off_t>(sizeInBytes)) == -1) {
+    return false;
+  }
+
+  d_sizeInBytes = sizeInBytes;
+  return true;
+}
+
+bool MappedFile::advise(MappedFileAdvice advice, std::size_t offset,
+                        std::size_t length) noexcept {
+  int mAdvise = 0;
+
+  if (!d_window || offset < d_windowOffset ||
+      offset - d_windowOffset > d_window.sizeInBytes() ||
+      !adviceToMAdvise(advice, mAdvise)) {
+    return false;
+  }
+
+  // The address passed to madvise must be page aligned.
+  auto begin = (offset - d_windowOffset) / d_pageSize * d_pageSize;
+  auto end = std::min(offset - d_windowOffset + length, d_window.sizeInBytes());
+  return madvise(d_window.data() + begin, end - begin, mAdvise) == 0;
+}
+
+bool MappedFile::sync() noexcept {
+  if (!d_window) {
+    return true;
+  }
+
+  return msync(d_window.data(), d_window.sizeInBytes(), MS_SYNC) == 0;
+}
+
+// PRIVATE MANIPULATORS
+
+bool MappedFile::mapWindow(std::size_t offset, std::size_t length) noexcept {
+  std::size_t windowOffset = 0;
+  std::size_t windowSize = d_sizeInBytes;
+
+  if (d_options.windowSizeInBytes != 0) {
+    windowOffset = offset / d_pageSize * d_pageSize;
+    windowSize = (d_options.windowSizeInBytes + d_pageSize - 1) / d_pageSize *
+                 d_pageSize;
+    windowSize = std::min(std::max(windowSize, offset - windowOffset + length),
+                          d_sizeInBytes - windowOffset);
+  }
+
+  int protection = d_options.mode == MappedFileMode::ReadOnly
+                       ? PROT_READ
+                       : PROT_READ | PROT_WRITE;
+  void *memory = mmap(nullptr, windowSize, protection, MAP_SHARED,
+                      d_fileDescriptor, static_cast<off_t>(windowOffset));
+
+  if (memory == MAP_FAILED) {
+    return false;
+  }
+
+  auto header = new (std::nothrow) WindowHeader();
+  if (header == nullptr) {
+    munmap(memory, windowSize);
+    return false;
+  }
+
+  header->d_mappedWindowCount = d_mappedWindowCount;
+  d_mappedWindowCount->fetch_add(1, std::memory_order_relaxed);
+
+  header->d_referenceCount.store(1, std::memory_order_relaxed);
+  header->d_sizeInBytes = windowSize;
+  header->d_data = static_cast<char *>(memory);
+  header->d_release = releaseMapping;
+
+  d_window = Buffer(header);
+  d_windowOffset = windowOffset;
+
+  int mAdvise = 0;
+  if (d_options.advice != MappedFileAdvice::Normal &&
+      adviceToMAdvise(d_options.advice, mAdvise)) {
+    madvise(memory, windowSize, mAdvise);
+  }
+
+  return true;
+}
+
+} // namespace io
+} // namespace eco
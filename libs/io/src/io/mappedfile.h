@@ -0,0 +1,167 @@
+#ifndef ECO_IO_MAPPEDFILE
+#define ECO_IO_MAPPEDFILE
+
+#include <io/bufferchain.h>
+#include <io/filedescriptor.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace eco {
+namespace io {
+
+/**
+ * @brief How a `MappedFile` accesses its file.
+ */
+enum class MappedFileMode {
+  /**
+   * @brief Map an existing file for reading.
+   */
+  ReadOnly,
+
+  /**
+   * @brief Map a file for reading and writing, creating it when it does not
+   * exist. Writes are shared with the file.
+   */
+  ReadWrite
+};
+
+/**
+ * @brief Access pattern hints for the kernel.
+ */
+enum class MappedFileAdvice {
+  Normal,
+  Sequential,
+  Random,
+
+  /**
+   * @brief Read the pages ahead, because they will be accessed soon.
+   */
+  WillNeed,
+
+  /**
+   * @brief Back the mapping with transparent huge pages where the file system
+   * supports it.
+   */
+  HugePage
+};
+
+/**
+ * @brief Configures a `MappedFile`.
+ */
+struct MappedFileOptions {
+  MappedFileMode mode = MappedFileMode::ReadOnly;
+
+  /**
+   * @brief The size of the part of the file that is mapped at a time, rounded
+   * up to whole pages. Zero maps the whole file. Mapping windows keeps the
+   * address space used by large files bounded.
+   */
+  std::size_t windowSizeInBytes = 0;
+
+  /**
+   * @brief The hint applied to each mapped window.
+   */
+  MappedFileAdvice advice = MappedFileAdvice::Normal;
+};
+
+/**
+ * @brief A file that is accessed through memory mappings instead of copies.
+ *
+ * Only the window of the file that contains the most recently requested view
+ * is mapped by the file itself. Views are `BufferSlice`s that keep the window
+ * they refer to mapped until they are released, so they stay valid when the
+ * file maps another window or is destroyed.
+ *
+ * This class is not thread-safe, but its views can be used on any thread.
+ */
+class MappedFile {
+  // PRIVATE DATA
+  FileDescriptor d_fileDescriptor = -1;
+  MappedFileOptions d_options;
+  std::size_t d_sizeInBytes = 0;
+  std::size_t d_pageSize = 0;
+  std::size_t d_windowOffset = 0;
+  Buffer d_window;
+
+  // The number of windows that are still mapped by the file or its views,
+  // shared with the windows because views can outlive the file.
+  std::shared_ptr<std::atomic<std::size_t>> d_mappedWindowCount;
+
+  // PRIVATE CREATORS
+  MappedFile() = default;
+
+public:
+  // STATIC CREATORS
+  /**
+   * @brief Open the file at the specified `path` according to the specified
+   * `options`. Return `nullptr` when the file can not be opened.
+   */
+  static std::unique_ptr<MappedFile>
+  open(char const *path,
+       MappedFileOptions const &options = MappedFileOptions()) noexcept;
+
+  // CREATORS
+  MappedFile(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile const &) = delete;
+
+  ~MappedFile();
+
+  // MANIPULATORS
+  /**
+   * @brief Return a view of the specified `length` bytes at the specified
+   * `offset` of the file, mapping the window that contains them if needed.
+   * Return an empty slice when the range exceeds the file or can not be
+   * mapped. Views of a read-only file must not be written to.
+   */
+  BufferSlice view(std::size_t offset, std::size_t length) noexcept;
+
+  /**
+   * @brief Change the size of a read-write file to the specified
+   * `sizeInBytes`, e.g. to extend it before streaming output into its views.
+   * Return `true` on success. Shrinking fails while views of the file are
+   * alive, because accessing their pages past the new end of the file would
+   * raise `SIGBUS`.
+   */
+  bool resize(std::size_t sizeInBytes) noexcept;
+
+  /**
+   * @brief Apply the specified `advice` to the specified `length` bytes at the
+   * specified `offset`, which must be inside of the currently mapped window.
+   * Return `true` on success.
+   */
+  bool advise(MappedFileAdvice advice, std::size_t offset,
+              std::size_t length) noexcept;
+
+  /**
+   * @brief Write the modified pages of the currently mapped window to the
+   * file and wait for completion. Return `true` on success.
+   */
+  bool sync() noexcept;
+
+  // ACCESSORS
+  std::size_t sizeInBytes() const noexcept { return d_sizeInBytes; }
+
+  /**
+   * @brief Return the offset in the file of the currently mapped window.
+   */
+  std::size_t windowOffset() const noexcept { return d_windowOffset; }
+
+  /**
+   * @brief Return the size of the currently mapped window, or `0` when none
+   * is mapped.
+   */
+  std::size_t windowSizeInBytes() const noexcept {
+    return d_window.sizeInBytes();
+  }
+
+private:
+  // PRIVATE MANIPULATORS
+  bool mapWindow(std::size_t offset, std::size_t length) noexcept;
+};
+
+} // namespace io
+} // namespace eco
+
+#endif // ECO_IO_MAPPEDFILE
@@ -0,0 +1,134 @@
+#include <io/mappedfile.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <unistd.h>
+
+using namespace eco::io;
+
+namespace {
+
+std::string createFile(std::size_t sizeInBytes) {
+  char path[] = "/tmp/mappedfile.test.XXXXXX";
+  int fileDescriptor = mkstemp(path);
+  EXPECT_NE(-1, fileDescriptor) << strerror(errno);
+
+  for (std::size_t i = 0; i < sizeInBytes; ++i) {
+    char byte = static_cast<char>(i % 251);
+    EXPECT_EQ(1, write(fileDescriptor, &byte, 1));
+  }
+
+  close(fileDescriptor);
+  return path;
+}
+
+} // namespace
+
+TEST(MappedFile, ReadOnly) {
+  // GIVEN
+  auto path = createFile(10000);
+  auto sut = MappedFile::open(path.c_str());
+  ASSERT_NE(nullptr, sut);
+
+  // WHEN
+  auto view = sut->view(5000, 100);
+
+  // THEN
+  EXPECT_EQ(10000, sut->sizeInBytes());
+  EXPECT_EQ(0, sut->windowOffset());
+  EXPECT_EQ(10000, sut->windowSizeInBytes());
+  ASSERT_EQ(100, view.length);
+  EXPECT_EQ(static_cast<char>(5000 % 251), view.data()[0]);
+  EXPECT_TRUE(sut->advise(MappedFileAdvice::WillNeed, 5000, 100));
+  EXPECT_FALSE(sut->view(9950, 100).buffer);
+  EXPECT_FALSE(sut->view(0, 0).buffer);
+
+  unlink(path.c_str());
+}
+
+TEST(MappedFile, Windows) {
+  // GIVEN
+  auto path = createFile(5 * 4096);
+  MappedFileOptions options;
+  options.windowSizeInBytes = 4096;
+  options.advice = MappedFileAdvice::Sequential;
+  auto sut = MappedFile::open(path.c_str(), options);
+  ASSERT_NE(nullptr, sut);
+
+  // WHEN
+  auto first = sut->view(100, 10);
+  auto second = sut->view(3 * 4096 + 4000, 200);
+
+  // THEN only the window around the view is mapped, and earlier views stay
+  // valid.
+  EXPECT_EQ(3 * 4096, sut->windowOffset());
+  EXPECT_EQ(4000 + 200, sut->windowSizeInBytes());
+  EXPECT_EQ(static_cast<char>(100 % 251), first.data()[0]);
+  EXPECT_EQ(static_cast<char>((3 * 4096 + 4000) % 251), second.data()[0]);
+  EXPECT_EQ(static_cast<char>((3 * 4096 + 4199) % 251), second.data()[199]);
+
+  sut.reset();
+  EXPECT_EQ(static_cast<char>(109 % 251), first.data()[9]);
+
+  unlink(path.c_str());
+}
+
+TEST(MappedFile, ReadWrite) {
+  // GIVEN
+  auto path = createFile(0);
+  MappedFileOptions options;
+  options.mode = MappedFileMode::ReadWrite;
+  auto sut = MappedFile::open(path.c_str(), options);
+  ASSERT_NE(nullptr, sut);
+
+  // WHEN
+  EXPECT_TRUE(sut->resize(8192));
+  auto view = sut->view(4096, 8);
+  std::memcpy(view.data(), "abcdefg", 8);
+  EXPECT_TRUE(sut->sync());
+
+  // THEN
+  auto file = MappedFile::open(path.c_str());
+  ASSERT_NE(nullptr, file);
+  EXPECT_EQ(8192, file->sizeInBytes());
+  EXPECT_STREQ("abcdefg", file->view(4096, 8).data());
+
+  unlink(path.c_str());
+}
+
+TEST(MappedFile, ShrinkWhileViewed) {
+  // GIVEN
+  auto path = createFile(8192);
+  MappedFileOptions options;
+  options.mode = MappedFileMode::ReadWrite;
+  auto sut = MappedFile::open(path.c_str(), options);
+  ASSERT_NE(nullptr, sut);
+  auto view = sut->view(4096, 8);
+  ASSERT_NE(nullptr, view.data());
+
+  // WHEN-THEN shrinking fails while a view is alive, and growing does not.
+  EXPECT_FALSE(sut->resize(100));
+  EXPECT_EQ(8192, sut->sizeInBytes());
+  EXPECT_EQ(static_cast<char>(4096 % 251), view.data()[0]);
+  EXPECT_TRUE(sut->resize(16384));
+
+  // WHEN-THEN shrinking succeeds once the views are released.
+  view = BufferSlice();
+  EXPECT_TRUE(sut->resize(100));
+  EXPECT_EQ(100, sut->sizeInBytes());
+
+  unlink(path.c_str());
+}
+
+TEST(MappedFile, OpenFailure) {
+  EXPECT_EQ(nullptr, MappedFile::open("/does/not/exist"));
+  EXPECT_EQ(nullptr, MappedFile::open("/tmp"));
+
+  auto path = createFile(10);
+  EXPECT_FALSE(MappedFile::open(path.c_str())->resize(100));
+  unlink(path.c_str());
+}
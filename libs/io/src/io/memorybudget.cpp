@@ -0,0 +1,47 @@
+#include <io/memorybudget.h>
+
+#include <utility>
+
+namespace eco {
+namespace io {
+
+// CREATORS
+
+MemoryBudget::MemoryBudget(std::size_t limitInBytes,
+                           std::shared_ptr<MemoryBudget> parent) noexcept
+    : d_limitInBytes(limitInBytes), d_parent(std::move(parent)) {}
+
+MemoryBudget::~MemoryBudget() {
+  if (d_parent != nullptr) {
+    d_parent->release(usedInBytes());
+  }
+}
+
+// MANIPULATORS
+
+void MemoryBudget::charge(std::size_t sizeInBytes) noexcept {
+  for (auto budget = this; budget != nullptr; budget = budget->d_parent.get()) {
+    budget->d_usedInBytes.fetch_add(sizeInBytes, std::memory_order_relaxed);
+  }
+}
+
+void MemoryBudget::release(std::size_t sizeInBytes) noexcept {
+  for (auto budget = this; budget != nullptr; budget = budget->d_parent.get()) {
+    budget->d_usedInBytes.fetch_sub(sizeInBytes, std::memory_order_relaxed);
+  }
+}
+
+// ACCESSORS
+
+bool MemoryBudget::isExhausted() const noexcept {
+  for (auto budget = this; budget != nullptr; budget = budget->d_parent.get()) {
+    if (budget->usedInBytes() >= budget->d_limitInBytes) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+} // namespace io
+} // namespace eco
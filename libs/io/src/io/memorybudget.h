@@ -0,0 +1,85 @@
+#ifndef ECO_IO_MEMORYBUDGET
+#define ECO_IO_MEMORYBUDGET
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+
+namespace eco {
+namespace io {
+
+/**
+ * @brief Accounts for the bytes that are buffered against a limit.
+ *
+ * Budgets form a hierarchy: bytes charged to a budget are charged to its
+ * parent as well, so each connection can have a budget of its own whose
+ * parent is the budget of the whole process. A budget is exhausted once it or
+ * any of its ancestors reached its limit. Charging never fails; it is up to
+ * the owner of the buffered bytes to stop producing more while the budget is
+ * exhausted, e.g. by not reading from a socket.
+ *
+ * Charging and releasing are thread-safe, so a parent can be shared by the
+ * budgets of several loops. A budget releases its remaining charge from its
+ * parent when it is destroyed.
+ */
+class MemoryBudget {
+  // PRIVATE DATA
+  std::size_t d_limitInBytes;
+  std::atomic<std::size_t> d_usedInBytes{0};
+  std::shared_ptr<MemoryBudget> d_parent;
+
+public:
+  // PUBLIC CONSTANTS
+  static constexpr std::size_t c_unlimited =
+      std::numeric_limits<std::size_t>::max();
+
+  // CREATORS
+  /**
+   * @brief Create a budget of the specified `limitInBytes` bytes whose charges
+   * are passed on to the specified `parent`, if any.
+   */
+  explicit MemoryBudget(
+      std::size_t limitInBytes = c_unlimited,
+      std::shared_ptr<MemoryBudget> parent = nullptr) noexcept;
+
+  MemoryBudget(MemoryBudget const &) = delete;
+  MemoryBudget &operator=(MemoryBudget const &) = delete;
+
+  ~MemoryBudget();
+
+  // MANIPULATORS
+  /**
+   * @brief Charge the specified `sizeInBytes` bytes to this budget and its
+   * ancestors.
+   */
+  void charge(std::size_t sizeInBytes) noexcept;
+
+  /**
+   * @brief Release the specified `sizeInBytes` bytes, which must have been
+   * charged before, from this budget and its ancestors.
+   */
+  void release(std::size_t sizeInBytes) noexcept;
+
+  // ACCESSORS
+  /**
+   * @brief Return `true` when this budget or any of its ancestors reached its
+   * limit.
+   */
+  bool isExhausted() const noexcept;
+
+  std::size_t usedInBytes() const noexcept {
+    return d_usedInBytes.load(std::memory_order_relaxed);
+  }
+
+  std::size_t limitInBytes() const noexcept { return d_limitInBytes; }
+
+  std::shared_ptr<MemoryBudget> const &parent() const noexcept {
+    return d_parent;
+  }
+};
+
+} // namespace io
+} // namespace eco
+
+#endif // ECO_IO_MEMORYBUDGET
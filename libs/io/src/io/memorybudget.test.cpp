@@ -0,0 +1,82 @@
+#include <io/memorybudget.h>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+using namespace eco::io;
+
+TEST(MemoryBudget, Hierarchy) {
+  // GIVEN
+  auto process = std::make_shared<MemoryBudget>(1000);
+  MemoryBudget first(600, process);
+  MemoryBudget second(MemoryBudget::c_unlimited, process);
+
+  // WHEN-THEN charges are passed on to the parent.
+  first.charge(500);
+  second.charge(300);
+  EXPECT_EQ(500, first.usedInBytes());
+  EXPECT_EQ(800, process->usedInBytes());
+  EXPECT_FALSE(first.isExhausted());
+  EXPECT_FALSE(second.isExhausted());
+
+  // WHEN-THEN a budget is exhausted by its own limit.
+  first.charge(100);
+  EXPECT_TRUE(first.isExhausted());
+  EXPECT_FALSE(second.isExhausted());
+
+  // WHEN-THEN all budgets are exhausted by the limit of their parent.
+  second.charge(300);
+  EXPECT_TRUE(process->isExhausted());
+  EXPECT_TRUE(second.isExhausted());
+
+  // WHEN-THEN releasing drains the parent as well.
+  first.release(200);
+  second.release(300);
+  EXPECT_FALSE(first.isExhausted());
+  EXPECT_FALSE(second.isExhausted());
+  EXPECT_EQ(700, process->usedInBytes());
+}
+
+TEST(MemoryBudget, DestructorReleasesFromParent) {
+  // GIVEN
+  auto process = std::make_shared<MemoryBudget>(100);
+
+  {
+    MemoryBudget connection(MemoryBudget::c_unlimited, process);
+    connection.charge(150);
+    EXPECT_TRUE(process->isExhausted());
+
+    // WHEN
+  }
+
+  // THEN
+  EXPECT_EQ(0, process->usedInBytes());
+  EXPECT_FALSE(process->isExhausted());
+}
+
+TEST(MemoryBudget, ConcurrentCharges) {
+  // GIVEN
+  auto process = std::make_shared<MemoryBudget>();
+  std::vector<std::thread> threads;
+
+  // WHEN
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([process] {
+      MemoryBudget connection(MemoryBudget::c_unlimited, process);
+
+      for (int j = 0; j < 10000; ++j) {
+        connection.charge(3);
+        connection.release(2);
+      }
+    });
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // THEN each destroyed budget released the rest of its charges.
+  EXPECT_EQ(0, process->usedInBytes());
+}
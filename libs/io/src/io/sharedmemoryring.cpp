@@ -0,0 +1,370 @@
+#include <io/sharedmemoryring.h>
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if __linux__
+#include <sys/eventfd.h>
+#endif
+
+namespace eco {
+namespace io {
+
+/**
+ * @brief The shared state in front of the records. The indices count bytes
+ * since the ring was created and are only ever increased, each by one side,
+ * on cache lines of their own.
+ */
+struct SharedMemoryRing::Header {
+  std::uint64_t d_magic = 0;
+  std::uint64_t d_capacityInBytes = 0;
+  alignas(64) std::atomic<std::uint64_t> d_writeIndex{0};
+  alignas(64) std::atomic<std::uint64_t> d_readIndex{0};
+};
+
+namespace {
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "The indices are shared between processes");
+
+const std::uint64_t c_magic = 0x45434f52494e4731; // "ECORING1"
+
+/**
+ * @brief The size of a record header that marks the rest of the ring up to its
+ * end as unused, because the next record did not fit there.
+ */
+const std::uint64_t c_paddingMarker = static_cast<std::uint64_t>(-1);
+
+const std::size_t c_minCapacityInBytes = 64;
+const std::size_t c_maxCapacityInBytes = std::size_t(1) << 40;
+
+std::uint64_t recordLength(std::size_t sizeInBytes) noexcept {
+  auto const alignment = SharedMemoryRing::c_recordHeaderSizeInBytes;
+  return (alignment + sizeInBytes + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+// STATIC CREATORS
+
+std::unique_ptr<SharedMemoryRing>
+SharedMemoryRing::create(std::size_t capacityInBytes) noexcept {
+#if __linux__
+  if (capacityInBytes > c_maxCapacityInBytes) {
+    return nullptr;
+  }
+
+  std::size_t capacity = c_minCapacityInBytes;
+  while (capacity < capacityInBytes) {
+    capacity *= 2;
+  }
+
+  auto ring =
+      std::unique_ptr<SharedMemoryRing>(new (std::nothrow) SharedMemoryRing());
+  if (ring == nullptr) {
+    return nullptr;
+  }
+
+  ring->d_memoryFileDescriptor =
+      memfd_create("eco-shared-memory-ring", MFD_CLOEXEC);
+  ring->d_doorbellFileDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  ring->d_capacityInBytes = capacity;
+
+  auto mappingSizeInBytes = sizeof(Header) + capacity;
+  if (ring->d_memoryFileDescriptor == -1 ||
+      ring->d_doorbellFileDescriptor == -1 ||
+      ftruncate(ring->d_memoryFileDescriptor,
+                static_cast<off_t>(mappingSizeInBytes)) == -1 ||
+      !ring->map(mappingSizeInBytes, true)) {
+    return nullptr;
+  }
+
+  return ring;
+#else
+  (void)capacityInBytes;
+  return nullptr;
+#endif
+}
+
+std::unique_ptr<SharedMemoryRing>
+SharedMemoryRing::attach(FileDescriptor memoryFileDescriptor,
+                         FileDescriptor doorbellFileDescriptor) noexcept {
+  auto ring =
+      std::unique_ptr<SharedMemoryRing>(new (std::nothrow) SharedMemoryRing());
+  if (ring == nullptr) {
+    close(memoryFileDescriptor);
+    close(doorbellFileDescriptor);
+    return nullptr;
+  }
+
+  ring->d_memoryFileDescriptor = memoryFileDescriptor;
+  ring->d_doorbellFileDescriptor = doorbellFileDescriptor;
+
+  struct stat status;
+  if (fstat(memoryFileDescriptor, &status) == -1 ||
+      static_cast<std::size_t>(status.st_size) < sizeof(Header) ||
+      !ring->map(static_cast<std::size_t>(status.st_size), false)) {
+    return nullptr;
+  }
+
+  return ring;
+}
+
+// CREATORS
+
+SharedMemoryRing::~SharedMemoryRing() {
+  if (d_registry != nullptr) {
+    d_registry->remove(d_doorbellFileDescriptor);
+  }
+
+  if (d_header != nullptr) {
+    munmap(d_header, d_mappingSizeInBytes);
+  }
+
+  if (d_memoryFileDescriptor != -1) {
+    close(d_memoryFileDescriptor);
+  }
+
+  if (d_doorbellFileDescriptor != -1) {
+    close(d_doorbellFileDescriptor);
+  }
+}
+
+// PRODUCER MANIPULATORS
+
+char *SharedMemoryRing::reserve(std::size_t sizeInBytes) noexcept {
+  if (d_reservedSizeInBytes != 0 || sizeInBytes > maxRecordSizeInBytes()) {
+    return nullptr;
+  }
+
+  auto length = recordLength(sizeInBytes);
+  auto writeIndex = d_header->d_writeIndex.load(std::memory_order_relaxed);
+  auto offset = writeIndex & (d_capacityInBytes - 1);
+
+  // A record is never split at the end of the ring, so the rest of the ring
+  // is skipped when the record does not fit there.
+  auto paddingSizeInBytes =
+      d_capacityInBytes - offset < length ? d_capacityInBytes - offset : 0;
+  auto endIndex = writeIndex + paddingSizeInBytes + length;
+
+  if (endIndex - d_cachedReadIndex > d_capacityInBytes) {
+    d_cachedReadIndex = d_header->d_readIndex.load(std::memory_order_acquire);
+
+    if (endIndex - d_cachedReadIndex > d_capacityInBytes) {
+      return nullptr;
+    }
+  }
+
+  if (paddingSizeInBytes != 0) {
+    std::memcpy(d_records + offset, &c_paddingMarker, sizeof(c_paddingMarker));
+    offset = 0;
+  }
+
+  std::uint64_t size = sizeInBytes;
+  std::memcpy(d_records + offset, &size, sizeof(size));
+  d_reservedIndex = writeIndex + paddingSizeInBytes;
+  d_reservedSizeInBytes = length;
+  return d_records + offset + c_recordHeaderSizeInBytes;
+}
+
+void SharedMemoryRing::commit() noexcept {
+  if (d_reservedSizeInBytes == 0) {
+    return;
+  }
+
+  auto previousWriteIndex =
+      d_header->d_writeIndex.load(std::memory_order_relaxed);
+  d_header->d_writeIndex.store(d_reservedIndex + d_reservedSizeInBytes,
+                               std::memory_order_release);
+  d_reservedSizeInBytes = 0;
+
+  // Pairs with the fence of the consumer between releasing its last record
+  // and checking for new ones: either the consumer sees this record, or this
+  // side sees that the ring was drained and rings the doorbell.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  d_cachedReadIndex = d_header->d_readIndex.load(std::memory_order_acquire);
+
+  if (d_cachedReadIndex != previousWriteIndex) {
+    return;
+  }
+
+#if __linux__
+  std::uint64_t value = 1;
+  // The counter only overflows when the consumer never clears it, and then
+  // it is readable anyway.
+  while (::write(d_doorbellFileDescriptor, &value, sizeof(value)) == -1 &&
+         errno == EINTR)
+    ;
+#endif
+
+  ++d_doorbellCount;
+}
+
+bool SharedMemoryRing::write(char const *data,
+                             std::size_t sizeInBytes) noexcept {
+  auto record = reserve(sizeInBytes);
+
+  if (record == nullptr) {
+    return false;
+  }
+
+  std::memcpy(record, data, sizeInBytes);
+  commit();
+  return true;
+}
+
+// CONSUMER MANIPULATORS
+
+bool SharedMemoryRing::registerDoorbell(
+    std::shared_ptr<FileDescriptorEventRegistry> registry,
+    DoorbellCallback callback) noexcept {
+  FileDescriptorEventOptions options;
+  options.interest = FileDescriptorInterest::Read;
+
+  if (!registry->addOrReplace(d_doorbellFileDescriptor, this, options)) {
+    return false;
+  }
+
+  d_registry = std::move(registry);
+  d_doorbellCallback = std::move(callback);
+  return true;
+}
+
+void SharedMemoryRing::clearDoorbell() noexcept {
+  std::uint64_t value = 0;
+
+  while (::read(d_doorbellFileDescriptor, &value, sizeof(value)) == -1 &&
+         errno == EINTR)
+    ;
+}
+
+void SharedMemoryRing::onEvent(FileDescriptorEventType) noexcept {
+  clearDoorbell();
+
+  if (d_doorbellCallback) {
+    d_doorbellCallback(*this);
+  }
+}
+
+char const *SharedMemoryRing::peek(std::size_t &sizeInBytes) noexcept {
+  if (d_hasError) {
+    return nullptr;
+  }
+
+  auto readIndex = d_header->d_readIndex.load(std::memory_order_relaxed);
+
+  while (true) {
+    if (readIndex == d_cachedWriteIndex) {
+      d_cachedWriteIndex =
+          d_header->d_writeIndex.load(std::memory_order_acquire);
+    }
+
+    if (readIndex == d_cachedWriteIndex) {
+      // Pairs with the fence of the producer in `commit`.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      d_cachedWriteIndex =
+          d_header->d_writeIndex.load(std::memory_order_acquire);
+
+      if (readIndex == d_cachedWriteIndex) {
+        d_peekedSizeInBytes = 0;
+        return nullptr;
+      }
+    }
+
+    // Everything in shared memory is written by the other process, so
+    // nothing of it is trusted to stay within the ring.
+    auto availableSizeInBytes = d_cachedWriteIndex - readIndex;
+    if (availableSizeInBytes > d_capacityInBytes) {
+      return fail();
+    }
+
+    auto offset = readIndex & (d_capacityInBytes - 1);
+    std::uint64_t size = 0;
+    std::memcpy(&size, d_records + offset, sizeof(size));
+
+    if (size == c_paddingMarker) {
+      if (d_capacityInBytes - offset >= availableSizeInBytes) {
+        return fail();
+      }
+
+      readIndex += d_capacityInBytes - offset;
+      d_header->d_readIndex.store(readIndex, std::memory_order_release);
+      continue;
+    }
+
+    if (size > maxRecordSizeInBytes()) {
+      return fail();
+    }
+
+    auto length = recordLength(static_cast<std::size_t>(size));
+    if (length > availableSizeInBytes || length > d_capacityInBytes - offset) {
+      return fail();
+    }
+
+    sizeInBytes = static_cast<std::size_t>(size);
+    d_peekedSizeInBytes = length;
+    return d_records + offset + c_recordHeaderSizeInBytes;
+  }
+}
+
+void SharedMemoryRing::pop() noexcept {
+  if (d_peekedSizeInBytes == 0) {
+    return;
+  }
+
+  auto readIndex = d_header->d_readIndex.load(std::memory_order_relaxed);
+  d_header->d_readIndex.store(readIndex + d_peekedSizeInBytes,
+                              std::memory_order_release);
+  d_peekedSizeInBytes = 0;
+}
+
+// PRIVATE MANIPULATORS
+
+char const *SharedMemoryRing::fail() noexcept {
+  d_hasError = true;
+  d_peekedSizeInBytes = 0;
+  return nullptr;
+}
+
+bool SharedMemoryRing::map(std::size_t mappingSizeInBytes,
+                           bool isNew) noexcept {
+  void *memory = mmap(nullptr, mappingSizeInBytes, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, d_memoryFileDescriptor, 0);
+
+  if (memory == MAP_FAILED) {
+    return false;
+  }
+
+  d_mappingSizeInBytes = mappingSizeInBytes;
+
+  if (isNew) {
+    d_header = new (memory) Header();
+    d_header->d_capacityInBytes = d_capacityInBytes;
+    d_header->d_magic = c_magic;
+  } else {
+    d_header = static_cast<Header *>(memory);
+    d_capacityInBytes = d_header->d_capacityInBytes;
+
+    if (d_header->d_magic != c_magic ||
+        d_capacityInBytes < c_minCapacityInBytes ||
+        (d_capacityInBytes & (d_capacityInBytes - 1)) != 0 ||
+        sizeof(Header) + d_capacityInBytes != mappingSizeInBytes) {
+      return false;
+    }
+
+    d_cachedReadIndex = d_header->d_readIndex.load(std::memory_order_acquire);
+    d_cachedWriteIndex =
+        d_header->d_writeIndex.load(std::memory_order_acquire);
+  }
+
+  d_records = static_cast<char *>(memory) + sizeof(Header);
+  return true;
+}
+
+} // namespace io
+} // namespace eco
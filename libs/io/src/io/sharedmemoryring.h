@@ -0,0 +1,232 @@
+#ifndef ECO_IO_SHAREDMEMORYRING
+#define ECO_IO_SHAREDMEMORYRING
+
+#include <io/filedescriptor.h>
+#include <io/filedescriptoreventpoller.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace eco {
+namespace io {
+
+/**
+ * @brief A single-producer single-consumer ring of variable-length records in
+ * shared memory, for passing messages between processes without copying them
+ * through the kernel.
+ *
+ * The ring lives in a memory file that both processes map, and comes with an
+ * event file descriptor as its doorbell. The producer rings the doorbell only
+ * when it commits a record to a ring that the consumer had drained, so a busy
+ * consumer is never woken by system calls and an idle one sleeps in its event
+ * loop. The creating process passes `memoryFileDescriptor` and
+ * `doorbellFileDescriptor` to the other process, e.g. over a local socket, and
+ * the other process attaches to them.
+ *
+ * The producer writes a record in place between `reserve` and `commit`. The
+ * consumer reads records in place with `peek` and releases them with `pop`;
+ * `consume` does both for all available records. After each doorbell event,
+ * call `clearDoorbell` and consume until the ring is empty, as no further
+ * event is signalled before that. A loop that hands events to `onEvent` does
+ * the former and calls the doorbell callback for the latter.
+ *
+ * Each side must be used by a single thread at a time. The record layout is
+ * shared between processes, so both must be built for the same architecture.
+ *
+ * The ring is Linux-only: its memory file comes from `memfd_create` and its
+ * doorbell is an `eventfd`, so `create` fails on other platforms.
+ */
+class SharedMemoryRing : public FileDescriptorEventUserData {
+public:
+  // PUBLIC TYPES
+  using DoorbellCallback = std::function<void(SharedMemoryRing &)>;
+
+private:
+  // PRIVATE TYPES
+  struct Header;
+
+  // PRIVATE DATA
+  FileDescriptor d_memoryFileDescriptor = -1;
+  FileDescriptor d_doorbellFileDescriptor = -1;
+  std::shared_ptr<FileDescriptorEventRegistry> d_registry;
+  DoorbellCallback d_doorbellCallback;
+  Header *d_header = nullptr;
+  char *d_records = nullptr;
+  std::size_t d_mappingSizeInBytes = 0;
+  std::uint64_t d_capacityInBytes = 0;
+
+  // Indices of the producer side, with the read index as last seen, so that
+  // the cache line of the consumer is only read when the ring looks full.
+  std::uint64_t d_reservedIndex = 0;
+  std::uint64_t d_reservedSizeInBytes = 0;
+  std::uint64_t d_cachedReadIndex = 0;
+
+  // Indices of the consumer side, with the write index as last seen.
+  std::uint64_t d_peekedSizeInBytes = 0;
+  std::uint64_t d_cachedWriteIndex = 0;
+
+  std::uint64_t d_doorbellCount = 0;
+  bool d_hasError = false;
+
+  // PRIVATE CREATORS
+  SharedMemoryRing() = default;
+
+public:
+  // PUBLIC CONSTANTS
+  /**
+   * @brief The bytes in front of each record, and the alignment of records.
+   */
+  static constexpr std::size_t c_recordHeaderSizeInBytes = 8;
+
+  // STATIC CREATORS
+  /**
+   * @brief Create a ring with room for the specified `capacityInBytes` bytes
+   * of records and their headers, rounded up to a power of two. Return
+   * `nullptr` on failure, and always outside of Linux.
+   */
+  static std::unique_ptr<SharedMemoryRing>
+  create(std::size_t capacityInBytes) noexcept;
+
+  /**
+   * @brief Attach to the ring of another process, given the specified
+   * `memoryFileDescriptor` and `doorbellFileDescriptor` it was created with,
+   * and take ownership of them. Return `nullptr` when they do not refer to a
+   * ring, in which case they are closed.
+   */
+  static std::unique_ptr<SharedMemoryRing>
+  attach(FileDescriptor memoryFileDescriptor,
+         FileDescriptor doorbellFileDescriptor) noexcept;
+
+  // CREATORS
+  SharedMemoryRing(SharedMemoryRing const &) = delete;
+  SharedMemoryRing &operator=(SharedMemoryRing const &) = delete;
+
+  ~SharedMemoryRing();
+
+  // PRODUCER MANIPULATORS
+  /**
+   * @brief Reserve a record of the specified `sizeInBytes` bytes and return
+   * where to write it. Return `nullptr` when the ring has no room for it, or
+   * another record is reserved. The record is not visible to the consumer
+   * before it was committed.
+   */
+  char *reserve(std::size_t sizeInBytes) noexcept;
+
+  /**
+   * @brief Publish the reserved record, and ring the doorbell when the
+   * consumer had drained the ring.
+   */
+  void commit() noexcept;
+
+  /**
+   * @brief Copy the specified `sizeInBytes` bytes of the specified `data` into
+   * a new record and commit it. Return `false` when the ring has no room.
+   */
+  bool write(char const *data, std::size_t sizeInBytes) noexcept;
+
+  // CONSUMER MANIPULATORS
+  /**
+   * @brief Register the doorbell in the specified `registry`, with this ring
+   * as user data, and call the specified `callback`, if any, from `onEvent`
+   * to consume the records. Return `true` on success.
+   */
+  bool registerDoorbell(std::shared_ptr<FileDescriptorEventRegistry> registry,
+                        DoorbellCallback callback = nullptr) noexcept;
+
+  /**
+   * @brief Consume the pending signals of the doorbell.
+   */
+  void clearDoorbell() noexcept;
+
+  /**
+   * @brief Clear the doorbell after the specified `eventType` was retrieved
+   * for it, and call the doorbell callback.
+   */
+  void onEvent(FileDescriptorEventType eventType) noexcept override;
+
+  /**
+   * @brief Return the oldest record and load its size into the specified
+   * `sizeInBytes`, or return `nullptr` when the ring is empty. The record
+   * stays valid until `pop` is called. Return `nullptr` as well when the
+   * indices or the record header in shared memory are out of bounds, which
+   * puts the ring into an error state in which it stays.
+   */
+  char const *peek(std::size_t &sizeInBytes) noexcept;
+
+  /**
+   * @brief Release the record returned by the last `peek`, which makes its
+   * room available to the producer.
+   */
+  void pop() noexcept;
+
+  /**
+   * @brief Call the specified `callback` with the data and size of each
+   * available record, up to the specified `maxCount` records, and release
+   * them. Return the number of consumed records.
+   */
+  template <typename CALLBACK>
+  std::size_t consume(CALLBACK &&callback,
+                      std::size_t maxCount = static_cast<std::size_t>(-1)) {
+    std::size_t count = 0;
+    std::size_t sizeInBytes = 0;
+
+    while (count < maxCount) {
+      char const *data = peek(sizeInBytes);
+
+      if (data == nullptr) {
+        break;
+      }
+
+      callback(data, sizeInBytes);
+      pop();
+      ++count;
+    }
+
+    return count;
+  }
+
+  // ACCESSORS
+  FileDescriptor memoryFileDescriptor() const noexcept {
+    return d_memoryFileDescriptor;
+  }
+
+  FileDescriptor doorbellFileDescriptor() const noexcept {
+    return d_doorbellFileDescriptor;
+  }
+
+  std::size_t capacityInBytes() const noexcept {
+    return static_cast<std::size_t>(d_capacityInBytes);
+  }
+
+  /**
+   * @brief Return the largest record that fits into the empty ring.
+   */
+  std::size_t maxRecordSizeInBytes() const noexcept {
+    return static_cast<std::size_t>(d_capacityInBytes) / 2 -
+           c_recordHeaderSizeInBytes;
+  }
+
+  /**
+   * @brief Return the number of times this side rang the doorbell.
+   */
+  std::uint64_t doorbellCount() const noexcept { return d_doorbellCount; }
+
+  /**
+   * @brief Return `true` when the consumer found the ring corrupted, after
+   * which no further records are returned.
+   */
+  bool hasError() const noexcept { return d_hasError; }
+
+private:
+  // PRIVATE MANIPULATORS
+  char const *fail() noexcept;
+  bool map(std::size_t mappingSizeInBytes, bool isNew) noexcept;
+};
+
+} // namespace io
+} // namespace eco
+
+#endif // ECO_IO_SHAREDMEMORYRING
@@ -0,0 +1,214 @@
+#include <io/sharedmemoryring.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace eco::io;
+
+namespace {
+
+std::string readRecord(SharedMemoryRing &ring) {
+  std::size_t sizeInBytes = 0;
+  auto data = ring.peek(sizeInBytes);
+
+  if (data == nullptr) {
+    return "<empty>";
+  }
+
+  std::string record(data, sizeInBytes);
+  ring.pop();
+  return record;
+}
+
+} // namespace
+
+TEST(SharedMemoryRing, WriteAndRead) {
+  // GIVEN
+  auto sut = SharedMemoryRing::create(1000);
+  ASSERT_NE(nullptr, sut);
+
+  // WHEN
+  EXPECT_TRUE(sut->write("hello", 5));
+  auto record = sut->reserve(0);
+  ASSERT_NE(nullptr, record);
+  sut->commit();
+  EXPECT_TRUE(sut->write("world", 5));
+
+  // THEN
+  EXPECT_EQ(1024, sut->capacityInBytes());
+  EXPECT_EQ("hello", readRecord(*sut));
+  EXPECT_EQ("", readRecord(*sut));
+  EXPECT_EQ("world", readRecord(*sut));
+  EXPECT_EQ("<empty>", readRecord(*sut));
+}
+
+TEST(SharedMemoryRing, FullAndWrapAround) {
+  // GIVEN
+  auto sut = SharedMemoryRing::create(64);
+  ASSERT_NE(nullptr, sut);
+  std::string record(20, 'a');
+
+  // WHEN each record takes 32 bytes, so the ring is full after two
+  EXPECT_TRUE(sut->write(record.data(), record.size()));
+  EXPECT_TRUE(sut->write(record.data(), record.size()));
+  EXPECT_FALSE(sut->write(record.data(), record.size()));
+  EXPECT_EQ(nullptr, sut->reserve(sut->maxRecordSizeInBytes() + 1));
+
+  // THEN records of other sizes that do not fit at the end start at the
+  // beginning again
+  std::deque<std::string> expected{record, record};
+  for (char letter = 'b'; letter <= 'z'; ++letter) {
+    EXPECT_EQ(expected.front(), readRecord(*sut));
+    expected.pop_front();
+
+    record = std::string(letter % 3 == 0 ? 4 : 20, letter);
+    while (sut->write(record.data(), record.size())) {
+      expected.push_back(record);
+    }
+  }
+
+  while (!expected.empty()) {
+    EXPECT_EQ(expected.front(), readRecord(*sut));
+    expected.pop_front();
+  }
+  EXPECT_EQ("<empty>", readRecord(*sut));
+}
+
+TEST(SharedMemoryRing, CorruptedRecordSize) {
+  // GIVEN
+  auto sut = SharedMemoryRing::create(1024);
+  ASSERT_NE(nullptr, sut);
+  EXPECT_TRUE(sut->write("hello", 5));
+
+  // WHEN the producer commits a record whose size exceeds the ring
+  auto record = sut->reserve(5);
+  ASSERT_NE(nullptr, record);
+  std::uint64_t size = 1u << 20;
+  std::memcpy(record - SharedMemoryRing::c_recordHeaderSizeInBytes, &size,
+              sizeof(size));
+  sut->commit();
+  EXPECT_TRUE(sut->write("world", 5));
+
+  // THEN the records before it are read, and none after it.
+  EXPECT_EQ("hello", readRecord(*sut));
+  EXPECT_FALSE(sut->hasError());
+  EXPECT_EQ("<empty>", readRecord(*sut));
+  EXPECT_TRUE(sut->hasError());
+  EXPECT_EQ("<empty>", readRecord(*sut));
+}
+
+TEST(SharedMemoryRing, CorruptedRecordPastWriteIndex) {
+  // GIVEN
+  auto sut = SharedMemoryRing::create(1024);
+  ASSERT_NE(nullptr, sut);
+
+  // WHEN the size of a committed record exceeds the committed bytes
+  auto record = sut->reserve(5);
+  ASSERT_NE(nullptr, record);
+  std::uint64_t size = 100;
+  std::memcpy(record - SharedMemoryRing::c_recordHeaderSizeInBytes, &size,
+              sizeof(size));
+  sut->commit();
+
+  // THEN
+  EXPECT_EQ("<empty>", readRecord(*sut));
+  EXPECT_TRUE(sut->hasError());
+}
+
+TEST(SharedMemoryRing, DoorbellOnlyWhenDrained) {
+  // GIVEN
+  std::shared_ptr<FileDescriptorEventRegistry> registry =
+      FileDescriptorEventRegistry::createSystemDefault();
+  FileDescriptorEventPoller poller(registry);
+  auto sut = SharedMemoryRing::create(4096);
+  ASSERT_NE(nullptr, sut);
+  ASSERT_TRUE(sut->registerDoorbell(registry));
+
+  // WHEN
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(sut->write("x", 1));
+  }
+  auto event = poller.waitForNextEvent(std::chrono::milliseconds(100));
+  sut->clearDoorbell();
+  auto count = sut->consume([](char const *, std::size_t) {});
+  EXPECT_TRUE(sut->write("y", 1));
+
+  // THEN
+  EXPECT_EQ(sut.get(), event.userData);
+  EXPECT_EQ(10, count);
+  EXPECT_EQ(2, sut->doorbellCount());
+}
+
+TEST(SharedMemoryRing, BetweenProcesses) {
+  // GIVEN
+  std::shared_ptr<FileDescriptorEventRegistry> registry =
+      FileDescriptorEventRegistry::createSystemDefault();
+  FileDescriptorEventPoller poller(registry);
+  auto sut = SharedMemoryRing::create(4096);
+  ASSERT_NE(nullptr, sut);
+  ASSERT_TRUE(sut->registerDoorbell(registry));
+  const int recordCount = 10000;
+
+  // WHEN a child process attaches and produces the records
+  auto child = fork();
+  ASSERT_NE(-1, child);
+
+  if (child == 0) {
+    auto producer =
+        SharedMemoryRing::attach(dup(sut->memoryFileDescriptor()),
+                                 dup(sut->doorbellFileDescriptor()));
+    for (int i = 0; producer != nullptr && i < recordCount;) {
+      i += producer->write(reinterpret_cast<char const *>(&i), sizeof(i));
+    }
+
+    _exit(producer == nullptr ? 1 : 0);
+  }
+
+  std::vector<int> received;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (received.size() < recordCount &&
+         std::chrono::steady_clock::now() < deadline) {
+    poller.waitForNextEvent(std::chrono::milliseconds(10));
+    sut->clearDoorbell();
+    sut->consume([&](char const *data, std::size_t sizeInBytes) {
+      int value = -1;
+      if (sizeInBytes == sizeof(value)) {
+        std::memcpy(&value, data, sizeof(value));
+      }
+      received.push_back(value);
+    });
+  }
+
+  int status = -1;
+  waitpid(child, &status, 0);
+
+  // THEN
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(0, WEXITSTATUS(status));
+  ASSERT_EQ(recordCount, received.size());
+  for (int i = 0; i < recordCount; ++i) {
+    ASSERT_EQ(i, received[i]);
+  }
+}
+
+TEST(SharedMemoryRing, AttachRejectsOtherFiles) {
+  // GIVEN
+  int pipeFileDescriptors[2];
+  ASSERT_EQ(0, pipe(pipeFileDescriptors));
+
+  // WHEN
+  auto sut = SharedMemoryRing::attach(pipeFileDescriptors[0],
+                                      pipeFileDescriptors[1]);
+
+  // THEN
+  EXPECT_EQ(nullptr, sut);
+}
@@ -0,0 +1,4 @@
+set(ECO_DEPENDENCIES
+    "io"
+    "async"
+)
@@ -0,0 +1,169 @@
+#include <net/asyncacceptor.h>
+
+#include <net/asynclocalsocket.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace eco {
+namespace net {
+
+namespace {
+    class AsyncAcceptorImpl : public AsyncAcceptor {
+        // PRIVATE DATA
+        io::FileDescriptor d_fileDescriptor;
+        std::shared_ptr<io::FileDescriptorEventRegistry> d_registry;
+        std::shared_ptr<async::Dispatcher> d_dispatcher;
+        AcceptCallback d_callback;
+        AsyncConnectedSocketOptions d_socketOptions;
+        std::uint64_t d_acceptedCount = 0;
+        int d_acceptError = 0;
+        bool d_isLocal = false;
+
+    public:
+        AsyncAcceptorImpl(
+            io::FileDescriptor fileDescriptor,
+            std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+            AcceptCallback callback,
+            AsyncConnectedSocketOptions const &socketOptions,
+            std::shared_ptr<async::Dispatcher> dispatcher,
+            bool isLocal)
+        : d_fileDescriptor(fileDescriptor)
+        , d_registry(std::move(registry))
+        , d_dispatcher(std::move(dispatcher))
+        , d_callback(std::move(callback))
+        , d_socketOptions(socketOptions)
+        , d_isLocal(isLocal)
+        {
+        }
+
+        ~AsyncAcceptorImpl() {
+            d_registry->remove(d_fileDescriptor);
+            close(d_fileDescriptor);
+        }
+
+        void onEvent(io::FileDescriptorEventType eventType) noexcept override {
+            if (io::hasEventType(eventType, io::FileDescriptorEventType::Readable)) {
+                acceptPending();
+            }
+        }
+
+        std::size_t acceptPending() noexcept override {
+            std::size_t count = 0;
+
+            while (true) {
+                int fileDescriptor = accept4(
+                    d_fileDescriptor, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+                if (fileDescriptor == -1) {
+                    // Connections that were reset before they were accepted
+                    // only affect themselves.
+                    if (errno == EINTR || errno == ECONNABORTED || errno == EPROTO) {
+                        continue;
+                    }
+
+                    d_acceptError = errno == EAGAIN || errno == EWOULDBLOCK ? 0 : errno;
+                    return count;
+                }
+
+                ++count;
+                ++d_acceptedCount;
+
+                auto socket = d_isLocal ?
+                    AsyncLocalSocket::create(fileDescriptor, d_registry, d_dispatcher, d_socketOptions) :
+                    AsyncConnectedSocket::create(fileDescriptor, d_registry, d_dispatcher, d_socketOptions);
+                if (socket != nullptr) {
+                    d_callback(std::move(socket));
+                }
+            }
+        }
+
+        io::FileDescriptor fileDescriptor() const noexcept override {
+            return d_fileDescriptor;
+        }
+
+        std::uint64_t acceptedCount() const noexcept override {
+            return d_acceptedCount;
+        }
+
+        int acceptError() const noexcept override {
+            return d_acceptError;
+        }
+    };
+}
+
+// PUBLIC STATIC CREATORS
+
+std::unique_ptr<AsyncAcceptor> AsyncAcceptor::listen(
+    sockaddr const *address,
+    socklen_t addressLength,
+    std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+    AcceptCallback callback,
+    AsyncAcceptorOptions const &options,
+    std::shared_ptr<async::Dispatcher> dispatcher) noexcept {
+    int fileDescriptor = socket(
+        address->sa_family, options.socketType | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (fileDescriptor == -1) {
+        return nullptr;
+    }
+
+    int enable = 1;
+    bool isListening =
+        setsockopt(fileDescriptor, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) == 0 &&
+        (!options.reusePort ||
+            setsockopt(fileDescriptor, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) == 0) &&
+        bind(fileDescriptor, address, addressLength) == 0 &&
+        ::listen(fileDescriptor, options.backlog) == 0;
+
+    if (!isListening) {
+        close(fileDescriptor);
+        return nullptr;
+    }
+
+    auto acceptor = std::make_unique<AsyncAcceptorImpl>(
+        fileDescriptor, registry, std::move(callback), options.socketOptions, std::move(dispatcher),
+        address->sa_family == AF_UNIX);
+
+    io::FileDescriptorEventOptions eventOptions;
+    eventOptions.interest = io::FileDescriptorInterest::Read;
+
+    if (!registry->addOrReplace(fileDescriptor, acceptor.get(), eventOptions)) {
+        // The destructor closes the file descriptor.
+        return nullptr;
+    }
+
+    // Connections that arrived before the registration are reported by the
+    // first readiness event, so nothing needs to be accepted here.
+    return acceptor;
+}
+
+std::unique_ptr<AsyncAcceptor> AsyncAcceptor::listenLocal(
+    char const *path,
+    std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+    AcceptCallback callback,
+    AsyncAcceptorOptions const &options,
+    std::shared_ptr<async::Dispatcher> dispatcher) noexcept {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+
+    if (std::strlen(path) >= sizeof(address.sun_path)) {
+        return nullptr;
+    }
+
+    std::strcpy(address.sun_path, path);
+    return listen(
+        reinterpret_cast<sockaddr *>(&address),
+        sizeof(address),
+        std::move(registry),
+        std::move(callback),
+        options,
+        std::move(dispatcher));
+}
+
+}
+}
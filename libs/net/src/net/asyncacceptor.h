@@ -0,0 +1,132 @@
+#ifndef ECO_NET_ASYNCACCEPTOR
+#define ECO_NET_ASYNCACCEPTOR
+
+#include <net/asyncconnectedsocket.h>
+#include <net/asyncsocket.h>
+
+#include <async/dispatcher.h>
+#include <io/filedescriptoreventpoller.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include <sys/socket.h>
+
+namespace eco {
+namespace net {
+
+    /**
+     * @brief Options of a listening socket.
+     */
+    struct AsyncAcceptorOptions {
+        /**
+         * @brief The maximum length of the queue of connections that were not
+         * accepted yet.
+         */
+        int backlog = SOMAXCONN;
+
+        /**
+         * @brief Set `SO_REUSEPORT`, so that one acceptor per loop can listen
+         * on the same address and the kernel balances new connections between
+         * them.
+         */
+        bool reusePort = false;
+
+        /**
+         * @brief The type of the socket, `SOCK_STREAM` or, for local
+         * addresses, `SOCK_SEQPACKET`.
+         */
+        int socketType = SOCK_STREAM;
+
+        /**
+         * @brief The options of the accepted sockets.
+         */
+        AsyncConnectedSocketOptions socketOptions;
+    };
+
+    /**
+     * @brief Listening stream socket that accepts connections into its
+     * registry.
+     *
+     * On each readiness event the acceptor accepts connections with
+     * `accept4` until none are pending, and registers each of them as an
+     * `AsyncConnectedSocket` in the registry of the acceptor before handing it
+     * to the accept callback. To spread a connection storm across cores,
+     * create one acceptor with `reusePort` per loop, each with the registry of
+     * its loop.
+     *
+     * Connections accepted on an `AF_UNIX` address are `AsyncLocalSocket`s,
+     * which the accept callback can cast to.
+     *
+     * When accepting fails because a resource limit like the number of open
+     * file descriptors was reached, pending connections stay queued and
+     * `acceptPending` must be called once resources were freed, as no further
+     * readiness event is reported for them.
+     *
+     * This class is not thread-safe: use it on the thread that polls its
+     * registry.
+     */
+    class AsyncAcceptor : public AsyncSocket {
+    public:
+        // PUBLIC TYPES
+        using AcceptCallback = std::function<void(std::unique_ptr<AsyncConnectedSocket>)>;
+
+        // PUBLIC STATIC CREATORS
+
+        /**
+         * @brief Listen on the specified `address` of the specified
+         * `addressLength` with the specified `options`, and register the
+         * listening socket in the specified `registry`. Pass each accepted
+         * connection to the specified `callback`, with futures resolving on
+         * the specified `dispatcher` or inline when it is `nullptr`. Return
+         * `nullptr` on failure.
+         */
+        static std::unique_ptr<AsyncAcceptor> listen(
+            sockaddr const *address,
+            socklen_t addressLength,
+            std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+            AcceptCallback callback,
+            AsyncAcceptorOptions const &options = AsyncAcceptorOptions(),
+            std::shared_ptr<async::Dispatcher> dispatcher = nullptr) noexcept;
+
+        /**
+         * @brief Listen on the `AF_UNIX` socket at the specified `path`, as
+         * `listen` does for other addresses. An existing socket at `path` is
+         * not removed.
+         */
+        static std::unique_ptr<AsyncAcceptor> listenLocal(
+            char const *path,
+            std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+            AcceptCallback callback,
+            AsyncAcceptorOptions const &options = AsyncAcceptorOptions(),
+            std::shared_ptr<async::Dispatcher> dispatcher = nullptr) noexcept;
+
+        // PUBLIC MANIPULATORS
+
+        /**
+         * @brief Accept connections until none are pending or accepting fails.
+         * Return the number of accepted connections.
+         */
+        virtual std::size_t acceptPending() noexcept = 0;
+
+        // PUBLIC ACCESSORS
+
+        /**
+         * @brief Return the total number of accepted connections.
+         */
+        virtual std::uint64_t acceptedCount() const noexcept = 0;
+
+        /**
+         * @brief Return the `errno` value that stopped the last call to
+         * `acceptPending`, or `0` when it stopped because no connections were
+         * pending.
+         */
+        virtual int acceptError() const noexcept = 0;
+    };
+
+}
+}
+
+#endif //  ECO_NET_ASYNCACCEPTOR
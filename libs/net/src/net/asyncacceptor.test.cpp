@@ -0,0 +1,114 @@
+#include <net/asyncacceptor.h>
+#include <net/asyncsocketmanager.h>
+
+#include <io/bufferpool.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace eco;
+using namespace eco::net;
+
+namespace {
+    sockaddr_in loopbackAddress(in_port_t port) {
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        return address;
+    }
+
+    in_port_t localPort(io::FileDescriptor fileDescriptor) {
+        sockaddr_in address = {};
+        socklen_t length = sizeof(address);
+        EXPECT_EQ(0, getsockname(fileDescriptor, reinterpret_cast<sockaddr *>(&address), &length));
+        return ntohs(address.sin_port);
+    }
+
+    int connectTo(in_port_t port) {
+        int fileDescriptor = socket(AF_INET, SOCK_STREAM, 0);
+        auto address = loopbackAddress(port);
+        EXPECT_EQ(0, connect(fileDescriptor, reinterpret_cast<sockaddr *>(&address), sizeof(address)));
+        return fileDescriptor;
+    }
+}
+
+TEST(AsyncAcceptor, AcceptsAllPendingConnections) {
+    // GIVEN
+    AsyncSocketManager manager;
+    std::vector<std::unique_ptr<AsyncConnectedSocket>> sockets;
+    auto address = loopbackAddress(0);
+    auto sut = manager.listen(
+        reinterpret_cast<sockaddr *>(&address),
+        sizeof(address),
+        [&](std::unique_ptr<AsyncConnectedSocket> socket) {
+            sockets.push_back(std::move(socket));
+        });
+    ASSERT_NE(nullptr, sut);
+
+    std::vector<int> clients;
+    for (int i = 0; i < 32; ++i) {
+        clients.push_back(connectTo(localPort(sut->fileDescriptor())));
+    }
+
+    // WHEN
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (sockets.size() < clients.size() && std::chrono::steady_clock::now() < deadline) {
+        manager.processEvents(std::chrono::milliseconds(10));
+    }
+
+    // THEN all connections are accepted and registered in the registry of
+    // the manager.
+    EXPECT_EQ(clients.size(), sockets.size());
+    EXPECT_EQ(clients.size(), sut->acceptedCount());
+    EXPECT_EQ(0, sut->acceptError());
+    EXPECT_EQ(0, sut->acceptPending());
+
+    io::BufferPool pool;
+    std::size_t readCount = 0;
+    for (std::size_t i = 0; i < sockets.size(); ++i) {
+        ASSERT_EQ(1, write(clients[i], "x", 1));
+        sockets[i]->readAsync(pool.allocate(16)).setResultCallback([&](std::size_t value) {
+            readCount += value;
+        });
+    }
+
+    while (readCount < sockets.size() && std::chrono::steady_clock::now() < deadline) {
+        manager.processEvents(std::chrono::milliseconds(10));
+    }
+
+    EXPECT_EQ(sockets.size(), readCount);
+
+    for (auto client : clients) {
+        close(client);
+    }
+}
+
+TEST(AsyncAcceptor, ReusePort) {
+    // GIVEN
+    std::shared_ptr<io::FileDescriptorEventRegistry> registry =
+        io::FileDescriptorEventRegistry::createSystemDefault();
+    auto ignore = [](std::unique_ptr<AsyncConnectedSocket>) {};
+    AsyncAcceptorOptions options;
+    options.reusePort = true;
+    auto address = loopbackAddress(0);
+    auto first = AsyncAcceptor::listen(
+        reinterpret_cast<sockaddr *>(&address), sizeof(address), registry, ignore, options);
+    ASSERT_NE(nullptr, first);
+    address = loopbackAddress(localPort(first->fileDescriptor()));
+
+    // WHEN
+    auto second = AsyncAcceptor::listen(
+        reinterpret_cast<sockaddr *>(&address), sizeof(address), registry, ignore, options);
+    auto third = AsyncAcceptor::listen(
+        reinterpret_cast<sockaddr *>(&address), sizeof(address), registry, ignore);
+
+    // THEN
+    EXPECT_NE(nullptr, second);
+    EXPECT_EQ(nullptr, third);
+}
@@ -1,15 +1,20 @@
 #include <net/asyncconnectedsocket.h>
 
+#include <net/asyncconnectedsocketimpl.h>
+
 namespace eco {
 namespace net {
 
-/*
-namespace {
-    class AsyncConnectedSocketImpl : public AsyncConnectedSocket, public AsyncSocketManager::AsyncSocket {
-    public:
-    };
+// PUBLIC STATIC CREATORS
+
+std::unique_ptr<AsyncConnectedSocket> AsyncConnectedSocket::create(
+    io::FileDescriptor fileDescriptor,
+    std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+    std::shared_ptr<async::Dispatcher> dispatcher,
+    AsyncConnectedSocketOptions const &options) noexcept {
+    return createSocket<AsyncConnectedSocketImpl<AsyncConnectedSocket>>(
+        fileDescriptor, std::move(registry), std::move(dispatcher), options);
 }
-*/
 
 }
 }
@@ -1,37 +1,288 @@
 #ifndef ECO_NET_ASYNCCONNECTEDSOCKET
-#define  ECO_NET_ASYNCCONNECTEDSOCKET
+#define ECO_NET_ASYNCCONNECTEDSOCKET
+
+#include <net/asyncreadthrottle.h>
+#include <net/asyncsocket.h>
+#include <net/asyncwriteflusher.h>
+#include <net/asynczerocopydrain.h>
+
+#include <async/dispatcher.h>
+#include <async/future.h>
+#include <io/buffer.h>
+#include <io/bufferchain.h>
+#include <io/filedescriptoreventpoller.h>
+#include <io/memorybudget.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
 
 namespace eco {
 namespace net {
-/*
-    class AsyncConnectedSocket {
-    public:
-        enum {
-            ALL_BYTES = std::numeric_limits<size_t>::max()
+
+    /**
+     * @brief Options of a connected socket.
+     */
+    struct AsyncConnectedSocketOptions {
+        /**
+         * @brief Queue writes instead of sending them right away, and send all
+         * queued writes with a single vectored send when the socket is
+         * flushed.
+         */
+        bool coalesceWrites = false;
+
+        /**
+         * @brief Flush as soon as this many bytes are queued.
+         */
+        std::size_t flushThresholdInBytes = 64 * 1024;
+
+        /**
+         * @brief Pass `MSG_MORE` to all but the last send of a flush that
+         * needs more than one, so that the kernel does not send partial
+         * segments between them.
+         */
+        bool useMsgMore = true;
+
+        /**
+         * @brief The non-owning flusher that flushes the socket once per loop
+         * iteration. Without it, coalesced writes are sent when the threshold
+         * is reached or `flush` is called.
+         */
+        AsyncWriteFlusher *flusher = nullptr;
+
+        /**
+         * @brief Send with `MSG_ZEROCOPY` when at least this many bytes are
+         * passed to a single send of a write that is not coalesced, or never
+         * when it is `0`. Ignored where the socket does not support it, or
+         * without a `zeroCopyDrain`.
+         */
+        std::size_t zeroCopyThresholdInBytes = 0;
+
+        /**
+         * @brief The non-owning drain that keeps the socket and the buffers of
+         * its pending zero copy sends when it is destroyed, until the kernel
+         * released them.
+         */
+        AsyncZeroCopyDrain *zeroCopyDrain = nullptr;
+
+        /**
+         * @brief The most bytes that may be buffered for the connection, or
+         * `io::MemoryBudget::c_unlimited`.
+         */
+        std::size_t memoryLimitInBytes = io::MemoryBudget::c_unlimited;
+
+        /**
+         * @brief The budget shared with other connections, typically by the
+         * whole process, that the budget of the connection is charged to as
+         * well, or `nullptr`.
+         */
+        std::shared_ptr<io::MemoryBudget> sharedMemoryBudget;
+
+        /**
+         * @brief The non-owning throttle that resumes reading once per loop
+         * iteration after the budget drained. Without it, reading is resumed
+         * when `resumeReading` is called.
+         */
+        AsyncReadThrottle *readThrottle = nullptr;
+    };
+
+    /**
+     * @brief Counters of a connected socket.
+     */
+    struct AsyncConnectedSocketStatistics {
+        std::uint64_t writeRequestCount = 0;
+        std::uint64_t writeSystemCallCount = 0;
+
+        /**
+         * @brief The number of sends with `MSG_ZEROCOPY`, and how many of
+         * them the kernel completed by copying after all, as it does for
+         * loopback connections.
+         */
+        std::uint64_t zeroCopySendCount = 0;
+        std::uint64_t zeroCopyCopiedCount = 0;
+
+        /**
+         * @brief The number of times reading paused because the memory budget
+         * was exhausted.
+         */
+        std::uint64_t readPauseCount = 0;
+
+        /**
+         * @brief Return the number of send system calls saved by coalescing
+         * writes.
+         */
+        std::uint64_t savedSystemCallCount() const noexcept {
+            return writeRequestCount > writeSystemCallCount ?
+                writeRequestCount - writeSystemCallCount :
+                0;
         }
+    };
 
-        virtual Future<size_t> readAsync(
-            std::shared_ptr<Buffer> buffer,
-            size_t minimumByteCount = 0,
-            std::shared_ptr<AsyncContext> asyncContext = nullptr) = 0;
+    /**
+     * @brief Connected stream socket with asynchronous scatter/gather reads
+     * and writes.
+     *
+     * Reads fill the buffers of the given chain with a single `readv` per
+     * readiness event where possible, writes send the chain with a single
+     * vectored send. The chain is held by the socket until the operation
+     * completed, so its pooled buffers stay alive; keep a copy of the chain to
+     * access the read bytes, as copies share the buffers.
+     *
+     * The futures resolve with the number of transferred bytes once at least
+     * the minimum byte count was transferred. A smaller count means the peer
+     * closed the connection or an error occurred, which `readError` and
+     * `writeError` tell apart. At most one read and one write can be pending
+     * at a time; further operations resolve with `0` immediately.
+     *
+     * Without a dispatcher, operations complete inline when the socket is
+     * ready, so a future can be resolved before `readAsync` or `writeAsync`
+     * returns, and completion callbacks must not destroy the socket. With a
+     * dispatcher, futures are resolved by functions dispatched to it.
+     *
+     * With zero copy sends, the kernel keeps referencing the sent buffers
+     * until it signals their completion through the error queue of the
+     * socket. The socket keeps the buffers until then, and resolves the write
+     * future only once all of its zero copy sends completed, after which the
+     * buffers can be reused. When the socket is destroyed before, its file
+     * descriptor and the pinned buffers are handed to its zero copy drain.
+     *
+     * When writes are coalesced, any number of writes can be pending. They
+     * are sent in order when the socket is flushed, and each future resolves
+     * once all of its bytes were sent, regardless of its minimum byte count.
+     *
+     * Each socket has a memory budget, which the bytes of its queued
+     * coalesced writes are charged to. Consumers of the read bytes charge
+     * what they buffer to it as well. While the budget or a budget it shares
+     * is exhausted, the socket stops reading and drops its read interest in
+     * the registry, so a slow consumer pushes back on the peer through the
+     * flow control of the transport instead of buffering without bound. A
+     * pending read continues once reading was resumed.
+     *
+     * This class is not thread-safe: use it on the thread that polls its
+     * registry.
+     */
+    class AsyncConnectedSocket : public AsyncSocket {
+        friend class AsyncWriteFlusher;
 
-        virtual Future<size_t> readAsync(
-            std::vector<std::shared_ptr<Buffer>> buffers,
-            size_t minimumByteCount = 0,
-            std::shared_ptr<AsyncContext> asyncContext = nullptr) = 0;
+    public:
+        enum : std::size_t {
+            ALL_BYTES = std::numeric_limits<std::size_t>::max()
+        };
+
+        // PUBLIC STATIC CREATORS
+
+        /**
+         * @brief Take ownership of the connected `fileDescriptor`, make it
+         * non-blocking and register it edge-triggered in the specified
+         * `registry`. Resolve futures on the specified `dispatcher`, or inline
+         * when it is `nullptr`, and apply the specified `options`. Return
+         * `nullptr` on failure, in which case the file descriptor is closed.
+         */
+        static std::unique_ptr<AsyncConnectedSocket> create(
+            io::FileDescriptor fileDescriptor,
+            std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+            std::shared_ptr<async::Dispatcher> dispatcher = nullptr,
+            AsyncConnectedSocketOptions const &options = AsyncConnectedSocketOptions()) noexcept;
+
+        // PUBLIC MANIPULATORS
+
+        /**
+         * @brief Read into the specified `buffer` until at least the specified
+         * `minimumByteCount` bytes, or any bytes when it is `0`, were read.
+         */
+        virtual async::Future<std::size_t> readAsync(
+            io::Buffer buffer,
+            std::size_t minimumByteCount = 0) noexcept = 0;
+
+        /**
+         * @brief Read into the specified `buffers` until at least the specified
+         * `minimumByteCount` bytes, or any bytes when it is `0`, were read.
+         */
+        virtual async::Future<std::size_t> readAsync(
+            io::BufferChain buffers,
+            std::size_t minimumByteCount = 0) noexcept = 0;
+
+        /**
+         * @brief Write the specified `buffer` until at least the specified
+         * `minimumByteCount` bytes were written.
+         */
+        virtual async::Future<std::size_t> writeAsync(
+            io::Buffer buffer,
+            std::size_t minimumByteCount = ALL_BYTES) noexcept = 0;
+
+        /**
+         * @brief Write the specified `buffers` until at least the specified
+         * `minimumByteCount` bytes were written.
+         */
+        virtual async::Future<std::size_t> writeAsync(
+            io::BufferChain buffers,
+            std::size_t minimumByteCount = ALL_BYTES) noexcept = 0;
+
+        /**
+         * @brief Send the coalesced writes that are queued, as far as possible
+         * without blocking. The rest is sent when the socket becomes writable.
+         */
+        virtual void flush() noexcept = 0;
+
+        /**
+         * @brief Resume reading when it was paused and the memory budget
+         * drained. Return `true` when reading was resumed.
+         */
+        virtual bool resumeReading() noexcept = 0;
 
-        virtual Future<size_t> writeAsync(
-            std::shared_ptr<Buffer> buffer,
-            size_t minimumByteCount = ALL_BYTES,
-            std::shared_ptr<AsyncContext> asyncContext = nullptr) = 0;
+        /**
+         * @brief Return the budget of the connection, which buffered bytes
+         * that were read can be charged to.
+         */
+        virtual io::MemoryBudget &memoryBudget() noexcept = 0;
 
-        virtual Future<size_t> writeAsync(
-            std::vector<std::shared_ptr<Buffer>> buffers,
-            size_t minimumByteCount = ALL_BYTES,
-            std::shared_ptr<AsyncContext> asyncContext = nullptr) = 0;
+        // PUBLIC ACCESSORS
 
+        /**
+         * @brief Return the `errno` value of the last completed read, or `0`
+         * when it succeeded or stopped at the end of the stream.
+         */
+        virtual int readError() const noexcept = 0;
+
+        /**
+         * @brief Return the `errno` value of the last completed write, or `0`
+         * when it succeeded.
+         */
+        virtual int writeError() const noexcept = 0;
+
+        /**
+         * @brief Return the number of bytes of coalesced writes that are not
+         * sent yet.
+         */
+        virtual std::size_t queuedWriteSizeInBytes() const noexcept = 0;
+
+        /**
+         * @brief Return the number of zero copy sends whose completion was not
+         * signalled yet.
+         */
+        virtual std::size_t pendingZeroCopySendCount() const noexcept = 0;
+
+        virtual bool isZeroCopyEnabled() const noexcept = 0;
+
+        /**
+         * @brief Return `true` while reading is paused because the memory
+         * budget is exhausted.
+         */
+        virtual bool isReadPaused() const noexcept = 0;
+
+        virtual AsyncConnectedSocketStatistics const &statistics() const noexcept = 0;
+
+    private:
+        // PRIVATE MANIPULATORS
+
+        /**
+         * @brief Flush the socket on behalf of the flusher it scheduled itself
+         * on.
+         */
+        virtual void flushScheduled() noexcept = 0;
     };
-*/
+
 }
 }
 
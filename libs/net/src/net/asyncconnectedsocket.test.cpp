@@ -0,0 +1,401 @@
+#include <net/asyncconnectedsocket.h>
+
+#include <net/testloop.test.h>
+
+#include <io/bufferpool.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <optional>
+#include <string>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace eco;
+using namespace eco::net;
+
+namespace {
+    struct Fixture : test::TestLoop {
+        std::unique_ptr<AsyncConnectedSocket> d_socket;
+        int d_peer = -1;
+
+        Fixture(AsyncConnectedSocketOptions const &options = AsyncConnectedSocketOptions()) {
+            int sockets[2];
+            EXPECT_EQ(0, socketpair(PF_LOCAL, SOCK_STREAM, 0, sockets));
+            d_socket = AsyncConnectedSocket::create(sockets[0], d_registry, nullptr, options);
+            d_peer = sockets[1];
+        }
+
+        ~Fixture() {
+            close(d_peer);
+        }
+
+        /**
+         * Dispatch events until the specified `result` is set or the
+         * specified `timeout` passed.
+         */
+        void waitFor(
+            std::optional<std::size_t> const &result,
+            std::chrono::milliseconds timeout = std::chrono::seconds(1)) {
+            processUntil([&] { return result.has_value(); }, timeout);
+        }
+    };
+
+    std::string toString(io::BufferChain const &chain, std::size_t length) {
+        std::string text(length, '\0');
+        chain.copyTo(text.data(), length);
+        return text;
+    }
+}
+
+TEST(AsyncConnectedSocket, ScatterRead) {
+    // GIVEN
+    Fixture fixture;
+    ASSERT_NE(nullptr, fixture.d_socket);
+    io::BufferChain buffers;
+    buffers.append(fixture.d_pool.allocate(256), 0, 4);
+    buffers.append(fixture.d_pool.allocate(256));
+
+    std::optional<std::size_t> result;
+    fixture.d_socket->readAsync(buffers, 10).setResultCallback([&](std::size_t value) {
+        result = value;
+    });
+
+    // WHEN the bytes arrive in two parts.
+    write(fixture.d_peer, "hello ", 6);
+    fixture.waitFor(result, std::chrono::milliseconds(20));
+    EXPECT_FALSE(result);
+    write(fixture.d_peer, "world", 5);
+    fixture.waitFor(result);
+
+    // THEN
+    EXPECT_EQ(11, result);
+    EXPECT_EQ(0, fixture.d_socket->readError());
+    EXPECT_EQ("hello world", toString(buffers, 11));
+}
+
+TEST(AsyncConnectedSocket, GatherWriteCompletesInline) {
+    // GIVEN
+    Fixture fixture;
+    auto buffers = fixture.createChain("hello ");
+    buffers.append(fixture.createChain("world"));
+
+    // WHEN
+    std::optional<std::size_t> result;
+    fixture.d_socket->writeAsync(buffers).setResultCallback([&](std::size_t value) {
+        result = value;
+    });
+
+    // THEN the socket is writable, so no loop iteration is needed.
+    EXPECT_EQ(11, result);
+    char text[12] = {0};
+    EXPECT_EQ(11, read(fixture.d_peer, text, 11));
+    EXPECT_STREQ("hello world", text);
+}
+
+TEST(AsyncConnectedSocket, LargeWrite) {
+    // GIVEN
+    Fixture fixture;
+    io::BufferChain buffers;
+    for (int i = 0; i < 100; ++i) {
+        auto buffer = fixture.d_pool.allocate(io::BufferPool::c_maxBufferSize);
+        std::memset(buffer.data(), 'a' + i % 26, buffer.sizeInBytes());
+        buffers.append(buffer);
+    }
+    auto size = buffers.sizeInBytes();
+
+    // WHEN the write does not fit into the socket buffer.
+    std::optional<std::size_t> result;
+    fixture.d_socket->writeAsync(buffers).setResultCallback([&](std::size_t value) {
+        result = value;
+    });
+    EXPECT_FALSE(result);
+
+    // THEN it is completed while the peer reads.
+    std::string received;
+    while (!result || received.size() < size) {
+        char text[65536];
+        auto count = recv(fixture.d_peer, text, sizeof(text), MSG_DONTWAIT);
+        if (count > 0) {
+            received.append(text, count);
+        }
+
+        fixture.d_manager.processEvents(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(size, result);
+    EXPECT_EQ(size, received.size());
+    EXPECT_EQ('a' + 99 % 26, received.back());
+}
+
+TEST(AsyncConnectedSocket, PeerClosed) {
+    // GIVEN
+    Fixture fixture;
+    std::optional<std::size_t> result;
+    fixture.d_socket->readAsync(fixture.d_pool.allocate(256), 10).setResultCallback([&](std::size_t value) {
+        result = value;
+    });
+
+    // WHEN
+    write(fixture.d_peer, "abc", 3);
+    shutdown(fixture.d_peer, SHUT_WR);
+    fixture.waitFor(result);
+
+    // THEN a short count is reported without an error.
+    EXPECT_EQ(3, result);
+    EXPECT_EQ(0, fixture.d_socket->readError());
+}
+
+TEST(AsyncConnectedSocket, OnePendingOperation) {
+    // GIVEN
+    Fixture fixture;
+    std::optional<std::size_t> first;
+    fixture.d_socket->readAsync(fixture.d_pool.allocate(256)).setResultCallback([&](std::size_t value) {
+        first = value;
+    });
+
+    // WHEN-THEN
+    std::optional<std::size_t> second;
+    fixture.d_socket->readAsync(fixture.d_pool.allocate(256)).setResultCallback([&](std::size_t value) {
+        second = value;
+    });
+    EXPECT_FALSE(first);
+    EXPECT_EQ(0, second);
+
+    // WHEN-THEN destroying the socket cancels the pending read.
+    fixture.d_socket.reset();
+    EXPECT_EQ(0, first);
+}
+
+TEST(AsyncConnectedSocket, CoalescedWrites) {
+    // GIVEN
+    AsyncConnectedSocketOptions options;
+    options.coalesceWrites = true;
+    options.flushThresholdInBytes = 8;
+    Fixture fixture(options);
+    std::size_t written = 0;
+    auto count = [&](std::size_t value) {
+        written += value;
+    };
+
+    // WHEN-THEN writes below the threshold are queued.
+    fixture.d_socket->writeAsync(fixture.createChain("abc")).setResultCallback(count);
+    fixture.d_socket->writeAsync(fixture.createChain("def")).setResultCallback(count);
+    EXPECT_EQ(0, written);
+    EXPECT_EQ(6, fixture.d_socket->queuedWriteSizeInBytes());
+    EXPECT_EQ(0, fixture.d_socket->statistics().writeSystemCallCount);
+
+    // WHEN-THEN reaching the threshold sends all of them at once.
+    fixture.d_socket->writeAsync(fixture.createChain("ghi")).setResultCallback(count);
+    EXPECT_EQ(9, written);
+    EXPECT_EQ(0, fixture.d_socket->queuedWriteSizeInBytes());
+    EXPECT_EQ(1, fixture.d_socket->statistics().writeSystemCallCount);
+    EXPECT_EQ(2, fixture.d_socket->statistics().savedSystemCallCount());
+
+    // WHEN-THEN flush sends queued writes below the threshold.
+    fixture.d_socket->writeAsync(fixture.createChain("jk")).setResultCallback(count);
+    fixture.d_socket->flush();
+    EXPECT_EQ(11, written);
+
+    char buffer[16] = {};
+    EXPECT_EQ(11, read(fixture.d_peer, buffer, sizeof(buffer)));
+    EXPECT_STREQ("abcdefghijk", buffer);
+}
+
+TEST(AsyncConnectedSocket, CoalescedWriteFailure) {
+    // GIVEN
+    AsyncConnectedSocketOptions options;
+    options.coalesceWrites = true;
+    Fixture fixture(options);
+    close(fixture.d_peer);
+    fixture.d_peer = -1;
+
+    std::optional<std::size_t> first;
+    std::optional<std::size_t> second;
+    fixture.d_socket->writeAsync(fixture.createChain("abc")).setResultCallback([&](std::size_t value) {
+        first = value;
+    });
+    fixture.d_socket->writeAsync(fixture.createChain("def")).setResultCallback([&](std::size_t value) {
+        second = value;
+    });
+
+    // WHEN
+    fixture.d_socket->flush();
+
+    // THEN
+    EXPECT_EQ(0, first);
+    EXPECT_EQ(0, second);
+    EXPECT_EQ(EPIPE, fixture.d_socket->writeError());
+}
+
+TEST(AsyncConnectedSocket, ReadPausesWhileBudgetIsExhausted) {
+    // GIVEN
+    AsyncConnectedSocketOptions options;
+    options.memoryLimitInBytes = 100;
+    options.coalesceWrites = true;
+    Fixture fixture(options);
+    auto &budget = fixture.d_socket->memoryBudget();
+
+    // WHEN-THEN queued writes are charged until they are sent.
+    fixture.d_socket->writeAsync(fixture.createChain("abc"));
+    EXPECT_EQ(3, budget.usedInBytes());
+    fixture.d_socket->flush();
+    EXPECT_EQ(0, budget.usedInBytes());
+
+    // WHEN the budget is exhausted while bytes arrive
+    budget.charge(100);
+    std::optional<std::size_t> result;
+    fixture.d_socket->readAsync(fixture.d_pool.allocate(16)).setResultCallback([&](std::size_t value) {
+        result = value;
+    });
+    ASSERT_EQ(5, write(fixture.d_peer, "hello", 5));
+    fixture.waitFor(result, std::chrono::milliseconds(50));
+
+    // THEN the read does not complete
+    EXPECT_FALSE(result);
+    EXPECT_TRUE(fixture.d_socket->isReadPaused());
+    EXPECT_EQ(1, fixture.d_socket->statistics().readPauseCount);
+    EXPECT_FALSE(fixture.d_socket->resumeReading());
+
+    // WHEN the budget drained
+    budget.release(100);
+
+    // THEN the read continues once reading is resumed
+    EXPECT_TRUE(fixture.d_socket->resumeReading());
+    EXPECT_EQ(5, result);
+    EXPECT_FALSE(fixture.d_socket->isReadPaused());
+}
+
+TEST(AsyncConnectedSocket, ZeroCopyWrite) {
+    // GIVEN
+    test::TestLoop loop;
+    int sockets[2];
+    test::tcpSocketPair(sockets);
+
+    AsyncConnectedSocketOptions options;
+    options.zeroCopyThresholdInBytes = 16 * 1024;
+    auto sut = loop.d_manager.createConnectedSocket(sockets[0], options);
+    ASSERT_NE(nullptr, sut);
+
+    io::BufferChain chain;
+    for (int i = 0; i < 64; ++i) {
+        auto buffer = loop.d_pool.allocate(io::BufferPool::c_maxBufferSize);
+        std::memset(buffer.data(), 'a' + i % 26, buffer.sizeInBytes());
+        chain.append(buffer);
+    }
+    auto sizeInBytes = chain.sizeInBytes();
+
+    std::size_t received = 0;
+    std::thread reader([&] {
+        char buffer[64 * 1024];
+        ssize_t count = 0;
+        while ((count = read(sockets[1], buffer, sizeof(buffer))) > 0) {
+            received += static_cast<std::size_t>(count);
+        }
+    });
+
+    // WHEN
+    std::optional<std::size_t> result;
+    sut->writeAsync(chain).setResultCallback([&](std::size_t value) {
+        result = value;
+    });
+
+    loop.processUntil([&] { return result.has_value(); }, std::chrono::seconds(5));
+
+    // THEN the write resolves once the kernel released all buffers.
+    ASSERT_TRUE(result);
+    EXPECT_EQ(sizeInBytes, *result);
+    EXPECT_EQ(0, sut->writeError());
+    EXPECT_EQ(0, sut->pendingZeroCopySendCount());
+
+    if (sut->isZeroCopyEnabled()) {
+        EXPECT_LT(0, sut->statistics().zeroCopySendCount);
+    }
+
+    sut.reset();
+    reader.join();
+    EXPECT_EQ(sizeInBytes, received);
+    close(sockets[1]);
+}
+
+TEST(AsyncConnectedSocket, ZeroCopyBuffersOutliveSocket) {
+    // GIVEN
+    test::TestLoop loop;
+    auto &drain = loop.d_manager.zeroCopyDrain();
+    int sockets[2];
+    test::tcpSocketPair(sockets);
+
+    AsyncConnectedSocketOptions options;
+    options.zeroCopyThresholdInBytes = 16 * 1024;
+    auto sut = loop.d_manager.createConnectedSocket(sockets[0], options);
+    ASSERT_NE(nullptr, sut);
+
+    if (!sut->isZeroCopyEnabled()) {
+        close(sockets[1]);
+        GTEST_SKIP() << "zero copy is not supported";
+    }
+
+    auto buffer = loop.d_pool.allocate(io::BufferPool::c_maxBufferSize);
+    io::BufferChain chain;
+    for (int i = 0; i < 16; ++i) {
+        chain.append(buffer);
+    }
+    sut->writeAsync(std::move(chain));
+    ASSERT_LT(0, sut->pendingZeroCopySendCount());
+
+    // WHEN the socket is destroyed before the kernel signalled the completions
+    sut.reset();
+
+    // THEN its buffers are kept until the kernel released them.
+    EXPECT_EQ(1, drain.parkedCount());
+    EXPECT_LT(1, buffer.useCount());
+
+    std::thread reader([&] {
+        char bytes[64 * 1024];
+        while (read(sockets[1], bytes, sizeof(bytes)) > 0) {
+        }
+    });
+
+    EXPECT_TRUE(loop.processUntil([&] { return drain.parkedCount() == 0; }, std::chrono::seconds(5)));
+    EXPECT_EQ(1, buffer.useCount());
+    reader.join();
+    close(sockets[1]);
+}
+
+TEST(AsyncConnectedSocket, ZeroCopyUnsupported) {
+    // GIVEN
+    test::TestLoop loop;
+    int sockets[2];
+    ASSERT_EQ(0, socketpair(PF_LOCAL, SOCK_STREAM, 0, sockets));
+    AsyncConnectedSocketOptions options;
+    options.zeroCopyThresholdInBytes = 1;
+
+    // WHEN
+    auto sut = loop.d_manager.createConnectedSocket(sockets[0], options);
+
+    // THEN local sockets always copy.
+    ASSERT_NE(nullptr, sut);
+    EXPECT_FALSE(sut->isZeroCopyEnabled());
+    close(sockets[1]);
+}
+
+TEST(AsyncConnectedSocket, ZeroCopyRequiresDrain) {
+    // GIVEN
+    test::TestLoop loop;
+    int sockets[2];
+    test::tcpSocketPair(sockets);
+    AsyncConnectedSocketOptions options;
+    options.zeroCopyThresholdInBytes = 1;
+
+    // WHEN
+    auto sut = AsyncConnectedSocket::create(sockets[0], loop.d_registry, nullptr, options);
+
+    // THEN without a drain to keep its buffers the socket copies.
+    ASSERT_NE(nullptr, sut);
+    EXPECT_FALSE(sut->isZeroCopyEnabled());
+    close(sockets[1]);
+}
@@ -0,0 +1,697 @@
+#ifndef ECO_NET_ASYNCCONNECTEDSOCKETIMPL
+#define ECO_NET_ASYNCCONNECTEDSOCKETIMPL
+
+#include <net/asyncconnectedsocket.h>
+#include <net/asynczerocopydrain.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <optional>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace eco {
+namespace net {
+
+    /**
+     * @brief The most slices passed to a single vectored call.
+     */
+    const std::size_t c_maxIoVecCount = 64;
+
+    /**
+     * @brief The implementation of `AsyncConnectedSocket`, shared by the
+     * socket types that extend its interface, which are given as `BASE`.
+     *
+     * Derived implementations can override how bytes are received and sent,
+     * for example to pass ancillary data.
+     */
+    template <typename BASE>
+    class AsyncConnectedSocketImpl : public BASE {
+        struct Operation {
+            io::BufferChain d_remaining;
+            std::size_t d_minimumByteCount = 0;
+            std::size_t d_transferred = 0;
+            int d_error = 0;
+            std::optional<async::ResultPromise<std::size_t>> d_promise;
+        };
+
+        struct QueuedWrite {
+            std::size_t d_beginOffset = 0;
+            std::size_t d_endOffset = 0;
+            async::ResultPromise<std::size_t> d_promise;
+        };
+
+    protected:
+        // PROTECTED DATA
+        io::FileDescriptor d_fileDescriptor;
+        std::shared_ptr<io::FileDescriptorEventRegistry> d_registry;
+        std::shared_ptr<async::Dispatcher> d_dispatcher;
+        AsyncConnectedSocketOptions d_options;
+
+        // Whether a short read ends at a message boundary or at ancillary
+        // data, so that it neither means that the socket was drained nor
+        // lets the read continue into the next message.
+        bool d_isShortReadBounded = false;
+
+    private:
+        // PRIVATE DATA
+        AsyncConnectedSocketStatistics d_statistics;
+        bool d_isReadable = false;
+        bool d_isWritable = true;
+        bool d_isReadClosed = false;
+        bool d_isReadPaused = false;
+        io::MemoryBudget d_memoryBudget;
+        Operation d_read;
+        Operation d_write;
+
+        // Coalesced writes, with offsets counted from the first queued byte.
+        io::BufferChain d_writeQueue;
+        std::deque<QueuedWrite> d_queuedWrites;
+        std::size_t d_queuedOffset = 0;
+        std::size_t d_sentOffset = 0;
+        bool d_isFlushScheduled = false;
+
+        // Zero copy sends whose buffers the kernel still references, in the
+        // order of their sequence numbers.
+        bool d_isZeroCopyEnabled = false;
+        std::uint32_t d_zeroCopySequence = 0;
+        std::deque<ZeroCopySend> d_zeroCopySends;
+        bool d_isWriteWaitingForZeroCopy = false;
+
+    public:
+        AsyncConnectedSocketImpl(
+            io::FileDescriptor fileDescriptor,
+            std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+            std::shared_ptr<async::Dispatcher> dispatcher,
+            AsyncConnectedSocketOptions const &options)
+        : d_fileDescriptor(fileDescriptor)
+        , d_registry(std::move(registry))
+        , d_dispatcher(std::move(dispatcher))
+        , d_options(options)
+        , d_memoryBudget(options.memoryLimitInBytes, options.sharedMemoryBudget)
+        {
+        }
+
+        ~AsyncConnectedSocketImpl() override {
+            d_registry->remove(d_fileDescriptor);
+
+            // The kernel may still transmit from the buffers of pending zero
+            // copy sends, so they are kept with the socket until it released
+            // them.
+            if (d_zeroCopySends.empty()) {
+                close(d_fileDescriptor);
+            } else {
+                d_options.zeroCopyDrain->park(d_fileDescriptor, std::move(d_zeroCopySends));
+            }
+
+            if (d_isFlushScheduled) {
+                d_options.flusher->cancel(this);
+            }
+
+            if (d_isReadPaused && d_options.readThrottle != nullptr) {
+                d_options.readThrottle->cancel(this);
+            }
+
+            failQueuedWrites(ECANCELED);
+
+            if (d_read.d_promise) {
+                complete(d_read, ECANCELED);
+            }
+
+            if (d_write.d_promise) {
+                complete(d_write, ECANCELED);
+            }
+        }
+
+        async::Future<std::size_t> readAsync(
+            io::Buffer buffer,
+            std::size_t minimumByteCount) noexcept override {
+            return readAsync(io::BufferChain(std::move(buffer)), minimumByteCount);
+        }
+
+        async::Future<std::size_t> readAsync(
+            io::BufferChain buffers,
+            std::size_t minimumByteCount) noexcept override {
+            return start(d_read, true, std::move(buffers), minimumByteCount);
+        }
+
+        async::Future<std::size_t> writeAsync(
+            io::Buffer buffer,
+            std::size_t minimumByteCount) noexcept override {
+            return writeAsync(io::BufferChain(std::move(buffer)), minimumByteCount);
+        }
+
+        async::Future<std::size_t> writeAsync(
+            io::BufferChain buffers,
+            std::size_t minimumByteCount) noexcept override {
+            if (d_options.coalesceWrites) {
+                ++d_statistics.writeRequestCount;
+                return queue(std::move(buffers));
+            }
+
+            return startWrite(std::move(buffers), minimumByteCount);
+        }
+
+        void flush() noexcept override {
+            while (d_isWritable && !d_writeQueue.empty()) {
+                struct iovec ioVecs[c_maxIoVecCount];
+                auto count = d_writeQueue.exportIoVecs(ioVecs, c_maxIoVecCount);
+                std::size_t requested = 0;
+                for (std::size_t i = 0; i < count; ++i) {
+                    requested += ioVecs[i].iov_len;
+                }
+
+                int flags = MSG_NOSIGNAL;
+                if (d_options.useMsgMore && requested < d_writeQueue.sizeInBytes()) {
+                    flags |= MSG_MORE;
+                }
+
+                struct msghdr message = {};
+                message.msg_iov = ioVecs;
+                message.msg_iovlen = count;
+                ssize_t result = send(message, flags);
+                ++d_statistics.writeSystemCallCount;
+
+                if (result >= 0) {
+                    auto transferred = static_cast<std::size_t>(result);
+                    d_writeQueue.trimFront(transferred);
+                    d_memoryBudget.release(transferred);
+                    d_sentOffset += transferred;
+
+                    // As with single writes, a short send means the socket
+                    // buffer is full.
+                    if (transferred < requested) {
+                        d_isWritable = false;
+                    }
+
+                    completeQueuedWrites();
+                    continue;
+                }
+
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    d_isWritable = false;
+                    return;
+                }
+
+                failQueuedWrites(errno);
+                return;
+            }
+        }
+
+        bool resumeReading() noexcept override {
+            if (!d_isReadPaused || d_memoryBudget.isExhausted()) {
+                return false;
+            }
+
+            setReadPaused(false);
+
+            // Bytes that arrived while paused were not reported, so the
+            // socket is read until it is drained.
+            d_isReadable = true;
+
+            if (d_read.d_promise) {
+                advance(d_read, true);
+            }
+
+            return true;
+        }
+
+        io::MemoryBudget &memoryBudget() noexcept override {
+            return d_memoryBudget;
+        }
+
+        void enableZeroCopy() noexcept {
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+            int enable = 1;
+            d_isZeroCopyEnabled = d_options.zeroCopyThresholdInBytes > 0 &&
+                d_options.zeroCopyDrain != nullptr &&
+                setsockopt(d_fileDescriptor, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) == 0;
+#endif
+        }
+
+        void onEvent(io::FileDescriptorEventType eventType) noexcept override {
+            using io::FileDescriptorEventType;
+
+            // Zero copy completions are reported as errors. Only when the
+            // error queue held none, the socket itself failed.
+            if (!d_zeroCopySends.empty() &&
+                io::hasEventType(eventType, FileDescriptorEventType::ErrorCondition) &&
+                completeZeroCopySends() &&
+                !io::hasEventType(eventType, FileDescriptorEventType::HangUp)) {
+                eventType = static_cast<FileDescriptorEventType>(
+                    static_cast<int>(eventType) & ~static_cast<int>(FileDescriptorEventType::ErrorCondition));
+            }
+
+            // Errors and hang-ups are reported by the next read or write.
+            auto failureTypes = FileDescriptorEventType::ErrorCondition | FileDescriptorEventType::HangUp;
+
+            if (io::hasEventType(eventType, FileDescriptorEventType::Readable | FileDescriptorEventType::PeerClosed | failureTypes)) {
+                d_isReadable = true;
+            }
+
+            if (io::hasEventType(eventType, FileDescriptorEventType::PeerClosed | failureTypes)) {
+                d_isReadClosed = true;
+            }
+
+            if (io::hasEventType(eventType, FileDescriptorEventType::Writable | failureTypes)) {
+                d_isWritable = true;
+            }
+
+            if (d_isReadable && d_read.d_promise) {
+                advance(d_read, true);
+            }
+
+            if (d_isWritable && d_write.d_promise && !d_isWriteWaitingForZeroCopy) {
+                advance(d_write, false);
+            }
+
+            if (d_isWritable && !d_writeQueue.empty()) {
+                flush();
+            }
+        }
+
+        io::FileDescriptor fileDescriptor() const noexcept override {
+            return d_fileDescriptor;
+        }
+
+        int readError() const noexcept override {
+            return d_read.d_error;
+        }
+
+        int writeError() const noexcept override {
+            return d_write.d_error;
+        }
+
+        std::size_t queuedWriteSizeInBytes() const noexcept override {
+            return d_writeQueue.sizeInBytes();
+        }
+
+        std::size_t pendingZeroCopySendCount() const noexcept override {
+            return d_zeroCopySends.size();
+        }
+
+        bool isZeroCopyEnabled() const noexcept override {
+            return d_isZeroCopyEnabled;
+        }
+
+        bool isReadPaused() const noexcept override {
+            return d_isReadPaused;
+        }
+
+        AsyncConnectedSocketStatistics const &statistics() const noexcept override {
+            return d_statistics;
+        }
+
+    protected:
+        // PROTECTED MANIPULATORS
+
+        /**
+         * @brief Read into the specified `count` `ioVecs` and return the
+         * result of the system call.
+         */
+        virtual ssize_t receive(struct iovec *ioVecs, std::size_t count) noexcept {
+            return readv(d_fileDescriptor, ioVecs, static_cast<int>(count));
+        }
+
+        /**
+         * @brief Send the specified `message` with the specified `flags` and
+         * return the result of the system call.
+         */
+        virtual ssize_t send(struct msghdr &message, int flags) noexcept {
+            return sendmsg(d_fileDescriptor, &message, flags);
+        }
+
+        /**
+         * @brief Start a write of the specified `buffers` that is not
+         * coalesced, and completes once the specified `minimumByteCount`
+         * bytes were written.
+         */
+        async::Future<std::size_t> startWrite(io::BufferChain buffers, std::size_t minimumByteCount) noexcept {
+            ++d_statistics.writeRequestCount;
+            return start(d_write, false, std::move(buffers), minimumByteCount);
+        }
+
+        // PROTECTED ACCESSORS
+
+        /**
+         * @brief Return `true` when no write is pending, so that a write can
+         * be started.
+         */
+        bool canStartWrite() const noexcept {
+            return !d_write.d_promise && d_writeQueue.empty();
+        }
+
+    private:
+        void flushScheduled() noexcept override {
+            d_isFlushScheduled = false;
+            flush();
+        }
+
+        async::Future<std::size_t> start(
+            Operation &operation,
+            bool isRead,
+            io::BufferChain buffers,
+            std::size_t minimumByteCount) noexcept {
+            if (operation.d_promise || buffers.empty()) {
+                async::ResultPromise<std::size_t> promise;
+                promise.setResult(0);
+                return promise.future();
+            }
+
+            operation.d_minimumByteCount = std::min(
+                std::max<std::size_t>(minimumByteCount, 1),
+                buffers.sizeInBytes());
+            operation.d_remaining = std::move(buffers);
+            operation.d_transferred = 0;
+            operation.d_error = 0;
+            operation.d_promise.emplace();
+            auto future = operation.d_promise->future();
+
+            // The socket is used right away while it is known to be ready,
+            // because no further edge is reported for it.
+            if (isRead ? d_isReadable : d_isWritable) {
+                advance(operation, isRead);
+            }
+
+            return future;
+        }
+
+        /**
+         * @brief Transfer bytes of the specified `operation` until it is done
+         * or the socket is not ready anymore.
+         */
+        void advance(Operation &operation, bool isRead) noexcept {
+            auto &isReady = isRead ? d_isReadable : d_isWritable;
+
+            if (isRead && !canRead()) {
+                return;
+            }
+
+            while (true) {
+                struct iovec ioVecs[c_maxIoVecCount];
+                auto count = operation.d_remaining.exportIoVecs(ioVecs, c_maxIoVecCount);
+                std::size_t requested = 0;
+                for (std::size_t i = 0; i < count; ++i) {
+                    requested += ioVecs[i].iov_len;
+                }
+
+                ssize_t result = 0;
+                bool isZeroCopy = false;
+                if (isRead) {
+                    result = receive(ioVecs, count);
+                } else {
+                    struct msghdr message = {};
+                    message.msg_iov = ioVecs;
+                    message.msg_iovlen = count;
+                    int flags = MSG_NOSIGNAL;
+#ifdef MSG_ZEROCOPY
+                    isZeroCopy = d_isZeroCopyEnabled && requested >= d_options.zeroCopyThresholdInBytes;
+                    flags |= isZeroCopy ? MSG_ZEROCOPY : 0;
+#endif
+                    result = send(message, flags);
+                    ++d_statistics.writeSystemCallCount;
+
+                    // The pages can not be pinned when the socket exceeds its
+                    // limit of locked memory, so the bytes are copied.
+                    if (result == -1 && isZeroCopy && errno == ENOBUFS) {
+                        isZeroCopy = false;
+                        result = send(message, MSG_NOSIGNAL);
+                        ++d_statistics.writeSystemCallCount;
+                    }
+                }
+
+                if (result > 0) {
+                    auto transferred = static_cast<std::size_t>(result);
+                    operation.d_transferred += transferred;
+
+                    if (isZeroCopy) {
+                        // Each zero copy send is numbered by the kernel, and
+                        // its buffers are held until that number completed.
+                        ++d_statistics.zeroCopySendCount;
+                        d_zeroCopySends.push_back(ZeroCopySend{
+                            d_zeroCopySequence++, operation.d_remaining.splitFront(transferred)});
+                    } else {
+                        operation.d_remaining.trimFront(transferred);
+                    }
+
+                    // A short transfer means the socket buffer was drained or
+                    // filled. Further data or space is reported with a new
+                    // edge, so there is no need to wait for EAGAIN. The end of
+                    // the stream is not reported again, so it is read.
+                    bool isShort = transferred < requested;
+                    bool isBounded = isRead && isShort && d_isShortReadBounded;
+                    if (isShort && !isBounded && !(isRead && d_isReadClosed)) {
+                        isReady = false;
+                    }
+
+                    bool isDone = operation.d_remaining.empty() ||
+                        ((!isReady || isBounded) && operation.d_transferred >= operation.d_minimumByteCount);
+
+                    if (isDone) {
+                        finish(operation, isRead);
+                        return;
+                    }
+
+                    if (!isReady) {
+                        return;
+                    }
+
+                    continue;
+                }
+
+                if (result == 0) {
+                    // The peer closed the connection.
+                    complete(operation, 0);
+                    return;
+                }
+
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    isReady = false;
+
+                    if (operation.d_transferred >= operation.d_minimumByteCount) {
+                        finish(operation, isRead);
+                    }
+
+                    return;
+                }
+
+                complete(operation, errno);
+                return;
+            }
+        }
+
+        /**
+         * @brief Return `true` when the memory budget permits reading, and
+         * pause or resume reading as it requires.
+         */
+        bool canRead() noexcept {
+            bool isExhausted = d_memoryBudget.isExhausted();
+
+            if (isExhausted != d_isReadPaused) {
+                setReadPaused(isExhausted);
+            }
+
+            return !isExhausted;
+        }
+
+        /**
+         * @brief Drop or restore the read interest of the socket in the
+         * registry as the specified `isPaused` tells, and let the throttle
+         * check the paused socket.
+         */
+        void setReadPaused(bool isPaused) noexcept {
+            auto interest = io::FileDescriptorInterest::Write | io::FileDescriptorInterest::PeerClosed;
+            io::FileDescriptorEventOptions eventOptions;
+            eventOptions.interest = isPaused ? interest : interest | io::FileDescriptorInterest::Read;
+            d_registry->modify(d_fileDescriptor, eventOptions);
+            d_isReadPaused = isPaused;
+
+            if (isPaused) {
+                ++d_statistics.readPauseCount;
+            }
+
+            if (d_options.readThrottle == nullptr) {
+                return;
+            }
+
+            if (isPaused) {
+                d_options.readThrottle->pause(this);
+            } else {
+                d_options.readThrottle->cancel(this);
+            }
+        }
+
+        /**
+         * @brief Complete the specified `operation` that succeeded, or wait
+         * for the completion of the zero copy sends of a write.
+         */
+        void finish(Operation &operation, bool isRead) noexcept {
+            if (!isRead && !d_zeroCopySends.empty()) {
+                d_isWriteWaitingForZeroCopy = true;
+                return;
+            }
+
+            complete(operation, 0);
+        }
+
+        /**
+         * @brief Release the buffers of the zero copy sends that the kernel
+         * signalled as completed on the error queue. Return `true` when any
+         * completion was read.
+         */
+        bool completeZeroCopySends() noexcept {
+            bool hasCompletions = reapZeroCopySends(
+                d_fileDescriptor, d_zeroCopySends, d_statistics.zeroCopyCopiedCount);
+
+            if (d_isWriteWaitingForZeroCopy && d_zeroCopySends.empty()) {
+                d_isWriteWaitingForZeroCopy = false;
+                complete(d_write, 0);
+            }
+
+            return hasCompletions;
+        }
+
+        /**
+         * @brief Queue the specified `buffers` as a coalesced write and flush
+         * when the threshold is reached.
+         */
+        async::Future<std::size_t> queue(io::BufferChain buffers) noexcept {
+            if (buffers.empty()) {
+                async::ResultPromise<std::size_t> promise;
+                promise.setResult(0);
+                return promise.future();
+            }
+
+            QueuedWrite write;
+            write.d_beginOffset = d_queuedOffset;
+            write.d_endOffset = d_queuedOffset + buffers.sizeInBytes();
+            auto future = write.d_promise.future();
+
+            d_queuedOffset = write.d_endOffset;
+            d_queuedWrites.push_back(std::move(write));
+            d_memoryBudget.charge(buffers.sizeInBytes());
+            d_writeQueue.append(std::move(buffers));
+
+            if (d_writeQueue.sizeInBytes() >= d_options.flushThresholdInBytes) {
+                flush();
+            } else if (!d_isFlushScheduled && d_options.flusher != nullptr) {
+                d_options.flusher->schedule(this);
+                d_isFlushScheduled = true;
+            }
+
+            return future;
+        }
+
+        /**
+         * @brief Resolve the futures of the coalesced writes that were sent
+         * completely.
+         */
+        void completeQueuedWrites() noexcept {
+            while (!d_queuedWrites.empty() && d_queuedWrites.front().d_endOffset <= d_sentOffset) {
+                auto write = std::move(d_queuedWrites.front());
+                d_queuedWrites.pop_front();
+                d_write.d_error = 0;
+                resolve(write.d_promise, write.d_endOffset - write.d_beginOffset);
+            }
+        }
+
+        /**
+         * @brief Resolve the futures of all coalesced writes with the bytes
+         * that were sent of them, after the specified `error` occurred.
+         */
+        void failQueuedWrites(int error) noexcept {
+            d_memoryBudget.release(d_writeQueue.sizeInBytes());
+            d_writeQueue.clear();
+            auto writes = std::move(d_queuedWrites);
+            d_queuedWrites.clear();
+            auto sentOffset = d_sentOffset;
+            d_sentOffset = d_queuedOffset;
+
+            for (auto &write : writes) {
+                d_write.d_error = error;
+                resolve(write.d_promise, std::max(sentOffset, write.d_beginOffset) - write.d_beginOffset);
+            }
+        }
+
+        /**
+         * @brief Resolve the future of the specified `operation`. The callback
+         * can start the next operation, so the operation is reset first.
+         */
+        void complete(Operation &operation, int error) noexcept {
+            operation.d_error = error;
+            operation.d_remaining.clear();
+            auto promise = std::move(*operation.d_promise);
+            operation.d_promise.reset();
+            resolve(promise, operation.d_transferred);
+        }
+
+        /**
+         * @brief Resolve the specified `promise` with the specified `result`,
+         * inline or on the dispatcher.
+         */
+        void resolve(async::ResultPromise<std::size_t> &promise, std::size_t result) noexcept {
+            if (d_dispatcher == nullptr) {
+                promise.setResult(result);
+                return;
+            }
+
+            d_dispatcher->dispatch([promise, result]() mutable {
+                promise.setResult(result);
+            });
+        }
+    };
+
+    /**
+     * @brief Make the connected `fileDescriptor` non-blocking and register a
+     * socket of the implementation `IMPL` for it in the specified `registry`,
+     * which is created with the specified `dispatcher` and `options`. Return
+     * `nullptr` on failure, in which case the file descriptor is closed.
+     */
+    template <typename IMPL>
+    std::unique_ptr<IMPL> createSocket(
+        io::FileDescriptor fileDescriptor,
+        std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+        std::shared_ptr<async::Dispatcher> dispatcher,
+        AsyncConnectedSocketOptions const &options) noexcept {
+        int flags = fcntl(fileDescriptor, F_GETFL);
+
+        if (flags == -1 ||
+            ((flags & O_NONBLOCK) == 0 && fcntl(fileDescriptor, F_SETFL, flags | O_NONBLOCK) == -1)) {
+            close(fileDescriptor);
+            return nullptr;
+        }
+
+        auto socket = std::make_unique<IMPL>(fileDescriptor, registry, std::move(dispatcher), options);
+        socket->enableZeroCopy();
+
+        io::FileDescriptorEventOptions eventOptions;
+        eventOptions.interest = io::FileDescriptorInterest::Read |
+            io::FileDescriptorInterest::Write |
+            io::FileDescriptorInterest::PeerClosed;
+
+        if (!registry->addOrReplace(fileDescriptor, socket.get(), eventOptions)) {
+            // The destructor closes the file descriptor.
+            return nullptr;
+        }
+
+        return socket;
+    }
+
+}
+}
+
+#endif //  ECO_NET_ASYNCCONNECTEDSOCKETIMPL
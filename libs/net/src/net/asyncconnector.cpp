@@ -0,0 +1,151 @@
+#include <net/asyncconnector.h>
+
+#include <net/asyncsocket.h>
+
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace eco {
+namespace net {
+
+class AsyncConnector::PendingConnect : public AsyncSocket {
+public:
+    // PUBLIC DATA
+    AsyncConnector *d_connector;
+    io::FileDescriptor d_fileDescriptor;
+    std::size_t d_index = 0;
+    async::ResultPromise<std::unique_ptr<AsyncConnectedSocket>> d_promise;
+
+    // PUBLIC CREATORS
+    PendingConnect(AsyncConnector *connector, io::FileDescriptor fileDescriptor)
+    : d_connector(connector)
+    , d_fileDescriptor(fileDescriptor)
+    {
+    }
+
+    // PUBLIC MANIPULATORS
+    void onEvent(io::FileDescriptorEventType eventType) noexcept override {
+        using io::FileDescriptorEventType;
+
+        if (!io::hasEventType(
+                eventType,
+                FileDescriptorEventType::Writable | FileDescriptorEventType::ErrorCondition | FileDescriptorEventType::HangUp)) {
+            return;
+        }
+
+        int error = 0;
+        socklen_t length = sizeof(error);
+
+        if (getsockopt(d_fileDescriptor, SOL_SOCKET, SO_ERROR, &error, &length) == -1) {
+            error = errno;
+        }
+
+        d_connector->complete(this, error);
+    }
+
+    // PUBLIC ACCESSORS
+    io::FileDescriptor fileDescriptor() const noexcept override {
+        return d_fileDescriptor;
+    }
+};
+
+// PUBLIC CREATORS
+
+AsyncConnector::AsyncConnector(
+    std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+    std::shared_ptr<async::Dispatcher> dispatcher,
+    AsyncConnectedSocketOptions const &socketOptions)
+: d_registry(std::move(registry))
+, d_dispatcher(std::move(dispatcher))
+, d_socketOptions(socketOptions)
+{
+}
+
+AsyncConnector::~AsyncConnector() {
+    while (!d_pendingConnects.empty()) {
+        complete(d_pendingConnects.back().get(), ECANCELED);
+    }
+}
+
+// PUBLIC MANIPULATORS
+
+AsyncConnector::SocketFuture AsyncConnector::connect(
+    sockaddr const *address,
+    socklen_t addressLength) noexcept {
+    async::ResultPromise<std::unique_ptr<AsyncConnectedSocket>> promise;
+    int fileDescriptor = socket(address->sa_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (fileDescriptor == -1) {
+        d_lastError = errno;
+        promise.setResult(nullptr);
+        return promise.future();
+    }
+
+    int result = 0;
+    do {
+        result = ::connect(fileDescriptor, address, addressLength);
+    } while (result == -1 && errno == EINTR);
+
+    // Local sockets connect right away.
+    if (result == 0) {
+        promise.setResult(AsyncConnectedSocket::create(
+            fileDescriptor, d_registry, d_dispatcher, d_socketOptions));
+        return promise.future();
+    }
+
+    if (errno != EINPROGRESS) {
+        d_lastError = errno;
+        close(fileDescriptor);
+        promise.setResult(nullptr);
+        return promise.future();
+    }
+
+    auto pendingConnect = std::make_unique<PendingConnect>(this, fileDescriptor);
+    auto future = pendingConnect->d_promise.future();
+
+    io::FileDescriptorEventOptions eventOptions;
+    eventOptions.interest = io::FileDescriptorInterest::Write;
+
+    if (!d_registry->addOrReplace(fileDescriptor, pendingConnect.get(), eventOptions)) {
+        d_lastError = errno;
+        close(fileDescriptor);
+        pendingConnect->d_promise.setResult(nullptr);
+        return future;
+    }
+
+    pendingConnect->d_index = d_pendingConnects.size();
+    d_pendingConnects.push_back(std::move(pendingConnect));
+    return future;
+}
+
+// PRIVATE MANIPULATORS
+
+void AsyncConnector::complete(PendingConnect *pendingConnect, int error) noexcept {
+    // Take ownership of the pending connect and close the gap it leaves.
+    auto index = pendingConnect->d_index;
+    auto owned = std::move(d_pendingConnects[index]);
+
+    if (index + 1 < d_pendingConnects.size()) {
+        d_pendingConnects[index] = std::move(d_pendingConnects.back());
+        d_pendingConnects[index]->d_index = index;
+    }
+
+    d_pendingConnects.pop_back();
+
+    if (error != 0) {
+        d_lastError = error;
+        d_registry->remove(owned->d_fileDescriptor);
+        close(owned->d_fileDescriptor);
+        owned->d_promise.setResult(nullptr);
+        return;
+    }
+
+    // The socket replaces the registration of the pending connect.
+    owned->d_promise.setResult(AsyncConnectedSocket::create(
+        owned->d_fileDescriptor, d_registry, d_dispatcher, d_socketOptions));
+}
+
+}
+}
@@ -0,0 +1,106 @@
+#ifndef ECO_NET_ASYNCCONNECTOR
+#define ECO_NET_ASYNCCONNECTOR
+
+#include <net/asyncconnectedsocket.h>
+
+#include <async/dispatcher.h>
+#include <async/future.h>
+#include <io/filedescriptoreventpoller.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <sys/socket.h>
+
+namespace eco {
+namespace net {
+
+    /**
+     * @brief Establishes outbound stream connections without blocking.
+     *
+     * Each connect creates a non-blocking socket, starts connecting and waits
+     * for the socket to become writable, after which `SO_ERROR` tells whether
+     * the connection was established. The connected socket is registered in
+     * the registry of the connector, with the dispatcher and options of the
+     * connector.
+     *
+     * Futures resolve on the thread that polls the registry, with `nullptr`
+     * when connecting failed, in which case `lastError` returns the reason.
+     * Connects that are pending when the connector is destroyed resolve with
+     * `nullptr` as well.
+     *
+     * This class is not thread-safe: use it on the thread that polls its
+     * registry.
+     */
+    class AsyncConnector {
+    public:
+        // PUBLIC TYPES
+        using SocketFuture = async::Future<std::unique_ptr<AsyncConnectedSocket>>;
+
+    private:
+        class PendingConnect;
+
+        // PRIVATE DATA
+        std::shared_ptr<io::FileDescriptorEventRegistry> d_registry;
+        std::shared_ptr<async::Dispatcher> d_dispatcher;
+        AsyncConnectedSocketOptions d_socketOptions;
+        std::vector<std::unique_ptr<PendingConnect>> d_pendingConnects;
+        int d_lastError = 0;
+
+    public:
+        // PUBLIC CREATORS
+
+        /**
+         * @brief Create a connector that registers the sockets it connects in
+         * the specified `registry`, with the specified `dispatcher` and
+         * `socketOptions`.
+         */
+        explicit AsyncConnector(
+            std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+            std::shared_ptr<async::Dispatcher> dispatcher = nullptr,
+            AsyncConnectedSocketOptions const &socketOptions = AsyncConnectedSocketOptions());
+
+        AsyncConnector(AsyncConnector const &) = delete;
+        AsyncConnector &operator=(AsyncConnector const &) = delete;
+
+        ~AsyncConnector();
+
+        // PUBLIC MANIPULATORS
+
+        /**
+         * @brief Connect to the specified `address` of the specified
+         * `addressLength`.
+         */
+        SocketFuture connect(sockaddr const *address, socklen_t addressLength) noexcept;
+
+        // PUBLIC ACCESSORS
+
+        /**
+         * @brief Return the number of connects that did not complete yet.
+         */
+        std::size_t pendingCount() const noexcept {
+            return d_pendingConnects.size();
+        }
+
+        /**
+         * @brief Return the `errno` value of the last failed connect, or `0`.
+         */
+        int lastError() const noexcept {
+            return d_lastError;
+        }
+
+    private:
+        // PRIVATE MANIPULATORS
+
+        /**
+         * @brief Complete the specified `pendingConnect` with the specified
+         * `error`, and destroy it.
+         */
+        void complete(PendingConnect *pendingConnect, int error) noexcept;
+    };
+
+}
+}
+
+#endif //  ECO_NET_ASYNCCONNECTOR
@@ -0,0 +1,90 @@
+#include <net/asyncconnector.h>
+
+#include <net/testloop.test.h>
+
+#include <gtest/gtest.h>
+
+#include <optional>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace eco;
+using namespace eco::net;
+
+namespace {
+    struct Fixture : test::TestLoop, test::LoopbackListener {
+    };
+}
+
+TEST(AsyncConnector, Connect) {
+    // GIVEN
+    Fixture fixture;
+    AsyncConnector sut(fixture.d_registry);
+    std::optional<std::unique_ptr<AsyncConnectedSocket>> result;
+
+    // WHEN
+    sut.connect(fixture.address(), sizeof(sockaddr_in))
+        .setResultCallback([&](std::unique_ptr<AsyncConnectedSocket> socket) {
+            result = std::move(socket);
+        });
+    fixture.processUntil([&] { return result.has_value(); });
+
+    // THEN the connected socket can be used right away.
+    ASSERT_TRUE(result);
+    ASSERT_NE(nullptr, *result);
+    EXPECT_EQ(0, sut.pendingCount());
+
+    std::optional<std::size_t> written;
+    (*result)->writeAsync(io::BufferChain()).setResultCallback([&](std::size_t value) {
+        written = value;
+    });
+    EXPECT_EQ(0, written);
+
+    int peer = accept(fixture.d_fileDescriptor, nullptr, nullptr);
+    EXPECT_NE(-1, peer);
+    close(peer);
+}
+
+TEST(AsyncConnector, ConnectionRefused) {
+    // GIVEN
+    Fixture fixture;
+    close(fixture.d_fileDescriptor);
+    fixture.d_fileDescriptor = -1;
+    AsyncConnector sut(fixture.d_registry);
+    std::optional<std::unique_ptr<AsyncConnectedSocket>> result;
+
+    // WHEN
+    sut.connect(fixture.address(), sizeof(sockaddr_in))
+        .setResultCallback([&](std::unique_ptr<AsyncConnectedSocket> socket) {
+            result = std::move(socket);
+        });
+    fixture.processUntil([&] { return result.has_value(); });
+
+    // THEN
+    ASSERT_TRUE(result);
+    EXPECT_EQ(nullptr, *result);
+    EXPECT_EQ(ECONNREFUSED, sut.lastError());
+}
+
+TEST(AsyncConnector, CancelOnDestruction) {
+    // GIVEN
+    Fixture fixture;
+    auto sut = std::make_unique<AsyncConnector>(fixture.d_registry);
+    std::optional<std::unique_ptr<AsyncConnectedSocket>> result;
+    sut->connect(fixture.address(), sizeof(sockaddr_in))
+        .setResultCallback([&](std::unique_ptr<AsyncConnectedSocket> socket) {
+            result = std::move(socket);
+        });
+
+    // WHEN
+    auto pendingCount = sut->pendingCount();
+    sut.reset();
+
+    // THEN connects that were pending resolve with `nullptr`.
+    ASSERT_TRUE(result);
+    if (pendingCount > 0) {
+        EXPECT_EQ(nullptr, *result);
+    }
+}
@@ -0,0 +1,474 @@
+#include <net/asyncdatagramsocket.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifndef SOL_UDP
+#define SOL_UDP IPPROTO_UDP
+#endif
+
+namespace eco {
+namespace net {
+
+namespace {
+    /**
+     * @brief The most segments the kernel accepts in a single GSO buffer.
+     */
+    const std::size_t c_maxGsoSegmentCount = 64;
+
+    /**
+     * @brief The most payload bytes in a single GSO buffer, so that the IP
+     * packet it describes stays below 64 KiB.
+     */
+    const std::size_t c_maxGsoSizeInBytes = 65000;
+
+    bool isSameAddress(Datagram const &first, Datagram const &second) noexcept {
+        return first.addressLength == second.addressLength &&
+            std::memcmp(&first.address, &second.address, first.addressLength) == 0;
+    }
+
+    class AsyncDatagramSocketImpl : public AsyncDatagramSocket {
+        // PRIVATE DATA
+        io::FileDescriptor d_fileDescriptor;
+        std::shared_ptr<io::FileDescriptorEventRegistry> d_registry;
+        io::BufferPool *d_pool;
+        ReceiveCallback d_callback;
+        AsyncDatagramSocketOptions d_options;
+        bool d_isGroEnabled = false;
+        bool d_isGsoEnabled = false;
+        bool d_isWritable = true;
+        int d_sendError = 0;
+        AsyncDatagramSocketStatistics d_statistics;
+
+        // Receiving
+        std::vector<io::Buffer> d_receiveBuffers;
+        std::vector<Datagram> d_received;
+
+        // Sending
+        std::deque<Datagram> d_pending;
+        std::vector<std::size_t> d_groupSizes;
+
+        // Message headers shared by receiving and sending
+        std::vector<mmsghdr> d_messages;
+        std::vector<iovec> d_ioVecs;
+        std::vector<sockaddr_storage> d_addresses;
+        std::vector<char> d_controls;
+        std::size_t d_controlSizeInBytes = CMSG_SPACE(sizeof(int));
+
+    public:
+        AsyncDatagramSocketImpl(
+            io::FileDescriptor fileDescriptor,
+            std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+            io::BufferPool &pool,
+            ReceiveCallback callback,
+            AsyncDatagramSocketOptions const &options)
+        : d_fileDescriptor(fileDescriptor)
+        , d_registry(std::move(registry))
+        , d_pool(&pool)
+        , d_callback(std::move(callback))
+        , d_options(options)
+        {
+            d_options.batchSize = std::max<std::size_t>(d_options.batchSize, 1);
+            d_receiveBuffers.resize(d_options.batchSize);
+            d_messages.resize(d_options.batchSize);
+            d_ioVecs.resize(d_options.batchSize * c_maxGsoSegmentCount);
+            d_addresses.resize(d_options.batchSize);
+            d_controls.resize(d_options.batchSize * d_controlSizeInBytes);
+            d_groupSizes.resize(d_options.batchSize);
+        }
+
+        ~AsyncDatagramSocketImpl() {
+            d_registry->remove(d_fileDescriptor);
+            close(d_fileDescriptor);
+        }
+
+        void enableOffloads() noexcept {
+            int enable = 1;
+
+#ifdef UDP_GRO
+            d_isGroEnabled = d_options.enableGro &&
+                setsockopt(d_fileDescriptor, SOL_UDP, UDP_GRO, &enable, sizeof(enable)) == 0;
+#endif
+
+#ifdef UDP_SEGMENT
+            d_isGsoEnabled = d_options.enableGso;
+#endif
+        }
+
+        void onEvent(io::FileDescriptorEventType eventType) noexcept override {
+            using io::FileDescriptorEventType;
+
+            auto failureTypes = FileDescriptorEventType::ErrorCondition | FileDescriptorEventType::HangUp;
+
+            if (io::hasEventType(eventType, FileDescriptorEventType::Readable | failureTypes)) {
+                receive();
+            }
+
+            if (io::hasEventType(eventType, FileDescriptorEventType::Writable | failureTypes)) {
+                d_isWritable = true;
+                flush();
+            }
+        }
+
+        std::size_t send(Datagram const *datagrams, std::size_t count) noexcept override {
+            auto accepted = std::min(count, d_options.maxPendingSendCount - d_pending.size());
+            d_statistics.droppedDatagrams += count - accepted;
+
+            d_pending.insert(d_pending.end(), datagrams, datagrams + accepted);
+
+            if (d_isWritable) {
+                flush();
+            }
+
+            return accepted;
+        }
+
+        io::FileDescriptor fileDescriptor() const noexcept override {
+            return d_fileDescriptor;
+        }
+
+        std::size_t pendingSendCount() const noexcept override {
+            return d_pending.size();
+        }
+
+        int sendError() const noexcept override {
+            return d_sendError;
+        }
+
+        bool isGroEnabled() const noexcept override {
+            return d_isGroEnabled;
+        }
+
+        bool isGsoEnabled() const noexcept override {
+            return d_isGsoEnabled;
+        }
+
+        AsyncDatagramSocketStatistics const &statistics() const noexcept override {
+            return d_statistics;
+        }
+
+    private:
+        void receive() noexcept {
+            auto bufferSize = d_isGroEnabled ?
+                io::BufferPool::c_maxBufferSize :
+                d_options.maxDatagramSizeInBytes;
+
+            while (true) {
+                for (std::size_t i = 0; i < d_options.batchSize; ++i) {
+                    // Buffers that received nothing are reused by the next
+                    // batch.
+                    if (!d_receiveBuffers[i]) {
+                        d_receiveBuffers[i] = d_pool->allocate(bufferSize);
+
+                        if (!d_receiveBuffers[i]) {
+                            drop();
+                            return;
+                        }
+                    }
+
+                    d_ioVecs[i].iov_base = d_receiveBuffers[i].data();
+                    d_ioVecs[i].iov_len = std::min(bufferSize, d_receiveBuffers[i].sizeInBytes());
+
+                    auto &header = d_messages[i].msg_hdr;
+                    header = msghdr();
+                    header.msg_name = &d_addresses[i];
+                    header.msg_namelen = sizeof(sockaddr_storage);
+                    header.msg_iov = &d_ioVecs[i];
+                    header.msg_iovlen = 1;
+
+                    if (d_isGroEnabled) {
+                        header.msg_control = &d_controls[i * d_controlSizeInBytes];
+                        header.msg_controllen = d_controlSizeInBytes;
+                    }
+                }
+
+                int count = recvmmsg(d_fileDescriptor, d_messages.data(), d_options.batchSize, 0, nullptr);
+                ++d_statistics.receiveCalls;
+
+                if (count == -1) {
+                    // Errors like ICMP port unreachable on a connected socket
+                    // are reported once and do not stop receiving.
+                    if (errno == EINTR || errno == ECONNREFUSED || errno == EHOSTUNREACH || errno == ENETUNREACH) {
+                        continue;
+                    }
+
+                    return;
+                }
+
+                for (int i = 0; i < count; ++i) {
+                    collect(i);
+                }
+
+                if (!d_received.empty()) {
+                    d_statistics.receivedDatagrams += d_received.size();
+                    d_callback(d_received.data(), d_received.size());
+                    d_received.clear();
+                }
+
+                // The receive queue was drained when the batch was not filled.
+                if (static_cast<std::size_t>(count) < d_options.batchSize) {
+                    return;
+                }
+            }
+        }
+
+        void drop() noexcept {
+            // The edge-triggered socket reports no further datagrams until
+            // its receive queue is drained, so without buffers to receive
+            // into the queued datagrams are dropped instead.
+            for (std::size_t i = 0; i < d_options.batchSize; ++i) {
+                auto &header = d_messages[i].msg_hdr;
+                header = msghdr();
+            }
+
+            while (true) {
+                int count = recvmmsg(d_fileDescriptor, d_messages.data(), d_options.batchSize, 0, nullptr);
+                ++d_statistics.receiveCalls;
+
+                if (count == -1) {
+                    if (errno == EINTR || errno == ECONNREFUSED || errno == EHOSTUNREACH || errno == ENETUNREACH) {
+                        continue;
+                    }
+
+                    return;
+                }
+
+                d_statistics.droppedDatagrams += count;
+
+                if (static_cast<std::size_t>(count) < d_options.batchSize) {
+                    return;
+                }
+            }
+        }
+
+        void collect(int index) noexcept {
+            auto &message = d_messages[index];
+            auto buffer = std::move(d_receiveBuffers[index]);
+
+            if ((message.msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+                ++d_statistics.droppedDatagrams;
+                return;
+            }
+
+            std::size_t segmentSize = message.msg_len;
+
+#ifdef UDP_GRO
+            for (auto control = CMSG_FIRSTHDR(&message.msg_hdr);
+                 control != nullptr;
+                 control = CMSG_NXTHDR(&message.msg_hdr, control)) {
+                if (control->cmsg_level == SOL_UDP && control->cmsg_type == UDP_GRO) {
+                    int size = 0;
+                    std::memcpy(&size, CMSG_DATA(control), sizeof(size));
+                    segmentSize = size > 0 ? static_cast<std::size_t>(size) : segmentSize;
+                }
+            }
+#endif
+
+            // A coalesced buffer holds datagrams of the segment size, except
+            // for a shorter last one. All of them share the buffer.
+            std::size_t offset = 0;
+
+            do {
+                Datagram datagram;
+                datagram.data = io::BufferSlice{
+                    buffer, offset, std::min<std::size_t>(segmentSize, message.msg_len - offset)};
+                std::memcpy(&datagram.address, &d_addresses[index], message.msg_hdr.msg_namelen);
+                datagram.addressLength = message.msg_hdr.msg_namelen;
+                d_received.push_back(std::move(datagram));
+                offset += segmentSize;
+            } while (offset < message.msg_len);
+        }
+
+        void flush() noexcept {
+            while (!d_pending.empty()) {
+                auto messageCount = prepareSend();
+                int count = sendmmsg(d_fileDescriptor, d_messages.data(), messageCount, MSG_NOSIGNAL);
+                ++d_statistics.sendCalls;
+
+                if (count == -1) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                        d_isWritable = false;
+                        return;
+                    }
+
+                    // Devices without UDP checksum offload reject GSO buffers.
+                    if (d_isGsoEnabled && d_groupSizes[0] > 1 && (errno == EIO || errno == EINVAL)) {
+                        d_isGsoEnabled = false;
+                        continue;
+                    }
+
+                    // The first datagram can not be sent; drop it so that the
+                    // others are not blocked behind it.
+                    d_sendError = errno;
+                    d_statistics.droppedDatagrams += d_groupSizes[0];
+                    pop(d_groupSizes[0]);
+                    continue;
+                }
+
+                for (int i = 0; i < count; ++i) {
+                    d_statistics.sentDatagrams += d_groupSizes[i];
+                    pop(d_groupSizes[i]);
+                }
+            }
+        }
+
+        /**
+         * Fill the message headers with the pending datagrams, grouping them
+         * into GSO buffers where possible, and return the number of messages.
+         */
+        std::size_t prepareSend() noexcept {
+            std::size_t messageCount = 0;
+            std::size_t datagramIndex = 0;
+
+            while (messageCount < d_options.batchSize && datagramIndex < d_pending.size()) {
+                auto &first = d_pending[datagramIndex];
+                auto segmentSize = first.data.length;
+                auto groupSize = groupSizeAt(datagramIndex);
+                auto ioVecs = &d_ioVecs[messageCount * c_maxGsoSegmentCount];
+
+                for (std::size_t i = 0; i < groupSize; ++i) {
+                    auto &datagram = d_pending[datagramIndex + i];
+                    ioVecs[i].iov_base = const_cast<char *>(datagram.data.data());
+                    ioVecs[i].iov_len = datagram.data.length;
+                }
+
+                auto &header = d_messages[messageCount].msg_hdr;
+                header = msghdr();
+                header.msg_name = first.addressLength > 0 ? &first.address : nullptr;
+                header.msg_namelen = first.addressLength;
+                header.msg_iov = ioVecs;
+                header.msg_iovlen = groupSize;
+
+#ifdef UDP_SEGMENT
+                if (groupSize > 1) {
+                    header.msg_control = &d_controls[messageCount * d_controlSizeInBytes];
+                    header.msg_controllen = CMSG_SPACE(sizeof(std::uint16_t));
+                    auto control = CMSG_FIRSTHDR(&header);
+                    control->cmsg_level = SOL_UDP;
+                    control->cmsg_type = UDP_SEGMENT;
+                    control->cmsg_len = CMSG_LEN(sizeof(std::uint16_t));
+                    auto size = static_cast<std::uint16_t>(segmentSize);
+                    std::memcpy(CMSG_DATA(control), &size, sizeof(size));
+                }
+#endif
+
+                d_groupSizes[messageCount] = groupSize;
+                datagramIndex += groupSize;
+                ++messageCount;
+            }
+
+            return messageCount;
+        }
+
+        /**
+         * Return the number of pending datagrams from the specified `index`
+         * on that can be sent as a single GSO buffer.
+         */
+        std::size_t groupSizeAt(std::size_t index) const noexcept {
+            if (!d_isGsoEnabled) {
+                return 1;
+            }
+
+            auto &first = d_pending[index];
+            auto segmentSize = first.data.length;
+            auto totalSize = segmentSize;
+            std::size_t groupSize = 1;
+
+            while (index + groupSize < d_pending.size() && groupSize < c_maxGsoSegmentCount) {
+                auto &next = d_pending[index + groupSize];
+
+                if (next.data.length > segmentSize ||
+                    next.data.length == 0 ||
+                    totalSize + next.data.length > c_maxGsoSizeInBytes ||
+                    !isSameAddress(first, next)) {
+                    break;
+                }
+
+                totalSize += next.data.length;
+                ++groupSize;
+
+                // Only the last segment can be shorter.
+                if (next.data.length < segmentSize) {
+                    break;
+                }
+            }
+
+            return groupSize;
+        }
+
+        void pop(std::size_t count) noexcept {
+            d_pending.erase(d_pending.begin(), d_pending.begin() + count);
+        }
+    };
+}
+
+// PUBLIC STATIC CREATORS
+
+std::unique_ptr<AsyncDatagramSocket> AsyncDatagramSocket::bind(
+    sockaddr const *address,
+    socklen_t addressLength,
+    std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+    io::BufferPool &pool,
+    ReceiveCallback callback,
+    AsyncDatagramSocketOptions const &options) noexcept {
+    int fileDescriptor = socket(address->sa_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (fileDescriptor == -1) {
+        return nullptr;
+    }
+
+    if (::bind(fileDescriptor, address, addressLength) == -1) {
+        close(fileDescriptor);
+        return nullptr;
+    }
+
+    return create(fileDescriptor, std::move(registry), pool, std::move(callback), options);
+}
+
+std::unique_ptr<AsyncDatagramSocket> AsyncDatagramSocket::create(
+    io::FileDescriptor fileDescriptor,
+    std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+    io::BufferPool &pool,
+    ReceiveCallback callback,
+    AsyncDatagramSocketOptions const &options) noexcept {
+    int flags = fcntl(fileDescriptor, F_GETFL);
+
+    if (options.maxDatagramSizeInBytes == 0 ||
+        options.maxDatagramSizeInBytes > io::BufferPool::c_maxBufferSize ||
+        flags == -1 ||
+        ((flags & O_NONBLOCK) == 0 && fcntl(fileDescriptor, F_SETFL, flags | O_NONBLOCK) == -1)) {
+        close(fileDescriptor);
+        return nullptr;
+    }
+
+    auto socket = std::make_unique<AsyncDatagramSocketImpl>(
+        fileDescriptor, registry, pool, std::move(callback), options);
+    socket->enableOffloads();
+
+    io::FileDescriptorEventOptions eventOptions;
+    eventOptions.interest = io::FileDescriptorInterest::Read | io::FileDescriptorInterest::Write;
+
+    if (!registry->addOrReplace(fileDescriptor, socket.get(), eventOptions)) {
+        // The destructor closes the file descriptor.
+        return nullptr;
+    }
+
+    return socket;
+}
+
+}
+}
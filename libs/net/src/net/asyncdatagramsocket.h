@@ -0,0 +1,165 @@
+#ifndef ECO_NET_ASYNCDATAGRAMSOCKET
+#define ECO_NET_ASYNCDATAGRAMSOCKET
+
+#include <net/asyncsocket.h>
+
+#include <io/bufferchain.h>
+#include <io/bufferpool.h>
+#include <io/filedescriptoreventpoller.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include <sys/socket.h>
+
+namespace eco {
+namespace net {
+
+    /**
+     * @brief A datagram and the address of its sender or receiver.
+     */
+    struct Datagram {
+        /**
+         * @brief The payload of the datagram.
+         */
+        io::BufferSlice data;
+
+        /**
+         * @brief The address of the peer. Leave `addressLength` `0` to send
+         * to the peer of a connected socket.
+         */
+        sockaddr_storage address = {};
+        socklen_t addressLength = 0;
+    };
+
+    /**
+     * @brief Options of a datagram socket.
+     */
+    struct AsyncDatagramSocketOptions {
+        /**
+         * @brief The size of the buffers datagrams are received into, at
+         * most `io::BufferPool::c_maxBufferSize`. Longer datagrams are
+         * truncated and dropped, as are datagrams that arrive while the pool
+         * has no buffer available.
+         */
+        std::size_t maxDatagramSizeInBytes = 2048;
+
+        /**
+         * @brief The most datagrams received or sent with a single system
+         * call.
+         */
+        std::size_t batchSize = 32;
+
+        /**
+         * @brief The most datagrams queued while the socket is not writable.
+         * Datagrams sent while the queue is full are dropped.
+         */
+        std::size_t maxPendingSendCount = 1024;
+
+        /**
+         * @brief Let the kernel coalesce received datagrams of a flow into a
+         * single buffer (`UDP_GRO`), which are split into slices of it again.
+         * Receive buffers are allocated with the maximum buffer size then.
+         */
+        bool enableGro = false;
+
+        /**
+         * @brief Send consecutive datagrams of the same size to the same
+         * address as a single buffer that is segmented by the kernel or the
+         * device (`UDP_SEGMENT`). Disabled automatically where unsupported.
+         */
+        bool enableGso = false;
+    };
+
+    /**
+     * @brief Counters of a datagram socket.
+     */
+    struct AsyncDatagramSocketStatistics {
+        std::uint64_t receiveCalls = 0;
+        std::uint64_t receivedDatagrams = 0;
+        std::uint64_t sendCalls = 0;
+        std::uint64_t sentDatagrams = 0;
+        std::uint64_t droppedDatagrams = 0;
+    };
+
+    /**
+     * @brief Datagram socket that receives and sends in batches.
+     *
+     * Received datagrams are read with `recvmmsg` into buffers of the given
+     * pool, and passed to the receive callback a batch at a time; the
+     * callback can keep the buffers of the datagrams. Sent datagrams are
+     * written with `sendmmsg` while the socket is writable and queued
+     * otherwise. With GRO and GSO many datagrams are moved per buffer, which
+     * reduces the per-datagram cost inside of the kernel as well.
+     *
+     * The pool must outlive the socket. This class is not thread-safe: use it
+     * on the thread that polls its registry.
+     */
+    class AsyncDatagramSocket : public AsyncSocket {
+    public:
+        // PUBLIC TYPES
+        using ReceiveCallback = std::function<void(Datagram *datagrams, std::size_t count)>;
+
+        // PUBLIC STATIC CREATORS
+
+        /**
+         * @brief Create a datagram socket bound to the specified `address` of
+         * the specified `addressLength`, as `create` does.
+         */
+        static std::unique_ptr<AsyncDatagramSocket> bind(
+            sockaddr const *address,
+            socklen_t addressLength,
+            std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+            io::BufferPool &pool,
+            ReceiveCallback callback,
+            AsyncDatagramSocketOptions const &options = AsyncDatagramSocketOptions()) noexcept;
+
+        /**
+         * @brief Take ownership of the datagram socket `fileDescriptor`, make
+         * it non-blocking and register it edge-triggered in the specified
+         * `registry`. Receive datagrams into buffers of the specified `pool`
+         * and pass them to the specified `callback`. Return `nullptr` on
+         * failure or when the specified `options` are invalid, in which case
+         * the file descriptor is closed.
+         */
+        static std::unique_ptr<AsyncDatagramSocket> create(
+            io::FileDescriptor fileDescriptor,
+            std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+            io::BufferPool &pool,
+            ReceiveCallback callback,
+            AsyncDatagramSocketOptions const &options = AsyncDatagramSocketOptions()) noexcept;
+
+        // PUBLIC MANIPULATORS
+
+        /**
+         * @brief Send the specified `count` `datagrams`, queueing those that
+         * can not be sent without blocking. Return the number of datagrams
+         * that were sent or queued; the others were dropped.
+         */
+        virtual std::size_t send(Datagram const *datagrams, std::size_t count) noexcept = 0;
+
+        // PUBLIC ACCESSORS
+
+        /**
+         * @brief Return the number of queued datagrams.
+         */
+        virtual std::size_t pendingSendCount() const noexcept = 0;
+
+        /**
+         * @brief Return the `errno` value of the last failed send, or `0`.
+         */
+        virtual int sendError() const noexcept = 0;
+
+        virtual bool isGroEnabled() const noexcept = 0;
+
+        virtual bool isGsoEnabled() const noexcept = 0;
+
+        virtual AsyncDatagramSocketStatistics const &statistics() const noexcept = 0;
+    };
+
+}
+}
+
+#endif //  ECO_NET_ASYNCDATAGRAMSOCKET
@@ -0,0 +1,153 @@
+#include <net/asyncdatagramsocket.h>
+
+#include <net/testloop.test.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+using namespace eco;
+using namespace eco::net;
+
+namespace {
+    struct Fixture : test::TestLoop {
+        std::vector<std::string> d_received;
+        std::unique_ptr<AsyncDatagramSocket> d_receiver;
+        std::unique_ptr<AsyncDatagramSocket> d_sender;
+        Datagram d_receiverAddress;
+
+        Fixture(AsyncDatagramSocketOptions const &options = AsyncDatagramSocketOptions()) {
+            sockaddr_in address = {};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+            d_receiver = AsyncDatagramSocket::bind(
+                reinterpret_cast<sockaddr *>(&address), sizeof(address), d_registry, d_pool,
+                [this](Datagram *datagrams, std::size_t count) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        d_received.emplace_back(datagrams[i].data.data(), datagrams[i].data.length);
+                    }
+                },
+                options);
+            d_sender = AsyncDatagramSocket::bind(
+                reinterpret_cast<sockaddr *>(&address), sizeof(address), d_registry, d_pool,
+                [](Datagram *, std::size_t) {},
+                options);
+
+            d_receiverAddress.addressLength = sizeof(sockaddr_storage);
+            EXPECT_EQ(0, getsockname(
+                d_receiver->fileDescriptor(),
+                reinterpret_cast<sockaddr *>(&d_receiverAddress.address),
+                &d_receiverAddress.addressLength));
+        }
+
+        std::vector<Datagram> createDatagrams(std::size_t count, std::size_t sizeInBytes) {
+            std::vector<Datagram> datagrams;
+
+            for (std::size_t i = 0; i < count; ++i) {
+                auto buffer = d_pool.allocate(sizeInBytes);
+                std::memset(buffer.data(), 'a' + i % 26, sizeInBytes);
+                auto datagram = d_receiverAddress;
+                datagram.data = io::BufferSlice{buffer, 0, sizeInBytes};
+                datagrams.push_back(datagram);
+            }
+
+            return datagrams;
+        }
+
+        void receive(std::size_t count) {
+            processUntil([&] { return d_received.size() >= count; });
+        }
+    };
+}
+
+TEST(AsyncDatagramSocket, BatchedSendAndReceive) {
+    // GIVEN
+    Fixture fixture;
+    ASSERT_NE(nullptr, fixture.d_receiver);
+    ASSERT_NE(nullptr, fixture.d_sender);
+    auto datagrams = fixture.createDatagrams(100, 100);
+
+    // WHEN
+    EXPECT_EQ(100, fixture.d_sender->send(datagrams.data(), datagrams.size()));
+    fixture.receive(100);
+
+    // THEN
+    ASSERT_EQ(100, fixture.d_received.size());
+    for (std::size_t i = 0; i < 100; ++i) {
+        EXPECT_EQ(std::string(100, 'a' + i % 26), fixture.d_received[i]);
+    }
+
+    EXPECT_EQ(100, fixture.d_sender->statistics().sentDatagrams);
+    EXPECT_GE(4, fixture.d_sender->statistics().sendCalls);
+    EXPECT_GT(100, fixture.d_receiver->statistics().receiveCalls);
+    EXPECT_EQ(0, fixture.d_sender->pendingSendCount());
+}
+
+TEST(AsyncDatagramSocket, SegmentationOffload) {
+    // GIVEN
+    AsyncDatagramSocketOptions options;
+    options.enableGso = true;
+    options.enableGro = true;
+    Fixture fixture(options);
+    ASSERT_NE(nullptr, fixture.d_receiver);
+    ASSERT_NE(nullptr, fixture.d_sender);
+    auto datagrams = fixture.createDatagrams(40, 1000);
+    datagrams.back().data.length = 500;
+
+    // WHEN
+    EXPECT_EQ(40, fixture.d_sender->send(datagrams.data(), datagrams.size()));
+    fixture.receive(40);
+
+    // THEN the datagrams arrive separately, whether they were coalesced or
+    // not.
+    ASSERT_EQ(40, fixture.d_received.size());
+    for (std::size_t i = 0; i < 39; ++i) {
+        EXPECT_EQ(std::string(1000, 'a' + i % 26), fixture.d_received[i]);
+    }
+    EXPECT_EQ(std::string(500, 'a' + 39 % 26), fixture.d_received[39]);
+
+    if (fixture.d_sender->isGsoEnabled()) {
+        EXPECT_EQ(1, fixture.d_sender->statistics().sendCalls);
+    }
+}
+
+TEST(AsyncDatagramSocket, QueueLimit) {
+    // GIVEN
+    AsyncDatagramSocketOptions options;
+    options.maxPendingSendCount = 0;
+    Fixture fixture(options);
+    ASSERT_NE(nullptr, fixture.d_sender);
+    auto datagrams = fixture.createDatagrams(3, 10);
+
+    // WHEN
+    auto count = fixture.d_sender->send(datagrams.data(), datagrams.size());
+
+    // THEN
+    EXPECT_EQ(0, count);
+    EXPECT_EQ(3, fixture.d_sender->statistics().droppedDatagrams);
+}
+
+TEST(AsyncDatagramSocket, DatagramSizeBeyondBufferPool) {
+    // GIVEN
+    test::TestLoop loop;
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    AsyncDatagramSocketOptions options;
+    options.maxDatagramSizeInBytes = io::BufferPool::c_maxBufferSize + 1;
+
+    // WHEN
+    auto socket = AsyncDatagramSocket::bind(
+        reinterpret_cast<sockaddr *>(&address), sizeof(address), loop.d_registry, loop.d_pool,
+        [](Datagram *, std::size_t) {},
+        options);
+
+    // THEN
+    EXPECT_EQ(nullptr, socket);
+}
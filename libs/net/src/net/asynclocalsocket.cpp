@@ -0,0 +1,240 @@
+#include <net/asynclocalsocket.h>
+
+#include <net/asyncconnectedsocketimpl.h>
+
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace eco {
+namespace net {
+
+namespace {
+    int toSocketType(LocalSocketType type) noexcept {
+        return type == LocalSocketType::Stream ? SOCK_STREAM : SOCK_SEQPACKET;
+    }
+
+    class AsyncLocalSocketImpl : public AsyncConnectedSocketImpl<AsyncLocalSocket> {
+        // PRIVATE TYPES
+        using Base = AsyncConnectedSocketImpl<AsyncLocalSocket>;
+
+        // PRIVATE DATA
+        std::vector<io::FileDescriptor> d_sendFileDescriptors;
+        std::vector<io::FileDescriptor> d_receivedFileDescriptors;
+        std::size_t d_truncatedMessageCount = 0;
+
+    public:
+        AsyncLocalSocketImpl(
+            io::FileDescriptor fileDescriptor,
+            std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+            std::shared_ptr<async::Dispatcher> dispatcher,
+            AsyncConnectedSocketOptions const &options)
+        : Base(fileDescriptor, std::move(registry), std::move(dispatcher), options)
+        {
+            // Sequenced packets are received one at a time, and a stream read
+            // stops before bytes that were sent with file descriptors.
+            d_isShortReadBounded = true;
+        }
+
+        ~AsyncLocalSocketImpl() override {
+            for (auto fileDescriptor : d_receivedFileDescriptors) {
+                close(fileDescriptor);
+            }
+        }
+
+        async::Future<std::size_t> writeFileDescriptorsAsync(
+            io::BufferChain buffers,
+            std::vector<io::FileDescriptor> const &fileDescriptors) noexcept override {
+            if (fileDescriptors.size() > c_maxFileDescriptorCount || buffers.empty() || !canStartWrite()) {
+                async::ResultPromise<std::size_t> promise;
+                promise.setResult(0);
+                return promise.future();
+            }
+
+            // Coalescing would send the file descriptors with other bytes, so
+            // the write is started on its own.
+            d_sendFileDescriptors = fileDescriptors;
+            return startWrite(std::move(buffers), ALL_BYTES);
+        }
+
+        std::vector<io::FileDescriptor> takeReceivedFileDescriptors() noexcept override {
+            return std::move(d_receivedFileDescriptors);
+        }
+
+        std::vector<std::unique_ptr<AsyncConnectedSocket>> adoptReceivedSockets(
+            AsyncConnectedSocketOptions const &options) noexcept override {
+            std::vector<std::unique_ptr<AsyncConnectedSocket>> sockets;
+
+            for (auto fileDescriptor : takeReceivedFileDescriptors()) {
+                auto socket = AsyncConnectedSocket::create(fileDescriptor, d_registry, d_dispatcher, options);
+
+                if (socket != nullptr) {
+                    sockets.push_back(std::move(socket));
+                }
+            }
+
+            return sockets;
+        }
+
+        std::size_t receivedFileDescriptorCount() const noexcept override {
+            return d_receivedFileDescriptors.size();
+        }
+
+        std::size_t truncatedMessageCount() const noexcept override {
+            return d_truncatedMessageCount;
+        }
+
+    protected:
+        ssize_t receive(struct iovec *ioVecs, std::size_t count) noexcept override {
+            alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * c_maxFileDescriptorCount)];
+            struct msghdr message = {};
+            message.msg_iov = ioVecs;
+            message.msg_iovlen = count;
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+
+            ssize_t result = recvmsg(d_fileDescriptor, &message, MSG_CMSG_CLOEXEC);
+
+            if (result == -1) {
+                return result;
+            }
+
+            auto previousCount = d_receivedFileDescriptors.size();
+
+            for (auto header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header)) {
+                if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+                    continue;
+                }
+
+                auto fileDescriptorCount = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+
+                for (std::size_t i = 0; i < fileDescriptorCount; ++i) {
+                    int fileDescriptor = -1;
+                    std::memcpy(&fileDescriptor, CMSG_DATA(header) + i * sizeof(int), sizeof(int));
+                    d_receivedFileDescriptors.push_back(fileDescriptor);
+                }
+            }
+
+            // The peer sent more file descriptors than fit, and the kernel
+            // closed the rest, so the received ones are incomplete. The bytes
+            // were consumed all the same and are kept, so that a stream stays
+            // intact.
+            if ((message.msg_flags & MSG_CTRUNC) != 0) {
+                for (auto i = previousCount; i < d_receivedFileDescriptors.size(); ++i) {
+                    close(d_receivedFileDescriptors[i]);
+                }
+
+                d_receivedFileDescriptors.resize(previousCount);
+                ++d_truncatedMessageCount;
+            }
+
+            return result;
+        }
+
+        ssize_t send(struct msghdr &message, int flags) noexcept override {
+            if (d_sendFileDescriptors.empty()) {
+                return Base::send(message, flags);
+            }
+
+            alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(int) * c_maxFileDescriptorCount)];
+            auto sizeInBytes = sizeof(int) * d_sendFileDescriptors.size();
+            message.msg_control = control;
+            message.msg_controllen = CMSG_SPACE(sizeInBytes);
+
+            auto header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET;
+            header->cmsg_type = SCM_RIGHTS;
+            header->cmsg_len = CMSG_LEN(sizeInBytes);
+            std::memcpy(CMSG_DATA(header), d_sendFileDescriptors.data(), sizeInBytes);
+
+            ssize_t result = Base::send(message, flags);
+            message.msg_control = nullptr;
+            message.msg_controllen = 0;
+
+            // The file descriptors are passed with the first byte that was
+            // sent.
+            if (result > 0) {
+                d_sendFileDescriptors.clear();
+            }
+
+            return result;
+        }
+    };
+}
+
+// PUBLIC STATIC CREATORS
+
+std::unique_ptr<AsyncLocalSocket> AsyncLocalSocket::create(
+    io::FileDescriptor fileDescriptor,
+    std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+    std::shared_ptr<async::Dispatcher> dispatcher,
+    AsyncConnectedSocketOptions const &options) noexcept {
+    // Coalesced writes are sent as one packet, which would merge messages.
+    auto socketOptions = options;
+    int type = 0;
+    socklen_t length = sizeof(type);
+
+    if (getsockopt(fileDescriptor, SOL_SOCKET, SO_TYPE, &type, &length) == 0 && type == SOCK_SEQPACKET) {
+        socketOptions.coalesceWrites = false;
+    }
+
+    return createSocket<AsyncLocalSocketImpl>(
+        fileDescriptor, std::move(registry), std::move(dispatcher), socketOptions);
+}
+
+std::unique_ptr<AsyncLocalSocket> AsyncLocalSocket::connect(
+    char const *path,
+    LocalSocketType type,
+    std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+    std::shared_ptr<async::Dispatcher> dispatcher,
+    AsyncConnectedSocketOptions const &options) noexcept {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+
+    if (std::strlen(path) >= sizeof(address.sun_path)) {
+        return nullptr;
+    }
+
+    std::strcpy(address.sun_path, path);
+    int fileDescriptor = socket(AF_UNIX, toSocketType(type) | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if (fileDescriptor == -1) {
+        return nullptr;
+    }
+
+    // A local connect completes immediately unless the backlog of the
+    // listener is full, which fails with `EAGAIN` instead of blocking the
+    // loop.
+    if (::connect(fileDescriptor, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1) {
+        close(fileDescriptor);
+        return nullptr;
+    }
+
+    return create(fileDescriptor, std::move(registry), std::move(dispatcher), options);
+}
+
+std::pair<std::unique_ptr<AsyncLocalSocket>, std::unique_ptr<AsyncLocalSocket>> AsyncLocalSocket::createPair(
+    LocalSocketType type,
+    std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+    std::shared_ptr<async::Dispatcher> dispatcher,
+    AsyncConnectedSocketOptions const &options) noexcept {
+    int fileDescriptors[2];
+
+    if (socketpair(AF_UNIX, toSocketType(type) | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fileDescriptors) == -1) {
+        return {};
+    }
+
+    auto first = create(fileDescriptors[0], registry, dispatcher, options);
+    auto second = create(fileDescriptors[1], registry, dispatcher, options);
+
+    if (first == nullptr || second == nullptr) {
+        return {};
+    }
+
+    return {std::move(first), std::move(second)};
+}
+
+}
+}
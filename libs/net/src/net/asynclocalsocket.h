@@ -0,0 +1,144 @@
+#ifndef ECO_NET_ASYNCLOCALSOCKET
+#define ECO_NET_ASYNCLOCALSOCKET
+
+#include <net/asyncconnectedsocket.h>
+
+#include <async/dispatcher.h>
+#include <async/future.h>
+#include <io/bufferchain.h>
+#include <io/filedescriptoreventpoller.h>
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace eco {
+namespace net {
+
+    /**
+     * @brief The types of local sockets.
+     */
+    enum class LocalSocketType {
+        /**
+         * @brief A byte stream, like TCP (`SOCK_STREAM`).
+         */
+        Stream,
+
+        /**
+         * @brief A sequence of messages whose boundaries are preserved
+         * (`SOCK_SEQPACKET`). Each read receives at most one message.
+         */
+        SequencedPacket
+    };
+
+    /**
+     * @brief Connected `AF_UNIX` socket that can pass file descriptors.
+     *
+     * Reads and writes behave like those of every `AsyncConnectedSocket`. In
+     * addition, file descriptors can be sent along with the bytes of a write
+     * (`SCM_RIGHTS`). Received file descriptors are collected by reads and
+     * can be taken as they are, or adopted as sockets that are registered in
+     * the registry of this socket, which hands accepted connections to
+     * worker processes without a further hop.
+     *
+     * This class is not thread-safe: use it on the thread that polls its
+     * registry.
+     */
+    class AsyncLocalSocket : public AsyncConnectedSocket {
+    public:
+        // PUBLIC CONSTANTS
+
+        /**
+         * @brief The most file descriptors passed with a single write or
+         * received with a single read. When the peer sent more with a single
+         * message, its bytes are still read, but its file descriptors are
+         * closed and counted by `truncatedMessageCount`.
+         */
+        static constexpr std::size_t c_maxFileDescriptorCount = 16;
+
+        // PUBLIC STATIC CREATORS
+
+        /**
+         * @brief Take ownership of the connected local socket
+         * `fileDescriptor`, as `AsyncConnectedSocket::create` does. Writes of
+         * sequenced packet sockets are never coalesced, so that each write
+         * stays a message of its own.
+         */
+        static std::unique_ptr<AsyncLocalSocket> create(
+            io::FileDescriptor fileDescriptor,
+            std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+            std::shared_ptr<async::Dispatcher> dispatcher = nullptr,
+            AsyncConnectedSocketOptions const &options = AsyncConnectedSocketOptions()) noexcept;
+
+        /**
+         * @brief Connect to the socket bound to the specified `path` with the
+         * specified `type`. Return `nullptr` on failure, with `errno` set to
+         * `EAGAIN` when the backlog of the listener is full and connecting
+         * can be retried later.
+         */
+        static std::unique_ptr<AsyncLocalSocket> connect(
+            char const *path,
+            LocalSocketType type,
+            std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+            std::shared_ptr<async::Dispatcher> dispatcher = nullptr,
+            AsyncConnectedSocketOptions const &options = AsyncConnectedSocketOptions()) noexcept;
+
+        /**
+         * @brief Create a pair of connected sockets of the specified `type`.
+         * Return a pair of `nullptr` on failure.
+         */
+        static std::pair<std::unique_ptr<AsyncLocalSocket>, std::unique_ptr<AsyncLocalSocket>> createPair(
+            LocalSocketType type,
+            std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+            std::shared_ptr<async::Dispatcher> dispatcher = nullptr,
+            AsyncConnectedSocketOptions const &options = AsyncConnectedSocketOptions()) noexcept;
+
+        // PUBLIC MANIPULATORS
+
+        /**
+         * @brief Write the specified `buffers` and pass the specified
+         * `fileDescriptors` along with their first byte. The file descriptors
+         * are duplicated into the peer, so the caller keeps ownership and can
+         * close them once the future resolved. Resolves with `0` when more
+         * than `c_maxFileDescriptorCount` file descriptors are given or
+         * another write is pending, including coalesced ones.
+         */
+        virtual async::Future<std::size_t> writeFileDescriptorsAsync(
+            io::BufferChain buffers,
+            std::vector<io::FileDescriptor> const &fileDescriptors) noexcept = 0;
+
+        /**
+         * @brief Return the file descriptors received so far and transfer
+         * their ownership to the caller.
+         */
+        virtual std::vector<io::FileDescriptor> takeReceivedFileDescriptors() noexcept = 0;
+
+        /**
+         * @brief Register the received file descriptors, which must be
+         * connected sockets, in the registry of this socket with its
+         * dispatcher and the specified `options`, and return them.
+         */
+        virtual std::vector<std::unique_ptr<AsyncConnectedSocket>> adoptReceivedSockets(
+            AsyncConnectedSocketOptions const &options = AsyncConnectedSocketOptions()) noexcept = 0;
+
+        // PUBLIC ACCESSORS
+
+        /**
+         * @brief Return the number of received file descriptors that were not
+         * taken yet.
+         */
+        virtual std::size_t receivedFileDescriptorCount() const noexcept = 0;
+
+        /**
+         * @brief Return the number of received messages whose file
+         * descriptors were closed because the peer sent more than
+         * `c_maxFileDescriptorCount` of them.
+         */
+        virtual std::size_t truncatedMessageCount() const noexcept = 0;
+    };
+
+}
+}
+
+#endif //  ECO_NET_ASYNCLOCALSOCKET
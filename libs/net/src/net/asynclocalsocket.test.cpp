@@ -0,0 +1,160 @@
+#include <net/asynclocalsocket.h>
+
+#include <net/asyncacceptor.h>
+#include <net/testloop.test.h>
+
+#include <io/bufferpool.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace eco;
+using namespace eco::net;
+
+namespace {
+    struct Fixture : test::TestLoop {
+        std::string read(AsyncConnectedSocket &socket) {
+            auto buffer = d_pool.allocate(256);
+            std::optional<std::size_t> result;
+            socket.readAsync(buffer).setResultCallback([&](std::size_t value) {
+                result = value;
+            });
+            processUntil([&] { return result.has_value(); });
+            return std::string(buffer.data(), result.value_or(0));
+        }
+    };
+}
+
+TEST(AsyncLocalSocket, SequencedPacketBoundaries) {
+    // GIVEN
+    Fixture fixture;
+    auto sockets = AsyncLocalSocket::createPair(LocalSocketType::SequencedPacket, fixture.d_registry);
+    ASSERT_NE(nullptr, sockets.first);
+    ASSERT_NE(nullptr, sockets.second);
+
+    // WHEN
+    sockets.first->writeAsync(fixture.createChain("ab"));
+    sockets.first->writeAsync(fixture.createChain("cde"));
+
+    // THEN each read receives one message.
+    EXPECT_EQ("ab", fixture.read(*sockets.second));
+    EXPECT_EQ("cde", fixture.read(*sockets.second));
+}
+
+TEST(AsyncLocalSocket, SequencedPacketsAreNotCoalesced) {
+    // GIVEN
+    Fixture fixture;
+    AsyncConnectedSocketOptions options;
+    options.coalesceWrites = true;
+    auto sockets = AsyncLocalSocket::createPair(
+        LocalSocketType::SequencedPacket, fixture.d_registry, nullptr, options);
+    ASSERT_NE(nullptr, sockets.first);
+    ASSERT_NE(nullptr, sockets.second);
+
+    // WHEN
+    sockets.first->writeAsync(fixture.createChain("ab"));
+    sockets.first->writeAsync(fixture.createChain("cde"));
+    sockets.first->flush();
+
+    // THEN each write is sent as a message of its own.
+    EXPECT_EQ(0, sockets.first->queuedWriteSizeInBytes());
+    EXPECT_EQ("ab", fixture.read(*sockets.second));
+    EXPECT_EQ("cde", fixture.read(*sockets.second));
+}
+
+TEST(AsyncLocalSocket, PassFileDescriptors) {
+    // GIVEN
+    Fixture fixture;
+    auto sockets = AsyncLocalSocket::createPair(LocalSocketType::Stream, fixture.d_registry);
+    ASSERT_NE(nullptr, sockets.first);
+    int passed[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, passed));
+
+    // WHEN
+    std::optional<std::size_t> written;
+    sockets.first->writeFileDescriptorsAsync(fixture.createChain("x"), {passed[0]}).setResultCallback([&](std::size_t value) {
+        written = value;
+    });
+    auto message = fixture.read(*sockets.second);
+    close(passed[0]);
+
+    // THEN the received socket is registered in the registry of the receiver.
+    EXPECT_EQ(1, written);
+    EXPECT_EQ("x", message);
+    ASSERT_EQ(1, sockets.second->receivedFileDescriptorCount());
+    auto adopted = sockets.second->adoptReceivedSockets();
+    ASSERT_EQ(1, adopted.size());
+    ASSERT_NE(nullptr, adopted[0]);
+    EXPECT_EQ(0, sockets.second->receivedFileDescriptorCount());
+
+    ASSERT_EQ(5, write(passed[1], "hello", 5));
+    EXPECT_EQ("hello", fixture.read(*adopted[0]));
+    close(passed[1]);
+}
+
+TEST(AsyncLocalSocket, TooManyFileDescriptors) {
+    // GIVEN
+    Fixture fixture;
+    int sockets[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+    auto sut = AsyncLocalSocket::create(sockets[0], fixture.d_registry);
+    ASSERT_NE(nullptr, sut);
+
+    // WHEN the peer sends more file descriptors than fit into a read
+    int passed[AsyncLocalSocket::c_maxFileDescriptorCount + 1];
+    std::fill(std::begin(passed), std::end(passed), sockets[1]);
+    alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(passed))];
+    char byte = 'x';
+    struct iovec ioVec = {&byte, 1};
+    struct msghdr message = {};
+    message.msg_iov = &ioVec;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    auto header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(passed));
+    std::memcpy(CMSG_DATA(header), passed, sizeof(passed));
+    ASSERT_EQ(1, sendmsg(sockets[1], &message, 0));
+
+    // THEN the bytes are read without keeping any of them.
+    EXPECT_EQ("x", fixture.read(*sut));
+    EXPECT_EQ(0, sut->readError());
+    EXPECT_EQ(0, sut->receivedFileDescriptorCount());
+    EXPECT_EQ(1, sut->truncatedMessageCount());
+    close(sockets[1]);
+}
+
+TEST(AsyncLocalSocket, ListenAndConnect) {
+    // GIVEN
+    Fixture fixture;
+    std::string path = "/tmp/asynclocalsocket.test." + std::to_string(getpid());
+    unlink(path.c_str());
+    std::unique_ptr<AsyncLocalSocket> accepted;
+    auto acceptor = AsyncAcceptor::listenLocal(
+        path.c_str(), fixture.d_registry, [&](std::unique_ptr<AsyncConnectedSocket> socket) {
+            accepted.reset(static_cast<AsyncLocalSocket *>(socket.release()));
+        });
+    ASSERT_NE(nullptr, acceptor);
+
+    // WHEN
+    auto sut = AsyncLocalSocket::connect(path.c_str(), LocalSocketType::Stream, fixture.d_registry);
+    ASSERT_NE(nullptr, sut);
+    fixture.processUntil([&] { return accepted != nullptr; });
+
+    // THEN
+    ASSERT_NE(nullptr, accepted);
+    sut->writeAsync(fixture.createChain("ping"));
+    EXPECT_EQ("ping", fixture.read(*accepted));
+
+    unlink(path.c_str());
+}
@@ -0,0 +1,50 @@
+#include <net/asyncreadthrottle.h>
+
+#include <net/asyncconnectedsocket.h>
+
+#include <algorithm>
+
+namespace eco {
+namespace net {
+
+// PUBLIC MANIPULATORS
+
+void AsyncReadThrottle::pause(AsyncConnectedSocket *socket) noexcept {
+    d_sockets.push_back(socket);
+}
+
+void AsyncReadThrottle::cancel(AsyncConnectedSocket *socket) noexcept {
+    // Resumed reads complete inline and their callbacks can destroy other
+    // sockets, so those are only cleared from the list being resumed.
+    std::replace(d_resuming.begin(), d_resuming.end(), socket, static_cast<AsyncConnectedSocket *>(nullptr));
+    d_sockets.erase(std::remove(d_sockets.begin(), d_sockets.end(), socket), d_sockets.end());
+}
+
+std::size_t AsyncReadThrottle::resumeDrained() noexcept {
+    if (d_sockets.empty()) {
+        return 0;
+    }
+
+    d_resuming.swap(d_sockets);
+    std::size_t count = 0;
+
+    for (std::size_t i = 0; i < d_resuming.size(); ++i) {
+        auto socket = d_resuming[i];
+
+        if (socket == nullptr) {
+            continue;
+        }
+
+        if (socket->resumeReading()) {
+            ++count;
+        } else if (socket->isReadPaused()) {
+            d_sockets.push_back(socket);
+        }
+    }
+
+    d_resuming.clear();
+    return count;
+}
+
+}
+}
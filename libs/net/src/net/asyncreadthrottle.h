@@ -0,0 +1,59 @@
+#ifndef ECO_NET_ASYNCREADTHROTTLE
+#define ECO_NET_ASYNCREADTHROTTLE
+
+#include <cstddef>
+#include <vector>
+
+namespace eco {
+namespace net {
+
+    class AsyncConnectedSocket;
+
+    /**
+     * @brief Collects the sockets of one event loop that paused reading
+     * because their memory budget was exhausted, and resumes them once per
+     * loop iteration when it drained.
+     *
+     * A socket whose own budget drains is resumed as soon as the bytes are
+     * released, but a budget shared by many sockets can be drained by any of
+     * them, or by another thread, so the paused sockets are checked here.
+     *
+     * This class is not thread-safe: use it on the thread of its loop.
+     */
+    class AsyncReadThrottle {
+        // PRIVATE DATA
+        std::vector<AsyncConnectedSocket *> d_sockets;
+        std::vector<AsyncConnectedSocket *> d_resuming;
+
+    public:
+        // PUBLIC MANIPULATORS
+
+        /**
+         * @brief Check the specified `socket`, which paused reading, on the
+         * next call of `resumeDrained`.
+         */
+        void pause(AsyncConnectedSocket *socket) noexcept;
+
+        /**
+         * @brief Do not check the specified `socket`, which resumed reading or
+         * is being destroyed.
+         */
+        void cancel(AsyncConnectedSocket *socket) noexcept;
+
+        /**
+         * @brief Resume reading of the paused sockets whose budgets drained,
+         * and return their number. The others stay paused.
+         */
+        std::size_t resumeDrained() noexcept;
+
+        // PUBLIC ACCESSORS
+
+        std::size_t pausedCount() const noexcept {
+            return d_sockets.size();
+        }
+    };
+
+}
+}
+
+#endif //  ECO_NET_ASYNCREADTHROTTLE
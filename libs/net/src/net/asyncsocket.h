@@ -0,0 +1,35 @@
+#ifndef ECO_NET_ASYNCSOCKET
+#define ECO_NET_ASYNCSOCKET
+
+#include <io/filedescriptor.h>
+#include <io/filedescriptoreventpoller.h>
+
+namespace eco {
+namespace net {
+
+    /**
+     * @brief Base class of sockets that are driven by the events of a
+     * `io::FileDescriptorEventPoller`.
+     *
+     * Sockets register themselves as the user data of their file descriptor,
+     * so the loop that retrieves an event hands it to `onEvent` of the socket.
+     */
+    class AsyncSocket : public io::FileDescriptorEventUserData {
+    public:
+        // PUBLIC MANIPULATORS
+
+        /**
+         * @brief Advance the pending operations of the socket after the
+         * specified `eventType` was retrieved for its file descriptor.
+         */
+        void onEvent(io::FileDescriptorEventType eventType) noexcept override = 0;
+
+        // PUBLIC ACCESSORS
+
+        virtual io::FileDescriptor fileDescriptor() const noexcept = 0;
+    };
+
+}
+}
+
+#endif //  ECO_NET_ASYNCSOCKET
@@ -3,68 +3,105 @@
 namespace eco {
 namespace net {
 
-// namespace {
-//     struct RegistrationImpl : AsyncSocketManager::Registration {
-//         AsyncSocketManager *d_manager;
-//         AsyncSocket *d_socket;
-//         std::mutex d_mutex;
-//         size_t d_minimumReadByteCount = 0;
-//         size_t d_minimumWriteByteCount = 0;
-//         std::shared_ptr<AsyncContext> d_asyncReadContext;
-//         std::shared_ptr<AsyncContext> d_asyncWriteContext;
-//         std::vector<std::shared_ptr<Buffer>> d_readBuffers;
-//         std::vector<std::shared_ptr<Buffer>> d_writeBuffers;
-
-//         Registration(AsyncSocketManager *manager, AsyncSocket *socket)
-//         : d_manager(manager)
-//         , d_socket(socket)
-//         {
-//         }
-
-//         ~Registration() {
-//             d_manager->unregisterSocket(d_socket);
-//         }
-//     };
-// }
-
-// static std::shared_ptr<AsyncSocketManager> AsyncSocketManager::instance(std::unique_ptr<AsyncSocketManager> setInstance) {
-//     static std::weak_ptr<AsyncSocketManager> s_instance;
-//     static std::mutex s_mutex;
-
-//     auto lock = std::lock_guard(d_mutex);
-
-//     if (setInstance != nullptr) {
-//         auto object = std::shared_ptr<AsyncSocketManager>(setInstance);
-//         s_instance = object;
-//         return std::move(object);
-//         // TODO: clear s_instance in deleter!
-//     }
-    
-//     auto object = s_instance.lock();
-//     if (object == nullptr) {
-//         auto newObject = new AsyncSocketManager();
-//         s_instance = object = std::shared_ptr<AsyncSocketManager>(newObject, [](AsyncSocketManager *newObject){
-//             auto lock = std::lock_guard(d_mutex);
-//             // If we don't do this the weak_ptr will keep a reference to the
-//             // shared_ptr data and the memory is not released, even if the
-//             // object is destructed.
-//             if (s_instance.get() == newObject) {
-//                 s_instance.reset();
-//             }
-//             delete newObject;
-//         });
-//     }
-
-//     return object;
-// }
-
-// void AsyncSocketManager::unregisterSocket(AsyncSocket *socket) {
-
-// }
-
-// std::shared_ptr<Registration> AsyncSocketManager::registerSocket(AsyncSocket *socket) {
-
-// }
+// PUBLIC CREATORS
 
+AsyncSocketManager::AsyncSocketManager(
+    std::shared_ptr<async::Dispatcher> dispatcher,
+    std::shared_ptr<io::FileDescriptorEventRegistry> registry)
+: d_registry(std::move(registry))
+, d_dispatcher(std::move(dispatcher))
+, d_poller(d_registry)
+{
+}
+
+AsyncSocketManager::AsyncSocketManager(
+    std::shared_ptr<async::Dispatcher> dispatcher)
+: AsyncSocketManager(
+    std::move(dispatcher),
+    io::FileDescriptorEventRegistry::createSystemDefault())
+{
+}
+
+// PUBLIC MANIPULATORS
+
+std::unique_ptr<AsyncConnectedSocket> AsyncSocketManager::createConnectedSocket(
+    io::FileDescriptor fileDescriptor,
+    AsyncConnectedSocketOptions const &options) noexcept {
+    return AsyncConnectedSocket::create(
+        fileDescriptor, d_registry, d_dispatcher, withLoop(options));
+}
+
+std::unique_ptr<AsyncAcceptor> AsyncSocketManager::listen(
+    sockaddr const *address,
+    socklen_t addressLength,
+    AsyncAcceptor::AcceptCallback callback,
+    AsyncAcceptorOptions const &options) noexcept {
+    auto acceptorOptions = options;
+    acceptorOptions.socketOptions = withLoop(options.socketOptions);
+
+    return AsyncAcceptor::listen(
+        address, addressLength, d_registry, std::move(callback), acceptorOptions, d_dispatcher);
+}
+
+int AsyncSocketManager::processEvents(std::chrono::nanoseconds const &timeout) noexcept {
+    // Functions that were deferred and writes that were queued since the
+    // last call, for example by dispatched functions, are handled before
+    // blocking, and sockets whose budget drained meanwhile read again.
+    runDeferredFunctions();
+    d_throttle.resumeDrained();
+    d_flusher.flushAll();
+
+    int count = d_poller.waitForEvents(d_events, timeout);
+
+    // Handlers can destroy the sockets of later events in the batch, whose
+    // events are then skipped.
+    if (count > 0) {
+        io::FileDescriptorEventPoller::dispatch(d_events.data(), static_cast<std::size_t>(count));
+    }
+
+    runDeferredFunctions();
+    d_throttle.resumeDrained();
+    d_flusher.flushAll();
+    d_zeroCopyDrain.drain();
+    return count;
+}
+
+void AsyncSocketManager::defer(DeferredFunction function) noexcept {
+    d_deferredFunctions.push_back(std::move(function));
+}
+
+// PRIVATE MANIPULATORS
+
+void AsyncSocketManager::runDeferredFunctions() noexcept {
+    while (!d_deferredFunctions.empty()) {
+        d_runningFunctions.swap(d_deferredFunctions);
+
+        for (auto &function : d_runningFunctions) {
+            function();
+        }
+
+        d_runningFunctions.clear();
+    }
+}
+
+AsyncConnectedSocketOptions AsyncSocketManager::withLoop(
+    AsyncConnectedSocketOptions const &options) noexcept {
+    auto result = options;
+
+    if (result.coalesceWrites && result.flusher == nullptr) {
+        result.flusher = &d_flusher;
+    }
+
+    if (result.zeroCopyThresholdInBytes > 0 && result.zeroCopyDrain == nullptr) {
+        result.zeroCopyDrain = &d_zeroCopyDrain;
+    }
+
+    if (result.readThrottle == nullptr) {
+        result.readThrottle = &d_throttle;
+    }
+
+    return result;
+}
+
+}
 }
-}
\ No newline at end of file
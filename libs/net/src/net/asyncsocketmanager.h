@@ -1,40 +1,175 @@
-#ifndef ECO_ASYNC_ASYNCSOCKETMANAGER
-#define ECO_ASYNC_ASYNCSOCKETMANAGER
+#ifndef ECO_NET_ASYNCSOCKETMANAGER
+#define ECO_NET_ASYNCSOCKETMANAGER
 
+#include <net/asyncacceptor.h>
+#include <net/asyncconnectedsocket.h>
+#include <net/asyncreadthrottle.h>
+#include <net/asyncsocket.h>
+#include <net/asyncwriteflusher.h>
+#include <net/asynczerocopydrain.h>
+
+#include <async/dispatcher.h>
+#include <io/filedescriptoreventpoller.h>
+
+#include <array>
+#include <chrono>
+#include <functional>
 #include <memory>
-#include <mutex>
+#include <vector>
 
 namespace eco {
-namespace async {
-// class AsyncSocketManager {
-// public:
-//     class AsyncSocket {
-//     public:
-//         virtual int socketFileDescriptor() noexcept = 0;
-//         virtual void onReadCompleted() noexcept = 0;
-//         virtual void onWriteCompleted() noexcept = 0;
-//         // TODO: onConnectionAccepted() ?
-//     };
-
-//     class Registration {
-//     public:
-//         virtual ~Registration() {}
-//         virtual void setWriteOperation(std::vector<std::shared_ptr<Buffer> buffers, size_t mimimumBytes, std::shared_ptr<AsyncContext> asyncContext);
-//         virtual void setReadOperation(std::vector<std::shared_ptr<Buffer> buffers, size_t mimimumBytes, std::shared_ptr<AsyncContext> asyncContext);
-//     };
-// private:
-
-//     void unregisterSocket(AsyncSocket *socket);
-
-// public:
-
-//     static std::shared_ptr<AsyncSocketManager> instance(std::unique_ptr<AsyncSocketManager> setInstance = nullptr);
-
-//     std::shared_ptr<Registration> registerSocket(AsyncSocket *socket);
-    
-
-// };
+namespace net {
+
+    /**
+     * @brief Drives the sockets of one event loop.
+     *
+     * A manager owns a poller of its registry and hands each retrieved event
+     * to `onEvent` of the user data of the file descriptor, so no lookup
+     * table or lock is involved. Completions of the
+     * sockets it creates are dispatched to its dispatcher, their coalesced
+     * writes are flushed once per call of `processEvents`, and those that
+     * paused reading for their memory budget are resumed by it once the
+     * budget drained. Sockets destroyed while the kernel still referenced
+     * the buffers of their zero copy sends are closed by it once it released
+     * them. Work that must not happen within a callback, like
+     * destroying the socket whose callback runs, can be deferred until the
+     * batch of events was handed out.
+     *
+     * Create one manager per loop, typically one per core. Managers can use
+     * separate registries, or share a sharded registry in which case each
+     * manager gets its own poller of it. Besides sockets, the loop can drive
+     * any other user data that handles its events in `onEvent`, like
+     * `io::SharedMemoryRing`, `io::AsyncFileIo` and
+     * `io::FileDescriptorTransfer`.
+     *
+     * This class is not thread-safe: use it on the thread of its loop.
+     */
+    class AsyncSocketManager {
+    public:
+        // PUBLIC TYPES
+        using DeferredFunction = std::function<void()>;
+
+    private:
+        // PRIVATE CONSTANTS
+        static constexpr std::size_t c_eventBatchSize = 256;
+
+        // PRIVATE DATA
+        std::shared_ptr<io::FileDescriptorEventRegistry> d_registry;
+        std::shared_ptr<async::Dispatcher> d_dispatcher;
+        io::FileDescriptorEventPoller d_poller;
+        AsyncWriteFlusher d_flusher;
+        AsyncReadThrottle d_throttle;
+        AsyncZeroCopyDrain d_zeroCopyDrain;
+        std::array<io::FileDescriptorEvent, c_eventBatchSize> d_events;
+        std::vector<DeferredFunction> d_deferredFunctions;
+        std::vector<DeferredFunction> d_runningFunctions;
+
+    public:
+        // PUBLIC CREATORS
+
+        /**
+         * @brief Create a manager that dispatches completions to the specified
+         * `dispatcher`, or completes them inline when it is `nullptr`, and
+         * polls the specified `registry`.
+         */
+        AsyncSocketManager(
+            std::shared_ptr<async::Dispatcher> dispatcher,
+            std::shared_ptr<io::FileDescriptorEventRegistry> registry);
+
+        /**
+         * @brief Create a manager with its own registry that dispatches
+         * completions to the specified `dispatcher`.
+         */
+        explicit AsyncSocketManager(
+            std::shared_ptr<async::Dispatcher> dispatcher = nullptr);
+
+        AsyncSocketManager(AsyncSocketManager const &) = delete;
+        AsyncSocketManager &operator=(AsyncSocketManager const &) = delete;
+
+        // PUBLIC MANIPULATORS
+
+        /**
+         * @brief Take ownership of the connected `fileDescriptor` and return a
+         * socket with the specified `options` that is driven by this manager,
+         * or `nullptr` on failure.
+         */
+        std::unique_ptr<AsyncConnectedSocket> createConnectedSocket(
+            io::FileDescriptor fileDescriptor,
+            AsyncConnectedSocketOptions const &options = AsyncConnectedSocketOptions()) noexcept;
+
+        /**
+         * @brief Listen on the specified `address` of the specified
+         * `addressLength` with the specified `options` and pass the accepted
+         * connections, driven by this manager, to the specified `callback`.
+         * Return `nullptr` on failure.
+         */
+        std::unique_ptr<AsyncAcceptor> listen(
+            sockaddr const *address,
+            socklen_t addressLength,
+            AsyncAcceptor::AcceptCallback callback,
+            AsyncAcceptorOptions const &options = AsyncAcceptorOptions()) noexcept;
+
+        /**
+         * @brief Flush coalesced writes, wait for at most the specified
+         * `timeout` for events, hand them to their user data and flush the
+         * writes they caused. Deferred functions run, and paused sockets
+         * whose memory budget drained resume reading, before and after
+         * waiting. Destroyed sockets whose zero copy sends completed are
+         * closed after waiting. Return the number of handled events or `-1`
+         * on error.
+         */
+        int processEvents(std::chrono::nanoseconds const &timeout) noexcept;
+
+        /**
+         * @brief Call the specified `function` once the current batch of
+         * events was handed out, or before the next wait when called outside
+         * of `processEvents`.
+         */
+        void defer(DeferredFunction function) noexcept;
+
+        io::FileDescriptorEventPoller &poller() noexcept {
+            return d_poller;
+        }
+
+        AsyncWriteFlusher &flusher() noexcept {
+            return d_flusher;
+        }
+
+        AsyncReadThrottle &throttle() noexcept {
+            return d_throttle;
+        }
+
+        AsyncZeroCopyDrain &zeroCopyDrain() noexcept {
+            return d_zeroCopyDrain;
+        }
+
+        // PUBLIC ACCESSORS
+
+        std::shared_ptr<io::FileDescriptorEventRegistry> const &registry() const noexcept {
+            return d_registry;
+        }
+
+        std::shared_ptr<async::Dispatcher> const &dispatcher() const noexcept {
+            return d_dispatcher;
+        }
+
+    private:
+        // PRIVATE MANIPULATORS
+
+        /**
+         * @brief Call the deferred functions, including those they defer.
+         */
+        void runDeferredFunctions() noexcept;
+
+        /**
+         * @brief Return the specified `options` with the flusher of this
+         * manager when writes are coalesced, with its zero copy drain when
+         * zero copy is enabled, and with its throttle.
+         */
+        AsyncConnectedSocketOptions withLoop(AsyncConnectedSocketOptions const &options) noexcept;
+    };
+
 }
 }
 
-#endif //  ECO_ASYNC_ASYNCSOCKETMANAGER
\ No newline at end of file
+#endif //  ECO_NET_ASYNCSOCKETMANAGER
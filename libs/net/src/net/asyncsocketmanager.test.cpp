@@ -0,0 +1,252 @@
+#include <net/asyncsocketmanager.h>
+
+#include <net/testloop.test.h>
+
+#include <io/bufferpool.h>
+#include <io/sharedmemoryring.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace eco;
+using namespace eco::net;
+
+namespace {
+    using test::QueueDispatcher;
+
+    /**
+     * Process events of the specified `manager` until the specified `result`
+     * is set or one second passed.
+     */
+    void processUntil(
+        AsyncSocketManager &manager,
+        std::optional<std::size_t> const &result,
+        QueueDispatcher *dispatcher = nullptr) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+
+        while (!result && std::chrono::steady_clock::now() < deadline) {
+            manager.processEvents(std::chrono::milliseconds(10));
+
+            if (dispatcher != nullptr) {
+                dispatcher->runAll();
+            }
+        }
+    }
+}
+
+TEST(AsyncSocketManager, DispatchesCompletions) {
+    // GIVEN
+    auto dispatcher = std::make_shared<QueueDispatcher>();
+    AsyncSocketManager sut(dispatcher);
+    io::BufferPool pool;
+
+    int sockets[2];
+    ASSERT_EQ(0, socketpair(PF_LOCAL, SOCK_STREAM, 0, sockets));
+    auto socket = sut.createConnectedSocket(sockets[0]);
+    ASSERT_NE(nullptr, socket);
+
+    auto buffer = pool.allocate(256);
+    std::optional<std::size_t> result;
+    socket->readAsync(buffer, 5).setResultCallback([&](std::size_t value) {
+        result = value;
+    });
+
+    // WHEN
+    ASSERT_EQ(5, write(sockets[1], "hello", 5));
+    while (dispatcher->d_functions.empty() && sut.processEvents(std::chrono::seconds(1)) > 0) {
+    }
+
+    // THEN the read completes only when the dispatched function runs.
+    EXPECT_FALSE(result);
+    ASSERT_EQ(1, dispatcher->d_functions.size());
+    dispatcher->runAll();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(5, *result);
+    EXPECT_EQ(0, std::memcmp("hello", buffer.data(), 5));
+
+    close(sockets[1]);
+}
+
+TEST(AsyncSocketManager, ManagerPerThread) {
+    // GIVEN
+    auto run = [](char const *text, std::optional<std::size_t> &result) {
+        AsyncSocketManager manager;
+        io::BufferPool pool;
+
+        int sockets[2];
+        ASSERT_EQ(0, socketpair(PF_LOCAL, SOCK_STREAM, 0, sockets));
+        auto socket = manager.createConnectedSocket(sockets[0]);
+        ASSERT_NE(nullptr, socket);
+
+        auto buffer = pool.allocate(256);
+        socket->readAsync(buffer, std::strlen(text)).setResultCallback([&](std::size_t value) {
+            result = value;
+        });
+
+        ASSERT_EQ(std::strlen(text), write(sockets[1], text, std::strlen(text)));
+        processUntil(manager, result);
+
+        if (result) {
+            EXPECT_EQ(0, std::memcmp(text, buffer.data(), *result));
+        }
+
+        close(sockets[1]);
+    };
+
+    std::optional<std::size_t> first;
+    std::optional<std::size_t> second;
+
+    // WHEN
+    std::thread firstThread(run, "first loop", std::ref(first));
+    std::thread secondThread(run, "second", std::ref(second));
+    firstThread.join();
+    secondThread.join();
+
+    // THEN
+    ASSERT_TRUE(first);
+    EXPECT_EQ(10, *first);
+    ASSERT_TRUE(second);
+    EXPECT_EQ(6, *second);
+}
+
+TEST(AsyncSocketManager, FlushesCoalescedWritesPerIteration) {
+    // GIVEN
+    AsyncSocketManager sut;
+    io::BufferPool pool;
+
+    int sockets[2];
+    ASSERT_EQ(0, socketpair(PF_LOCAL, SOCK_STREAM, 0, sockets));
+    AsyncConnectedSocketOptions options;
+    options.coalesceWrites = true;
+    auto socket = sut.createConnectedSocket(sockets[0], options);
+    ASSERT_NE(nullptr, socket);
+
+    std::size_t completed = 0;
+    for (int i = 0; i < 10; ++i) {
+        auto buffer = pool.allocate(1);
+        buffer.data()[0] = static_cast<char>('0' + i);
+        io::BufferChain chain;
+        chain.append(buffer, 0, 1);
+        socket->writeAsync(std::move(chain)).setResultCallback([&](std::size_t) {
+            ++completed;
+        });
+    }
+    EXPECT_EQ(0, completed);
+
+    // WHEN
+    sut.processEvents(std::chrono::nanoseconds(0));
+
+    // THEN
+    EXPECT_EQ(10, completed);
+    EXPECT_EQ(1, socket->statistics().writeSystemCallCount);
+    EXPECT_EQ(9, socket->statistics().savedSystemCallCount());
+    EXPECT_TRUE(sut.flusher().empty());
+
+    char buffer[16] = {};
+    EXPECT_EQ(10, read(sockets[1], buffer, sizeof(buffer)));
+    EXPECT_STREQ("0123456789", buffer);
+
+    close(sockets[1]);
+}
+
+TEST(AsyncSocketManager, ResumesReadingWhenSharedBudgetDrains) {
+    // GIVEN two connections that share a budget
+    AsyncSocketManager sut;
+    io::BufferPool pool;
+    auto process = std::make_shared<io::MemoryBudget>(100);
+    AsyncConnectedSocketOptions options;
+    options.sharedMemoryBudget = process;
+
+    int sockets[2];
+    ASSERT_EQ(0, socketpair(PF_LOCAL, SOCK_STREAM, 0, sockets));
+    auto socket = sut.createConnectedSocket(sockets[0], options);
+    ASSERT_NE(nullptr, socket);
+    io::MemoryBudget other(io::MemoryBudget::c_unlimited, process);
+
+    // WHEN the other connection exhausts the shared budget
+    other.charge(100);
+    std::optional<std::size_t> result;
+    socket->readAsync(pool.allocate(16)).setResultCallback([&](std::size_t value) {
+        result = value;
+    });
+    ASSERT_EQ(5, write(sockets[1], "hello", 5));
+    sut.processEvents(std::chrono::milliseconds(10));
+
+    // THEN the socket waits for it to drain
+    EXPECT_FALSE(result);
+    EXPECT_TRUE(socket->isReadPaused());
+    EXPECT_EQ(1, sut.throttle().pausedCount());
+
+    // WHEN
+    other.release(100);
+    processUntil(sut, result);
+
+    // THEN
+    EXPECT_EQ(5, result);
+    EXPECT_FALSE(socket->isReadPaused());
+    EXPECT_EQ(0, sut.throttle().pausedCount());
+
+    close(sockets[1]);
+}
+
+TEST(AsyncSocketManager, DrivesOtherUserData) {
+    // GIVEN a socket and a shared memory ring in the same loop
+    AsyncSocketManager sut;
+    io::BufferPool pool;
+
+    int sockets[2];
+    ASSERT_EQ(0, socketpair(PF_LOCAL, SOCK_STREAM, 0, sockets));
+    auto socket = sut.createConnectedSocket(sockets[0]);
+    ASSERT_NE(nullptr, socket);
+
+    auto ring = io::SharedMemoryRing::create(4096);
+    ASSERT_NE(nullptr, ring);
+    std::string received;
+    ASSERT_TRUE(ring->registerDoorbell(sut.registry(), [&](io::SharedMemoryRing &ring) {
+        ring.consume([&](char const *data, std::size_t sizeInBytes) {
+            received.append(data, sizeInBytes);
+        });
+    }));
+
+    std::optional<std::size_t> result;
+    socket->readAsync(pool.allocate(16)).setResultCallback([&](std::size_t value) {
+        result = value;
+    });
+
+    // WHEN
+    ASSERT_TRUE(ring->write("ring", 4));
+    ASSERT_EQ(5, write(sockets[1], "hello", 5));
+    processUntil(sut, result);
+    sut.processEvents(std::chrono::milliseconds(0));
+
+    // THEN both are handed their events
+    EXPECT_EQ(5, result);
+    EXPECT_EQ("ring", received);
+
+    close(sockets[1]);
+}
+
+TEST(AsyncSocketManager, RunsDeferredFunctions) {
+    // GIVEN
+    AsyncSocketManager sut;
+    std::vector<int> calls;
+
+    // WHEN a deferred function defers another one
+    sut.defer([&] {
+        calls.push_back(1);
+        sut.defer([&] { calls.push_back(2); });
+    });
+    EXPECT_TRUE(calls.empty());
+    sut.processEvents(std::chrono::milliseconds(0));
+
+    // THEN both run with the next call.
+    EXPECT_EQ((std::vector<int>{1, 2}), calls);
+}
@@ -0,0 +1,40 @@
+#include <net/asyncwriteflusher.h>
+
+#include <net/asyncconnectedsocket.h>
+
+#include <algorithm>
+
+namespace eco {
+namespace net {
+
+// PUBLIC MANIPULATORS
+
+void AsyncWriteFlusher::schedule(AsyncConnectedSocket *socket) noexcept {
+    d_sockets.push_back(socket);
+}
+
+void AsyncWriteFlusher::cancel(AsyncConnectedSocket *socket) noexcept {
+    // A socket can be destroyed by a completion callback while others are
+    // flushed, so it is only cleared from the list being flushed.
+    std::replace(d_flushing.begin(), d_flushing.end(), socket, static_cast<AsyncConnectedSocket *>(nullptr));
+    d_sockets.erase(std::remove(d_sockets.begin(), d_sockets.end(), socket), d_sockets.end());
+}
+
+void AsyncWriteFlusher::flushAll() noexcept {
+    if (d_sockets.empty()) {
+        return;
+    }
+
+    d_flushing.swap(d_sockets);
+
+    for (std::size_t i = 0; i < d_flushing.size(); ++i) {
+        if (d_flushing[i] != nullptr) {
+            d_flushing[i]->flushScheduled();
+        }
+    }
+
+    d_flushing.clear();
+}
+
+}
+}
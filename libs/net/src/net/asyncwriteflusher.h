@@ -0,0 +1,55 @@
+#ifndef ECO_NET_ASYNCWRITEFLUSHER
+#define ECO_NET_ASYNCWRITEFLUSHER
+
+#include <vector>
+
+namespace eco {
+namespace net {
+
+    class AsyncConnectedSocket;
+
+    /**
+     * @brief Collects the sockets with coalesced writes of one event loop and
+     * flushes them once per loop iteration.
+     *
+     * Sockets schedule themselves when the first write is queued after a
+     * flush, so `flushAll` only visits sockets that have queued writes.
+     *
+     * This class is not thread-safe: use it on the thread of its loop.
+     */
+    class AsyncWriteFlusher {
+        // PRIVATE DATA
+        std::vector<AsyncConnectedSocket *> d_sockets;
+        std::vector<AsyncConnectedSocket *> d_flushing;
+
+    public:
+        // PUBLIC MANIPULATORS
+
+        /**
+         * @brief Flush the specified `socket` on the next call of `flushAll`.
+         */
+        void schedule(AsyncConnectedSocket *socket) noexcept;
+
+        /**
+         * @brief Do not flush the specified `socket`, which is being
+         * destroyed.
+         */
+        void cancel(AsyncConnectedSocket *socket) noexcept;
+
+        /**
+         * @brief Flush all scheduled sockets. Sockets that are scheduled while
+         * flushing are flushed on the next call.
+         */
+        void flushAll() noexcept;
+
+        // PUBLIC ACCESSORS
+
+        bool empty() const noexcept {
+            return d_sockets.empty();
+        }
+    };
+
+}
+}
+
+#endif //  ECO_NET_ASYNCWRITEFLUSHER
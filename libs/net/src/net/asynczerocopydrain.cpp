@@ -0,0 +1,116 @@
+#include <net/asynczerocopydrain.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#if __linux__
+#include <linux/errqueue.h>
+#endif
+
+namespace eco {
+namespace net {
+
+bool reapZeroCopySends(
+    io::FileDescriptor fileDescriptor,
+    std::deque<ZeroCopySend> &sends,
+    std::uint64_t &copiedCount) noexcept {
+    bool hasCompletions = false;
+
+#if __linux__
+    while (true) {
+        char control[CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6))];
+        struct msghdr message = {};
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        if (recvmsg(fileDescriptor, &message, MSG_ERRQUEUE) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            break;
+        }
+
+        for (auto header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header)) {
+            bool isError = (header->cmsg_level == SOL_IP && header->cmsg_type == IP_RECVERR) ||
+                (header->cmsg_level == SOL_IPV6 && header->cmsg_type == IPV6_RECVERR);
+
+            if (!isError) {
+                continue;
+            }
+
+            sock_extended_err error;
+            std::memcpy(&error, CMSG_DATA(header), sizeof(error));
+
+            if (error.ee_errno != 0 || error.ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                continue;
+            }
+
+            // The completion covers the sequence numbers from `ee_info` to
+            // `ee_data`, which wrap around.
+            std::uint32_t first = error.ee_info;
+            std::uint32_t last = error.ee_data;
+            hasCompletions = true;
+
+            if ((error.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0) {
+                copiedCount += last - first + 1;
+            }
+
+            sends.erase(
+                std::remove_if(sends.begin(), sends.end(), [&](ZeroCopySend const &send) {
+                    return send.d_sequence - first <= last - first;
+                }),
+                sends.end());
+        }
+    }
+#endif
+
+    return hasCompletions;
+}
+
+// PUBLIC CREATORS
+
+AsyncZeroCopyDrain::~AsyncZeroCopyDrain() {
+    for (auto &socket : d_sockets) {
+        struct linger reset = {1, 0};
+        setsockopt(socket.d_fileDescriptor, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+        close(socket.d_fileDescriptor);
+    }
+}
+
+// PUBLIC MANIPULATORS
+
+void AsyncZeroCopyDrain::park(io::FileDescriptor fileDescriptor, std::deque<ZeroCopySend> sends) noexcept {
+    shutdown(fileDescriptor, SHUT_RDWR);
+    d_sockets.push_back(ParkedSocket{fileDescriptor, std::move(sends)});
+}
+
+std::size_t AsyncZeroCopyDrain::drain() noexcept {
+    std::size_t count = 0;
+    std::uint64_t copiedCount = 0;
+
+    for (std::size_t i = 0; i < d_sockets.size();) {
+        auto &socket = d_sockets[i];
+        reapZeroCopySends(socket.d_fileDescriptor, socket.d_sends, copiedCount);
+
+        if (!socket.d_sends.empty()) {
+            ++i;
+            continue;
+        }
+
+        close(socket.d_fileDescriptor);
+        std::swap(socket, d_sockets.back());
+        d_sockets.pop_back();
+        ++count;
+    }
+
+    return count;
+}
+
+}
+}
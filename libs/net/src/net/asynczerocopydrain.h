@@ -0,0 +1,98 @@
+#ifndef ECO_NET_ASYNCZEROCOPYDRAIN
+#define ECO_NET_ASYNCZEROCOPYDRAIN
+
+#include <io/bufferchain.h>
+#include <io/filedescriptor.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace eco {
+namespace net {
+
+    /**
+     * @brief A send with `MSG_ZEROCOPY` whose buffers the kernel references
+     * until it signals the completion of its sequence number.
+     */
+    struct ZeroCopySend {
+        std::uint32_t d_sequence = 0;
+        io::BufferChain d_buffers;
+    };
+
+    /**
+     * @brief Read the zero copy completions from the error queue of the
+     * specified `fileDescriptor`, remove the completed sends from the
+     * specified `sends` and add the number of sends the kernel copied after
+     * all to the specified `copiedCount`. Return `true` when any completion
+     * was read.
+     */
+    bool reapZeroCopySends(
+        io::FileDescriptor fileDescriptor,
+        std::deque<ZeroCopySend> &sends,
+        std::uint64_t &copiedCount) noexcept;
+
+    /**
+     * @brief Keeps the sockets of one event loop that were destroyed while
+     * the kernel still referenced the buffers of their zero copy sends, and
+     * closes them once per loop iteration when it released all of them.
+     *
+     * Releasing the buffers earlier would return them to their pool, which
+     * can hand them out again while the kernel still transmits from them.
+     * Parked sockets are shut down, so the peer sees the connection close
+     * right away.
+     *
+     * This class is not thread-safe: use it on the thread of its loop.
+     */
+    class AsyncZeroCopyDrain {
+        // PRIVATE TYPES
+        struct ParkedSocket {
+            io::FileDescriptor d_fileDescriptor = -1;
+            std::deque<ZeroCopySend> d_sends;
+        };
+
+        // PRIVATE DATA
+        std::vector<ParkedSocket> d_sockets;
+
+    public:
+        // PUBLIC CREATORS
+
+        AsyncZeroCopyDrain() = default;
+
+        AsyncZeroCopyDrain(AsyncZeroCopyDrain const &) = delete;
+        AsyncZeroCopyDrain &operator=(AsyncZeroCopyDrain const &) = delete;
+
+        /**
+         * @brief Reset the connections that are still parked, which makes the
+         * kernel drop their unsent bytes instead of transmitting buffers that
+         * are released.
+         */
+        ~AsyncZeroCopyDrain();
+
+        // PUBLIC MANIPULATORS
+
+        /**
+         * @brief Take ownership of the specified `fileDescriptor` of a
+         * destroyed socket, which must not be registered anymore, and keep
+         * the specified pending `sends` until the kernel completed them.
+         */
+        void park(io::FileDescriptor fileDescriptor, std::deque<ZeroCopySend> sends) noexcept;
+
+        /**
+         * @brief Read the completions of the parked sockets, and close those
+         * whose sends all completed. Return their number.
+         */
+        std::size_t drain() noexcept;
+
+        // PUBLIC ACCESSORS
+
+        std::size_t parkedCount() const noexcept {
+            return d_sockets.size();
+        }
+    };
+
+}
+}
+
+#endif //  ECO_NET_ASYNCZEROCOPYDRAIN
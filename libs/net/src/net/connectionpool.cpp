@@ -0,0 +1,197 @@
+#include <net/connectionpool.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+
+namespace eco {
+namespace net {
+
+// PRIVATE TYPES
+
+ConnectionPool::EndpointKey::EndpointKey(sockaddr const *address, socklen_t addressLength) noexcept
+: d_addressLength(std::min<socklen_t>(addressLength, sizeof(sockaddr_storage)))
+{
+    std::memcpy(&d_address, address, d_addressLength);
+}
+
+bool ConnectionPool::EndpointKey::operator==(EndpointKey const &other) const noexcept {
+    return d_addressLength == other.d_addressLength &&
+        std::memcmp(&d_address, &other.d_address, d_addressLength) == 0;
+}
+
+std::size_t ConnectionPool::EndpointKeyHash::operator()(EndpointKey const &key) const noexcept {
+    // FNV-1a over the bytes of the address.
+    std::uint64_t hash = 14695981039346656037ull;
+    auto bytes = reinterpret_cast<unsigned char const *>(&key.d_address);
+
+    for (socklen_t i = 0; i < key.d_addressLength; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+
+    return static_cast<std::size_t>(hash);
+}
+
+// PUBLIC CREATORS
+
+ConnectionPool::ConnectionPool(
+    std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+    std::shared_ptr<async::Dispatcher> dispatcher,
+    ConnectionPoolOptions const &options)
+: d_options(options)
+, d_connector(std::move(registry), std::move(dispatcher), options.socketOptions)
+{
+}
+
+ConnectionPool::~ConnectionPool() {
+    // Waiters are resolved first, so that canceled connects do not start new
+    // ones for them.
+    for (auto &entry : d_endpoints) {
+        auto waiters = std::move(entry.second.d_waiters);
+        entry.second.d_waiters.clear();
+
+        for (auto &promise : waiters) {
+            promise.setResult(nullptr);
+        }
+    }
+}
+
+// PUBLIC MANIPULATORS
+
+ConnectionPool::SocketFuture ConnectionPool::checkout(
+    sockaddr const *address,
+    socklen_t addressLength) noexcept {
+    auto &entry = *d_endpoints.try_emplace(EndpointKey(address, addressLength)).first;
+    auto &endpoint = entry.second;
+    SocketPromise promise;
+    auto future = promise.future();
+    auto expiry = std::chrono::steady_clock::now() - d_options.idleTimeout;
+
+    // The most recently used connection is the least likely to be closed by
+    // the peer.
+    while (!endpoint.d_idleConnections.empty()) {
+        auto connection = std::move(endpoint.d_idleConnections.back());
+        endpoint.d_idleConnections.pop_back();
+
+        if (connection.d_checkinTime >= expiry && isHealthy(*connection.d_socket)) {
+            ++d_statistics.hitCount;
+            promise.setResult(std::move(connection.d_socket));
+            return future;
+        }
+
+        ++d_statistics.unhealthyCount;
+        --endpoint.d_connectionCount;
+    }
+
+    if (endpoint.d_connectionCount < d_options.maxConnectionsPerEndpoint) {
+        ++endpoint.d_connectionCount;
+        connect(entry.first, endpoint, std::move(promise));
+        return future;
+    }
+
+    ++d_statistics.waitCount;
+    endpoint.d_waiters.push_back(std::move(promise));
+    return future;
+}
+
+void ConnectionPool::checkin(
+    sockaddr const *address,
+    socklen_t addressLength,
+    std::unique_ptr<AsyncConnectedSocket> socket) noexcept {
+    auto &entry = *d_endpoints.try_emplace(EndpointKey(address, addressLength)).first;
+    auto &endpoint = entry.second;
+
+    if (socket == nullptr || !isHealthy(*socket)) {
+        release(entry.first, endpoint);
+        return;
+    }
+
+    if (!endpoint.d_waiters.empty()) {
+        auto promise = std::move(endpoint.d_waiters.front());
+        endpoint.d_waiters.pop_front();
+        promise.setResult(std::move(socket));
+        return;
+    }
+
+    endpoint.d_idleConnections.push_back(IdleConnection{std::move(socket), std::chrono::steady_clock::now()});
+}
+
+std::size_t ConnectionPool::evictIdle(std::chrono::steady_clock::time_point now) noexcept {
+    std::size_t count = 0;
+    auto expiry = now - d_options.idleTimeout;
+
+    for (auto &entry : d_endpoints) {
+        auto &connections = entry.second.d_idleConnections;
+
+        // Idle connections are ordered by their checkin time.
+        while (!connections.empty() && connections.front().d_checkinTime < expiry) {
+            connections.pop_front();
+            --entry.second.d_connectionCount;
+            ++count;
+        }
+    }
+
+    d_statistics.evictionCount += count;
+    return count;
+}
+
+// PUBLIC ACCESSORS
+
+std::size_t ConnectionPool::idleCount(sockaddr const *address, socklen_t addressLength) const noexcept {
+    auto endpoint = findEndpoint(address, addressLength);
+    return endpoint != nullptr ? endpoint->d_idleConnections.size() : 0;
+}
+
+std::size_t ConnectionPool::connectionCount(sockaddr const *address, socklen_t addressLength) const noexcept {
+    auto endpoint = findEndpoint(address, addressLength);
+    return endpoint != nullptr ? endpoint->d_connectionCount : 0;
+}
+
+// PRIVATE MANIPULATORS
+
+void ConnectionPool::connect(EndpointKey const &key, Endpoint &endpoint, SocketPromise promise) noexcept {
+    ++d_statistics.connectCount;
+
+    // Endpoints are never erased, and elements of the map are stable.
+    auto future = d_connector.connect(reinterpret_cast<sockaddr const *>(&key.d_address), key.d_addressLength);
+    future.setResultCallback([this, &key, &endpoint, promise](std::unique_ptr<AsyncConnectedSocket> socket) mutable {
+        if (socket == nullptr) {
+            release(key, endpoint);
+        }
+
+        promise.setResult(std::move(socket));
+    });
+}
+
+void ConnectionPool::release(EndpointKey const &key, Endpoint &endpoint) noexcept {
+    --endpoint.d_connectionCount;
+
+    if (!endpoint.d_waiters.empty()) {
+        auto promise = std::move(endpoint.d_waiters.front());
+        endpoint.d_waiters.pop_front();
+        ++endpoint.d_connectionCount;
+        connect(key, endpoint, std::move(promise));
+    }
+}
+
+// PRIVATE ACCESSORS
+
+bool ConnectionPool::isHealthy(AsyncConnectedSocket const &socket) noexcept {
+    // An idle connection has nothing to read: bytes mean the peer broke the
+    // protocol, the end of the stream means it closed the connection.
+    char byte = 0;
+    ssize_t count = recv(socket.fileDescriptor(), &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    return count == -1 && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+ConnectionPool::Endpoint const *ConnectionPool::findEndpoint(
+    sockaddr const *address,
+    socklen_t addressLength) const noexcept {
+    auto it = d_endpoints.find(EndpointKey(address, addressLength));
+    return it != d_endpoints.end() ? &it->second : nullptr;
+}
+
+}
+}
@@ -0,0 +1,210 @@
+#ifndef ECO_NET_CONNECTIONPOOL
+#define ECO_NET_CONNECTIONPOOL
+
+#include <net/asyncconnectedsocket.h>
+#include <net/asyncconnector.h>
+
+#include <async/dispatcher.h>
+#include <async/future.h>
+#include <io/filedescriptoreventpoller.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+
+#include <sys/socket.h>
+
+namespace eco {
+namespace net {
+
+    /**
+     * @brief Options of a connection pool.
+     */
+    struct ConnectionPoolOptions {
+        /**
+         * @brief The most connections to one endpoint, counting idle,
+         * checked out and connecting ones. Further checkouts wait for a
+         * connection to be checked in.
+         */
+        std::size_t maxConnectionsPerEndpoint = 16;
+
+        /**
+         * @brief How long a connection can be idle before it is evicted.
+         */
+        std::chrono::nanoseconds idleTimeout = std::chrono::seconds(30);
+
+        /**
+         * @brief The options of the pooled sockets.
+         */
+        AsyncConnectedSocketOptions socketOptions;
+    };
+
+    /**
+     * @brief Counters of a connection pool.
+     */
+    struct ConnectionPoolStatistics {
+        std::uint64_t hitCount = 0;
+        std::uint64_t connectCount = 0;
+        std::uint64_t waitCount = 0;
+        std::uint64_t unhealthyCount = 0;
+        std::uint64_t evictionCount = 0;
+    };
+
+    /**
+     * @brief Pool of outbound connections of one event loop, keyed by the
+     * address of the endpoint.
+     *
+     * Checking out reuses the most recently checked in connection of the
+     * endpoint when it is still healthy, which means that the peer did not
+     * close it and did not send unexpected bytes. Otherwise a new connection
+     * is established, unless the endpoint reached its connection limit, in
+     * which case the checkout waits for a connection to be checked in.
+     *
+     * Each checked out connection must be checked in again, with `nullptr`
+     * when it was closed, so that the pool can account for it. Idle
+     * connections are evicted by `evictIdle`, which is meant to be called
+     * periodically by the loop, and when they are found expired on checkout.
+     *
+     * Create one pool per loop: it uses no locks and is not thread-safe. The
+     * futures resolve on the thread of the loop.
+     */
+    class ConnectionPool {
+    public:
+        // PUBLIC TYPES
+        using SocketFuture = AsyncConnector::SocketFuture;
+
+    private:
+        // PRIVATE TYPES
+        using SocketPromise = async::ResultPromise<std::unique_ptr<AsyncConnectedSocket>>;
+
+        struct EndpointKey {
+            sockaddr_storage d_address = {};
+            socklen_t d_addressLength = 0;
+
+            EndpointKey(sockaddr const *address, socklen_t addressLength) noexcept;
+
+            bool operator==(EndpointKey const &other) const noexcept;
+        };
+
+        struct EndpointKeyHash {
+            std::size_t operator()(EndpointKey const &key) const noexcept;
+        };
+
+        struct IdleConnection {
+            std::unique_ptr<AsyncConnectedSocket> d_socket;
+            std::chrono::steady_clock::time_point d_checkinTime;
+        };
+
+        struct Endpoint {
+            std::size_t d_connectionCount = 0;
+            std::deque<IdleConnection> d_idleConnections;
+            std::deque<SocketPromise> d_waiters;
+        };
+
+        // PRIVATE DATA
+        ConnectionPoolOptions d_options;
+        ConnectionPoolStatistics d_statistics;
+        std::unordered_map<EndpointKey, Endpoint, EndpointKeyHash> d_endpoints;
+
+        // Destroyed first, so that canceled connects find the endpoints.
+        AsyncConnector d_connector;
+
+    public:
+        // PUBLIC CREATORS
+
+        /**
+         * @brief Create a pool that registers its connections in the specified
+         * `registry` with the specified `dispatcher` and `options`.
+         */
+        explicit ConnectionPool(
+            std::shared_ptr<io::FileDescriptorEventRegistry> registry,
+            std::shared_ptr<async::Dispatcher> dispatcher = nullptr,
+            ConnectionPoolOptions const &options = ConnectionPoolOptions());
+
+        ConnectionPool(ConnectionPool const &) = delete;
+        ConnectionPool &operator=(ConnectionPool const &) = delete;
+
+        /**
+         * @brief Resolve the futures of waiting and connecting checkouts with
+         * `nullptr` and close the idle connections.
+         */
+        ~ConnectionPool();
+
+        // PUBLIC MANIPULATORS
+
+        /**
+         * @brief Return a future that resolves with a connection to the
+         * specified `address` of the specified `addressLength`, or `nullptr`
+         * when connecting failed.
+         */
+        SocketFuture checkout(sockaddr const *address, socklen_t addressLength) noexcept;
+
+        /**
+         * @brief Return the specified `socket`, which was checked out for the
+         * specified `address` of the specified `addressLength`, to the pool.
+         * Pass `nullptr` when the connection was closed. The socket must not
+         * have pending operations.
+         */
+        void checkin(
+            sockaddr const *address,
+            socklen_t addressLength,
+            std::unique_ptr<AsyncConnectedSocket> socket) noexcept;
+
+        /**
+         * @brief Close the connections that were idle for longer than the idle
+         * timeout at the specified `now`. Return the number of closed
+         * connections.
+         */
+        std::size_t evictIdle(
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now()) noexcept;
+
+        // PUBLIC ACCESSORS
+
+        /**
+         * @brief Return the number of idle connections to the specified
+         * `address` of the specified `addressLength`.
+         */
+        std::size_t idleCount(sockaddr const *address, socklen_t addressLength) const noexcept;
+
+        /**
+         * @brief Return the number of idle, checked out and connecting
+         * connections to the specified `address` of the specified
+         * `addressLength`.
+         */
+        std::size_t connectionCount(sockaddr const *address, socklen_t addressLength) const noexcept;
+
+        ConnectionPoolStatistics const &statistics() const noexcept {
+            return d_statistics;
+        }
+
+    private:
+        // PRIVATE MANIPULATORS
+        /**
+         * @brief Open a new connection to the specified `endpoint` for the
+         * specified `promise`.
+         */
+        void connect(EndpointKey const &key, Endpoint &endpoint, SocketPromise promise) noexcept;
+
+        /**
+         * @brief Account for a closed connection of the specified `endpoint`,
+         * and connect for the next waiter.
+         */
+        void release(EndpointKey const &key, Endpoint &endpoint) noexcept;
+
+        // PRIVATE ACCESSORS
+
+        /**
+         * @brief Return `true` when the specified idle `socket` can be reused.
+         */
+        static bool isHealthy(AsyncConnectedSocket const &socket) noexcept;
+
+        Endpoint const *findEndpoint(sockaddr const *address, socklen_t addressLength) const noexcept;
+    };
+
+}
+}
+
+#endif //  ECO_NET_CONNECTIONPOOL
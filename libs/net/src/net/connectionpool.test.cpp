@@ -0,0 +1,134 @@
+#include <net/connectionpool.h>
+
+#include <net/testloop.test.h>
+
+#include <gtest/gtest.h>
+
+#include <optional>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace eco;
+using namespace eco::net;
+
+namespace {
+    using SocketResult = std::optional<std::unique_ptr<AsyncConnectedSocket>>;
+
+    struct Fixture : test::TestLoop, test::LoopbackListener {
+        std::unique_ptr<ConnectionPool> d_connectionPool;
+
+        Fixture(ConnectionPoolOptions const &options = ConnectionPoolOptions()) {
+            d_connectionPool = std::make_unique<ConnectionPool>(d_registry, nullptr, options);
+        }
+
+        void checkout(SocketResult &result) {
+            d_connectionPool->checkout(address(), addressLength())
+                .setResultCallback([&](std::unique_ptr<AsyncConnectedSocket> socket) {
+                    result = std::move(socket);
+                });
+        }
+
+        void checkin(SocketResult &result) {
+            d_connectionPool->checkin(address(), addressLength(), std::move(*result));
+            result.reset();
+        }
+
+        void waitFor(SocketResult const &result) {
+            processUntil([&] { return result.has_value(); });
+        }
+    };
+}
+
+TEST(ConnectionPool, ReusesConnections) {
+    // GIVEN
+    Fixture fixture;
+    SocketResult result;
+    fixture.checkout(result);
+    fixture.waitFor(result);
+    ASSERT_TRUE(result && *result);
+    auto fileDescriptor = (*result)->fileDescriptor();
+
+    // WHEN
+    fixture.checkin(result);
+    EXPECT_EQ(1, fixture.d_connectionPool->idleCount(fixture.address(), sizeof(sockaddr_in)));
+    fixture.checkout(result);
+
+    // THEN the idle connection is handed out right away.
+    ASSERT_TRUE(result && *result);
+    EXPECT_EQ(fileDescriptor, (*result)->fileDescriptor());
+    EXPECT_EQ(1, fixture.d_connectionPool->statistics().hitCount);
+    EXPECT_EQ(1, fixture.d_connectionPool->statistics().connectCount);
+    EXPECT_EQ(1, fixture.d_connectionPool->connectionCount(fixture.address(), sizeof(sockaddr_in)));
+}
+
+TEST(ConnectionPool, MaxConnectionsPerEndpoint) {
+    // GIVEN
+    ConnectionPoolOptions options;
+    options.maxConnectionsPerEndpoint = 1;
+    Fixture fixture(options);
+    SocketResult first;
+    SocketResult second;
+    fixture.checkout(first);
+    fixture.waitFor(first);
+    ASSERT_TRUE(first && *first);
+
+    // WHEN
+    fixture.checkout(second);
+
+    // THEN the second checkout waits for the first connection.
+    EXPECT_FALSE(second);
+    EXPECT_EQ(1, fixture.d_connectionPool->statistics().waitCount);
+    auto fileDescriptor = (*first)->fileDescriptor();
+    fixture.checkin(first);
+    ASSERT_TRUE(second && *second);
+    EXPECT_EQ(fileDescriptor, (*second)->fileDescriptor());
+
+    // WHEN-THEN a closed connection makes room for a new one.
+    fixture.checkout(first);
+    EXPECT_FALSE(first);
+    fixture.d_connectionPool->checkin(fixture.address(), sizeof(sockaddr_in), nullptr);
+    fixture.waitFor(first);
+    ASSERT_TRUE(first && *first);
+    EXPECT_EQ(2, fixture.d_connectionPool->statistics().connectCount);
+}
+
+TEST(ConnectionPool, HealthCheckOnCheckout) {
+    // GIVEN
+    Fixture fixture;
+    SocketResult result;
+    fixture.checkout(result);
+    fixture.waitFor(result);
+    ASSERT_TRUE(result && *result);
+    fixture.checkin(result);
+
+    // WHEN the peer closes the idle connection
+    close(accept(fixture.d_fileDescriptor, nullptr, nullptr));
+    fixture.checkout(result);
+    fixture.waitFor(result);
+
+    // THEN a new connection is established.
+    ASSERT_TRUE(result && *result);
+    EXPECT_EQ(1, fixture.d_connectionPool->statistics().unhealthyCount);
+    EXPECT_EQ(2, fixture.d_connectionPool->statistics().connectCount);
+    EXPECT_EQ(1, fixture.d_connectionPool->connectionCount(fixture.address(), sizeof(sockaddr_in)));
+}
+
+TEST(ConnectionPool, EvictIdle) {
+    // GIVEN
+    ConnectionPoolOptions options;
+    options.idleTimeout = std::chrono::seconds(10);
+    Fixture fixture(options);
+    SocketResult result;
+    fixture.checkout(result);
+    fixture.waitFor(result);
+    ASSERT_TRUE(result && *result);
+    fixture.checkin(result);
+
+    // WHEN-THEN
+    EXPECT_EQ(0, fixture.d_connectionPool->evictIdle());
+    EXPECT_EQ(1, fixture.d_connectionPool->evictIdle(std::chrono::steady_clock::now() + std::chrono::seconds(11)));
+    EXPECT_EQ(0, fixture.d_connectionPool->idleCount(fixture.address(), sizeof(sockaddr_in)));
+    EXPECT_EQ(0, fixture.d_connectionPool->connectionCount(fixture.address(), sizeof(sockaddr_in)));
+}
@@ -0,0 +1,307 @@
+#include <net/framecodec.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace eco {
+namespace net {
+
+namespace {
+    bool isValidFixedLengthSize(std::size_t sizeInBytes) noexcept {
+        return sizeInBytes == 1 || sizeInBytes == 2 || sizeInBytes == 4 || sizeInBytes == 8;
+    }
+}
+
+// PUBLIC STATIC MANIPULATORS
+
+std::size_t FrameEncoder::encodeHeader(
+    std::size_t sizeInBytes,
+    char *destination,
+    FrameCodecOptions const &options) noexcept {
+    if (sizeInBytes > options.maxFrameSizeInBytes) {
+        return 0;
+    }
+
+    std::uint64_t value = sizeInBytes;
+
+    if (options.lengthEncoding == FrameLengthEncoding::Varint) {
+        std::size_t headerSizeInBytes = 0;
+
+        while (value >= 0x80) {
+            destination[headerSizeInBytes++] = static_cast<char>((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+
+        destination[headerSizeInBytes++] = static_cast<char>(value);
+        return headerSizeInBytes;
+    }
+
+    auto width = options.fixedLengthSizeInBytes;
+
+    if (!isValidFixedLengthSize(width) || (width < 8 && value >> (8 * width) != 0)) {
+        return 0;
+    }
+
+    for (std::size_t i = 0; i < width; ++i) {
+        destination[i] = static_cast<char>(value >> (8 * (width - 1 - i)));
+    }
+
+    return width;
+}
+
+bool FrameEncoder::encode(
+    io::BufferChain &payload,
+    io::BufferPool &pool,
+    FrameCodecOptions const &options) noexcept {
+    auto buffer = pool.allocate(c_maxHeaderSizeInBytes);
+
+    if (!buffer) {
+        return false;
+    }
+
+    auto headerSizeInBytes = encodeHeader(payload.sizeInBytes(), buffer.data(), options);
+    return headerSizeInBytes != 0 && payload.prepend(std::move(buffer), 0, headerSizeInBytes);
+}
+
+// PUBLIC CREATORS
+
+FrameDecoder::FrameDecoder(FrameCodecOptions const &options) noexcept
+: d_options(options)
+{
+}
+
+// PUBLIC MANIPULATORS
+
+void FrameDecoder::append(io::BufferChain bytes) noexcept {
+    d_received.append(std::move(bytes));
+}
+
+bool FrameDecoder::next(io::BufferChain &frame) noexcept {
+    if (d_hasError || (!d_hasHeader && !parseHeader())) {
+        return false;
+    }
+
+    if (d_received.sizeInBytes() < d_headerSizeInBytes + d_frameSizeInBytes) {
+        return false;
+    }
+
+    d_received.trimFront(d_headerSizeInBytes);
+    frame = d_received.splitFront(d_frameSizeInBytes);
+    d_hasHeader = false;
+    return true;
+}
+
+// PUBLIC ACCESSORS
+
+std::size_t FrameDecoder::missingSizeInBytes() const noexcept {
+    auto receivedSizeInBytes = d_received.sizeInBytes();
+
+    if (d_hasHeader) {
+        auto sizeInBytes = d_headerSizeInBytes + d_frameSizeInBytes;
+        return sizeInBytes > receivedSizeInBytes ? sizeInBytes - receivedSizeInBytes : 0;
+    }
+
+    if (d_options.lengthEncoding == FrameLengthEncoding::FixedWidth &&
+        d_options.fixedLengthSizeInBytes > receivedSizeInBytes) {
+        return d_options.fixedLengthSizeInBytes - receivedSizeInBytes;
+    }
+
+    return 1;
+}
+
+// PRIVATE MANIPULATORS
+
+bool FrameDecoder::parseHeader() noexcept {
+    if (d_received.empty()) {
+        return false;
+    }
+
+    // The prefix is parsed in place unless it spans slices.
+    char copy[FrameEncoder::c_maxHeaderSizeInBytes];
+    char const *header = d_received.begin()->data();
+    auto availableSizeInBytes = std::min(d_received.sizeInBytes(), FrameEncoder::c_maxHeaderSizeInBytes);
+
+    if (d_received.begin()->length < availableSizeInBytes) {
+        d_received.copyTo(copy, availableSizeInBytes);
+        header = copy;
+    }
+
+    std::uint64_t value = 0;
+    std::size_t headerSizeInBytes = 0;
+
+    if (d_options.lengthEncoding == FrameLengthEncoding::Varint) {
+        for (std::size_t i = 0; i < availableSizeInBytes && headerSizeInBytes == 0; ++i) {
+            auto byte = static_cast<std::uint8_t>(header[i]);
+
+            // The tenth byte holds the top bit of a 64 bit length.
+            if (i == FrameEncoder::c_maxHeaderSizeInBytes - 1 && byte > 1) {
+                d_hasError = true;
+                return false;
+            }
+
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << (7 * i);
+            headerSizeInBytes = (byte & 0x80) == 0 ? i + 1 : 0;
+        }
+
+        if (headerSizeInBytes == 0) {
+            return false;
+        }
+    } else {
+        auto width = d_options.fixedLengthSizeInBytes;
+
+        if (!isValidFixedLengthSize(width)) {
+            d_hasError = true;
+            return false;
+        }
+
+        if (availableSizeInBytes < width) {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < width; ++i) {
+            value = (value << 8) | static_cast<std::uint8_t>(header[i]);
+        }
+
+        headerSizeInBytes = width;
+    }
+
+    if (value > d_options.maxFrameSizeInBytes) {
+        d_hasError = true;
+        return false;
+    }
+
+    d_hasHeader = true;
+    d_headerSizeInBytes = headerSizeInBytes;
+    d_frameSizeInBytes = static_cast<std::size_t>(value);
+    return true;
+}
+
+// PUBLIC CREATORS
+
+FrameReader::FrameReader(
+    AsyncConnectedSocket &socket,
+    io::BufferPool &pool,
+    FrameCodecOptions const &options,
+    std::size_t readSizeInBytes) noexcept
+: d_socket(socket)
+, d_pool(pool)
+, d_decoder(options)
+, d_readSizeInBytes(readSizeInBytes)
+, d_isAlive(std::make_shared<bool>(true))
+{
+}
+
+FrameReader::~FrameReader() {
+    // Completions of the pending read that are dispatched after this point
+    // must not act on this reader anymore.
+    *d_isAlive = false;
+    d_socket.memoryBudget().release(d_chargedSizeInBytes);
+}
+
+// PUBLIC MANIPULATORS
+
+async::Future<std::optional<io::BufferChain>> FrameReader::readFrameAsync() noexcept {
+    if (d_promise) {
+        async::ResultPromise<std::optional<io::BufferChain>> promise;
+        promise.setResult(std::nullopt);
+        return promise.future();
+    }
+
+    d_promise.emplace();
+    auto future = d_promise->future();
+    advance();
+    return future;
+}
+
+// PRIVATE MANIPULATORS
+
+void FrameReader::advance() noexcept {
+    // Reads that complete inline are continued by this loop rather than by
+    // their callbacks, so that a burst of reads does not recurse.
+    d_isAdvancing = true;
+
+    while (d_promise && !d_isReading) {
+        io::BufferChain frame;
+
+        if (d_decoder.next(frame)) {
+            complete(std::move(frame));
+            break;
+        }
+
+        if (d_decoder.hasError() || d_isClosed) {
+            complete(std::nullopt);
+            break;
+        }
+
+        // Reads are capped rather than sized for the rest of the frame, so a
+        // prefix alone does not make the reader allocate up to the maximum
+        // frame size, of which only the received bytes are charged.
+        io::BufferChain buffers;
+
+        while (buffers.sizeInBytes() < d_readSizeInBytes) {
+            auto buffer = d_pool.allocate(
+                std::min(d_readSizeInBytes - buffers.sizeInBytes(), io::BufferPool::c_maxBufferSize));
+
+            if (!buffer) {
+                break;
+            }
+
+            buffers.append(std::move(buffer));
+        }
+
+        if (buffers.empty()) {
+            complete(std::nullopt);
+            break;
+        }
+
+        d_isReading = true;
+        d_socket.readAsync(buffers).setResultCallback([this, isAlive = d_isAlive, buffers](std::size_t count) {
+            if (*isAlive) {
+                onRead(buffers, count);
+            }
+        });
+    }
+
+    d_isAdvancing = false;
+}
+
+void FrameReader::onRead(io::BufferChain buffers, std::size_t count) noexcept {
+    d_isReading = false;
+
+    if (count == 0) {
+        d_isClosed = true;
+    } else {
+        buffers.trimBack(buffers.sizeInBytes() - count);
+        d_decoder.append(std::move(buffers));
+        updateCharge();
+    }
+
+    if (!d_isAdvancing) {
+        advance();
+    }
+}
+
+void FrameReader::complete(std::optional<io::BufferChain> frame) noexcept {
+    updateCharge();
+    auto promise = std::move(*d_promise);
+    d_promise.reset();
+    promise.setResult(std::move(frame));
+}
+
+void FrameReader::updateCharge() noexcept {
+    auto &budget = d_socket.memoryBudget();
+    auto sizeInBytes = d_decoder.receivedSizeInBytes();
+
+    if (sizeInBytes >= d_chargedSizeInBytes) {
+        budget.charge(sizeInBytes - d_chargedSizeInBytes);
+        d_chargedSizeInBytes = sizeInBytes;
+        return;
+    }
+
+    budget.release(d_chargedSizeInBytes - sizeInBytes);
+    d_chargedSizeInBytes = sizeInBytes;
+    d_socket.resumeReading();
+}
+
+}
+}
@@ -0,0 +1,254 @@
+#ifndef ECO_NET_FRAMECODEC
+#define ECO_NET_FRAMECODEC
+
+#include <net/asyncconnectedsocket.h>
+
+#include <async/future.h>
+#include <io/bufferchain.h>
+#include <io/bufferpool.h>
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+namespace eco {
+namespace net {
+
+    /**
+     * @brief How the length of a frame is encoded in front of its payload.
+     */
+    enum class FrameLengthEncoding {
+        /**
+         * @brief Unsigned LEB128, with 7 bits per byte and the least
+         * significant group first, as used by protocol buffers.
+         */
+        Varint,
+
+        /**
+         * @brief An unsigned big-endian integer of
+         * `FrameCodecOptions::fixedLengthSizeInBytes` bytes.
+         */
+        FixedWidth
+    };
+
+    /**
+     * @brief Options of the frame encoder and decoder, which must match on
+     * both ends of a connection.
+     */
+    struct FrameCodecOptions {
+        FrameLengthEncoding lengthEncoding = FrameLengthEncoding::Varint;
+
+        /**
+         * @brief The size of a fixed-width length, which is 1, 2, 4 or 8.
+         */
+        std::size_t fixedLengthSizeInBytes = 4;
+
+        /**
+         * @brief The largest payload that is accepted. Larger frames are a
+         * decoding error, so that a peer can not make the decoder buffer
+         * without bounds.
+         */
+        std::size_t maxFrameSizeInBytes = 16 * 1024 * 1024;
+    };
+
+    /**
+     * @brief Writes length prefixes of frames.
+     */
+    class FrameEncoder {
+    public:
+        // PUBLIC CONSTANTS
+
+        /**
+         * @brief The largest length prefix, which is that of a varint of a
+         * 64 bit length.
+         */
+        static constexpr std::size_t c_maxHeaderSizeInBytes = 10;
+
+        // PUBLIC STATIC MANIPULATORS
+
+        /**
+         * @brief Write the prefix of a frame with a payload of the specified
+         * `sizeInBytes` to the specified `destination`, which has room for
+         * `c_maxHeaderSizeInBytes` bytes, according to the specified
+         * `options`. Return the size of the prefix, or `0` when the payload
+         * is too large.
+         */
+        static std::size_t encodeHeader(
+            std::size_t sizeInBytes,
+            char *destination,
+            FrameCodecOptions const &options = FrameCodecOptions()) noexcept;
+
+        /**
+         * @brief Turn the specified `payload` into a frame by prepending its
+         * prefix in a buffer of the specified `pool`, without copying the
+         * payload. Return `false` when the payload is too large or no buffer
+         * could be allocated, leaving `payload` unchanged.
+         */
+        static bool encode(
+            io::BufferChain &payload,
+            io::BufferPool &pool,
+            FrameCodecOptions const &options = FrameCodecOptions()) noexcept;
+    };
+
+    /**
+     * @brief Splits received bytes into length-prefixed frames.
+     *
+     * The payload of each frame is handed out as a chain of slices of the
+     * received buffers, so it is never copied, also when it was received with
+     * several reads. Only length prefixes that span buffers are copied to be
+     * parsed. Use `io::BufferChain::coalesce` for payloads that must be
+     * contiguous.
+     *
+     * Once the decoder detected a malformed or oversized frame, it stays in
+     * the error state, as the stream can not be resynchronized.
+     *
+     * This class is not thread-safe.
+     */
+    class FrameDecoder {
+        // PRIVATE DATA
+        FrameCodecOptions d_options;
+        io::BufferChain d_received;
+
+        // The prefix of the next frame, once it was parsed.
+        bool d_hasHeader = false;
+        std::size_t d_headerSizeInBytes = 0;
+        std::size_t d_frameSizeInBytes = 0;
+        bool d_hasError = false;
+
+    public:
+        // PUBLIC CREATORS
+        explicit FrameDecoder(FrameCodecOptions const &options = FrameCodecOptions()) noexcept;
+
+        // PUBLIC MANIPULATORS
+
+        /**
+         * @brief Append the specified received `bytes`.
+         */
+        void append(io::BufferChain bytes) noexcept;
+
+        /**
+         * @brief Remove the next complete frame from the received bytes and
+         * store its payload in the specified `frame`. Return `false` when no
+         * complete frame was received or the decoder is in the error state.
+         */
+        bool next(io::BufferChain &frame) noexcept;
+
+        // PUBLIC ACCESSORS
+
+        /**
+         * @brief Return the number of bytes that are missing to complete the
+         * next frame, or an estimate of at least `1` when its prefix is not
+         * complete yet, e.g. to size the next read.
+         */
+        std::size_t missingSizeInBytes() const noexcept;
+
+        std::size_t receivedSizeInBytes() const noexcept {
+            return d_received.sizeInBytes();
+        }
+
+        bool hasError() const noexcept {
+            return d_hasError;
+        }
+
+    private:
+        // PRIVATE MANIPULATORS
+
+        /**
+         * @brief Parse the prefix of the next frame. Return `false` when it is
+         * not complete yet or malformed.
+         */
+        bool parseHeader() noexcept;
+    };
+
+    /**
+     * @brief Reads length-prefixed frames from a connected socket.
+     *
+     * Reads go into buffers of the given pool, at most the read size at a
+     * time, and several frames received with one read are handed out without
+     * further reads.
+     *
+     * The received bytes of incomplete frames are charged to the memory
+     * budget of the socket, so a limit of the budget must exceed the largest
+     * frame.
+     *
+     * The socket and pool are not owned and must outlive the reader. The
+     * reader can be destroyed while a read is pending, also when its
+     * completion is dispatched later. This class is not thread-safe.
+     */
+    class FrameReader {
+        // PRIVATE DATA
+        AsyncConnectedSocket &d_socket;
+        io::BufferPool &d_pool;
+        FrameDecoder d_decoder;
+        std::size_t d_readSizeInBytes;
+        std::size_t d_chargedSizeInBytes = 0;
+        std::optional<async::ResultPromise<std::optional<io::BufferChain>>> d_promise;
+        bool d_isReading = false;
+        bool d_isAdvancing = false;
+        bool d_isClosed = false;
+        std::shared_ptr<bool> d_isAlive;
+
+    public:
+        // PUBLIC CREATORS
+
+        /**
+         * @brief Create a reader of the specified `socket` that reads at most
+         * the specified `readSizeInBytes` bytes at a time into buffers of the
+         * specified `pool`, and decodes frames according to the specified
+         * `options`.
+         */
+        FrameReader(
+            AsyncConnectedSocket &socket,
+            io::BufferPool &pool,
+            FrameCodecOptions const &options = FrameCodecOptions(),
+            std::size_t readSizeInBytes = 16 * 1024) noexcept;
+
+        FrameReader(FrameReader const &) = delete;
+        FrameReader &operator=(FrameReader const &) = delete;
+
+        ~FrameReader();
+
+        // PUBLIC MANIPULATORS
+
+        /**
+         * @brief Return a future that resolves with the payload of the next
+         * frame, or with no value when the connection was closed or failed,
+         * a frame was malformed, or another read is pending.
+         */
+        async::Future<std::optional<io::BufferChain>> readFrameAsync() noexcept;
+
+        // PUBLIC ACCESSORS
+
+        FrameDecoder const &decoder() const noexcept {
+            return d_decoder;
+        }
+
+    private:
+        // PRIVATE MANIPULATORS
+
+        /**
+         * @brief Resolve the pending future with the next frame, or read more
+         * bytes when none is complete.
+         */
+        void advance() noexcept;
+
+        /**
+         * @brief Take the specified `count` bytes read into the specified
+         * `buffers`.
+         */
+        void onRead(io::BufferChain buffers, std::size_t count) noexcept;
+
+        void complete(std::optional<io::BufferChain> frame) noexcept;
+
+        /**
+         * @brief Charge the bytes buffered by the decoder to the memory budget
+         * of the socket, or release those it handed out, in which case the
+         * socket can resume reading.
+         */
+        void updateCharge() noexcept;
+    };
+
+}
+}
+
+#endif //  ECO_NET_FRAMECODEC
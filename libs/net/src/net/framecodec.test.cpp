@@ -0,0 +1,252 @@
+#include <net/framecodec.h>
+
+#include <net/testloop.test.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace eco;
+using namespace eco::net;
+
+namespace {
+    io::BufferChain createChain(io::BufferPool &pool, std::string const &bytes) {
+        auto buffer = pool.allocate(bytes.size());
+        std::memcpy(buffer.data(), bytes.data(), bytes.size());
+        io::BufferChain chain;
+        chain.append(buffer, 0, bytes.size());
+        return chain;
+    }
+
+    std::string toString(io::BufferChain const &chain) {
+        std::string bytes(chain.sizeInBytes(), '\0');
+        chain.copyTo(&bytes[0], bytes.size());
+        return bytes;
+    }
+
+    std::string encode(std::string const &payload, FrameCodecOptions const &options = FrameCodecOptions()) {
+        char header[FrameEncoder::c_maxHeaderSizeInBytes];
+        auto headerSizeInBytes = FrameEncoder::encodeHeader(payload.size(), header, options);
+        return std::string(header, headerSizeInBytes) + payload;
+    }
+}
+
+TEST(FrameEncoder, Headers) {
+    // GIVEN
+    FrameCodecOptions fixed;
+    fixed.lengthEncoding = FrameLengthEncoding::FixedWidth;
+    fixed.fixedLengthSizeInBytes = 2;
+    char header[FrameEncoder::c_maxHeaderSizeInBytes];
+
+    // WHEN
+    auto varintSize = FrameEncoder::encodeHeader(300, header);
+    std::string varint(header, varintSize);
+    auto fixedSize = FrameEncoder::encodeHeader(300, header, fixed);
+    std::string fixedWidth(header, fixedSize);
+
+    // THEN
+    EXPECT_EQ(std::string("\xac\x02"), varint);
+    EXPECT_EQ(std::string("\x01\x2c"), fixedWidth);
+    EXPECT_EQ(1, FrameEncoder::encodeHeader(0, header));
+    EXPECT_EQ(0, FrameEncoder::encodeHeader(70000, header, fixed));
+    EXPECT_EQ(0, FrameEncoder::encodeHeader(fixed.maxFrameSizeInBytes + 1, header));
+}
+
+TEST(FrameDecoder, FramesOfOneRead) {
+    // GIVEN
+    io::BufferPool pool;
+    FrameDecoder sut;
+    auto received = createChain(pool, encode("hello") + encode("") + encode(std::string(200, 'x')));
+    auto data = received.begin()->data();
+
+    // WHEN
+    sut.append(received);
+    std::vector<io::BufferChain> frames;
+    io::BufferChain frame;
+    while (sut.next(frame)) {
+        frames.push_back(frame);
+    }
+
+    // THEN the payloads refer to the received buffer
+    ASSERT_EQ(3, frames.size());
+    EXPECT_EQ("hello", toString(frames[0]));
+    EXPECT_EQ(data + 1, frames[0].begin()->data());
+    EXPECT_EQ("", toString(frames[1]));
+    EXPECT_EQ(std::string(200, 'x'), toString(frames[2]));
+    EXPECT_EQ(data + 9, frames[2].begin()->data());
+    EXPECT_EQ(0, sut.receivedSizeInBytes());
+    EXPECT_FALSE(sut.hasError());
+}
+
+TEST(FrameDecoder, FrameAcrossReads) {
+    // GIVEN
+    io::BufferPool pool;
+    FrameCodecOptions options;
+    options.lengthEncoding = FrameLengthEncoding::FixedWidth;
+    FrameDecoder sut(options);
+    auto bytes = encode(std::string(1000, 'y'), options);
+    io::BufferChain frame;
+
+    // WHEN the prefix and payload are split
+    sut.append(createChain(pool, bytes.substr(0, 2)));
+    EXPECT_FALSE(sut.next(frame));
+    EXPECT_EQ(2, sut.missingSizeInBytes());
+    sut.append(createChain(pool, bytes.substr(2, 500)));
+    EXPECT_FALSE(sut.next(frame));
+    EXPECT_EQ(502, sut.missingSizeInBytes());
+    sut.append(createChain(pool, bytes.substr(502)));
+
+    // THEN the payload is made of slices of both reads
+    ASSERT_TRUE(sut.next(frame));
+    EXPECT_EQ(std::string(1000, 'y'), toString(frame));
+    EXPECT_EQ(2, frame.sliceCount());
+}
+
+TEST(FrameDecoder, Errors) {
+    // GIVEN
+    io::BufferPool pool;
+    FrameCodecOptions options;
+    options.maxFrameSizeInBytes = 100;
+    FrameDecoder oversized(options);
+    FrameDecoder malformed;
+    io::BufferChain frame;
+
+    // WHEN
+    oversized.append(createChain(pool, encode(std::string(101, 'z'))));
+    malformed.append(createChain(pool, std::string(10, '\xff')));
+
+    // THEN
+    EXPECT_FALSE(oversized.next(frame));
+    EXPECT_TRUE(oversized.hasError());
+    EXPECT_FALSE(malformed.next(frame));
+    EXPECT_TRUE(malformed.hasError());
+}
+
+TEST(FrameReader, ReadFrames) {
+    // GIVEN
+    test::TestLoop loop;
+    auto &pool = loop.d_pool;
+    int sockets[2];
+    ASSERT_EQ(0, socketpair(PF_LOCAL, SOCK_STREAM, 0, sockets));
+    auto socket = AsyncConnectedSocket::create(sockets[0], loop.d_registry);
+    ASSERT_NE(nullptr, socket);
+    FrameReader sut(*socket, pool, FrameCodecOptions(), 64);
+
+    auto payload = createChain(pool, std::string(50000, 'p'));
+    ASSERT_TRUE(FrameEncoder::encode(payload, pool));
+    auto bytes = encode("first") + encode("second") + toString(payload);
+
+    // WHEN
+    ASSERT_EQ(static_cast<ssize_t>(bytes.size()), write(sockets[1], bytes.data(), bytes.size()));
+    close(sockets[1]);
+    std::vector<std::optional<io::BufferChain>> frames;
+    std::function<void(std::optional<io::BufferChain>)> onFrame = [&](std::optional<io::BufferChain> frame) {
+        bool isEnd = !frame;
+        frames.push_back(std::move(frame));
+        if (!isEnd) {
+            sut.readFrameAsync().setResultCallback(onFrame);
+        }
+    };
+    sut.readFrameAsync().setResultCallback(onFrame);
+
+    loop.processUntil([&] { return !frames.empty() && !frames.back(); });
+
+    // THEN
+    ASSERT_EQ(4, frames.size());
+    EXPECT_EQ("first", toString(*frames[0]));
+    EXPECT_EQ("second", toString(*frames[1]));
+    EXPECT_EQ(std::string(50000, 'p'), toString(*frames[2]));
+    EXPECT_FALSE(frames[3]);
+    EXPECT_FALSE(sut.decoder().hasError());
+}
+
+TEST(FrameReader, ChargesIncompleteFrames) {
+    // GIVEN
+    test::TestLoop loop;
+    auto &pool = loop.d_pool;
+    int sockets[2];
+    ASSERT_EQ(0, socketpair(PF_LOCAL, SOCK_STREAM, 0, sockets));
+    auto socket = AsyncConnectedSocket::create(sockets[0], loop.d_registry);
+    ASSERT_NE(nullptr, socket);
+    auto &budget = socket->memoryBudget();
+    auto sut = std::make_unique<FrameReader>(*socket, pool);
+
+    // WHEN a frame arrives with the start of the next one
+    auto bytes = encode("first") + encode("second").substr(0, 4);
+    ASSERT_EQ(static_cast<ssize_t>(bytes.size()), write(sockets[1], bytes.data(), bytes.size()));
+    std::optional<io::BufferChain> frame;
+    sut->readFrameAsync().setResultCallback([&](std::optional<io::BufferChain> value) {
+        frame = std::move(value);
+    });
+
+    loop.processUntil([&] { return frame.has_value(); });
+
+    // THEN only the bytes of the incomplete frame stay charged
+    ASSERT_TRUE(frame);
+    EXPECT_EQ("first", toString(*frame));
+    EXPECT_EQ(4, budget.usedInBytes());
+
+    // WHEN-THEN destroying the reader releases them.
+    sut.reset();
+    EXPECT_EQ(0, budget.usedInBytes());
+    close(sockets[1]);
+}
+
+TEST(FrameReader, CapsReadsOfLargeFrames) {
+    // GIVEN
+    test::TestLoop loop;
+    int sockets[2];
+    ASSERT_EQ(0, socketpair(PF_LOCAL, SOCK_STREAM, 0, sockets));
+    auto socket = AsyncConnectedSocket::create(sockets[0], loop.d_registry);
+    ASSERT_NE(nullptr, socket);
+    FrameReader sut(*socket, loop.d_pool);
+    auto slabCount = loop.d_pool.slabCount();
+
+    // WHEN the prefix of a large frame arrives
+    auto header = encode(std::string(8 * 1024 * 1024, 'x')).substr(0, 4);
+    ASSERT_EQ(4, write(sockets[1], header.data(), header.size()));
+    std::optional<io::BufferChain> frame;
+    sut.readFrameAsync().setResultCallback([&](std::optional<io::BufferChain> value) {
+        frame = std::move(value);
+    });
+    loop.processUntil([&] { return socket->memoryBudget().usedInBytes() == 4; });
+    loop.d_manager.processEvents(std::chrono::milliseconds(0));
+
+    // THEN the next read does not allocate buffers for the whole frame
+    EXPECT_FALSE(frame);
+    EXPECT_LE(loop.d_pool.slabCount(), slabCount + 1);
+    close(sockets[1]);
+}
+
+TEST(FrameReader, DestroyedBeforeDispatchedCompletion) {
+    // GIVEN a reader whose read completes through a dispatcher
+    test::TestLoop loop;
+    auto dispatcher = std::make_shared<test::QueueDispatcher>();
+    int sockets[2];
+    ASSERT_EQ(0, socketpair(PF_LOCAL, SOCK_STREAM, 0, sockets));
+    auto socket = AsyncConnectedSocket::create(sockets[0], loop.d_registry, dispatcher);
+    ASSERT_NE(nullptr, socket);
+    auto &budget = socket->memoryBudget();
+    auto sut = std::make_unique<FrameReader>(*socket, loop.d_pool);
+    sut->readFrameAsync();
+
+    auto bytes = encode("first").substr(0, 3);
+    ASSERT_EQ(3, write(sockets[1], bytes.data(), bytes.size()));
+    loop.processUntil([&] { return !dispatcher->d_functions.empty(); });
+
+    // WHEN the reader is destroyed before the completion runs
+    sut.reset();
+    dispatcher->runAll();
+
+    // THEN the completion is ignored.
+    EXPECT_EQ(0, budget.usedInBytes());
+    close(sockets[1]);
+}
@@ -0,0 +1,560 @@
+#include <net/httprequestparser.h>
+
+#include <algorithm>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define ECO_NET_HTTP_X86 1
+#include <immintrin.h>
+#endif
+
+namespace eco {
+namespace net {
+
+namespace {
+    /**
+     * @brief Return the first byte in the range from the specified `begin` to
+     * the specified `end` that equals the specified `first` or `second`, or
+     * `end`.
+     */
+    using FindFunction = char const *(*)(char const *begin, char const *end, char first, char second);
+
+    char const *findScalar(char const *begin, char const *end, char first, char second) noexcept {
+        while (begin != end && *begin != first && *begin != second) {
+            ++begin;
+        }
+
+        return begin;
+    }
+
+#ifdef ECO_NET_HTTP_X86
+    __attribute__((target("sse4.2")))
+    char const *findSse42(char const *begin, char const *end, char first, char second) noexcept {
+        __m128i needles = _mm_setr_epi8(first, second, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+        while (end - begin >= 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(begin));
+            int index = _mm_cmpestri(
+                needles, 2, bytes, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+
+            if (index != 16) {
+                return begin + index;
+            }
+
+            begin += 16;
+        }
+
+        return findScalar(begin, end, first, second);
+    }
+
+    __attribute__((target("avx2")))
+    char const *findAvx2(char const *begin, char const *end, char first, char second) noexcept {
+        __m256i firsts = _mm256_set1_epi8(first);
+        __m256i seconds = _mm256_set1_epi8(second);
+
+        while (end - begin >= 32) {
+            __m256i bytes = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(begin));
+            __m256i matches = _mm256_or_si256(
+                _mm256_cmpeq_epi8(bytes, firsts), _mm256_cmpeq_epi8(bytes, seconds));
+            auto mask = static_cast<unsigned>(_mm256_movemask_epi8(matches));
+
+            if (mask != 0) {
+                return begin + __builtin_ctz(mask);
+            }
+
+            begin += 32;
+        }
+
+        return findScalar(begin, end, first, second);
+    }
+#endif
+
+    FindFunction selectFind() noexcept {
+#ifdef ECO_NET_HTTP_X86
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2")) {
+            return findAvx2;
+        }
+
+        if (__builtin_cpu_supports("sse4.2")) {
+            return findSse42;
+        }
+#endif
+
+        return findScalar;
+    }
+
+    FindFunction const c_bestFind = selectFind();
+
+    char toLower(char c) noexcept {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    bool equalsIgnoringCase(std::string_view left, std::string_view right) noexcept {
+        return left.size() == right.size() &&
+            std::equal(left.begin(), left.end(), right.begin(), [](char l, char r) {
+                return toLower(l) == toLower(r);
+            });
+    }
+
+    /**
+     * @brief Return whether the comma-separated list of the specified `value`
+     * contains the specified `token`, compared case-insensitively.
+     */
+    bool containsToken(std::string_view value, std::string_view token) noexcept {
+        while (!value.empty()) {
+            auto end = std::min(value.find(','), value.size());
+            auto element = value.substr(0, end);
+            value.remove_prefix(std::min(end + 1, value.size()));
+
+            while (!element.empty() && (element.front() == ' ' || element.front() == '\t')) {
+                element.remove_prefix(1);
+            }
+
+            while (!element.empty() && (element.back() == ' ' || element.back() == '\t')) {
+                element.remove_suffix(1);
+            }
+
+            if (equalsIgnoringCase(element, token)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool isTokenCharacter(char c) noexcept {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+            (c != 0 && std::string_view("!#$%&'*+-.^_`|~").find(c) != std::string_view::npos);
+    }
+
+    bool isToken(std::string_view value) noexcept {
+        return !value.empty() && std::all_of(value.begin(), value.end(), isTokenCharacter);
+    }
+
+    /**
+     * @brief The most bytes of a chunk size line, including extensions.
+     */
+    const std::size_t c_maxChunkLineSizeInBytes = 256;
+}
+
+// PUBLIC ACCESSORS
+
+std::string_view HttpRequest::header(std::string_view name) const noexcept {
+    for (auto const &field : headers) {
+        if (equalsIgnoringCase(field.name, name)) {
+            return field.value;
+        }
+    }
+
+    return {};
+}
+
+// PUBLIC CREATORS
+
+HttpRequestParser::HttpRequestParser(io::BufferPool &pool, HttpRequestParserOptions const &options) noexcept
+: d_pool(pool)
+, d_options(options)
+{
+    d_options.maxHeadSizeInBytes = std::min(d_options.maxHeadSizeInBytes, io::BufferPool::c_maxBufferSize);
+}
+
+// PUBLIC MANIPULATORS
+
+void HttpRequestParser::append(io::BufferChain bytes) noexcept {
+    d_received.append(std::move(bytes));
+}
+
+bool HttpRequestParser::next(HttpRequest &request) noexcept {
+    char line[c_maxChunkLineSizeInBytes];
+
+    while (true) {
+        switch (d_state) {
+        case State::Head: {
+            auto headSizeInBytes = findHeadEnd();
+
+            if (headSizeInBytes == 0 || !parseHead(headSizeInBytes)) {
+                return false;
+            }
+
+            if (d_state == State::Head) {
+                return complete(request);
+            }
+
+            continue;
+        }
+
+        case State::Body:
+            if (d_received.sizeInBytes() < d_remainingBodySizeInBytes) {
+                return false;
+            }
+
+            d_request.body = d_received.splitFront(d_remainingBodySizeInBytes);
+            d_remainingBodySizeInBytes = 0;
+            return complete(request);
+
+        case State::ChunkSize: {
+            auto length = takeLine(line, sizeof(line));
+
+            if (length < 0) {
+                return d_received.sizeInBytes() >= sizeof(line) ? fail(400) : false;
+            }
+
+            std::uint64_t sizeInBytes = 0;
+            long digitCount = 0;
+            for (; digitCount < length && digitCount < 16; ++digitCount) {
+                char c = toLower(line[digitCount]);
+                int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+
+                if (digit < 0) {
+                    break;
+                }
+
+                sizeInBytes = sizeInBytes * 16 + static_cast<std::uint64_t>(digit);
+            }
+
+            // Chunk extensions after the size are ignored.
+            if (digitCount == 0 || (digitCount < length && line[digitCount] != ';' &&
+                                    line[digitCount] != ' ' && line[digitCount] != '\t')) {
+                return fail(400);
+            }
+
+            if (sizeInBytes > d_options.maxBodySizeInBytes - d_request.body.sizeInBytes()) {
+                return fail(413);
+            }
+
+            d_remainingBodySizeInBytes = sizeInBytes;
+            d_state = sizeInBytes == 0 ? State::Trailer : State::ChunkData;
+            continue;
+        }
+
+        case State::ChunkData: {
+            // Partially received chunks are taken right away, so that the
+            // received buffers only hold bytes that are not parsed yet.
+            auto sizeInBytes = std::min<std::uint64_t>(d_received.sizeInBytes(), d_remainingBodySizeInBytes);
+            d_request.body.append(d_received.splitFront(sizeInBytes));
+            d_remainingBodySizeInBytes -= sizeInBytes;
+
+            if (d_remainingBodySizeInBytes != 0) {
+                return false;
+            }
+
+            d_state = State::ChunkDataEnd;
+            continue;
+        }
+
+        case State::ChunkDataEnd: {
+            auto length = takeLine(line, sizeof(line));
+
+            if (length < 0) {
+                return d_received.sizeInBytes() >= sizeof(line) ? fail(400) : false;
+            }
+
+            if (length != 0) {
+                return fail(400);
+            }
+
+            d_state = State::ChunkSize;
+            continue;
+        }
+
+        case State::Trailer: {
+            // Trailer fields are skipped.
+            auto length = takeLine(line, sizeof(line));
+
+            if (length < 0) {
+                return d_received.sizeInBytes() >= sizeof(line) ? fail(431) : false;
+            }
+
+            if (length != 0) {
+                continue;
+            }
+
+            return complete(request);
+        }
+
+        case State::Error:
+            return false;
+        }
+    }
+}
+
+// PUBLIC ACCESSORS
+
+char const *HttpRequestParser::scanImplementation() const noexcept {
+#ifdef ECO_NET_HTTP_X86
+    if (d_options.useSimd && c_bestFind == findAvx2) {
+        return "avx2";
+    }
+
+    if (d_options.useSimd && c_bestFind == findSse42) {
+        return "sse4.2";
+    }
+#endif
+
+    return "scalar";
+}
+
+// PRIVATE MANIPULATORS
+
+std::size_t HttpRequestParser::findHeadEnd() noexcept {
+    auto find = d_options.useSimd ? c_bestFind : findScalar;
+
+    // Empty lines in front of a request are ignored.
+    while (d_scannedSizeInBytes == 0 && !d_received.empty() &&
+           (*d_received.begin()->data() == '\r' || *d_received.begin()->data() == '\n')) {
+        d_received.trimFront(1);
+    }
+
+    // The head ends with an empty line, so it is found by scanning for line
+    // ends and checking whether only a carriage return separates them.
+    std::size_t sliceOffset = 0;
+
+    for (auto const &slice : d_received) {
+        if (sliceOffset + slice.length <= d_scannedSizeInBytes) {
+            sliceOffset += slice.length;
+            continue;
+        }
+
+        auto begin = slice.data() + (d_scannedSizeInBytes - sliceOffset);
+        auto end = slice.data() + slice.length;
+
+        while (begin != end) {
+            auto delimiter = find(begin, end, '\r', '\n');
+
+            if (delimiter != begin) {
+                d_isLineStart = false;
+            }
+
+            if (delimiter == end) {
+                break;
+            }
+
+            if (*delimiter == '\n') {
+                if (d_isLineStart) {
+                    auto headSizeInBytes = sliceOffset + static_cast<std::size_t>(delimiter + 1 - slice.data());
+                    d_scannedSizeInBytes = 0;
+                    d_isLineStart = false;
+                    return headSizeInBytes > d_options.maxHeadSizeInBytes ? (fail(431), 0) : headSizeInBytes;
+                }
+
+                d_isLineStart = true;
+            }
+
+            begin = delimiter + 1;
+        }
+
+        sliceOffset += slice.length;
+        d_scannedSizeInBytes = sliceOffset;
+    }
+
+    if (d_scannedSizeInBytes > d_options.maxHeadSizeInBytes) {
+        fail(431);
+    }
+
+    return 0;
+}
+
+bool HttpRequestParser::parseHead(std::size_t headSizeInBytes) noexcept {
+    auto find = d_options.useSimd ? c_bestFind : findScalar;
+    d_request.head = d_received.splitFront(headSizeInBytes);
+
+    if (d_request.head.sliceCount() > 1 && !d_request.head.coalesce(d_pool)) {
+        return fail(431);
+    }
+
+    auto begin = d_request.head.begin()->data();
+    auto end = begin + headSizeInBytes;
+
+    // Lines only end with a line feed, so another hop that ends them at a
+    // bare carriage return would see different fields (RFC 9112 2.2).
+    for (auto carriageReturn = find(begin, end, '\r', '\r'); carriageReturn != end;
+         carriageReturn = find(carriageReturn + 1, end, '\r', '\r')) {
+        if (carriageReturn + 1 == end || carriageReturn[1] != '\n') {
+            return fail(400);
+        }
+    }
+
+    // Return the next line without its end, and advance `begin` past it.
+    auto nextLine = [&]() {
+        auto lineEnd = find(begin, end, '\n', '\n');
+        std::string_view line(begin, static_cast<std::size_t>(lineEnd - begin));
+        begin = lineEnd == end ? end : lineEnd + 1;
+
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        return line;
+    };
+
+    auto requestLine = nextLine();
+    auto methodEnd = find(requestLine.data(), requestLine.data() + requestLine.size(), ' ', ' ');
+    d_request.method = requestLine.substr(0, static_cast<std::size_t>(methodEnd - requestLine.data()));
+    requestLine.remove_prefix(std::min(d_request.method.size() + 1, requestLine.size()));
+    auto targetEnd = find(requestLine.data(), requestLine.data() + requestLine.size(), ' ', ' ');
+    d_request.target = requestLine.substr(0, static_cast<std::size_t>(targetEnd - requestLine.data()));
+    requestLine.remove_prefix(std::min(d_request.target.size() + 1, requestLine.size()));
+
+    if (!isToken(d_request.method) || d_request.target.empty()) {
+        return fail(400);
+    }
+
+    if (requestLine.size() != 8 || requestLine.substr(0, 5) != "HTTP/" || requestLine[6] != '.') {
+        return fail(400);
+    }
+
+    if (requestLine[5] != '1' || requestLine[7] < '0' || requestLine[7] > '9') {
+        return fail(505);
+    }
+
+    d_request.minorVersion = requestLine[7] - '0';
+
+    while (true) {
+        auto line = nextLine();
+
+        if (line.empty()) {
+            break;
+        }
+
+        // Folded header fields are obsolete and rejected.
+        auto colon = find(line.data(), line.data() + line.size(), ':', ':');
+        auto name = line.substr(0, static_cast<std::size_t>(colon - line.data()));
+
+        if (colon == line.data() + line.size() || !isToken(name)) {
+            return fail(400);
+        }
+
+        auto value = line.substr(name.size() + 1);
+
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+            value.remove_prefix(1);
+        }
+
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+            value.remove_suffix(1);
+        }
+
+        if (d_request.headers.size() == d_options.maxHeaderCount) {
+            return fail(431);
+        }
+
+        d_request.headers.push_back(HttpHeader{name, value});
+    }
+
+    auto connection = d_request.header("Connection");
+    d_request.keepAlive = d_request.minorVersion == 0 ?
+        containsToken(connection, "keep-alive") :
+        !containsToken(connection, "close");
+
+    std::string_view transferEncoding;
+    std::size_t transferEncodingCount = 0;
+    bool hasContentLength = false;
+    std::uint64_t contentLength = 0;
+
+    for (auto const &field : d_request.headers) {
+        if (equalsIgnoringCase(field.name, "Transfer-Encoding")) {
+            transferEncoding = field.value;
+            ++transferEncodingCount;
+            continue;
+        }
+
+        if (!equalsIgnoringCase(field.name, "Content-Length")) {
+            continue;
+        }
+
+        std::uint64_t value = 0;
+        if (field.value.empty() || field.value.size() > 18 ||
+            !std::all_of(field.value.begin(), field.value.end(), [&](char c) {
+                value = value * 10 + static_cast<std::uint64_t>(c - '0');
+                return c >= '0' && c <= '9';
+            })) {
+            return fail(400);
+        }
+
+        // Conflicting lengths could make the parser and another hop disagree
+        // about where the next request starts.
+        if (hasContentLength && value != contentLength) {
+            return fail(400);
+        }
+
+        hasContentLength = true;
+        contentLength = value;
+    }
+
+    if (transferEncodingCount != 0) {
+        // Only a single field of exactly `chunked` frames the body in one
+        // way. Repeated, empty or listed codings, or codings that HTTP/1.0
+        // does not know, could make another hop find a different end of the
+        // request.
+        if (hasContentLength || transferEncodingCount > 1 || transferEncoding.empty() ||
+            transferEncoding.find(',') != std::string_view::npos || d_request.minorVersion == 0) {
+            return fail(400);
+        }
+
+        if (!equalsIgnoringCase(transferEncoding, "chunked")) {
+            return fail(501);
+        }
+
+        d_state = State::ChunkSize;
+        return true;
+    }
+
+    if (contentLength > d_options.maxBodySizeInBytes) {
+        return fail(413);
+    }
+
+    d_remainingBodySizeInBytes = contentLength;
+    d_state = contentLength == 0 ? State::Head : State::Body;
+    return true;
+}
+
+long HttpRequestParser::takeLine(char *line, std::size_t capacity) noexcept {
+    auto sizeInBytes = d_received.copyTo(line, capacity);
+    auto lineEnd = findScalar(line, line + sizeInBytes, '\n', '\n');
+
+    if (lineEnd == line + sizeInBytes) {
+        return -1;
+    }
+
+    auto length = lineEnd - line;
+    d_received.trimFront(static_cast<std::size_t>(length + 1));
+
+    if (length > 0 && line[length - 1] == '\r') {
+        --length;
+    }
+
+    if (findScalar(line, line + length, '\r', '\r') != line + length) {
+        fail(400);
+        return -1;
+    }
+
+    return length;
+}
+
+bool HttpRequestParser::complete(HttpRequest &request) noexcept {
+    // The request is swapped out, so that the header vector of the previous
+    // request is reused.
+    std::swap(request, d_request);
+    d_request.method = {};
+    d_request.target = {};
+    d_request.minorVersion = 1;
+    d_request.headers.clear();
+    d_request.body.clear();
+    d_request.keepAlive = true;
+    d_request.head.clear();
+    d_state = State::Head;
+    return true;
+}
+
+bool HttpRequestParser::fail(int status) noexcept {
+    if (d_state != State::Error) {
+        d_state = State::Error;
+        d_errorStatus = status;
+    }
+
+    return false;
+}
+
+}
+}
@@ -0,0 +1,220 @@
+#ifndef ECO_NET_HTTPREQUESTPARSER
+#define ECO_NET_HTTPREQUESTPARSER
+
+#include <io/bufferchain.h>
+#include <io/bufferpool.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace eco {
+namespace net {
+
+    /**
+     * @brief A header field of an HTTP request.
+     */
+    struct HttpHeader {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    /**
+     * @brief An HTTP/1.x request whose fields are views of the received
+     * bytes.
+     *
+     * The views stay valid as long as the request, which holds the buffers
+     * they refer to, is neither destroyed nor reused for the next request.
+     */
+    struct HttpRequest {
+        std::string_view method;
+        std::string_view target;
+
+        /**
+         * @brief The minor version of HTTP/1.x.
+         */
+        int minorVersion = 1;
+
+        std::vector<HttpHeader> headers;
+
+        /**
+         * @brief The body, with the chunks of a chunked body as slices of the
+         * received buffers, without the chunk framing.
+         */
+        io::BufferChain body;
+
+        /**
+         * @brief Whether the connection stays open after the response, as
+         * requested by the version and `Connection` header of the request.
+         */
+        bool keepAlive = true;
+
+        /**
+         * @brief The buffers of the request line and header fields.
+         */
+        io::BufferChain head;
+
+        /**
+         * @brief Return the value of the first header field with the specified
+         * `name`, compared case-insensitively, or an empty view.
+         */
+        std::string_view header(std::string_view name) const noexcept;
+    };
+
+    /**
+     * @brief Limits of the HTTP request parser.
+     */
+    struct HttpRequestParserOptions {
+        /**
+         * @brief The largest request line and header fields, at most
+         * `io::BufferPool::c_maxBufferSize`.
+         */
+        std::size_t maxHeadSizeInBytes = 16 * 1024;
+
+        std::size_t maxHeaderCount = 64;
+
+        std::size_t maxBodySizeInBytes = 1024 * 1024;
+
+        /**
+         * @brief Scan for delimiters with the SSE4.2 or AVX2 instructions when
+         * the processor supports them. Disabling it is meant for testing the
+         * scalar scan.
+         */
+        bool useSimd = true;
+    };
+
+    /**
+     * @brief Incremental parser of pipelined HTTP/1.x requests.
+     *
+     * Received bytes are appended as they arrive, and each complete request is
+     * taken out with `next`, so that several requests that arrived with one
+     * read are parsed without further reads. Delimiters are located with
+     * vector instructions that compare 16 or 32 bytes at a time where the
+     * processor supports them. The request line and header fields are parsed
+     * in place and handed out as views; only a head that spans several
+     * received buffers is copied into one buffer of the pool first. Bodies
+     * with a `Content-Length` and chunked bodies are handed out as slices of
+     * the received buffers. A `Transfer-Encoding` is only accepted as a single
+     * field of `chunked` in an HTTP/1.1 request without `Content-Length`,
+     * and a carriage return only in front of a line feed.
+     *
+     * Once a request was malformed or exceeded a limit, the parser stays in
+     * the error state, and `errorStatus` tells the status code to respond
+     * with before closing the connection.
+     *
+     * This class is not thread-safe.
+     */
+    class HttpRequestParser {
+        // PRIVATE TYPES
+        enum class State { Head, Body, ChunkSize, ChunkData, ChunkDataEnd, Trailer, Error };
+
+        // PRIVATE DATA
+        io::BufferPool &d_pool;
+        HttpRequestParserOptions d_options;
+        io::BufferChain d_received;
+        State d_state = State::Head;
+
+        // The part of the received bytes that was scanned for the end of the
+        // head, and whether the scan stopped at the start of a line.
+        std::size_t d_scannedSizeInBytes = 0;
+        bool d_isLineStart = false;
+
+        // The request whose body is being received.
+        HttpRequest d_request;
+        std::uint64_t d_remainingBodySizeInBytes = 0;
+        int d_errorStatus = 0;
+
+    public:
+        // PUBLIC CREATORS
+
+        /**
+         * @brief Create a parser that copies heads spanning several buffers
+         * into buffers of the specified `pool`, and applies the specified
+         * `options`.
+         */
+        explicit HttpRequestParser(
+            io::BufferPool &pool,
+            HttpRequestParserOptions const &options = HttpRequestParserOptions()) noexcept;
+
+        HttpRequestParser(HttpRequestParser const &) = delete;
+        HttpRequestParser &operator=(HttpRequestParser const &) = delete;
+
+        // PUBLIC MANIPULATORS
+
+        /**
+         * @brief Append the specified received `bytes`.
+         */
+        void append(io::BufferChain bytes) noexcept;
+
+        /**
+         * @brief Move the next complete request into the specified `request`.
+         * Return `false` when no complete request was received or the parser
+         * is in the error state.
+         */
+        bool next(HttpRequest &request) noexcept;
+
+        // PUBLIC ACCESSORS
+
+        bool hasError() const noexcept {
+            return d_state == State::Error;
+        }
+
+        /**
+         * @brief Return the status code that describes the error, or `0`.
+         */
+        int errorStatus() const noexcept {
+            return d_errorStatus;
+        }
+
+        std::size_t receivedSizeInBytes() const noexcept {
+            return d_received.sizeInBytes();
+        }
+
+        /**
+         * @brief Return the name of the instructions used to scan for
+         * delimiters: "avx2", "sse4.2" or "scalar".
+         */
+        char const *scanImplementation() const noexcept;
+
+    private:
+        // PRIVATE MANIPULATORS
+
+        /**
+         * @brief Return the size of the head when it was received completely,
+         * or `0`.
+         */
+        std::size_t findHeadEnd() noexcept;
+
+        /**
+         * @brief Parse the head of the specified `headSizeInBytes` into the
+         * request being received. Return `false` on error.
+         */
+        bool parseHead(std::size_t headSizeInBytes) noexcept;
+
+        /**
+         * @brief Take the next line of a chunked body into the specified
+         * `line`, which has room for the specified `capacity` bytes. Return
+         * the length of the line without its end, or `-1` when it was not
+         * received completely or failed the parser because it contains a
+         * bare carriage return.
+         */
+        long takeLine(char *line, std::size_t capacity) noexcept;
+
+        /**
+         * @brief Move the received request into the specified `request` and
+         * start receiving the next one. Return `true`.
+         */
+        bool complete(HttpRequest &request) noexcept;
+
+        /**
+         * @brief Enter the error state with the specified `status`, unless
+         * the parser failed already. Return `false`.
+         */
+        bool fail(int status) noexcept;
+    };
+
+}
+}
+
+#endif //  ECO_NET_HTTPREQUESTPARSER
@@ -0,0 +1,200 @@
+#include <net/httprequestparser.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+using namespace eco;
+using namespace eco::net;
+
+namespace {
+    io::BufferChain createChain(io::BufferPool &pool, std::string const &bytes) {
+        auto buffer = pool.allocate(bytes.size());
+        std::memcpy(buffer.data(), bytes.data(), bytes.size());
+        io::BufferChain chain;
+        chain.append(buffer, 0, bytes.size());
+        return chain;
+    }
+
+    std::string toString(io::BufferChain const &chain) {
+        std::string bytes(chain.sizeInBytes(), '\0');
+        chain.copyTo(&bytes[0], bytes.size());
+        return bytes;
+    }
+
+    HttpRequestParserOptions scalarOptions() {
+        HttpRequestParserOptions options;
+        options.useSimd = false;
+        return options;
+    }
+}
+
+class HttpRequestParserTest : public testing::TestWithParam<bool> {
+protected:
+    io::BufferPool d_pool;
+
+    HttpRequestParserOptions options() {
+        HttpRequestParserOptions options;
+        options.useSimd = GetParam();
+        return options;
+    }
+};
+
+INSTANTIATE_TEST_SUITE_P(Scan, HttpRequestParserTest, testing::Bool());
+
+TEST_P(HttpRequestParserTest, Request) {
+    // GIVEN
+    HttpRequestParser sut(d_pool, options());
+    std::string padding(100, 'p');
+    auto bytes = "GET /metrics?format=text HTTP/1.1\r\n"
+                 "Host: localhost\r\n"
+                 "X-Padding:  " + padding + " \r\n"
+                 "accept: */*\r\n"
+                 "\r\n";
+    auto received = createChain(d_pool, bytes);
+    auto data = received.begin()->data();
+
+    // WHEN
+    sut.append(received);
+    HttpRequest request;
+    ASSERT_TRUE(sut.next(request));
+
+    // THEN the fields are views of the received buffer
+    EXPECT_EQ("GET", request.method);
+    EXPECT_EQ(data, request.method.data());
+    EXPECT_EQ("/metrics?format=text", request.target);
+    EXPECT_EQ(1, request.minorVersion);
+    ASSERT_EQ(3, request.headers.size());
+    EXPECT_EQ("Host", request.headers[0].name);
+    EXPECT_EQ("localhost", request.headers[0].value);
+    EXPECT_EQ(padding, request.header("x-padding"));
+    EXPECT_EQ("*/*", request.header("Accept"));
+    EXPECT_TRUE(request.keepAlive);
+    EXPECT_TRUE(request.body.empty());
+    EXPECT_FALSE(sut.next(request));
+    EXPECT_FALSE(sut.hasError());
+}
+
+TEST_P(HttpRequestParserTest, PipelinedAcrossReads) {
+    // GIVEN
+    HttpRequestParser sut(d_pool, options());
+    std::string bytes = "POST /a HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello"
+                        "GET /b HTTP/1.0\r\n\r\n"
+                        "GET /c HTTP/1.1\r\nConnection: close\r\n\r\n";
+    HttpRequest requests[3];
+    std::size_t count = 0;
+
+    // WHEN the bytes arrive in pieces of 7 bytes
+    for (std::size_t offset = 0; offset < bytes.size(); offset += 7) {
+        sut.append(createChain(d_pool, bytes.substr(offset, 7)));
+        while (count < 3 && sut.next(requests[count])) {
+            ++count;
+        }
+    }
+
+    // THEN
+    ASSERT_EQ(3, count);
+    EXPECT_EQ("/a", requests[0].target);
+    EXPECT_EQ("hello", toString(requests[0].body));
+    EXPECT_TRUE(requests[0].keepAlive);
+    EXPECT_EQ("/b", requests[1].target);
+    EXPECT_EQ(0, requests[1].minorVersion);
+    EXPECT_FALSE(requests[1].keepAlive);
+    EXPECT_EQ("/c", requests[2].target);
+    EXPECT_FALSE(requests[2].keepAlive);
+    EXPECT_EQ(0, sut.receivedSizeInBytes());
+}
+
+TEST_P(HttpRequestParserTest, ChunkedBody) {
+    // GIVEN
+    HttpRequestParser sut(d_pool, options());
+    sut.append(createChain(d_pool, "\r\nPUT /upload HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                                   "5;name=value\r\nhello\r\n"
+                                   "1A\r\n abcdefghijklmnopqrstuvwxy\r\n"));
+    HttpRequest request;
+    EXPECT_FALSE(sut.next(request));
+
+    // WHEN
+    sut.append(createChain(d_pool, "0\r\nChecksum: 1\r\n\r\nGET / HTTP/1.1\r\n\r\n"));
+
+    // THEN the chunks are slices of the received buffers
+    ASSERT_TRUE(sut.next(request));
+    EXPECT_EQ("PUT", request.method);
+    EXPECT_EQ("hello abcdefghijklmnopqrstuvwxy", toString(request.body));
+    EXPECT_EQ(2, request.body.sliceCount());
+    ASSERT_TRUE(sut.next(request));
+    EXPECT_EQ("/", request.target);
+}
+
+TEST_P(HttpRequestParserTest, Errors) {
+    struct Case {
+        char const *bytes;
+        int status;
+    } cases[] = {
+        {"GET /\r\n\r\n", 400},
+        {"GET / HTTP/2.0\r\n\r\n", 505},
+        {"G(T / HTTP/1.1\r\n\r\n", 400},
+        {"GET / HTTP/1.1\r\nNo colon\r\n\r\n", 400},
+        {"GET / HTTP/1.1\r\nName : value\r\n\r\n", 400},
+        {"GET / HTTP/1.1\r\nA: b\r\n folded\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nContent-Length: 1\r\nTransfer-Encoding: chunked\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n", 501},
+        {"POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nTransfer-Encoding: chunked\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nTransfer-Encoding: identity\r\nTransfer-Encoding: chunked\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nTransfer-Encoding:\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nTransfer-Encoding: chunked, identity\r\n\r\n", 400},
+        {"POST / HTTP/1.0\r\nTransfer-Encoding: chunked\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nContent-Length: 2000000\r\n\r\n", 413},
+        {"POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n", 400},
+        {"GET /\r HTTP/1.1\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nX: a\rTransfer-Encoding: chunked\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nX: a\r\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n1;a\rb\r\n", 400},
+        {"POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n0\r\nX: a\rb\r\n", 400},
+    };
+
+    for (auto const &testCase : cases) {
+        // GIVEN
+        HttpRequestParser sut(d_pool, options());
+        HttpRequest request;
+
+        // WHEN
+        sut.append(createChain(d_pool, testCase.bytes));
+
+        // THEN
+        EXPECT_FALSE(sut.next(request)) << testCase.bytes;
+        EXPECT_TRUE(sut.hasError()) << testCase.bytes;
+        EXPECT_EQ(testCase.status, sut.errorStatus()) << testCase.bytes;
+    }
+}
+
+TEST_P(HttpRequestParserTest, HeadTooLarge) {
+    // GIVEN
+    auto parserOptions = options();
+    parserOptions.maxHeadSizeInBytes = 64;
+    HttpRequestParser sut(d_pool, parserOptions);
+    HttpRequest request;
+
+    // WHEN
+    sut.append(createChain(d_pool, "GET / HTTP/1.1\r\nX-Long: " + std::string(100, 'l')));
+
+    // THEN
+    EXPECT_FALSE(sut.next(request));
+    EXPECT_EQ(431, sut.errorStatus());
+}
+
+TEST(HttpRequestParser, ScanImplementation) {
+    // GIVEN
+    io::BufferPool pool;
+
+    // WHEN
+    HttpRequestParser simd(pool);
+    HttpRequestParser scalar(pool, scalarOptions());
+
+    // THEN
+    EXPECT_STREQ("scalar", scalar.scanImplementation());
+    EXPECT_NE(nullptr, simd.scanImplementation());
+}
@@ -0,0 +1,336 @@
+#include <net/httpserver.h>
+
+#include <cstring>
+#include <new>
+
+namespace eco {
+namespace net {
+
+namespace {
+    char const *reasonPhrase(int status) noexcept {
+        switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 301: return "Moved Permanently";
+        case 302: return "Found";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Content Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        case 505: return "HTTP Version Not Supported";
+        default: return "Unknown";
+        }
+    }
+}
+
+// PRIVATE TYPES
+
+/**
+ * @brief Reads the requests of one connection and writes the responses.
+ */
+class HttpServer::Connection {
+    // PRIVATE DATA
+    HttpServer &d_server;
+    std::unique_ptr<AsyncConnectedSocket> d_socket;
+    HttpRequestParser d_parser;
+    HttpRequest d_request;
+    io::BufferChain d_readBuffers;
+    std::size_t d_chargedSizeInBytes = 0;
+    bool d_isReading = false;
+    bool d_isAdvancing = false;
+    bool d_isClosing = false;
+    std::shared_ptr<bool> d_isAlive;
+
+public:
+    // PUBLIC CREATORS
+    Connection(HttpServer &server, std::unique_ptr<AsyncConnectedSocket> socket) noexcept
+    : d_server(server)
+    , d_socket(std::move(socket))
+    , d_parser(server.d_pool, server.d_options.parserOptions)
+    , d_isAlive(std::make_shared<bool>(true))
+    {
+    }
+
+    ~Connection() {
+        // Callbacks of the pending operations can still run, inline while
+        // the socket is destroyed or later through the dispatcher, and must
+        // not act on this connection anymore.
+        *d_isAlive = false;
+        d_socket->memoryBudget().release(d_chargedSizeInBytes);
+        d_socket.reset();
+    }
+
+    // PUBLIC MANIPULATORS
+
+    /**
+     * @brief Handle the complete requests that were received, and read more
+     * when none is left.
+     */
+    void advance() noexcept {
+        // Reads that complete inline are continued by this loop rather than
+        // by their callbacks, so that a burst of reads does not recurse.
+        d_isAdvancing = true;
+
+        while (!d_isReading && !d_isClosing) {
+            while (!d_isClosing && d_parser.next(d_request)) {
+                bool close = false;
+                auto response = d_server.respond(d_request, close);
+                write(std::move(response), close);
+            }
+
+            updateCharge();
+
+            if (d_isClosing) {
+                break;
+            }
+
+            if (d_parser.hasError()) {
+                write(d_server.respondWithError(d_parser.errorStatus()), true);
+                break;
+            }
+
+            auto buffer = d_server.d_pool.allocate(d_server.d_options.readSizeInBytes);
+
+            if (!buffer) {
+                write(d_server.respondWithError(503), true);
+                break;
+            }
+
+            // The buffers are kept by this connection rather than by the
+            // callback, which can outlive the pool when it is dispatched.
+            d_readBuffers = io::BufferChain(std::move(buffer));
+            d_isReading = true;
+            d_socket->readAsync(d_readBuffers).setResultCallback([this, isAlive = d_isAlive](std::size_t count) {
+                if (*isAlive) {
+                    onRead(count);
+                }
+            });
+        }
+
+        d_isAdvancing = false;
+    }
+
+private:
+    // PRIVATE MANIPULATORS
+
+    void onRead(std::size_t count) noexcept {
+        auto buffers = std::move(d_readBuffers);
+        d_isReading = false;
+
+        if (d_isClosing) {
+            return;
+        }
+
+        if (count == 0) {
+            d_isClosing = true;
+            d_server.close(this);
+            return;
+        }
+
+        buffers.trimBack(buffers.sizeInBytes() - count);
+        d_parser.append(std::move(buffers));
+        updateCharge();
+
+        if (!d_isAdvancing) {
+            advance();
+        }
+    }
+
+    /**
+     * @brief Charge the bytes buffered by the parser to the memory budget of
+     * the socket, or release those of the handled requests, in which case
+     * the socket can resume reading.
+     */
+    void updateCharge() noexcept {
+        auto &budget = d_socket->memoryBudget();
+        auto sizeInBytes = d_parser.receivedSizeInBytes();
+
+        if (sizeInBytes >= d_chargedSizeInBytes) {
+            budget.charge(sizeInBytes - d_chargedSizeInBytes);
+            d_chargedSizeInBytes = sizeInBytes;
+            return;
+        }
+
+        budget.release(d_chargedSizeInBytes - sizeInBytes);
+        d_chargedSizeInBytes = sizeInBytes;
+        d_socket->resumeReading();
+    }
+
+    /**
+     * @brief Write the specified `response`, and close the connection once
+     * it was written when the specified `close` is set.
+     */
+    void write(io::BufferChain response, bool close) noexcept {
+        auto sizeInBytes = response.sizeInBytes();
+        d_isClosing = d_isClosing || close;
+
+        if (response.empty()) {
+            d_isClosing = true;
+            d_server.close(this);
+            return;
+        }
+
+        d_socket->writeAsync(std::move(response)).setResultCallback([this, isAlive = d_isAlive, sizeInBytes, close](std::size_t count) {
+            if (*isAlive && (close || count < sizeInBytes)) {
+                d_isClosing = true;
+                d_server.close(this);
+            }
+        });
+    }
+};
+
+// PRIVATE CREATORS
+
+HttpServer::HttpServer(AsyncSocketManager &manager, Handler handler, HttpServerOptions const &options) noexcept
+: d_manager(manager)
+, d_handler(std::move(handler))
+, d_options(options)
+, d_isAlive(std::make_shared<bool>(true))
+{
+}
+
+// PUBLIC STATIC CREATORS
+
+std::unique_ptr<HttpServer> HttpServer::listen(
+    AsyncSocketManager &manager,
+    sockaddr const *address,
+    socklen_t addressLength,
+    Handler handler,
+    HttpServerOptions const &options) noexcept {
+    auto server = std::unique_ptr<HttpServer>(new (std::nothrow) HttpServer(manager, std::move(handler), options));
+
+    if (server == nullptr) {
+        return nullptr;
+    }
+
+    // Responses to pipelined requests are sent together.
+    auto acceptorOptions = options.acceptorOptions;
+    acceptorOptions.socketOptions.coalesceWrites = true;
+
+    auto serverPointer = server.get();
+    server->d_acceptor = manager.listen(
+        address,
+        addressLength,
+        [serverPointer](std::unique_ptr<AsyncConnectedSocket> socket) {
+            serverPointer->onAccept(std::move(socket));
+        },
+        acceptorOptions);
+
+    if (server->d_acceptor == nullptr) {
+        return nullptr;
+    }
+
+    return server;
+}
+
+// PUBLIC CREATORS
+
+HttpServer::~HttpServer() {
+    *d_isAlive = false;
+    d_acceptor.reset();
+    d_closedConnections.clear();
+    d_connections.clear();
+}
+
+// PRIVATE MANIPULATORS
+
+void HttpServer::onAccept(std::unique_ptr<AsyncConnectedSocket> socket) noexcept {
+    auto connection = std::unique_ptr<Connection>(new (std::nothrow) Connection(*this, std::move(socket)));
+
+    if (connection == nullptr) {
+        return;
+    }
+
+    auto pointer = connection.get();
+    d_connections.emplace(pointer, std::move(connection));
+    pointer->advance();
+}
+
+io::BufferChain HttpServer::respond(HttpRequest const &request, bool &close) noexcept {
+    ++d_requestCount;
+
+    HttpResponse response;
+    d_handler(request, response);
+    close = response.close || !request.keepAlive;
+    response.close = close;
+    return serialize(response, request.method == "HEAD");
+}
+
+io::BufferChain HttpServer::respondWithError(int status) noexcept {
+    HttpResponse response;
+    response.status = status;
+    response.close = true;
+    return serialize(response, false);
+}
+
+io::BufferChain HttpServer::serialize(HttpResponse &response, bool isHead) noexcept {
+    std::string head;
+    head.reserve(256);
+    head += "HTTP/1.1 ";
+    head += std::to_string(response.status);
+    head += ' ';
+    head += reasonPhrase(response.status);
+    head += "\r\n";
+
+    for (auto const &field : response.headers) {
+        head += field.first;
+        head += ": ";
+        head += field.second;
+        head += "\r\n";
+    }
+
+    head += "Content-Length: ";
+    head += std::to_string(response.body.sizeInBytes());
+    head += response.close ? "\r\nConnection: close\r\n\r\n" : "\r\n\r\n";
+
+    auto buffer = d_pool.allocate(head.size());
+
+    if (!buffer) {
+        return io::BufferChain();
+    }
+
+    std::memcpy(buffer.data(), head.data(), head.size());
+    io::BufferChain chain;
+    chain.append(std::move(buffer), 0, head.size());
+
+    if (!isHead) {
+        chain.append(std::move(response.body));
+    }
+
+    return chain;
+}
+
+void HttpServer::close(Connection *connection) noexcept {
+    auto position = d_connections.find(connection);
+
+    if (position == d_connections.end()) {
+        return;
+    }
+
+    d_closedConnections.push_back(std::move(position->second));
+    d_connections.erase(position);
+
+    if (!d_isReleaseDeferred) {
+        d_isReleaseDeferred = true;
+        d_manager.defer([this, isAlive = d_isAlive] {
+            if (*isAlive) {
+                releaseClosedConnections();
+            }
+        });
+    }
+}
+
+void HttpServer::releaseClosedConnections() noexcept {
+    d_isReleaseDeferred = false;
+    d_closedConnections.clear();
+}
+
+}
+}
@@ -0,0 +1,170 @@
+#ifndef ECO_NET_HTTPSERVER
+#define ECO_NET_HTTPSERVER
+
+#include <net/asyncacceptor.h>
+#include <net/asyncconnectedsocket.h>
+#include <net/asyncsocketmanager.h>
+#include <net/httprequestparser.h>
+
+#include <io/bufferchain.h>
+#include <io/bufferpool.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace eco {
+namespace net {
+
+    /**
+     * @brief The response to an HTTP request.
+     */
+    struct HttpResponse {
+        int status = 200;
+
+        /**
+         * @brief Header fields in addition to `Content-Length` and
+         * `Connection`, which the server sets.
+         */
+        std::vector<std::pair<std::string, std::string>> headers;
+
+        io::BufferChain body;
+
+        /**
+         * @brief Close the connection after the response.
+         */
+        bool close = false;
+    };
+
+    /**
+     * @brief Options of an HTTP server.
+     */
+    struct HttpServerOptions {
+        HttpRequestParserOptions parserOptions;
+
+        /**
+         * @brief The size of the buffers that requests are read into.
+         */
+        std::size_t readSizeInBytes = 16 * 1024;
+
+        AsyncAcceptorOptions acceptorOptions;
+    };
+
+    /**
+     * @brief Minimal HTTP/1.1 server, e.g. for health and metrics endpoints.
+     *
+     * Each request is passed to the handler, which fills in the response right
+     * away. Pipelined requests that arrive with one read are all handled
+     * before the next read, and their responses are coalesced into one send
+     * per loop iteration of the socket manager. Connections are kept alive
+     * unless the request or response asks to close them. Malformed requests
+     * are answered with the status reported by the parser, after which the
+     * connection is closed.
+     *
+     * Received bytes of requests that are not complete yet and responses that
+     * are not sent yet are charged to the memory budget of their connection,
+     * whose limits are given by the socket options of the acceptor. While a
+     * budget is exhausted the connection is not read, so a limit must exceed
+     * the largest request.
+     *
+     * This class is not thread-safe: use it on the thread that processes the
+     * events of its socket manager.
+     */
+    class HttpServer {
+    public:
+        // PUBLIC TYPES
+        using Handler = std::function<void(HttpRequest const &, HttpResponse &)>;
+
+    private:
+        // PRIVATE TYPES
+        class Connection;
+
+        // PRIVATE DATA
+        AsyncSocketManager &d_manager;
+        Handler d_handler;
+        HttpServerOptions d_options;
+        io::BufferPool d_pool;
+        std::unordered_map<Connection *, std::unique_ptr<Connection>> d_connections;
+        std::vector<std::unique_ptr<Connection>> d_closedConnections;
+        std::uint64_t d_requestCount = 0;
+        bool d_isReleaseDeferred = false;
+        std::shared_ptr<bool> d_isAlive;
+        std::unique_ptr<AsyncAcceptor> d_acceptor;
+
+        // PRIVATE CREATORS
+        HttpServer(AsyncSocketManager &manager, Handler handler, HttpServerOptions const &options) noexcept;
+
+    public:
+        // PUBLIC STATIC CREATORS
+
+        /**
+         * @brief Listen on the specified `address` of the specified
+         * `addressLength` in the specified `manager`, and pass requests to the
+         * specified `handler`. Return `nullptr` on failure.
+         */
+        static std::unique_ptr<HttpServer> listen(
+            AsyncSocketManager &manager,
+            sockaddr const *address,
+            socklen_t addressLength,
+            Handler handler,
+            HttpServerOptions const &options = HttpServerOptions()) noexcept;
+
+        // PUBLIC CREATORS
+        HttpServer(HttpServer const &) = delete;
+        HttpServer &operator=(HttpServer const &) = delete;
+
+        ~HttpServer();
+
+        // PUBLIC ACCESSORS
+
+        AsyncAcceptor &acceptor() noexcept {
+            return *d_acceptor;
+        }
+
+        std::size_t connectionCount() const noexcept {
+            return d_connections.size();
+        }
+
+        std::uint64_t requestCount() const noexcept {
+            return d_requestCount;
+        }
+
+    private:
+        // PRIVATE MANIPULATORS
+
+        void onAccept(std::unique_ptr<AsyncConnectedSocket> socket) noexcept;
+
+        /**
+         * @brief Handle the specified `request` and return the serialized
+         * response, which asks to close the connection when the specified
+         * `close` is set.
+         */
+        io::BufferChain respond(HttpRequest const &request, bool &close) noexcept;
+
+        /**
+         * @brief Return the serialized response with the specified `status`
+         * and no body, which closes the connection.
+         */
+        io::BufferChain respondWithError(int status) noexcept;
+
+        io::BufferChain serialize(HttpResponse &response, bool isHead) noexcept;
+
+        /**
+         * @brief Destroy the specified `connection` once no callback of it
+         * runs anymore, which the manager defers until its current batch of
+         * events was handed out.
+         */
+        void close(Connection *connection) noexcept;
+
+        void releaseClosedConnections() noexcept;
+    };
+
+}
+}
+
+#endif //  ECO_NET_HTTPSERVER
@@ -0,0 +1,174 @@
+#include <net/httpserver.h>
+
+#include <net/testloop.test.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace eco;
+using namespace eco::net;
+
+namespace {
+    struct Fixture : test::TestLoop {
+        std::unique_ptr<HttpServer> d_server;
+
+        explicit Fixture(std::shared_ptr<async::Dispatcher> dispatcher = nullptr)
+        : TestLoop(std::move(dispatcher))
+        {
+            sockaddr_in address = {};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            d_server = HttpServer::listen(
+                d_manager,
+                reinterpret_cast<sockaddr *>(&address),
+                sizeof(address),
+                [this](HttpRequest const &request, HttpResponse &response) {
+                    handle(request, response);
+                });
+        }
+
+        void handle(HttpRequest const &request, HttpResponse &response) {
+            if (request.target != "/echo") {
+                response.status = 404;
+                return;
+            }
+
+            response.headers.emplace_back("Content-Type", "text/plain");
+            response.body = request.body;
+        }
+
+        int connect() {
+            sockaddr_in address = {};
+            socklen_t length = sizeof(address);
+            EXPECT_EQ(0, getsockname(
+                d_server->acceptor().fileDescriptor(), reinterpret_cast<sockaddr *>(&address), &length));
+
+            int client = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+            ::connect(client, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+            return client;
+        }
+
+        /**
+         * Process events until the specified `client` received the specified
+         * `sizeInBytes` bytes, or until it was closed when the specified
+         * `isClosed` is given, in which case it is set, and return the
+         * received bytes.
+         */
+        std::string receive(int client, std::size_t sizeInBytes, bool *isClosed = nullptr) {
+            std::string received;
+
+            processUntil([&] {
+                char buffer[4096];
+                auto count = read(client, buffer, sizeof(buffer));
+
+                if (count > 0) {
+                    received.append(buffer, static_cast<std::size_t>(count));
+                }
+
+                if (count == 0 && isClosed != nullptr) {
+                    *isClosed = true;
+                }
+
+                return count == 0 || (isClosed == nullptr && received.size() >= sizeInBytes);
+            });
+
+            return received;
+        }
+    };
+}
+
+TEST(HttpServer, PipelinedRequests) {
+    // GIVEN
+    Fixture fixture;
+    ASSERT_NE(nullptr, fixture.d_server);
+    int client = fixture.connect();
+    std::string requests = "POST /echo HTTP/1.1\r\nContent-Length: 4\r\n\r\nping"
+                           "GET /missing HTTP/1.1\r\n\r\n"
+                           "HEAD /echo HTTP/1.1\r\n\r\n";
+    std::string expected = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 4\r\n\r\nping"
+                           "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n"
+                           "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 0\r\n\r\n";
+
+    // WHEN
+    fixture.receive(client, 0);
+    ASSERT_EQ(static_cast<ssize_t>(requests.size()), write(client, requests.data(), requests.size()));
+    auto received = fixture.receive(client, expected.size());
+
+    // THEN
+    EXPECT_EQ(expected, received);
+    EXPECT_EQ(3, fixture.d_server->requestCount());
+    EXPECT_EQ(1, fixture.d_server->connectionCount());
+    close(client);
+}
+
+TEST(HttpServer, CloseAfterResponse) {
+    // GIVEN
+    Fixture fixture;
+    ASSERT_NE(nullptr, fixture.d_server);
+    int client = fixture.connect();
+    std::string request = "GET /missing HTTP/1.1\r\nConnection: close\r\n\r\nGET /ignored HTTP/1.1\r\n\r\n";
+
+    // WHEN
+    fixture.receive(client, 0);
+    ASSERT_EQ(static_cast<ssize_t>(request.size()), write(client, request.data(), request.size()));
+    bool isClosed = false;
+    auto received = fixture.receive(client, 0, &isClosed);
+
+    // THEN the connection is closed right after the response.
+    EXPECT_TRUE(isClosed);
+    EXPECT_EQ("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n", received);
+    EXPECT_EQ(1, fixture.d_server->requestCount());
+    EXPECT_EQ(0, fixture.d_server->connectionCount());
+    close(client);
+}
+
+TEST(HttpServer, MalformedRequest) {
+    // GIVEN
+    Fixture fixture;
+    ASSERT_NE(nullptr, fixture.d_server);
+    int client = fixture.connect();
+    std::string request = "GET / HTTP/3.0\r\n\r\n";
+
+    // WHEN
+    fixture.receive(client, 0);
+    ASSERT_EQ(static_cast<ssize_t>(request.size()), write(client, request.data(), request.size()));
+    bool isClosed = false;
+    auto received = fixture.receive(client, 0, &isClosed);
+
+    // THEN the connection is closed right after the response.
+    EXPECT_TRUE(isClosed);
+    EXPECT_EQ("HTTP/1.1 505 HTTP Version Not Supported\r\nContent-Length: 0\r\nConnection: close\r\n\r\n", received);
+    EXPECT_EQ(0, fixture.d_server->requestCount());
+    close(client);
+}
+
+TEST(HttpServer, DestroyedBeforeDispatchedCompletions) {
+    // GIVEN a server whose completions are dispatched
+    auto dispatcher = std::make_shared<test::QueueDispatcher>();
+    Fixture fixture(dispatcher);
+    ASSERT_NE(nullptr, fixture.d_server);
+    int client = fixture.connect();
+    ASSERT_TRUE(fixture.processUntil([&] {
+        dispatcher->runAll();
+        return fixture.d_server->connectionCount() == 1;
+    }));
+
+    // WHEN the server is destroyed before the completion of a read runs
+    std::string request = "GET /missing HTTP/1.1\r\n\r\n";
+    ASSERT_EQ(static_cast<ssize_t>(request.size()), write(client, request.data(), request.size()));
+    ASSERT_TRUE(fixture.processUntil([&] { return !dispatcher->d_functions.empty(); }));
+    fixture.d_server.reset();
+    dispatcher->runAll();
+
+    // THEN the completion is ignored, and the connection was closed.
+    char byte = 0;
+    EXPECT_EQ(0, read(client, &byte, 1));
+    close(client);
+}
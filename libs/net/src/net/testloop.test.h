@@ -0,0 +1,147 @@
+#ifndef ECO_NET_TESTLOOP
+#define ECO_NET_TESTLOOP
+
+#include <net/asyncsocketmanager.h>
+
+#include <async/dispatcher.h>
+#include <io/bufferchain.h>
+#include <io/bufferpool.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <memory>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace eco {
+namespace net {
+namespace test {
+
+    /**
+     * @brief A dispatcher that queues the dispatched functions until the test
+     * runs them.
+     */
+    class QueueDispatcher : public async::Dispatcher {
+    public:
+        std::deque<DispatchFunction> d_functions;
+
+        void dispatch(DispatchFunction function) override {
+            d_functions.push_back(std::move(function));
+        }
+
+        void runAll() {
+            while (!d_functions.empty()) {
+                auto function = std::move(d_functions.front());
+                d_functions.pop_front();
+                function();
+            }
+        }
+    };
+
+    /**
+     * @brief The event loop of a test: a manager that completes inline unless
+     * given a dispatcher, whose events are processed until a condition holds,
+     * and a buffer pool.
+     */
+    struct TestLoop {
+        // The pool outlives the manager, which can hold its buffers.
+        io::BufferPool d_pool;
+        AsyncSocketManager d_manager;
+        std::shared_ptr<io::FileDescriptorEventRegistry> d_registry = d_manager.registry();
+
+        explicit TestLoop(std::shared_ptr<async::Dispatcher> dispatcher = nullptr)
+        : d_manager(std::move(dispatcher))
+        {
+        }
+
+        /**
+         * @brief Process events until the specified `predicate` holds or the
+         * specified `timeout` passed, and return whether it holds.
+         */
+        template <typename PREDICATE>
+        bool processUntil(
+            PREDICATE predicate,
+            std::chrono::milliseconds timeout = std::chrono::seconds(1)) {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+
+            while (!predicate()) {
+                auto now = std::chrono::steady_clock::now();
+
+                if (now >= deadline) {
+                    return false;
+                }
+
+                d_manager.processEvents(std::min<std::chrono::nanoseconds>(
+                    deadline - now, std::chrono::milliseconds(10)));
+            }
+
+            return true;
+        }
+
+        io::BufferChain createChain(char const *text) {
+            auto buffer = d_pool.allocate(std::strlen(text));
+            std::memcpy(buffer.data(), text, std::strlen(text));
+            io::BufferChain chain;
+            chain.append(buffer, 0, std::strlen(text));
+            return chain;
+        }
+    };
+
+    /**
+     * @brief A TCP socket that listens on an ephemeral port of the loopback
+     * interface.
+     */
+    struct LoopbackListener {
+        int d_fileDescriptor = -1;
+        sockaddr_in d_address = {};
+
+        explicit LoopbackListener(int backlog = 16) {
+            d_fileDescriptor = socket(AF_INET, SOCK_STREAM, 0);
+            d_address.sin_family = AF_INET;
+            d_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(d_address);
+            EXPECT_EQ(0, bind(d_fileDescriptor, reinterpret_cast<sockaddr *>(&d_address), sizeof(d_address)));
+            EXPECT_EQ(0, listen(d_fileDescriptor, backlog));
+            EXPECT_EQ(0, getsockname(d_fileDescriptor, reinterpret_cast<sockaddr *>(&d_address), &length));
+        }
+
+        LoopbackListener(LoopbackListener const &) = delete;
+        LoopbackListener &operator=(LoopbackListener const &) = delete;
+
+        ~LoopbackListener() {
+            if (d_fileDescriptor != -1) {
+                close(d_fileDescriptor);
+            }
+        }
+
+        sockaddr const *address() const {
+            return reinterpret_cast<sockaddr const *>(&d_address);
+        }
+
+        socklen_t addressLength() const {
+            return sizeof(d_address);
+        }
+    };
+
+    /**
+     * @brief Connect two TCP sockets over the loopback interface and store
+     * them in the specified `sockets`.
+     */
+    inline void tcpSocketPair(int sockets[2]) {
+        LoopbackListener listener(1);
+        sockets[1] = socket(AF_INET, SOCK_STREAM, 0);
+        EXPECT_EQ(0, connect(sockets[1], listener.address(), listener.addressLength()));
+        sockets[0] = accept(listener.d_fileDescriptor, nullptr, nullptr);
+    }
+
+}
+}
+}
+
+#endif //  ECO_NET_TESTLOOP